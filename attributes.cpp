@@ -28,8 +28,9 @@ namespace zsdp{
 
 
 #define AMETHODS(CLASS_NAME, KEY)                                \
+constexpr AttrId CLASS_NAME::kId;                                \
 CLASS_NAME::~CLASS_NAME(){}                                      \
-string CLASS_NAME::key() const{ return KEY; }                    \
+StringView CLASS_NAME::key() const{ return StringView(KEY, sizeof(KEY) - 1); } \
 
 #define SINGLE_STRING_PARAM_METHODS(CLASS_NAME, PARAM_NAME, KEY) \
 AMETHODS(CLASS_NAME, KEY)                                        \
@@ -103,33 +104,73 @@ void registerAttribute(const string& key,
     attributeParseFncs[key] = parseFnc;
 }
 
-sp<Attribute> parseAttribute(const string& attrStr){
+static sp<Attribute> decodeAttribute(const string& attrStr, size_t keySize){
     call_once(initAttributesOnceFlag, initAttributes);
 
-    vector<string> tokens = split(attrStr, ":", 2);
-    string key = tokens[0];
-    string val = tokens.size() > 1 ? tokens[1] : "";
+    string key = attrStr.substr(0, keySize);
 
     auto it = attributeParseFncs.find(key);
-    if(it == attributeParseFncs.end()){
-        fprintf(stderr, "No attribute parser for key '%s'.\n", key.c_str());
+    if(it == attributeParseFncs.end())
         return NULL;
-    }
 
+    string val = keySize < attrStr.size() ? attrStr.substr(keySize + 1) : "";
     auto parseAttr = it->second;
 
     return parseAttr(key, val);
 }
 
+static size_t attributeKeySize(const string& attrStr){
+    size_t colon = attrStr.find(':');
+
+    return colon == string::npos ? attrStr.size() : colon;
+}
+
+sp<Attribute> parseAttribute(const string& attrStr){
+    sp<Attribute> attr = decodeAttribute(attrStr, attributeKeySize(attrStr));
+    if(attr == NULL)
+        attr = make_shared<GenericAttribute>(attrStr);
+
+    return attr;
+}
+
+constexpr AttrId GenericAttribute::kId;
+
+GenericAttribute::GenericAttribute(const string& line)
+    : Attribute(kId), mLine(line), mKeySize(attributeKeySize(line)) {}
+
+GenericAttribute::~GenericAttribute(){}
+
+StringView GenericAttribute::key() const{
+    return StringView(mLine).substr(0, mKeySize);
+}
+
+string GenericAttribute::value() const{
+    return mKeySize < mLine.size() ? mLine.substr(mKeySize + 1) : "";
+}
+
+string GenericAttribute::sdpLine() const{
+    return mLine;
+}
+
+void GenericAttribute::appendSdpLine(string& out) const{
+    out += mLine;
+}
+
+sp<Attribute> GenericAttribute::decode() const{
+    return decodeAttribute(mLine, mKeySize);
+}
+
+constexpr AttrId AttrMediaDirection::kId;
+
 AttrMediaDirection::~AttrMediaDirection(){
     
 }
 
 std::string AttrMediaDirection::sdpLine() const {
-    return key();
+    return key().str();
 }
 
-string AttrMediaDirection::key() const{
+StringView AttrMediaDirection::key() const{
     switch(direction){
         case MediaDirection::SendRecv: return "sendrecv";
         case MediaDirection::RecvOnly: return "recvonly";
@@ -145,7 +186,82 @@ string AttrMediaDirection::value() const{
 
 
 
-AMETHODS(AttrFormatParams, "fmtp")
+constexpr AttrId AttrFormatParams::kId;
+
+/// A parse of one value of formatParams. Earlier parses are kept, since a caller may still hold their maps.
+struct AttrFormatParams::Parsed {
+    Parsed(const string& formatParams, Parsed* previousParse)
+        : source(formatParams), params(source), previous(previousParse) {}
+
+    ~Parsed(){ delete previous; }
+
+    struct Decoded {
+        StringView key; // The key of the entry in params that was decoded.
+        BinaryEncoding encoding;
+        sp<const BinaryParam> param;
+    };
+
+    const string source;
+    const FormatParamMap params; // Views into source.
+    Parsed* previous;
+
+    mutex decodedMutex;
+    SmallVector<Decoded, 2> decoded; // Guarded by decodedMutex.
+};
+
+AttrFormatParams::AttrFormatParams(const AttrFormatParams& other)
+    : Attribute(kId), payloadType(other.payloadType), formatParams(other.formatParams), mParsed(NULL) {}
+
+AttrFormatParams& AttrFormatParams::operator=(const AttrFormatParams& other){
+    payloadType = other.payloadType;
+    formatParams = other.formatParams;
+    return *this;
+}
+
+AttrFormatParams::~AttrFormatParams(){
+    delete mParsed.load();
+}
+
+StringView AttrFormatParams::key() const{ return StringView("fmtp", 4); }
+
+AttrFormatParams::Parsed& AttrFormatParams::parsed() const{
+    Parsed* current = mParsed.load(memory_order_acquire);
+    while(current == NULL || current->source != formatParams){
+        Parsed* fresh = new Parsed(formatParams, current);
+        if(mParsed.compare_exchange_strong(current, fresh, memory_order_acq_rel))
+            return *fresh;
+
+        // Another thread published first; current is now its parse. Check that one instead.
+        fresh->previous = NULL;
+        delete fresh;
+    }
+
+    return *current;
+}
+
+const FormatParamMap& AttrFormatParams::params() const{
+    return parsed().params;
+}
+
+sp<const BinaryParam> AttrFormatParams::binaryParam(StringView key, BinaryEncoding encoding) const{
+    Parsed& parse = parsed();
+    const FormatParam* param = parse.params.find(key);
+    if(param == NULL)
+        return NULL;
+
+    lock_guard<mutex> lock(parse.decodedMutex);
+    for(const Parsed::Decoded& decoded : parse.decoded){
+        if(decoded.key.data() == param->key.data() && decoded.encoding == encoding)
+            return decoded.param;
+    }
+
+    // Decoded under the lock, so threads asking at once still decode it once. Failures are cached too.
+    Parsed::Decoded decoded = { param->key, encoding, BinaryParam::decode(param->value, encoding) };
+    parse.decoded.push_back(decoded);
+
+    return decoded.param;
+}
+
 string AttrFormatParams::value() const {
     return to_string(payloadType) + " " + formatParams;
 }
@@ -173,7 +289,7 @@ AMETHODS(AttrRtpMap, "rtpmap")
 string AttrRtpMap::value() const {
     std::string val = std::to_string(payloadType)
                       + " "
-                      + encodingName
+                      + encodingName.str()
                       + "/"
                       + std::to_string(clockRate);
 
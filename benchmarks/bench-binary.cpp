@@ -0,0 +1,72 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include <zsdp/binary.h>
+#include <zsdp/sdp.h>
+
+using namespace zsdp;
+using namespace std;
+
+int main(int argc, char** argv){
+    static const size_t streamCounts[] = { 2, 16, 64 };
+
+    for(size_t streamCount : streamCounts){
+        string sdpStr = bench::mediaHeavySdp(streamCount);
+        Sdp sdp = parseSdp(sdpStr);
+        size_t iterations = 200000 / streamCount;
+        string suffix = " " + to_string(streamCount) + " streams";
+
+        string encoded;
+        encodeBinarySdp(sdp, encoded);
+        printf("%zu streams: %zu bytes of SDP, %zu bytes encoded\n", streamCount, sdpStr.size(), encoded.size());
+
+        string name = "encodeBinarySdp" + suffix;
+        bench::run(name.c_str(), iterations, encoded.size(), [&](){
+            encoded.clear();
+            encodeBinarySdp(sdp, encoded);
+        });
+
+        // What a process receiving the encoding typically does: look at the ports.
+        size_t sink = 0;
+        name = "BinarySdpView ports" + suffix;
+        bench::run(name.c_str(), iterations, encoded.size(), [&](){
+            BinarySdpView view(encoded);
+            for(size_t i = 0; i < view.streamCount(); i++)
+                sink += view.stream(i).port();
+        });
+
+        name = "BinarySdpView::toSdp" + suffix;
+        bench::run(name.c_str(), iterations, encoded.size(), [&](){
+            Sdp decoded = BinarySdpView(encoded).toSdp();
+            sink += decoded.streams.size();
+        });
+
+        name = "parseSdp" + suffix;
+        bench::run(name.c_str(), iterations, sdpStr.size(), [&](){
+            Sdp parsed = parseSdp(sdpStr);
+            sink += parsed.streams.size();
+        });
+
+        if(sink == 0)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include <zsdp/capability-negotiation.h>
+
+using namespace zsdp;
+using namespace std;
+
+/// Accepts only the last crypto suite, so most alternatives are pruned.
+class SuiteCheck : public CapabilityCheck {
+public:
+    virtual bool acceptsAttribute(const Attribute& attribute) const override{
+        return attribute.value().find("SUITE_6") != string::npos;
+    }
+};
+
+int main(int argc, char** argv){
+    registerCapabilityNegotiationAttributes();
+
+    // 8 configurations of 6 attribute and 3 transport alternatives each: 144 potential configurations.
+    string text = "v=0\r\n"
+                  "o=- 1 1 IN IP4 192.0.2.1\r\n"
+                  "s=-\r\n"
+                  "t=0 0\r\n"
+                  "m=audio 53456 RTP/AVP 0 8\r\n"
+                  "a=ptime:20\r\n"
+                  "a=sendrecv\r\n"
+                  "a=tcap:1 RTP/SAVP RTP/AVP RTP/SAVPF\r\n";
+
+    for(int i = 1; i <= 6; i++)
+        text += "a=acap:" + to_string(i) + " crypto:1 SUITE_" + to_string(i) + " inline:WVNfX19zZW1jdGwgKCkgewkyMjA7fQp9CnVubGVz\r\n";
+
+    for(int i = 1; i <= 8; i++)
+        text += "a=pcfg:" + to_string(i) + " a=1|2|3|4|5|6 t=1|2|3\r\n";
+
+    Sdp offer = parseSdp(text);
+    SuiteCheck check;
+    size_t sink = 0;
+
+    // Expanding every alternative into a Stream, then choosing.
+    bench::run("expand all configurations", 2000, 0, [&](){
+        ConfigurationEnumerator configurations(offer, 0);
+        PotentialConfiguration config;
+        vector<Stream> expanded;
+        while(configurations.next(config))
+            expanded.push_back(applyConfiguration(offer.streams[0], config));
+
+        for(const Stream& stream : expanded){
+            if(stream.attributes.back()->value().find("SUITE_6") != string::npos){
+                sink += stream.attributes.size();
+                break;
+            }
+        }
+    });
+
+    bench::run("enumerate all lazily", 20000, 0, [&](){
+        ConfigurationEnumerator configurations(offer, 0);
+        PotentialConfiguration config;
+        while(configurations.next(config))
+            sink += config.attributes.size();
+    });
+
+    bench::run("first acceptable, pruned", 20000, 0, [&](){
+        ConfigurationEnumerator configurations(offer, 0, check);
+        PotentialConfiguration config;
+        if(configurations.next(config))
+            sink += applyConfiguration(offer.streams[0], config).attributes.size();
+    });
+
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include <zsdp/compress.h>
+
+using namespace zsdp;
+using namespace std;
+
+static const char* const kWebRtcOffer =
+    "v=0\r\n"
+    "o=- 4611731400430051336 2 IN IP4 127.0.0.1\r\n"
+    "s=-\r\n"
+    "t=0 0\r\n"
+    "a=group:BUNDLE 0 1\r\n"
+    "a=extmap-allow-mixed\r\n"
+    "a=msid-semantic: WMS stream\r\n"
+    "m=audio 9 UDP/TLS/RTP/SAVPF 111 63 9 0 8 13 110 126\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=rtcp:9 IN IP4 0.0.0.0\r\n"
+    "a=ice-ufrag:F7gI\r\n"
+    "a=ice-pwd:x9cml/YzichV2+XlhiMu8g\r\n"
+    "a=ice-options:trickle\r\n"
+    "a=fingerprint:sha-256 D2:FA:0E:C3:22:59:5E:14:95:69:92:3D:13:B4:84:24:2C:C2:A2:C0:3E:FD:34:8E:5E:EA:6F:AF:52:CE:E6:0F\r\n"
+    "a=setup:actpass\r\n"
+    "a=mid:0\r\n"
+    "a=extmap:1 urn:ietf:params:rtp-hdrext:ssrc-audio-level\r\n"
+    "a=extmap:2 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+    "a=extmap:3 http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01\r\n"
+    "a=extmap:4 urn:ietf:params:rtp-hdrext:sdes:mid\r\n"
+    "a=sendrecv\r\n"
+    "a=msid:stream track0\r\n"
+    "a=rtcp-mux\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=rtcp-fb:111 transport-cc\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=rtpmap:63 red/48000/2\r\n"
+    "a=fmtp:63 111/111\r\n"
+    "a=rtpmap:9 G722/8000\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "a=rtpmap:8 PCMA/8000\r\n"
+    "a=rtpmap:13 CN/8000\r\n"
+    "a=rtpmap:110 telephone-event/48000\r\n"
+    "a=rtpmap:126 telephone-event/8000\r\n"
+    "a=ssrc:1001 cname:4TOk42mSjXCkVIa6\r\n"
+    "m=video 9 UDP/TLS/RTP/SAVPF 96 97\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=rtcp:9 IN IP4 0.0.0.0\r\n"
+    "a=ice-ufrag:F7gI\r\n"
+    "a=ice-pwd:x9cml/YzichV2+XlhiMu8g\r\n"
+    "a=ice-options:trickle\r\n"
+    "a=fingerprint:sha-256 D2:FA:0E:C3:22:59:5E:14:95:69:92:3D:13:B4:84:24:2C:C2:A2:C0:3E:FD:34:8E:5E:EA:6F:AF:52:CE:E6:0F\r\n"
+    "a=setup:actpass\r\n"
+    "a=mid:1\r\n"
+    "a=sendrecv\r\n"
+    "a=rtcp-mux\r\n"
+    "a=rtcp-rsize\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=rtcp-fb:96 goog-remb\r\n"
+    "a=rtcp-fb:96 transport-cc\r\n"
+    "a=rtcp-fb:96 ccm fir\r\n"
+    "a=rtcp-fb:96 nack\r\n"
+    "a=rtcp-fb:96 nack pli\r\n"
+    "a=rtpmap:97 rtx/90000\r\n"
+    "a=fmtp:97 apt=96\r\n"
+    "a=ssrc-group:FID 2002 2003\r\n"
+    "a=ssrc:2002 cname:4TOk42mSjXCkVIa6\r\n"
+    "a=ssrc:2003 cname:4TOk42mSjXCkVIa6\r\n";
+
+static void benchInput(const char* label, const string& sdp, size_t iterations){
+    string compressed;
+    compressSdp(sdp, compressed);
+    printf("%s: %zu -> %zu bytes (%.1f%%)\n", label, sdp.size(), compressed.size(), 100.0 * compressed.size() / sdp.size());
+
+    string name = string("compressSdp ") + label;
+    bench::run(name.c_str(), iterations, sdp.size(), [&](){
+        compressed.clear();
+        compressSdp(sdp, compressed);
+    });
+
+    string out;
+    name = string("decompressSdp ") + label;
+    bench::run(name.c_str(), iterations, sdp.size(), [&](){
+        out.clear();
+        decompressSdp(compressed, out);
+    });
+}
+
+int main(int argc, char** argv){
+    benchInput("WebRTC offer", kWebRtcOffer, 200000);
+    benchInput("media-heavy 16 streams", bench::mediaHeavySdp(16), 20000);
+
+    return 0;
+}
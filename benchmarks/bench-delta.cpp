@@ -0,0 +1,70 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include <zsdp/delta.h>
+#include <zsdp/sdp.h>
+
+using namespace zsdp;
+using namespace std;
+
+int main(int argc, char** argv){
+    static const size_t streamCounts[] = { 2, 16, 64 };
+
+    for(size_t streamCount : streamCounts){
+        string baseStr = bench::mediaHeavySdp(streamCount);
+        Sdp base = parseSdp(baseStr);
+        size_t iterations = 200000 / streamCount;
+        string suffix = " " + to_string(streamCount) + " streams";
+
+        // A typical re-offer: new session version, one port moved.
+        Sdp next = base;
+        next.origin.sessionVersion = "3";
+        next.streams[streamCount / 2].mediaDescription.port = 40000;
+        string nextStr = sdpToString(&next);
+
+        string delta;
+        encodeDelta(base, next, delta);
+        printf("%zu streams: %zu bytes of SDP, %zu byte delta\n", streamCount, nextStr.size(), delta.size());
+
+        string name = "encodeDelta" + suffix;
+        bench::run(name.c_str(), iterations, 0, [&](){
+            delta.clear();
+            encodeDelta(base, next, delta);
+        });
+
+        size_t sink = 0;
+        name = "applyDelta" + suffix;
+        bench::run(name.c_str(), iterations, 0, [&](){
+            Sdp applied = applyDelta(base, delta);
+            sink += applied.streams.size();
+        });
+
+        name = "parseSdp" + suffix;
+        bench::run(name.c_str(), iterations, 0, [&](){
+            Sdp parsed = parseSdp(nextStr);
+            sink += parsed.streams.size();
+        });
+
+        if(sink == 0)
+            return 1;
+    }
+
+    return 0;
+}
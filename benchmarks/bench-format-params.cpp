@@ -0,0 +1,104 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include <zsdp/sdp.h>
+#include "../string-util.h"
+
+using namespace zsdp;
+using namespace std;
+
+int main(int argc, char** argv){
+    AttrFormatParams fmtp;
+    fmtp.payloadType = 97;
+    fmtp.formatParams = "profile-level-id=42e01f;packetization-mode=1;level-asymmetry-allowed=1";
+
+    const size_t iterations = 2000000;
+    size_t sink = 0;
+
+    // What consumers do today: split the string again for every lookup.
+    bench::run("split per lookup", iterations, 0, [&](){
+        for(const string& param : split(fmtp.formatParams, ";")){
+            size_t equals = param.find('=');
+            if(param.compare(0, equals, "packetization-mode") == 0)
+                sink += param[equals + 1] - '0';
+        }
+    });
+
+    bench::run("FormatParamMap build", iterations, 0, [&](){
+        FormatParamMap params(fmtp.formatParams);
+        sink += params.size();
+    });
+
+    bench::run("cached params() lookup", iterations, 0, [&](){
+        sink += fmtp.params().intOr("packetization-mode", 0);
+    });
+
+    bench::run("cached parseH264Params", iterations, 0, [&](){
+        H264Params h264;
+        parseH264Params(fmtp.params(), &h264);
+        sink += h264.packetizationMode;
+    });
+
+    // A large parameter set: a 4 KiB blob, as base64 and hex.
+    string blob;
+    for(size_t i = 0; i < 4096; i++)
+        blob += (char)(i * 131);
+
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    string base64;
+    for(size_t i = 0; i + 3 <= blob.size(); i += 3){
+        uint32_t group = ((uint32_t)(uint8_t)blob[i] << 16) | ((uint32_t)(uint8_t)blob[i + 1] << 8) | (uint8_t)blob[i + 2];
+        for(int shift = 18; shift >= 0; shift -= 6)
+            base64 += alphabet[(group >> shift) & 63];
+    }
+
+    string hex;
+    for(char c : blob){
+        hex += "0123456789abcdef"[(uint8_t)c >> 4];
+        hex += "0123456789abcdef"[c & 15];
+    }
+
+    vector<uint8_t> bytes;
+    bench::run("decodeBase64 4 KiB", 20000, base64.size(), [&](){
+        bytes.clear();
+        decodeBase64(base64, bytes);
+        sink += bytes.size();
+    });
+
+    bench::run("decodeHex 4 KiB", 20000, hex.size(), [&](){
+        bytes.clear();
+        decodeHex(hex, bytes);
+        sink += bytes.size();
+    });
+
+    // What stream start does today versus the cached accessor.
+    AttrFormatParams h264;
+    h264.formatParams = "profile-level-id=42e01f;packetization-mode=1;sprop-parameter-sets=Z0LgH9oFB+Q=,aM4G4g==";
+
+    bench::run("decode sprop-parameter-sets", iterations, 0, [&](){
+        sink += BinaryParam::decode(h264.params().get("sprop-parameter-sets"), BinaryEncoding::Base64)->unitCount();
+    });
+
+    bench::run("cached spropParameterSets()", iterations, 0, [&](){
+        sink += h264.spropParameterSets()->unitCount();
+    });
+
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include "heap-counter.h"
+#include <zsdp/frozen.h>
+#include <zsdp/sdp.h>
+
+using namespace zsdp;
+using namespace std;
+
+int main(int argc, char** argv){
+    static const size_t streamCounts[] = { 2, 16, 64 };
+
+    for(size_t streamCount : streamCounts){
+        string text = bench::mediaHeavySdp(streamCount);
+        size_t iterations = 200000 / streamCount;
+        string suffix = " " + to_string(streamCount) + " streams";
+
+        size_t before = bench::liveHeapBytes();
+        Sdp* sdp = new Sdp(parseSdp(text));
+        size_t sdpBytes = bench::liveHeapBytes() - before;
+
+        before = bench::liveHeapBytes();
+        FrozenSdp* frozen = new FrozenSdp(*sdp);
+        size_t frozenBytes = bench::liveHeapBytes() - before;
+
+        printf("%zu streams: %zu bytes of SDP text, Sdp %zu heap bytes, FrozenSdp %zu heap bytes (%.1fx smaller)\n",
+               streamCount, text.size(), sdpBytes, frozenBytes, (double)sdpBytes / frozenBytes);
+
+        string name = "freeze" + suffix;
+        size_t sink = 0;
+        bench::run(name.c_str(), iterations, 0, [&](){
+            FrozenSdp f(*sdp);
+            sink += f.streamCount();
+        });
+
+        name = "frozen walk" + suffix;
+        bench::run(name.c_str(), iterations, 0, [&](){
+            for(size_t i = 0; i < frozen->streamCount(); i++){
+                FrozenStream stream = frozen->stream(i);
+                for(size_t j = 0; j < stream.attributeCount(); j++)
+                    sink += stream.attribute(j).value.size();
+            }
+        });
+
+        name = "Sdp walk" + suffix;
+        bench::run(name.c_str(), iterations, 0, [&](){
+            for(const Stream& stream : sdp->streams){
+                for(const sp<Attribute>& attr : stream.attributes)
+                    sink += attr->value().size();
+            }
+        });
+
+        name = "thaw" + suffix;
+        bench::run(name.c_str(), iterations / 4, 0, [&](){
+            Sdp thawed = frozen->toSdp();
+            sink += thawed.streams.size();
+        });
+
+        delete frozen;
+        delete sdp;
+
+        if(sink == 0)
+            return 1;
+    }
+
+    return 0;
+}
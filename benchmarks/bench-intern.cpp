@@ -0,0 +1,87 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include "heap-counter.h"
+#include <zsdp/intern.h>
+#include <zsdp/sdp.h>
+
+using namespace zsdp;
+using namespace std;
+
+/// Builds a table of sessionCount Sdps that differ only in their session IDs.
+static vector<Sdp> buildTable(const string& text, size_t sessionCount, const ParseOptions& options){
+    vector<Sdp> table;
+    table.reserve(sessionCount);
+    for(size_t i = 0; i < sessionCount; i++){
+        table.push_back(parseSdp(text, options));
+        table.back().origin.sessionID = to_string(i);
+    }
+
+    return table;
+}
+
+int main(int argc, char** argv){
+    static const size_t sessionCount = 2000;
+    static const size_t streamCounts[] = { 2, 16 };
+
+    for(size_t streamCount : streamCounts){
+        string text = bench::mediaHeavySdp(streamCount);
+        string suffix = " " + to_string(streamCount) + " streams";
+
+        ParseOptions plainOptions;
+        size_t before = bench::liveHeapBytes();
+        vector<Sdp>* plain = new vector<Sdp>(buildTable(text, sessionCount, plainOptions));
+        size_t plainBytes = bench::liveHeapBytes() - before;
+
+        InternPool pool;
+        ParseOptions internOptions;
+        internOptions.internPool = &pool;
+        before = bench::liveHeapBytes();
+        vector<Sdp>* interned = new vector<Sdp>(buildTable(text, sessionCount, internOptions));
+        size_t internedBytes = bench::liveHeapBytes() - before;
+
+        InternStats stats = pool.stats();
+        printf("%zu sessions x %zu streams: %zu heap bytes, %zu interned (%.1fx smaller); %zu distinct of %zu attributes (%.0fx)\n",
+               sessionCount, streamCount, plainBytes, internedBytes, (double)plainBytes / internedBytes,
+               stats.distinctAttributes, stats.attributeLookups, stats.attributeDedupRatio());
+
+        size_t iterations = 100000 / streamCount;
+        size_t sink = 0;
+        string name = "parseSdp" + suffix;
+        bench::run(name.c_str(), iterations, text.size(), [&](){
+            Sdp sdp = parseSdp(text, plainOptions);
+            sink += sdp.streams.size();
+        });
+
+        name = "parseSdp interned" + suffix;
+        bench::run(name.c_str(), iterations, text.size(), [&](){
+            Sdp sdp = parseSdp(text, internOptions);
+            sink += sdp.streams.size();
+        });
+
+        delete interned;
+        delete plain;
+
+        if(sink == 0)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include <zsdp/json.h>
+#include <zsdp/sdp.h>
+
+using namespace zsdp;
+using namespace std;
+
+int main(int argc, char** argv){
+    static const size_t streamCounts[] = { 2, 16, 64 };
+
+    for(size_t streamCount : streamCounts){
+        Sdp sdp = parseSdp(bench::mediaHeavySdp(streamCount));
+        size_t iterations = 200000 / streamCount;
+        string suffix = " " + to_string(streamCount) + " streams";
+
+        string sdpStr;
+        sdpToString(&sdp, sdpStr);
+        string name = "sdpToString" + suffix;
+        bench::run(name.c_str(), iterations, sdpStr.size(), [&](){
+            sdpStr.clear();
+            sdpToString(&sdp, sdpStr);
+        });
+
+        string json;
+        sdpToJson(sdp, json);
+        name = "sdpToJson" + suffix;
+        bench::run(name.c_str(), iterations, json.size(), [&](){
+            json.clear();
+            sdpToJson(sdp, json);
+        });
+
+        size_t sink = 0;
+        name = "sdpFromJson" + suffix;
+        bench::run(name.c_str(), iterations, json.size(), [&](){
+            Sdp fromJson = sdpFromJson(json);
+            sink += fromJson.streams.size();
+        });
+
+        if(sink == 0)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include <zsdp/negotiator.h>
+
+using namespace zsdp;
+using namespace std;
+
+static void addCodec(LocalCapabilities& local, MediaType mediaType, const char* name, uint32_t clockRate, uint32_t channels, const char* fmtp){
+    LocalCodec codec;
+    codec.mediaType = mediaType;
+    codec.encodingName = name;
+    codec.clockRate = clockRate;
+    codec.channels = channels;
+    codec.formatParams = fmtp;
+    local.codecs.push_back(codec);
+}
+
+int main(int argc, char** argv){
+    LocalCapabilities local;
+    addCodec(local, MediaType::Audio, "opus", 48000, 2, "minptime=10;useinbandfec=1");
+    addCodec(local, MediaType::Audio, "G722", 8000, 1, "");
+    addCodec(local, MediaType::Audio, "PCMA", 8000, 1, "");
+    addCodec(local, MediaType::Audio, "PCMU", 8000, 1, "");
+    addCodec(local, MediaType::Audio, "telephone-event", 8000, 1, "0-15");
+    addCodec(local, MediaType::Video, "AV1", 90000, 1, "");
+    addCodec(local, MediaType::Video, "VP9", 90000, 1, "profile-id=0");
+    addCodec(local, MediaType::Video, "H264", 90000, 1, "profile-level-id=42e01f;packetization-mode=1");
+    addCodec(local, MediaType::Video, "VP8", 90000, 1, "");
+    local.origin.host = "192.0.2.10";
+    local.connectionData.host = "192.0.2.10";
+    local.firstPort = 40000;
+
+    Negotiator negotiator(local);
+    static const size_t streamCounts[] = { 2, 16 };
+
+    for(size_t streamCount : streamCounts){
+        string text = bench::mediaHeavySdp(streamCount);
+        Sdp offer = parseSdp(text);
+        size_t iterations = 200000 / streamCount;
+        string suffix = " " + to_string(streamCount) + " streams";
+        size_t sink = 0;
+
+        string name = "answer" + suffix;
+        bench::run(name.c_str(), iterations, 0, [&](){
+            Sdp answer = negotiator.answer(offer);
+            sink += answer.streams.size();
+        });
+
+        name = "parse + answer + write" + suffix;
+        string out;
+        bench::run(name.c_str(), iterations / 4, text.size(), [&](){
+            Sdp parsed = parseSdp(text);
+            Sdp answer = negotiator.answer(parsed);
+            out.clear();
+            sdpToString(&answer, out);
+            sink += out.size();
+        });
+
+        if(sink == 0)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include "heap-counter.h"
+#include <zsdp/intern.h>
+#include <zsdp/sdp.h>
+#include "../json-util.h"
+
+using namespace zsdp;
+using namespace std;
+
+/// Heap allocations made by one call of fnc.
+template<typename Fnc>
+size_t allocationsPerCall(Fnc fnc){
+    size_t before = bench::heapAllocationCount();
+    fnc();
+
+    return bench::heapAllocationCount() - before;
+}
+
+int main(int argc, char** argv){
+    static const size_t streamCounts[] = { 2, 16, 64 };
+
+    for(size_t streamCount : streamCounts){
+        string sdpStr = bench::mediaHeavySdp(streamCount);
+        size_t iterations = 200000 / streamCount;
+        string name = "parseSdp " + to_string(streamCount) + " streams";
+
+        size_t sink = 0;
+        bench::run(name.c_str(), iterations, sdpStr.size(), [&](){
+            Sdp sdp = parseSdp(sdpStr);
+            sink += sdp.streams.size();
+        });
+
+        // A signalling message carries the SDP as a JSON string.
+        string jsonStr;
+        appendJsonString(jsonStr, sdpStr);
+        StringView escaped(jsonStr.data() + 1, jsonStr.size() - 2);
+
+        name = "unescape + parseSdp " + to_string(streamCount) + " streams";
+        bench::run(name.c_str(), iterations, jsonStr.size(), [&](){
+            string unescaped;
+            appendJsonUnescaped(unescaped, escaped);
+            Sdp sdp = parseSdp(unescaped);
+            sink += sdp.streams.size();
+        });
+
+        ParseOptions jsonOptions;
+        jsonOptions.inputEncoding = InputEncoding::JsonString;
+        name = "parseSdp JsonString " + to_string(streamCount) + " streams";
+        bench::run(name.c_str(), iterations, jsonStr.size(), [&](){
+            Sdp sdp = parseSdp(escaped, jsonOptions);
+            sink += sdp.streams.size();
+        });
+
+        Sdp reuse;
+        ParseContext& context = threadParseContext();
+        name = "parseSdpInto " + to_string(streamCount) + " streams";
+        bench::run(name.c_str(), iterations, sdpStr.size(), [&](){
+            parseSdpInto(reuse, sdpStr, context);
+            sink += reuse.streams.size();
+        });
+
+        InternPool pool;
+        ParseOptions internOptions;
+        internOptions.internPool = &pool;
+        name = "parseSdpInto interned " + to_string(streamCount) + " streams";
+        bench::run(name.c_str(), iterations, sdpStr.size(), [&](){
+            parseSdpInto(reuse, sdpStr, context, internOptions);
+            sink += reuse.streams.size();
+        });
+
+        printf("allocations per parse: parseSdp %zu, parseSdpInto %zu, parseSdpInto interned %zu\n",
+               allocationsPerCall([&](){ Sdp sdp = parseSdp(sdpStr); }),
+               allocationsPerCall([&](){ parseSdpInto(reuse, sdpStr, context); }),
+               allocationsPerCall([&](){ parseSdpInto(reuse, sdpStr, context, internOptions); }));
+
+        if(sink == 0)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include <zsdp/patcher.h>
+
+using namespace zsdp;
+using namespace std;
+
+static const char* const kTypicalOffer =
+    "v=0\r\n"
+    "o=alice 2890844526 2890844526 IN IP4 192.168.1.10\r\n"
+    "s=-\r\n"
+    "c=IN IP4 192.168.1.10\r\n"
+    "t=0 0\r\n"
+    "m=audio 49170 RTP/AVP 0 8 101\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "a=rtpmap:8 PCMA/8000\r\n"
+    "a=rtpmap:101 telephone-event/8000\r\n"
+    "a=sendrecv\r\n"
+    "m=video 51372 RTP/AVP 96\r\n"
+    "a=rtpmap:96 H264/90000\r\n"
+    "a=fmtp:96 profile-level-id=42e01f;packetization-mode=1\r\n"
+    "a=sendrecv\r\n";
+
+int main(int argc, char** argv){
+    SdpPatcher patcher;
+    patcher.setOriginAddress("198.51.100.7");
+    patcher.setConnectionAddress("198.51.100.7");
+    patcher.setMediaPort(0, 40000);
+    patcher.setMediaPort(1, 40002);
+
+    string typical = kTypicalOffer;
+    string heavy = bench::mediaHeavySdp(2);
+
+    string out;
+    size_t sink = 0;
+    double ns = bench::run("SdpPatcher::apply typical offer", 2000000, typical.size(), [&](){
+        sink += patcher.apply(typical, out);
+    });
+
+    printf("%.2f million patched SDPs/s\n", 1000.0 / ns);
+
+    ns = bench::run("SdpPatcher::apply media-heavy 2 streams", 2000000, heavy.size(), [&](){
+        sink += patcher.apply(heavy, out);
+    });
+
+    printf("%.2f million patched SDPs/s\n", 1000.0 / ns);
+
+    return sink == 0 ? 1 : 0;
+}
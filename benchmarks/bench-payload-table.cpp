@@ -0,0 +1,57 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include <zsdp/payload-table.h>
+
+using namespace zsdp;
+using namespace std;
+
+int main(int argc, char** argv){
+    Sdp sdp = parseSdp(bench::mediaHeavySdp(2));
+    const Stream& video = sdp.streams[1];
+    static const uint8_t packets[] = { 96, 97, 98, 97, 96, 98, 98, 97 };
+    const size_t iterations = 10000000;
+    size_t i = 0;
+    uint64_t sink = 0;
+
+    // What the packet path does today: find the rtpmap by walking the attributes.
+    bench::run("attribute walk per packet", iterations, 0, [&](){
+        uint8_t pt = packets[i++ & 7];
+        for(const sp<Attribute>& attr : video.attributes){
+            const AttrRtpMap* rtpMap = attr->as<AttrRtpMap>();
+            if(rtpMap != NULL && rtpMap->payloadType == pt){
+                sink += rtpMap->clockRate;
+                break;
+            }
+        }
+    });
+
+    PayloadTable table(video);
+    bench::run("PayloadTable per packet", iterations, 0, [&](){
+        sink += table[packets[i++ & 7]].clockRate;
+    });
+
+    bench::run("PayloadTable build", 100000, 0, [&](){
+        PayloadTable built(video);
+        sink += built.size();
+    });
+
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include <zsdp/payload-type-set.h>
+#include <zsdp/sdp.h>
+#include <algorithm>
+
+using namespace zsdp;
+using namespace std;
+
+int main(int argc, char** argv){
+    static const size_t participantCounts[] = { 4, 32 };
+
+    for(size_t participantCount : participantCounts){
+        // Every participant offers a slightly different list of 16 payload types.
+        vector<MediaDescription> participants(participantCount);
+        for(size_t p = 0; p < participantCount; p++){
+            for(uint8_t pt = 96; pt < 112; pt++)
+                participants[p].addPayloadType(pt == 96 + p % 16 ? 0 : pt);
+        }
+
+        size_t iterations = 4000000 / participantCount;
+        string suffix = " " + to_string(participantCount) + " participants";
+        size_t sink = 0;
+
+        // What a bridge does today: narrow the common list one participant at a time.
+        string name = "nested-loop intersection" + suffix;
+        bench::run(name.c_str(), iterations, 0, [&](){
+            PayloadTypeList common = participants[0].payloadTypes;
+            for(size_t p = 1; p < participantCount; p++){
+                const PayloadTypeList& other = participants[p].payloadTypes;
+                common.erase(remove_if(common.begin(), common.end(), [&](uint8_t pt){
+                    return find(other.begin(), other.end(), pt) == other.end();
+                }), common.end());
+            }
+
+            sink += common.size();
+        });
+
+        name = "PayloadTypeSet intersection" + suffix;
+        bench::run(name.c_str(), iterations, 0, [&](){
+            PayloadTypeSet common = participants[0].payloadTypeSet;
+            for(size_t p = 1; p < participantCount; p++)
+                common &= participants[p].payloadTypeSet;
+
+            sink += common.size();
+        });
+
+        if(sink == 0)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include <zsdp/sdp-merge.h>
+
+using namespace zsdp;
+using namespace std;
+
+int main(int argc, char** argv){
+    const int kPublishers = 100;
+
+    // Every publisher uses the same numbers, as browsers do; half send H264 where the others send VP8.
+    vector<SdpSnapshot> publishers;
+    for(int i = 0; i < kPublishers; i++){
+        bool h264 = i % 2 == 1;
+        string text = "v=0\r\n"
+                      "o=- " + to_string(i + 1) + " 1 IN IP4 10.0.0.1\r\n"
+                      "s=-\r\n"
+                      "t=0 0\r\n"
+                      "m=audio 9 RTP/AVP 111\r\n"
+                      "a=mid:a" + to_string(i) + "\r\n"
+                      "a=rtpmap:111 opus/48000/2\r\n"
+                      "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+                      "a=rtcp-fb:111 transport-cc\r\n"
+                      "a=extmap:1 urn:ietf:params:rtp-hdrext:ssrc-audio-level\r\n"
+                      "a=sendonly\r\n"
+                      "a=ssrc:" + to_string(1000 + i) + " cname:publisher" + to_string(i) + "\r\n"
+                      "m=video 9 RTP/AVP 96 97\r\n"
+                      "a=mid:v" + to_string(i) + "\r\n"
+                      + (h264 ? "a=rtpmap:96 H264/90000\r\n"
+                                "a=fmtp:96 profile-level-id=42e01f;packetization-mode=1\r\n"
+                              : "a=rtpmap:96 VP8/90000\r\n") +
+                      "a=rtpmap:97 rtx/90000\r\n"
+                      "a=fmtp:97 apt=96\r\n"
+                      "a=rtcp-fb:96 nack\r\n"
+                      "a=rtcp-fb:96 nack pli\r\n"
+                      "a=rtcp-fb:96 transport-cc\r\n"
+                      "a=extmap:2 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+                      "a=sendonly\r\n"
+                      "a=ssrc:" + to_string(2000 + i) + " cname:publisher" + to_string(i) + "\r\n";
+
+        publishers.emplace_back(parseSdp(text));
+    }
+
+    Sdp session = parseSdp("v=0\r\n"
+                           "o=- 7 1 IN IP4 10.0.0.9\r\n"
+                           "s=-\r\n"
+                           "t=0 0\r\n"
+                           "a=msid-semantic: WMS\r\n");
+
+    size_t sink = 0;
+    string out;
+
+    // Copying each Stream into one Sdp and serializing it, without any remapping.
+    bench::run("copy sections and serialize", 500, 0, [&](){
+        Sdp merged = session;
+        string group = "group:BUNDLE";
+        for(const SdpSnapshot& publisher : publishers){
+            for(size_t i = 0; i < publisher.streamCount(); i++){
+                merged.streams.push_back(publisher.stream(i));
+                group += " " + merged.streams.back().attributes[0]->value();   // a=mid comes first.
+            }
+        }
+
+        merged.attributes.insert(merged.attributes.begin(), make_shared<GenericAttribute>(group));
+
+        out.clear();
+        sdpToString(&merged, out);
+        sink += out.size();
+    });
+
+    // The same remapping, but through a full copy of every section.
+    bench::run("merge, copy and serialize", 500, 0, [&](){
+        SdpMerger merger(session);
+        for(const SdpSnapshot& publisher : publishers){
+            for(size_t i = 0; i < publisher.streamCount(); i++)
+                merger.add(publisher, i);
+        }
+
+        Sdp merged = merger.toSdp();
+        out.clear();
+        sdpToString(&merged, out);
+        sink += out.size();
+    });
+
+    bench::run("merge by reference and write", 500, 0, [&](){
+        SdpMerger merger(session);
+        for(const SdpSnapshot& publisher : publishers){
+            for(size_t i = 0; i < publisher.streamCount(); i++)
+                merger.add(publisher, i);
+        }
+
+        out.clear();
+        merger.write(out);
+        sink += out.size();
+    });
+
+    // A subscriber joining an existing session only needs the write.
+    SdpMerger merger(session);
+    for(const SdpSnapshot& publisher : publishers){
+        for(size_t i = 0; i < publisher.streamCount(); i++)
+            merger.add(publisher, i);
+    }
+
+    bench::run("write a built merger", 500, 0, [&](){
+        out.clear();
+        merger.write(out);
+        sink += out.size();
+    });
+
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include "heap-counter.h"
+#include <zsdp/sdp.h>
+
+using namespace zsdp;
+using namespace std;
+
+/*
+ * The container layout before SmallVector, holding the same elements, so
+ * only the containers differ between the two runs.
+ */
+struct VectorStream {
+    vector<uint8_t> payloadTypes;
+    vector<sp<Attribute>> attributes;
+};
+
+struct VectorSdp {
+    vector<sp<Attribute>> attributes;
+    vector<VectorStream> streams;
+};
+
+static VectorSdp toVectorLayout(const Sdp& sdp){
+    VectorSdp out;
+    out.attributes.assign(sdp.attributes.begin(), sdp.attributes.end());
+    for(const Stream& stream : sdp.streams){
+        out.streams.emplace_back();
+        VectorStream& s = out.streams.back();
+        s.payloadTypes.assign(stream.mediaDescription.payloadTypes.begin(), stream.mediaDescription.payloadTypes.end());
+        s.attributes.assign(stream.attributes.begin(), stream.attributes.end());
+    }
+
+    return out;
+}
+
+struct SmallStream {
+    PayloadTypeList payloadTypes;
+    AttributeList attributes;
+};
+
+struct SmallSdp {
+    AttributeList attributes;
+    SmallVector<SmallStream, 3> streams;
+};
+
+static SmallSdp toSmallLayout(const Sdp& sdp){
+    SmallSdp out;
+    out.attributes.assign(sdp.attributes.begin(), sdp.attributes.end());
+    for(const Stream& stream : sdp.streams){
+        out.streams.emplace_back();
+        SmallStream& s = out.streams.back();
+        s.payloadTypes.assign(stream.mediaDescription.payloadTypes.begin(), stream.mediaDescription.payloadTypes.end());
+        s.attributes.assign(stream.attributes.begin(), stream.attributes.end());
+    }
+
+    return out;
+}
+
+/// Heap allocations made by one call to fnc.
+template<typename Fnc>
+static size_t allocationsPerCall(Fnc fnc){
+    size_t before = bench::heapAllocationCount();
+    fnc();
+    return bench::heapAllocationCount() - before;
+}
+
+int main(int argc, char** argv){
+    static const size_t streamCounts[] = { 2, 3, 16 };
+
+    for(size_t streamCount : streamCounts){
+        string text = bench::mediaHeavySdp(streamCount);
+        Sdp sdp = parseSdp(text);
+        string suffix = " " + to_string(streamCount) + " streams";
+        size_t sink = 0;
+
+        auto buildVector = [&](){ sink += toVectorLayout(sdp).streams.size(); };
+        auto buildSmall = [&](){ sink += toSmallLayout(sdp).streams.size(); };
+        auto copySdp = [&](){ Sdp copy(sdp); sink += copy.streams.size(); };
+        auto parse = [&](){ sink += parseSdp(text).streams.size(); };
+
+        printf("%zu streams: containers %zu allocations with std::vector, %zu with SmallVector; "
+               "copy Sdp %zu, parseSdp %zu allocations\n",
+               streamCount, allocationsPerCall(buildVector), allocationsPerCall(buildSmall),
+               allocationsPerCall(copySdp), allocationsPerCall(parse));
+
+        size_t iterations = 400000 / streamCount;
+        string name = "std::vector layout" + suffix;
+        bench::run(name.c_str(), iterations, 0, buildVector);
+
+        name = "SmallVector layout" + suffix;
+        bench::run(name.c_str(), iterations, 0, buildSmall);
+
+        name = "copy Sdp" + suffix;
+        bench::run(name.c_str(), iterations, 0, copySdp);
+
+        name = "parseSdp" + suffix;
+        bench::run(name.c_str(), iterations / 10, text.size(), parse);
+
+        if(sink == 0)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bench-util.h"
+#include <zsdp/snapshot.h>
+#include <zsdp/sdp.h>
+#include <mutex>
+
+using namespace zsdp;
+using namespace std;
+
+int main(int argc, char** argv){
+    static const size_t streamCounts[] = { 2, 16 };
+
+    for(size_t streamCount : streamCounts){
+        string text = bench::mediaHeavySdp(streamCount);
+        size_t iterations = 400000 / streamCount;
+        string suffix = " " + to_string(streamCount) + " streams";
+        size_t sink = 0;
+
+        // What readers do today: copy the current Sdp under a lock.
+        Sdp sdp = parseSdp(text);
+        mutex sdpMutex;
+        string name = "locked Sdp copy" + suffix;
+        bench::run(name.c_str(), iterations, 0, [&](){
+            lock_guard<mutex> lock(sdpMutex);
+            Sdp copy = sdp;
+            sink += copy.streams.size();
+        });
+
+        AtomicSdpSnapshot current((SdpSnapshot(sdp)));
+        name = "snapshot load" + suffix;
+        bench::run(name.c_str(), iterations, 0, [&](){
+            SdpSnapshot snapshot = current.load();
+            sink += snapshot.streamCount();
+        });
+
+        SdpSnapshot snapshot = current.load();
+        uint16_t port = 0;
+        name = "Sdp copy + port change" + suffix;
+        bench::run(name.c_str(), iterations, 0, [&](){
+            Sdp next = sdp;
+            next.streams[0].mediaDescription.port = port++;
+            sink += next.streams.size();
+        });
+
+        name = "snapshot port change" + suffix;
+        bench::run(name.c_str(), iterations, 0, [&](){
+            SdpSnapshot next = snapshot.updateStream(0, [&](Stream& s){ s.mediaDescription.port = port++; });
+            sink += next.streamCount();
+        });
+
+        if(sink == 0)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_BENCH_UTIL_H__
+#define __ZSDP_BENCH_UTIL_H__
+
+#include <chrono>
+#include <stdio.h>
+#include <string>
+
+
+namespace zsdp {
+namespace bench {
+
+/**
+ * An SDP with streamCount audio/video m-sections, each carrying a handful
+ * of rtpmap/fmtp lines, like a conference offer.
+ */
+inline std::string mediaHeavySdp(size_t streamCount){
+    std::string sdp =
+        "v=0\r\n"
+        "o=- 4611731400430051336 2 IN IP4 127.0.0.1\r\n"
+        "s=-\r\n"
+        "c=IN IP4 203.0.113.1\r\n"
+        "t=0 0\r\n"
+        "a=tool:zsdp-bench\r\n";
+
+    for(size_t i = 0; i < streamCount; i++){
+        std::string port = std::to_string(10000 + 2 * i);
+        if(i % 2 == 0){
+            sdp += "m=audio " + port + " RTP/AVP 111 0 8 101\r\n"
+                   "c=IN IP4 203.0.113.1\r\n"
+                   "b=AS:64\r\n"
+                   "a=rtpmap:111 opus/48000/2\r\n"
+                   "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+                   "a=rtpmap:0 PCMU/8000\r\n"
+                   "a=rtpmap:8 PCMA/8000\r\n"
+                   "a=rtpmap:101 telephone-event/8000\r\n"
+                   "a=fmtp:101 0-15\r\n"
+                   "a=ptime:20\r\n"
+                   "a=maxptime:60\r\n"
+                   "a=sendrecv\r\n";
+        }
+        else{
+            sdp += "m=video " + port + " RTP/AVP 96 97 98\r\n"
+                   "c=IN IP4 203.0.113.1\r\n"
+                   "b=AS:2000\r\n"
+                   "a=rtpmap:96 VP8/90000\r\n"
+                   "a=rtpmap:97 H264/90000\r\n"
+                   "a=fmtp:97 profile-level-id=42e01f;packetization-mode=1;level-asymmetry-allowed=1\r\n"
+                   "a=rtpmap:98 VP9/90000\r\n"
+                   "a=fmtp:98 profile-id=0\r\n"
+                   "a=framerate:30\r\n"
+                   "a=sendrecv\r\n";
+        }
+    }
+
+    return sdp;
+}
+
+/**
+ * Runs fnc iterations times and prints the mean time per call, plus the
+ * throughput when bytesPerIteration is non-zero.
+ */
+template<typename Fnc>
+double run(const char* name, size_t iterations, size_t bytesPerIteration, Fnc fnc){
+    for(size_t i = 0; i < iterations / 10 + 1; i++)
+        fnc();
+
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; i++)
+        fnc();
+
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double nsPerIteration = seconds * 1e9 / iterations;
+
+    if(bytesPerIteration > 0){
+        double mbPerSec = bytesPerIteration * (double)iterations / seconds / 1e6;
+        printf("%-40s %12.1f ns/op %10.1f MB/s\n", name, nsPerIteration, mbPerSec);
+    }
+    else
+        printf("%-40s %12.1f ns/op\n", name, nsPerIteration);
+
+    return nsPerIteration;
+}
+
+} // namespace bench
+} // namespace zsdp
+
+#endif /* __ZSDP_BENCH_UTIL_H__ */
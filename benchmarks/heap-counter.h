@@ -0,0 +1,79 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_HEAP_COUNTER_H__
+#define __ZSDP_HEAP_COUNTER_H__
+
+/*
+ * Replaces the global operator new/delete to track live heap bytes and
+ * count allocations. Include
+ * from exactly one file of a benchmark.
+ */
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+
+namespace zsdp {
+namespace bench {
+
+/// Live heap bytes, as requested by the program (allocator overhead not included).
+static std::atomic<size_t> gLiveBytes(0);
+static std::atomic<size_t> gAllocationCount(0);
+static const size_t kHeaderSize = 16;
+
+inline size_t liveHeapBytes(){
+    return gLiveBytes;
+}
+
+/// Calls to operator new so far.
+inline size_t heapAllocationCount(){
+    return gAllocationCount;
+}
+
+} // namespace bench
+} // namespace zsdp
+
+
+void* operator new(size_t size){
+    char* p = (char*)malloc(size + zsdp::bench::kHeaderSize);
+    if(p == NULL)
+        throw std::bad_alloc();
+
+    *(size_t*)p = size;
+    zsdp::bench::gLiveBytes += size;
+    zsdp::bench::gAllocationCount++;
+    return p + zsdp::bench::kHeaderSize;
+}
+
+void operator delete(void* p) noexcept{
+    if(p == NULL)
+        return;
+
+    char* block = (char*)p - zsdp::bench::kHeaderSize;
+    zsdp::bench::gLiveBytes -= *(size_t*)block;
+    free(block);
+}
+
+void operator delete(void* p, size_t) noexcept{
+    operator delete(p);
+}
+
+#endif // __ZSDP_HEAP_COUNTER_H__
@@ -0,0 +1,399 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/binary.h>
+#include "sdp-codec.h"
+#include <stdexcept>
+
+
+using namespace std;
+
+namespace zsdp {
+
+namespace {
+
+const char kMagic[4] = { 'Z', 'S', 'D', 'B' };
+constexpr size_t kHeaderSize = 16;
+
+/**
+ * Attribute keys with a one-byte code. The code is an index into this table,
+ * so it is part of the format: only append, and bump the format version for
+ * anything else.
+ */
+const char* const kKnownAttributeKeys[] = {
+    NULL, // 0: literal key follows
+    "rtpmap",
+    "fmtp",
+    "ptime",
+    "maxptime",
+    "sendrecv",
+    "sendonly",
+    "recvonly",
+    "inactive",
+    "rtcp",
+    "rtcp-mux",
+    "rtcp-fb",
+    "rtcp-rsize",
+    "ice-ufrag",
+    "ice-pwd",
+    "ice-options",
+    "ice-lite",
+    "candidate",
+    "end-of-candidates",
+    "fingerprint",
+    "setup",
+    "mid",
+    "msid",
+    "msid-semantic",
+    "group",
+    "ssrc",
+    "ssrc-group",
+    "extmap",
+    "extmap-allow-mixed",
+    "sctp-port",
+    "max-message-size",
+    "framerate",
+    "orientation",
+    "type",
+    "charset",
+    "sdplang",
+    "lang",
+    "quality",
+    "cat",
+    "keywds",
+    "tool",
+    "crypto",
+};
+
+constexpr size_t kKnownAttributeKeyCount = sizeof(kKnownAttributeKeys) / sizeof(kKnownAttributeKeys[0]);
+
+uint8_t attributeKeyCode(StringView key){
+    for(size_t i = 1; i < kKnownAttributeKeyCount; i++){
+        if(key == kKnownAttributeKeys[i])
+            return (uint8_t)i;
+    }
+
+    return 0;
+}
+
+class Encoder {
+public:
+    Encoder(string& out) : mOut(out), mBase(out.size()) {}
+
+    void sdp(const Sdp& sdp){
+        mOut.append(kMagic, sizeof(kMagic));
+        mOut += (char)kBinarySdpFormatVersion;
+        mOut.append(3, '\0');
+        appendU32(mOut, (uint32_t)sdp.streams.size());
+        size_t tableOffsetPos = mOut.size();
+        appendU32(mOut, 0);
+
+        appendVarint(mOut, sdp.version);
+        appendLengthPrefixed(mOut, sdp.origin.username);
+        appendLengthPrefixed(mOut, sdp.origin.sessionID);
+        appendLengthPrefixed(mOut, sdp.origin.sessionVersion);
+        appendEnum(mOut, sdp.origin.networkType);
+        appendEnum(mOut, sdp.origin.addressType);
+        appendLengthPrefixed(mOut, sdp.origin.host);
+        appendLengthPrefixed(mOut, sdp.sessionName);
+        appendLengthPrefixed(mOut, sdp.sessionInformation);
+        appendLengthPrefixed(mOut, sdp.uri);
+        appendLengthPrefixed(mOut, sdp.email);
+        appendLengthPrefixed(mOut, sdp.phoneNumber);
+        appendConnectionData(mOut, sdp.connectionData);
+        appendBandwidth(mOut, sdp.bandwidth);
+
+        // Length-prefixed so the view can skip them.
+        mScratch.clear();
+        appendTimes(mScratch, sdp.times);
+        appendLengthPrefixed(mOut, mScratch);
+
+        mScratch.clear();
+        appendTimeZones(mScratch, sdp.timeZoneAdjustments);
+        appendLengthPrefixed(mOut, mScratch);
+
+        appendEncryption(mOut, sdp.encryption);
+        attributes(sdp.attributes);
+
+        size_t tablePos = mOut.size();
+        storeU32(mOut, tableOffsetPos, offset(tablePos));
+        mOut.append(4 * sdp.streams.size(), '\0');
+
+        for(size_t i = 0; i < sdp.streams.size(); i++){
+            storeU32(mOut, tablePos + 4 * i, offset(mOut.size()));
+            stream(sdp.streams[i]);
+        }
+    }
+
+private:
+    uint32_t offset(size_t pos) const {
+        size_t relative = pos - mBase;
+        if(relative > UINT32_MAX)
+            throw length_error("SDP too large for the binary encoding.");
+
+        return (uint32_t)relative;
+    }
+
+    void attributes(const AttributeList& attributes){
+        appendVarint(mOut, attributes.size());
+        size_t tablePos = mOut.size();
+        mOut.append(4 * attributes.size(), '\0');
+
+        for(size_t i = 0; i < attributes.size(); i++){
+            storeU32(mOut, tablePos + 4 * i, offset(mOut.size()));
+
+            StringView line = attributeLine(*attributes[i], mScratch);
+            size_t colon = line.find(':');
+            StringView key = line.substr(0, colon);
+            uint8_t code = attributeKeyCode(key);
+
+            mOut += (char)code;
+            if(code == 0)
+                appendLengthPrefixed(mOut, key);
+
+            if(colon == StringView::npos)
+                appendVarint(mOut, 0);
+            else{
+                StringView value = line.substr(colon + 1);
+                appendVarint(mOut, value.size() + 1);
+                mOut += value;
+            }
+        }
+    }
+
+    void stream(const Stream& stream){
+        appendMediaDescription(mOut, stream.mediaDescription);
+        appendLengthPrefixed(mOut, stream.title);
+        appendConnectionData(mOut, stream.connectionData);
+        appendBandwidth(mOut, stream.bandwidth);
+        appendEncryption(mOut, stream.encryption);
+        attributes(stream.attributes);
+    }
+
+    string& mOut;
+    size_t mBase;
+    string mScratch;
+};
+
+void readConnectionData(ByteReader& r, BinaryConnectionData& cd){
+    cd.networkType = readEnum(r, NetworkType::IN);
+    cd.addressType = readEnum(r, AddressType::IP6);
+    cd.host = r.lengthPrefixed();
+    cd.multicastIPv4TTL = r.u8();
+    cd.multicastAddressCount = (uint32_t)r.varint();
+}
+
+void readEncryption(ByteReader& r, BinaryEncryption& encryption){
+    encryption.type = readEnum(r, EncryptionType::PromptForKey);
+    encryption.key = r.lengthPrefixed();
+}
+
+/// Reads the count and checks that the offset table fits.
+void readAttributeList(ByteReader& r, StringView data, size_t* count, size_t* tableOffset){
+    *count = r.varint();
+    *tableOffset = r.position();
+    if(*count > (data.size() - *tableOffset) / 4)
+        throw invalid_argument("Truncated encoded SDP.");
+}
+
+ConnectionData toConnectionData(const BinaryConnectionData& binary){
+    ConnectionData cd;
+    cd.networkType = binary.networkType;
+    cd.addressType = binary.addressType;
+    cd.host = binary.host.str();
+    cd.multicastIPv4TTL = binary.multicastIPv4TTL;
+    cd.multicastAddressCount = binary.multicastAddressCount;
+
+    return cd;
+}
+
+Encryption toEncryption(const BinaryEncryption& binary){
+    Encryption encryption;
+    encryption.type = binary.type;
+    encryption.key = binary.key.str();
+
+    return encryption;
+}
+
+void appendAttributes(const BinaryAttributeList& list, AttributeList& out){
+    out.reserve(out.size() + list.size());
+    for(size_t i = 0; i < list.size(); i++)
+        out.push_back(list[i].decode());
+}
+
+} // namespace
+
+void encodeBinarySdp(const Sdp& sdp, string& out){
+    Encoder(out).sdp(sdp);
+}
+
+
+sp<Attribute> BinaryAttributeView::decode() const{
+    string line;
+    line.reserve(mKey.size() + 1 + mValue.size());
+    line += mKey;
+    if(mHasValue){
+        line += ':';
+        line += mValue;
+    }
+
+    return parseAttribute(line);
+}
+
+BinaryAttributeView BinaryAttributeList::operator[](size_t i) const{
+    if(i >= mCount)
+        throw out_of_range("Attribute index " + to_string(i) + " is out-of-range.");
+
+    ByteReader r(mData, loadU32(mData.data() + mTableOffset + 4 * i));
+    BinaryAttributeView attr;
+
+    uint8_t code = r.u8();
+    if(code >= kKnownAttributeKeyCount)
+        throw invalid_argument("Unknown attribute key code in encoded SDP.");
+
+    attr.mKey = code == 0 ? r.lengthPrefixed() : StringView(kKnownAttributeKeys[code]);
+
+    uint64_t valueSize = r.varint();
+    attr.mHasValue = valueSize != 0;
+    if(attr.mHasValue)
+        attr.mValue = r.bytes(valueSize - 1);
+
+    return attr;
+}
+
+
+Stream BinaryStreamView::toStream() const{
+    Stream stream;
+    MediaDescription& md = stream.mediaDescription;
+    md.mediaType = mMediaType;
+    md.port = mPort;
+    md.portCount = mPortCount;
+    md.protocol = mProtocol;
+    md.payloadTypes.assign((const uint8_t*)mPayloadTypes.begin(), (const uint8_t*)mPayloadTypes.end());
+    md.reindexPayloadTypes();
+    md.codec = mCodec.str();
+    stream.title = mTitle.str();
+    stream.connectionData = toConnectionData(mConnectionData);
+    stream.bandwidth = mBandwidth;
+    stream.encryption = toEncryption(mEncryption);
+    appendAttributes(mAttributes, stream.attributes);
+    stream.reindexAttributes();
+
+    return stream;
+}
+
+
+BinarySdpView::BinarySdpView(StringView encoded) : mData(encoded) {
+    if(encoded.size() < kHeaderSize || memcmp(encoded.data(), kMagic, sizeof(kMagic)) != 0)
+        throw invalid_argument("Not a binary SDP.");
+
+    if((uint8_t)encoded[4] != kBinarySdpFormatVersion)
+        throw invalid_argument("Unsupported binary SDP format version " + to_string((uint8_t)encoded[4]) + ".");
+
+    mStreamCount = loadU32(encoded.data() + 8);
+    mStreamTableOffset = loadU32(encoded.data() + 12);
+    if(mStreamTableOffset > encoded.size() || mStreamCount > (encoded.size() - mStreamTableOffset) / 4)
+        throw invalid_argument("Truncated encoded SDP.");
+
+    ByteReader r(encoded, kHeaderSize);
+    mVersion = (uint32_t)r.varint();
+    mOriginUsername = r.lengthPrefixed();
+    mOriginSessionID = r.lengthPrefixed();
+    mOriginSessionVersion = r.lengthPrefixed();
+    mOriginNetworkType = readEnum(r, NetworkType::IN);
+    mOriginAddressType = readEnum(r, AddressType::IP6);
+    mOriginHost = r.lengthPrefixed();
+    mSessionName = r.lengthPrefixed();
+    mSessionInformation = r.lengthPrefixed();
+    mUri = r.lengthPrefixed();
+    mEmail = r.lengthPrefixed();
+    mPhoneNumber = r.lengthPrefixed();
+    readConnectionData(r, mConnectionData);
+    mBandwidth = readBandwidth(r);
+    mTimes = r.lengthPrefixed();
+    mTimeZones = r.lengthPrefixed();
+    readEncryption(r, mEncryption);
+
+    mAttributes.mData = encoded;
+    readAttributeList(r, encoded, &mAttributes.mCount, &mAttributes.mTableOffset);
+}
+
+vector<Timing> BinarySdpView::times() const{
+    ByteReader r(mTimes);
+    return readTimes(r);
+}
+
+vector<TimeZoneAdjustment> BinarySdpView::timeZoneAdjustments() const{
+    ByteReader r(mTimeZones);
+    return readTimeZones(r);
+}
+
+BinaryStreamView BinarySdpView::stream(size_t i) const{
+    if(i >= mStreamCount)
+        throw out_of_range("Stream index " + to_string(i) + " is out-of-range.");
+
+    ByteReader r(mData, loadU32(mData.data() + mStreamTableOffset + 4 * i));
+    BinaryStreamView stream;
+
+    stream.mMediaType = readEnum(r, MediaType::Message);
+    stream.mPort = (uint16_t)r.varint();
+    stream.mPortCount = (uint16_t)r.varint();
+    stream.mProtocol = readEnum(r, Protocol::UnknownUDP);
+    stream.mPayloadTypes = r.lengthPrefixed();
+    stream.mCodec = r.lengthPrefixed();
+    stream.mTitle = r.lengthPrefixed();
+    readConnectionData(r, stream.mConnectionData);
+    stream.mBandwidth = readBandwidth(r);
+    readEncryption(r, stream.mEncryption);
+
+    stream.mAttributes.mData = mData;
+    readAttributeList(r, mData, &stream.mAttributes.mCount, &stream.mAttributes.mTableOffset);
+
+    return stream;
+}
+
+Sdp BinarySdpView::toSdp() const{
+    Sdp sdp;
+    sdp.version = mVersion;
+    sdp.origin.username = mOriginUsername.str();
+    sdp.origin.sessionID = mOriginSessionID.str();
+    sdp.origin.sessionVersion = mOriginSessionVersion.str();
+    sdp.origin.networkType = mOriginNetworkType;
+    sdp.origin.addressType = mOriginAddressType;
+    sdp.origin.host = mOriginHost.str();
+    sdp.sessionName = mSessionName.str();
+    sdp.sessionInformation = mSessionInformation.str();
+    sdp.uri = mUri.str();
+    sdp.email = mEmail.str();
+    sdp.phoneNumber = mPhoneNumber.str();
+    sdp.connectionData = toConnectionData(mConnectionData);
+    sdp.bandwidth = mBandwidth;
+    sdp.times = times();
+    sdp.timeZoneAdjustments = timeZoneAdjustments();
+    sdp.encryption = toEncryption(mEncryption);
+    appendAttributes(mAttributes, sdp.attributes);
+
+    sdp.streams.reserve(mStreamCount);
+    for(size_t i = 0; i < mStreamCount; i++)
+        sdp.streams.push_back(stream(i).toStream());
+
+    return sdp;
+}
+
+} // namespace zsdp
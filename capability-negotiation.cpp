@@ -0,0 +1,659 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/capability-negotiation.h>
+#include <algorithm>
+
+
+using namespace std;
+
+namespace zsdp {
+
+constexpr AttrId AttrCapability::kId;
+constexpr AttrId AttrTransportCapability::kId;
+constexpr AttrId AttrPotentialConfig::kId;
+constexpr AttrId AttrActualConfig::kId;
+constexpr uint16_t ConfigurationEnumerator::kNoList;
+
+namespace {
+
+bool isSpace(char c){
+    return c == ' ' || c == '\t';
+}
+
+/// Capability and configuration numbers run from 1 to 2^31 - 1.
+bool parseNumber(StringView s, uint32_t* number){
+    if(s.empty() || s.size() > 10)
+        return false;
+
+    uint64_t n = 0;
+    for(char c : s){
+        if(c < '0' || c > '9')
+            return false;
+
+        n = n * 10 + (c - '0');
+    }
+
+    if(n == 0 || n > INT32_MAX)
+        return false;
+
+    *number = (uint32_t)n;
+    return true;
+}
+
+/// Takes the next whitespace-separated field off the front of s.
+bool nextField(StringView& s, StringView& field){
+    size_t start = 0;
+    while(start < s.size() && isSpace(s[start]))
+        start++;
+
+    size_t end = start;
+    while(end < s.size() && !isSpace(s[end]))
+        end++;
+
+    field = s.substr(start, end - start);
+    s = s.substr(end);
+
+    return !field.empty();
+}
+
+StringView skipSpaces(StringView s){
+    size_t start = 0;
+    while(start < s.size() && isSpace(s[start]))
+        start++;
+
+    return s.substr(start);
+}
+
+/// "1,2,[3,4]": numbers inside brackets are optional.
+bool parseCapabilityList(StringView s, AttributeCapabilityList& list){
+    int depth = 0;
+    size_t i = 0;
+    while(i < s.size()){
+        char c = s[i];
+        if(c == '[' || c == ']' || c == ','){
+            depth += c == '[' ? 1 : (c == ']' ? -1 : 0);
+            if(depth < 0)
+                return false;
+
+            i++;
+            continue;
+        }
+
+        size_t end = i;
+        while(end < s.size() && s[end] >= '0' && s[end] <= '9')
+            end++;
+
+        uint32_t number;
+        if(!parseNumber(s.substr(i, end - i), &number))
+            return false;
+
+        if(depth > 0)
+            list.optional.push_back(number);
+        else
+            list.mandatory.push_back(number);
+
+        i = end;
+    }
+
+    return depth == 0 && (!list.mandatory.empty() || !list.optional.empty());
+}
+
+/// The lists after the configuration number of a pcfg or acfg line.
+struct ConfigLists {
+    uint32_t number = 0;
+    uint8_t deleteAttributes = kDeleteAttributes_None;
+    SmallVector<AttributeCapabilityList, 2> attributeLists;
+    SmallVector<uint32_t, 2> transports;
+    SmallVector<string, 1> extensions;
+};
+
+/// "a=-ms:1,2|3": the delete-attributes prefix, then '|'-separated lists.
+bool parseAttributeLists(StringView s, ConfigLists& lists){
+    if(!s.empty() && s[0] == '-'){
+        size_t colon = s.find(':');
+        StringView flags = s.substr(1, colon == StringView::npos ? StringView::npos : colon - 1);
+        if(flags == "m")
+            lists.deleteAttributes = kDeleteAttributes_Media;
+        else if(flags == "s")
+            lists.deleteAttributes = kDeleteAttributes_Session;
+        else if(flags == "ms")
+            lists.deleteAttributes = kDeleteAttributes_Media | kDeleteAttributes_Session;
+        else
+            return false;
+
+        // "a=-m" on its own only deletes.
+        if(colon == StringView::npos)
+            return true;
+
+        s = s.substr(colon + 1);
+    }
+
+    size_t start = 0;
+    while(start <= s.size()){
+        size_t end = s.find('|', start);
+        if(end == StringView::npos)
+            end = s.size();
+
+        AttributeCapabilityList list;
+        if(!parseCapabilityList(s.substr(start, end - start), list))
+            return false;
+
+        lists.attributeLists.push_back(std::move(list));
+        start = end + 1;
+    }
+
+    return true;
+}
+
+bool parseConfigLists(StringView value, ConfigLists& lists){
+    StringView field;
+    if(!nextField(value, field) || !parseNumber(field, &lists.number))
+        return false;
+
+    bool haveAttributes = false;
+    bool haveTransports = false;
+    while(nextField(value, field)){
+        StringView prefix = field.substr(0, 2);
+        if(prefix == "a="){
+            if(haveAttributes || !parseAttributeLists(field.substr(2), lists))
+                return false;
+
+            haveAttributes = true;
+        }
+        else if(prefix == "t="){
+            if(haveTransports)
+                return false;
+
+            haveTransports = true;
+            StringView rest = field.substr(2);
+            size_t start = 0;
+            while(start <= rest.size()){
+                size_t end = rest.find('|', start);
+                if(end == StringView::npos)
+                    end = rest.size();
+
+                uint32_t number;
+                if(!parseNumber(rest.substr(start, end - start), &number))
+                    return false;
+
+                lists.transports.push_back(number);
+                start = end + 1;
+            }
+        }
+        else if(field.find('=') != StringView::npos){
+            lists.extensions.push_back(field.str());
+        }
+        else{
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void appendNumbers(string& out, const uint32_t* numbers, size_t count, char separator){
+    for(size_t i = 0; i < count; i++){
+        if(i > 0)
+            out += separator;
+
+        out += to_string(numbers[i]);
+    }
+}
+
+void appendConfigLists(string& out,
+                       uint32_t number,
+                       uint8_t deleteAttributes,
+                       const SmallVector<AttributeCapabilityList, 2>& attributeLists,
+                       const uint32_t* transports,
+                       size_t transportCount,
+                       const SmallVector<string, 1>& extensions)
+{
+    out += to_string(number);
+
+    if(!attributeLists.empty() || deleteAttributes != kDeleteAttributes_None){
+        out += " a=";
+        if(deleteAttributes != kDeleteAttributes_None){
+            out += '-';
+            if(deleteAttributes & kDeleteAttributes_Media)
+                out += 'm';
+            if(deleteAttributes & kDeleteAttributes_Session)
+                out += 's';
+            if(!attributeLists.empty())
+                out += ':';
+        }
+
+        for(size_t i = 0; i < attributeLists.size(); i++){
+            const AttributeCapabilityList& list = attributeLists[i];
+            if(i > 0)
+                out += '|';
+
+            appendNumbers(out, list.mandatory.data(), list.mandatory.size(), ',');
+            if(!list.optional.empty()){
+                out += list.mandatory.empty() ? "[" : ",[";
+                appendNumbers(out, list.optional.data(), list.optional.size(), ',');
+                out += ']';
+            }
+        }
+    }
+
+    if(transportCount > 0){
+        out += " t=";
+        appendNumbers(out, transports, transportCount, '|');
+    }
+
+    for(const string& extension : extensions){
+        out += ' ';
+        out += extension;
+    }
+}
+
+sp<Attribute> parseCapability(const string& key, const string& val){
+    StringView value(val);
+    StringView field;
+
+    auto attr = make_shared<AttrCapability>();
+    if(!nextField(value, field) || !parseNumber(field, &attr->number))
+        return NULL;
+
+    value = skipSpaces(value);
+    if(value.empty())
+        return NULL;
+
+    attr->attribute = parseAttribute(value.str());
+    return attr;
+}
+
+sp<Attribute> parseTransportCapability(const string& key, const string& val){
+    StringView value(val);
+    StringView field;
+
+    auto attr = make_shared<AttrTransportCapability>();
+    if(!nextField(value, field) || !parseNumber(field, &attr->firstNumber))
+        return NULL;
+
+    while(nextField(value, field))
+        attr->protocols.push_back(Symbol(field));
+
+    if(attr->protocols.empty() || attr->firstNumber + (attr->protocols.size() - 1) > INT32_MAX)
+        return NULL;
+
+    return attr;
+}
+
+sp<Attribute> parsePotentialConfig(const string& key, const string& val){
+    ConfigLists lists;
+    if(!parseConfigLists(val, lists))
+        return NULL;
+
+    auto attr = make_shared<AttrPotentialConfig>();
+    attr->configNumber = lists.number;
+    attr->deleteAttributes = lists.deleteAttributes;
+    attr->attributeLists = std::move(lists.attributeLists);
+    attr->transports = std::move(lists.transports);
+    attr->extensions = std::move(lists.extensions);
+
+    return attr;
+}
+
+sp<Attribute> parseActualConfig(const string& key, const string& val){
+    ConfigLists lists;
+    if(!parseConfigLists(val, lists) || lists.attributeLists.size() > 1 || lists.transports.size() > 1)
+        return NULL;
+
+    auto attr = make_shared<AttrActualConfig>();
+    attr->configNumber = lists.number;
+    attr->deleteAttributes = lists.deleteAttributes;
+    attr->transport = lists.transports.empty() ? 0 : lists.transports[0];
+    attr->extensions = std::move(lists.extensions);
+
+    // The chosen optional capabilities may still be bracketed; they are used all the same.
+    if(!lists.attributeLists.empty()){
+        const AttributeCapabilityList& list = lists.attributeLists[0];
+        attr->attributes.assign(list.mandatory.begin(), list.mandatory.end());
+        for(uint32_t number : list.optional)
+            attr->attributes.push_back(number);
+    }
+
+    return attr;
+}
+
+/// The parser for a capability negotiation key, or NULL.
+AttributeParseFnc capabilityParser(StringView key){
+    if(key == "acap")
+        return parseCapability;
+    else if(key == "tcap")
+        return parseTransportCapability;
+    else if(key == "pcfg")
+        return parsePotentialConfig;
+    else if(key == "acfg")
+        return parseActualConfig;
+
+    return NULL;
+}
+
+Protocol protocolForName(StringView name){
+    if(name.equalsIgnoreCase("RTP/AVP"))
+        return Protocol::RTP_AVP;
+    else if(name.equalsIgnoreCase("RTP/SAVP"))
+        return Protocol::RTP_SAVP;
+    else if(name.equalsIgnoreCase("UDP"))
+        return Protocol::UnknownUDP;
+
+    return Protocol::NotSet;
+}
+
+CapabilityCheck gAcceptAll;
+
+} // namespace
+
+void registerCapabilityNegotiationAttributes(){
+    registerAttribute("acap", parseCapability);
+    registerAttribute("tcap", parseTransportCapability);
+    registerAttribute("pcfg", parsePotentialConfig);
+    registerAttribute("acfg", parseActualConfig);
+}
+
+
+AttrCapability::~AttrCapability(){}
+
+StringView AttrCapability::key() const{ return StringView("acap", 4); }
+
+string AttrCapability::value() const{
+    return to_string(number) + " " + (attribute != NULL ? attribute->sdpLine() : "");
+}
+
+AttrTransportCapability::~AttrTransportCapability(){}
+
+StringView AttrTransportCapability::key() const{ return StringView("tcap", 4); }
+
+string AttrTransportCapability::value() const{
+    string out = to_string(firstNumber);
+    for(const Symbol& protocol : protocols){
+        out += ' ';
+        out += protocol.str();
+    }
+
+    return out;
+}
+
+AttrPotentialConfig::~AttrPotentialConfig(){}
+
+bool AttrPotentialConfig::hasMandatoryExtension() const{
+    for(const string& extension : extensions){
+        if(!extension.empty() && extension[0] == '+')
+            return true;
+    }
+
+    return false;
+}
+
+StringView AttrPotentialConfig::key() const{ return StringView("pcfg", 4); }
+
+string AttrPotentialConfig::value() const{
+    string out;
+    appendConfigLists(out, configNumber, deleteAttributes, attributeLists, transports.data(), transports.size(), extensions);
+
+    return out;
+}
+
+AttrActualConfig::~AttrActualConfig(){}
+
+StringView AttrActualConfig::key() const{ return StringView("acfg", 4); }
+
+string AttrActualConfig::value() const{
+    SmallVector<AttributeCapabilityList, 2> attributeLists;
+    if(!attributes.empty()){
+        attributeLists.emplace_back();
+        attributeLists[0].mandatory.assign(attributes.begin(), attributes.end());
+    }
+
+    string out;
+    appendConfigLists(out, configNumber, deleteAttributes, attributeLists, &transport, transport != 0 ? 1 : 0, extensions);
+
+    return out;
+}
+
+
+sp<AttrActualConfig> PotentialConfiguration::actualConfig() const{
+    auto attr = make_shared<AttrActualConfig>();
+    attr->configNumber = configNumber;
+    attr->deleteAttributes = deleteAttributes;
+    attr->transport = transportNumber;
+
+    for(const AttrCapability* capability : attributes)
+        attr->attributes.push_back(capability->number);
+
+    return attr;
+}
+
+
+ConfigurationEnumerator::ConfigurationEnumerator(const Sdp& sdp, size_t streamIndex)
+    : ConfigurationEnumerator(sdp, streamIndex, gAcceptAll) {}
+
+ConfigurationEnumerator::ConfigurationEnumerator(const Sdp& sdp, size_t streamIndex, const CapabilityCheck& check)
+    : mCheck(check), mConfig(0), mEntered(false), mList(0), mTransport(0)
+{
+    // Capabilities may be listed at session level; configurations only per m-section.
+    collect(sdp.attributes, false);
+    collect(sdp.streams.at(streamIndex).attributes, true);
+
+    stable_sort(mAttributeCaps.begin(), mAttributeCaps.end(), [](const AttributeCap& a, const AttributeCap& b){
+        return a.number < b.number;
+    });
+
+    stable_sort(mTransportCaps.begin(), mTransportCaps.end(), [](const TransportCap& a, const TransportCap& b){
+        return a.number < b.number;
+    });
+
+    stable_sort(mConfigs.begin(), mConfigs.end(), [](const AttrPotentialConfig* a, const AttrPotentialConfig* b){
+        return a->configNumber < b->configNumber;
+    });
+}
+
+void ConfigurationEnumerator::collect(const AttributeList& attributes, bool mediaLevel){
+    for(const sp<Attribute>& attr : attributes){
+        const Attribute* decoded = attr.get();
+
+        if(decoded->id() == AttrId::Generic){
+            AttributeParseFnc parse = capabilityParser(decoded->key());
+            if(parse == NULL)
+                continue;
+
+            sp<Attribute> parsed = parse(decoded->key().str(), decoded->value());
+            if(parsed == NULL)
+                continue;
+
+            mDecoded.push_back(parsed);
+            decoded = parsed.get();
+        }
+
+        if(const AttrCapability* capability = decoded->as<AttrCapability>()){
+            AttributeCap cap = { capability->number, capability, -1 };
+            mAttributeCaps.push_back(cap);
+        }
+        else if(const AttrTransportCapability* transports = decoded->as<AttrTransportCapability>()){
+            for(size_t i = 0; i < transports->protocols.size(); i++){
+                const Symbol& name = transports->protocols[i];
+                TransportCap cap = { transports->firstNumber + (uint32_t)i, name, protocolForName(name.view()), -1 };
+                mTransportCaps.push_back(cap);
+            }
+        }
+        else if(mediaLevel){
+            if(const AttrPotentialConfig* config = decoded->as<AttrPotentialConfig>())
+                mConfigs.push_back(config);
+        }
+    }
+}
+
+const ConfigurationEnumerator::AttributeCap* ConfigurationEnumerator::attributeCap(uint32_t number) const{
+    auto it = lower_bound(mAttributeCaps.begin(), mAttributeCaps.end(), number, [](const AttributeCap& cap, uint32_t n){
+        return cap.number < n;
+    });
+
+    return it != mAttributeCaps.end() && it->number == number ? it : NULL;
+}
+
+const ConfigurationEnumerator::TransportCap* ConfigurationEnumerator::transportCap(uint32_t number) const{
+    auto it = lower_bound(mTransportCaps.begin(), mTransportCaps.end(), number, [](const TransportCap& cap, uint32_t n){
+        return cap.number < n;
+    });
+
+    return it != mTransportCaps.end() && it->number == number ? it : NULL;
+}
+
+bool ConfigurationEnumerator::usable(const AttributeCap* cap) const{
+    if(cap == NULL)
+        return false;
+
+    if(cap->accepted < 0)
+        cap->accepted = mCheck.acceptsAttribute(*cap->capability->attribute) ? 1 : 0;
+
+    return cap->accepted != 0;
+}
+
+bool ConfigurationEnumerator::usable(const TransportCap* cap) const{
+    if(cap == NULL)
+        return false;
+
+    if(cap->accepted < 0)
+        cap->accepted = mCheck.acceptsTransport(cap->name, cap->protocol) ? 1 : 0;
+
+    return cap->accepted != 0;
+}
+
+void ConfigurationEnumerator::enter(const AttrPotentialConfig& config){
+    mUsableLists.clear();
+    mUsableTransports.clear();
+    mList = 0;
+    mTransport = 0;
+
+    if(config.hasMandatoryExtension())
+        return;
+
+    if(config.attributeLists.empty())
+        mUsableLists.push_back(kNoList);
+
+    for(size_t i = 0; i < config.attributeLists.size() && i < kNoList; i++){
+        bool all = true;
+        for(uint32_t number : config.attributeLists[i].mandatory){
+            if(!usable(attributeCap(number))){
+                all = false;
+                break;
+            }
+        }
+
+        if(all)
+            mUsableLists.push_back((uint16_t)i);
+    }
+
+    // Nothing to pair the transports with, so don't ask about them.
+    if(mUsableLists.empty())
+        return;
+
+    if(config.transports.empty())
+        mUsableTransports.push_back(kNoList);
+
+    for(size_t i = 0; i < config.transports.size() && i < kNoList; i++){
+        if(usable(transportCap(config.transports[i])))
+            mUsableTransports.push_back((uint16_t)i);
+    }
+}
+
+bool ConfigurationEnumerator::next(PotentialConfiguration& configuration){
+    while(mConfig < mConfigs.size()){
+        const AttrPotentialConfig& config = *mConfigs[mConfig];
+        if(!mEntered){
+            enter(config);
+            mEntered = true;
+        }
+
+        if(mTransport >= mUsableTransports.size()){
+            mConfig++;
+            mEntered = false;
+            continue;
+        }
+
+        configuration.configNumber = config.configNumber;
+        configuration.deleteAttributes = config.deleteAttributes;
+        configuration.transportNumber = 0;
+        configuration.protocol = Protocol::NotSet;
+        configuration.attributes.clear();
+
+        uint16_t transport = mUsableTransports[mTransport];
+        if(transport != kNoList){
+            const TransportCap* cap = transportCap(config.transports[transport]);
+            configuration.transportNumber = cap->number;
+            configuration.protocol = cap->protocol;
+        }
+
+        uint16_t list = mUsableLists[mList];
+        if(list != kNoList){
+            const AttributeCapabilityList& capabilities = config.attributeLists[list];
+            for(uint32_t number : capabilities.mandatory)
+                configuration.attributes.push_back(attributeCap(number)->capability);
+
+            for(uint32_t number : capabilities.optional){
+                const AttributeCap* cap = attributeCap(number);
+                if(usable(cap))
+                    configuration.attributes.push_back(cap->capability);
+            }
+        }
+
+        if(++mList == mUsableLists.size()){
+            mList = 0;
+            mTransport++;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+void ConfigurationEnumerator::reset(){
+    mConfig = 0;
+    mEntered = false;
+    mList = 0;
+    mTransport = 0;
+}
+
+
+Stream applyConfiguration(const Stream& stream, const PotentialConfiguration& configuration){
+    Stream result = stream;
+    result.attributes.clear();
+
+    for(const sp<Attribute>& attr : stream.attributes){
+        if(capabilityParser(attr->key()) != NULL || (configuration.deleteAttributes & kDeleteAttributes_Media))
+            continue;
+
+        result.attributes.push_back(attr);
+    }
+
+    for(const AttrCapability* capability : configuration.attributes)
+        result.attributes.push_back(capability->attribute);
+
+    if(configuration.transportNumber != 0)
+        result.mediaDescription.protocol = configuration.protocol;
+
+    result.reindexAttributes();
+    return result;
+}
+
+} // namespace zsdp
@@ -0,0 +1,319 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/compress.h>
+#include "varint.h"
+#include <stdexcept>
+
+
+using namespace std;
+
+namespace zsdp {
+
+namespace {
+
+/**
+ * The static dictionary. It is part of format 1: any change needs a new
+ * kSdpCompressionFormat. Matches are cheaper the closer they are, but all
+ * offsets cost the same two bytes, so the order only matters in that the
+ * hash table keeps the last occurrence of each 4-byte sequence.
+ */
+const char kDictionary[] =
+    "a=crypto:1 AES_CM_128_HMAC_SHA1_80 inline:"
+    "RTP/SAVP RTP/SAVPF "
+    "a=rtpmap:9 G722/8000\r\n"
+    "a=rtpmap:13 CN/8000\r\n"
+    "a=rtpmap:18 G729/8000\r\n"
+    "a=fmtp:18 annexb=no\r\n"
+    "a=rtpmap:3 GSM/8000\r\n"
+    "a=maxptime:60\r\n"
+    "a=framerate:30\r\n"
+    "a=orientation:portrait\r\n"
+    "a=tool:"
+    "a=cat:a=keywds:a=type:broadcasta=charset:a=sdplang:a=lang:en\r\n"
+    "k=prompt\r\nk=clear:k=base64:k=uri:"
+    "e=p=u=http://www.example.com/\r\n"
+    "r=604800 3600 0 90000\r\n"
+    "z=0 -1h\r\n"
+    "b=CT:b=TIAS:"
+    "c=IN IP6 ::1\r\n"
+    "a=recvonly\r\n"
+    "a=sendonly\r\n"
+    "a=inactive\r\n"
+    "a=ice-lite\r\n"
+    "a=rtcp-fb:* nack\r\n"
+    "a=rtcp-fb:* ccm fir\r\n"
+    "a=fmtp:101 0-16\r\n"
+    "a=fmtp:126 profile-level-id=42e01f;level-asymmetry-allowed=1;packetization-mode=1\r\n"
+    "a=rtpmap:126 H264/90000\r\n"
+    "a=rtpmap:98 VP9/90000\r\n"
+    "a=fmtp:98 profile-id=0\r\n"
+    "a=rtpmap:45 AV1/90000\r\n"
+    "a=rtpmap:100 red/90000\r\n"
+    "a=rtpmap:127 ulpfec/90000\r\n"
+    "a=ssrc-group:FID "
+    " typ srflx raddr 0.0.0.0 rport 9"
+    " typ relay raddr "
+    " tcptype active"
+    " generation 0 network-id 1 network-cost 10\r\n"
+    "a=candidate:1 1 udp 2122260223 192.168.1.1 "
+    " typ host"
+    "a=end-of-candidates\r\n"
+    "m=application 9 UDP/DTLS/SCTP webrtc-datachannel\r\n"
+    "a=sctp-port:5000\r\n"
+    "a=max-message-size:262144\r\n"
+    "a=extmap:1 urn:ietf:params:rtp-hdrext:ssrc-audio-level\r\n"
+    "a=extmap:2 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+    "a=extmap:3 http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01\r\n"
+    "a=extmap:4 urn:ietf:params:rtp-hdrext:sdes:mid\r\n"
+    "a=extmap:5 urn:ietf:params:rtp-hdrext:sdes:rtp-stream-id\r\n"
+    "a=extmap:6 urn:ietf:params:rtp-hdrext:sdes:repaired-rtp-stream-id\r\n"
+    "a=extmap:13 urn:3gpp:video-orientation\r\n"
+    "a=extmap:14 urn:ietf:params:rtp-hdrext:toffset\r\n"
+    "a=extmap:12 http://www.webrtc.org/experiments/rtp-hdrext/playout-delay\r\n"
+    "a=extmap-allow-mixed\r\n"
+    "a=msid-semantic: WMS\r\n"
+    "a=group:BUNDLE 0 1\r\n"
+    "m=video 9 UDP/TLS/RTP/SAVPF 96 97 98 99 100 101 102\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=rtcp-fb:96 goog-remb\r\n"
+    "a=rtcp-fb:96 transport-cc\r\n"
+    "a=rtcp-fb:96 ccm fir\r\n"
+    "a=rtcp-fb:96 nack\r\n"
+    "a=rtcp-fb:96 nack pli\r\n"
+    "a=rtpmap:97 rtx/90000\r\n"
+    "a=fmtp:97 apt=96\r\n"
+    "a=rtpmap:97 H264/90000\r\n"
+    "a=fmtp:97 profile-level-id=42e01f;packetization-mode=1;level-asymmetry-allowed=1\r\n"
+    "a=framerate:"
+    "a=rtcp-rsize\r\n"
+    "a=ssrc:"
+    " cname:"
+    " msid:"
+    "a=msid:"
+    "a=fingerprint:sha-256 "
+    "a=setup:actpass\r\n"
+    "a=ice-options:trickle\r\n"
+    "a=ice-pwd:"
+    "a=ice-ufrag:"
+    "a=rtcp:9 IN IP4 0.0.0.0\r\n"
+    "a=mid:"
+    "m=audio 9 UDP/TLS/RTP/SAVPF 111 63 9 0 8 13 110 126\r\n"
+    "a=rtcp-fb:111 transport-cc\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "a=rtpmap:8 PCMA/8000\r\n"
+    "a=rtpmap:101 telephone-event/8000\r\n"
+    "a=fmtp:101 0-15\r\n"
+    "a=ptime:20\r\n"
+    "a=rtcp-mux\r\n"
+    "a=sendrecv\r\n"
+    "m=audio RTP/AVP m=video \r\n"
+    "b=AS:"
+    "c=IN IP4 0.0.0.0\r\n"
+    "t=0 0\r\n"
+    "s=-\r\n"
+    "i=v=0\r\no=- 0 2 IN IP4 127.0.0.1\r\n";
+
+constexpr size_t kDictionarySize = sizeof(kDictionary) - 1;
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxDistance = 0xffff;
+constexpr size_t kHashBits = 12;
+constexpr size_t kMaxDecompressedSize = 64 * 1024 * 1024;
+
+static_assert(kDictionarySize < kMaxDistance, "The dictionary must fit in the match window.");
+
+inline uint32_t load32(const char* p){
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+
+    return v;
+}
+
+inline uint32_t hash4(const char* p){
+    return (load32(p) * 2654435761u) >> (32 - kHashBits);
+}
+
+/// Hash table positions for the dictionary alone; every compression starts from a copy.
+struct DictionaryTable {
+    uint32_t positions[1 << kHashBits];
+
+    DictionaryTable(){
+        memset(positions, 0, sizeof(positions));
+        for(size_t i = 0; i + kMinMatch <= kDictionarySize; i++)
+            positions[hash4(kDictionary + i)] = (uint32_t)i;
+    }
+};
+
+const DictionaryTable& dictionaryTable(){
+    static const DictionaryTable table;
+    return table;
+}
+
+void appendLength(string& out, size_t extra){
+    if(extra >= 15)
+        appendVarint(out, extra - 15);
+}
+
+/// One sequence: a run of literals followed by a match (none for the last sequence).
+void appendSequence(string& out, StringView literals, size_t distance, size_t matchSize){
+    size_t litCode = literals.size() < 15 ? literals.size() : 15;
+    size_t matchExtra = matchSize == 0 ? 0 : matchSize - kMinMatch;
+    size_t matchCode = matchExtra < 15 ? matchExtra : 15;
+
+    out += (char)(litCode << 4 | matchCode);
+    appendLength(out, literals.size());
+    out += literals;
+
+    if(matchSize == 0)
+        return;
+
+    out += (char)distance;
+    out += (char)(distance >> 8);
+    appendLength(out, matchExtra);
+}
+
+[[noreturn]] void corrupt(){
+    throw invalid_argument("Corrupt compressed SDP.");
+}
+
+} // namespace
+
+/*
+ * Format 1: the format byte, the varint decompressed size, then sequences.
+ * Each sequence is a token byte (literal count << 4 | match size - 4, a
+ * nibble of 15 meaning a varint with the rest follows), the literals, and
+ * unless the output is complete, a 16-bit little-endian match distance and
+ * the varint rest of the match size. Distances reach back past the start of
+ * the output into the dictionary.
+ */
+void compressSdp(StringView sdp, string& out){
+    out += (char)kSdpCompressionFormat;
+    appendVarint(out, sdp.size());
+
+    // Matching runs over dictionary + input as one buffer so matches can span both.
+    string window;
+    window.reserve(kDictionarySize + sdp.size());
+    window.append(kDictionary, kDictionarySize);
+    window += sdp;
+
+    uint32_t table[1 << kHashBits];
+    memcpy(table, dictionaryTable().positions, sizeof(table));
+
+    const char* base = window.data();
+    size_t end = window.size();
+    size_t pos = kDictionarySize;
+    size_t anchor = pos;
+
+    while(pos + kMinMatch <= end){
+        uint32_t h = hash4(base + pos);
+        size_t candidate = table[h];
+        table[h] = (uint32_t)pos;
+
+        if(pos - candidate > kMaxDistance || load32(base + candidate) != load32(base + pos)){
+            pos++;
+            continue;
+        }
+
+        size_t matchSize = kMinMatch;
+        while(pos + matchSize < end && base[candidate + matchSize] == base[pos + matchSize])
+            matchSize++;
+
+        appendSequence(out, StringView(base + anchor, pos - anchor), pos - candidate, matchSize);
+
+        // Index the tail of the match so the next line can refer back into it.
+        size_t matchEnd = pos + matchSize;
+        if(matchEnd + kMinMatch <= end && matchSize > 2)
+            table[hash4(base + matchEnd - 2)] = (uint32_t)(matchEnd - 2);
+
+        pos = matchEnd;
+        anchor = pos;
+    }
+
+    appendSequence(out, StringView(base + anchor, end - anchor), 0, 0);
+}
+
+void decompressSdp(StringView compressed, string& out){
+    ByteReader r(compressed);
+    if(compressed.empty() || r.u8() != kSdpCompressionFormat)
+        throw invalid_argument("Not compressed SDP, or an unsupported format.");
+
+    uint64_t size = r.varint();
+    if(size > kMaxDecompressedSize)
+        corrupt();
+
+    size_t start = out.size();
+    out.resize(start + size);
+    char* dst = &out[start];
+    size_t produced = 0;
+
+    while(true){
+        uint8_t token = r.u8();
+
+        size_t literalCount = token >> 4;
+        if(literalCount == 15)
+            literalCount += r.varint();
+
+        if(literalCount > size - produced)
+            corrupt();
+
+        StringView literals = r.bytes(literalCount);
+        memcpy(dst + produced, literals.data(), literalCount);
+        produced += literalCount;
+
+        if(produced == size)
+            break;
+
+        size_t distance = r.u8();
+        distance |= (size_t)r.u8() << 8;
+
+        size_t matchSize = (token & 15) + kMinMatch;
+        if((token & 15) == 15)
+            matchSize += r.varint();
+
+        if(distance == 0 || distance > produced + kDictionarySize || matchSize > size - produced)
+            corrupt();
+
+        if(distance > produced){
+            // Starts in the dictionary, and may continue into the output.
+            size_t fromDictionary = distance - produced;
+            size_t n = fromDictionary < matchSize ? fromDictionary : matchSize;
+            memcpy(dst + produced, kDictionary + kDictionarySize - fromDictionary, n);
+            produced += n;
+            matchSize -= n;
+        }
+
+        const char* src = dst + produced - distance;
+        if(distance >= matchSize)
+            memcpy(dst + produced, src, matchSize);
+        else{
+            // The match overlaps the bytes it is producing (a repeated run).
+            for(size_t i = 0; i < matchSize; i++)
+                dst[produced + i] = src[i];
+        }
+
+        produced += matchSize;
+    }
+
+    if(!r.atEnd())
+        corrupt();
+}
+
+} // namespace zsdp
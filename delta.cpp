@@ -0,0 +1,421 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/delta.h>
+#include "sdp-codec.h"
+#include <stdexcept>
+
+
+using namespace std;
+
+namespace zsdp {
+
+/*
+ * Format 1:
+ *   u8 format, varint session field mask, the changed session fields,
+ *   session attribute list, varint stream count, then per stream:
+ *     0 (same as the base stream at this position),
+ *     1, varint stream field mask, the changed fields, attribute list, or
+ *     2, the whole stream.
+ *   An attribute list is a varint entry count followed by entries: a varint
+ *   (start << 1) and a varint run length copy base attributes start..start+run,
+ *   a varint 1 is followed by a new line ("key:value").
+ */
+
+namespace {
+
+enum SessionField : uint32_t {
+    SF_Version = 1 << 0,
+    SF_Origin = 1 << 1,
+    SF_SessionName = 1 << 2,
+    SF_SessionInformation = 1 << 3,
+    SF_Uri = 1 << 4,
+    SF_Email = 1 << 5,
+    SF_PhoneNumber = 1 << 6,
+    SF_ConnectionData = 1 << 7,
+    SF_Bandwidth = 1 << 8,
+    SF_Times = 1 << 9,
+    SF_TimeZones = 1 << 10,
+    SF_Encryption = 1 << 11,
+};
+
+enum StreamField : uint32_t {
+    STF_MediaDescription = 1 << 0,
+    STF_Title = 1 << 1,
+    STF_ConnectionData = 1 << 2,
+    STF_Bandwidth = 1 << 3,
+    STF_Encryption = 1 << 4,
+    STF_Attributes = 1 << 5,
+};
+
+enum StreamOp : uint8_t {
+    SO_Unchanged,
+    SO_Changed,
+    SO_New,
+};
+
+bool operator==(const Origin& a, const Origin& b){
+    return a.username == b.username && a.sessionID == b.sessionID && a.sessionVersion == b.sessionVersion
+           && a.networkType == b.networkType && a.addressType == b.addressType && a.host == b.host;
+}
+
+bool operator==(const ConnectionData& a, const ConnectionData& b){
+    return a.networkType == b.networkType && a.addressType == b.addressType && a.host == b.host
+           && a.multicastIPv4TTL == b.multicastIPv4TTL && a.multicastAddressCount == b.multicastAddressCount;
+}
+
+bool operator==(const Bandwidth& a, const Bandwidth& b){
+    return a.type == b.type && a.kbps == b.kbps;
+}
+
+bool operator==(const Encryption& a, const Encryption& b){
+    return a.type == b.type && a.key == b.key;
+}
+
+bool operator==(const RepeatingTime& a, const RepeatingTime& b){
+    return a.interval == b.interval && a.duration == b.duration && a.offsetsFromStartTime == b.offsetsFromStartTime;
+}
+
+bool operator==(const TimeZoneAdjustment& a, const TimeZoneAdjustment& b){
+    return a.adjustAtTime == b.adjustAtTime && a.adjustment == b.adjustment;
+}
+
+bool operator==(const MediaDescription& a, const MediaDescription& b){
+    return a.mediaType == b.mediaType && a.port == b.port && a.portCount == b.portCount
+           && a.protocol == b.protocol && a.payloadTypes == b.payloadTypes && a.codec == b.codec;
+}
+
+bool operator==(const Timing& a, const Timing& b);
+
+/// Defined after the element comparisons so they are visible to it.
+template<typename List>
+bool sameList(const List& a, const List& b){
+    if(a.size() != b.size())
+        return false;
+
+    for(size_t i = 0; i < a.size(); i++){
+        if(!(a[i] == b[i]))
+            return false;
+    }
+
+    return true;
+}
+
+bool operator==(const Timing& a, const Timing& b){
+    return a.start == b.start && a.end == b.end && sameList(a.repeatingTimes, b.repeatingTimes);
+}
+
+class DeltaEncoder {
+public:
+    explicit DeltaEncoder(string& out) : mOut(out) {}
+
+    void encode(const Sdp& base, const Sdp& next){
+        mOut += (char)kSdpDeltaFormat;
+
+        uint32_t mask = 0;
+        if(base.version != next.version) mask |= SF_Version;
+        if(!(base.origin == next.origin)) mask |= SF_Origin;
+        if(base.sessionName != next.sessionName) mask |= SF_SessionName;
+        if(base.sessionInformation != next.sessionInformation) mask |= SF_SessionInformation;
+        if(base.uri != next.uri) mask |= SF_Uri;
+        if(base.email != next.email) mask |= SF_Email;
+        if(base.phoneNumber != next.phoneNumber) mask |= SF_PhoneNumber;
+        if(!(base.connectionData == next.connectionData)) mask |= SF_ConnectionData;
+        if(!(base.bandwidth == next.bandwidth)) mask |= SF_Bandwidth;
+        if(!sameList(base.times, next.times)) mask |= SF_Times;
+        if(!sameList(base.timeZoneAdjustments, next.timeZoneAdjustments)) mask |= SF_TimeZones;
+        if(!(base.encryption == next.encryption)) mask |= SF_Encryption;
+
+        appendVarint(mOut, mask);
+        if(mask & SF_Version) appendVarint(mOut, next.version);
+        if(mask & SF_Origin){
+            appendLengthPrefixed(mOut, next.origin.username);
+            appendLengthPrefixed(mOut, next.origin.sessionID);
+            appendLengthPrefixed(mOut, next.origin.sessionVersion);
+            appendEnum(mOut, next.origin.networkType);
+            appendEnum(mOut, next.origin.addressType);
+            appendLengthPrefixed(mOut, next.origin.host);
+        }
+
+        if(mask & SF_SessionName) appendLengthPrefixed(mOut, next.sessionName);
+        if(mask & SF_SessionInformation) appendLengthPrefixed(mOut, next.sessionInformation);
+        if(mask & SF_Uri) appendLengthPrefixed(mOut, next.uri);
+        if(mask & SF_Email) appendLengthPrefixed(mOut, next.email);
+        if(mask & SF_PhoneNumber) appendLengthPrefixed(mOut, next.phoneNumber);
+        if(mask & SF_ConnectionData) appendConnectionData(mOut, next.connectionData);
+        if(mask & SF_Bandwidth) appendBandwidth(mOut, next.bandwidth);
+        if(mask & SF_Times) appendTimes(mOut, next.times);
+        if(mask & SF_TimeZones) appendTimeZones(mOut, next.timeZoneAdjustments);
+        if(mask & SF_Encryption) appendEncryption(mOut, next.encryption);
+
+        attributes(base.attributes, next.attributes);
+
+        appendVarint(mOut, next.streams.size());
+        for(size_t i = 0; i < next.streams.size(); i++){
+            if(i < base.streams.size())
+                stream(base.streams[i], next.streams[i]);
+            else{
+                mOut += (char)SO_New;
+                fullStream(next.streams[i]);
+            }
+        }
+    }
+
+private:
+    void stream(const Stream& base, const Stream& next){
+        uint32_t mask = 0;
+        if(!(base.mediaDescription == next.mediaDescription)) mask |= STF_MediaDescription;
+        if(base.title != next.title) mask |= STF_Title;
+        if(!(base.connectionData == next.connectionData)) mask |= STF_ConnectionData;
+        if(!(base.bandwidth == next.bandwidth)) mask |= STF_Bandwidth;
+        if(!(base.encryption == next.encryption)) mask |= STF_Encryption;
+        if(!sameAttributes(base.attributes, next.attributes)) mask |= STF_Attributes;
+
+        if(mask == 0){
+            mOut += (char)SO_Unchanged;
+            return;
+        }
+
+        mOut += (char)SO_Changed;
+        appendVarint(mOut, mask);
+        if(mask & STF_MediaDescription) appendMediaDescription(mOut, next.mediaDescription);
+        if(mask & STF_Title) appendLengthPrefixed(mOut, next.title);
+        if(mask & STF_ConnectionData) appendConnectionData(mOut, next.connectionData);
+        if(mask & STF_Bandwidth) appendBandwidth(mOut, next.bandwidth);
+        if(mask & STF_Encryption) appendEncryption(mOut, next.encryption);
+        if(mask & STF_Attributes) attributes(base.attributes, next.attributes);
+    }
+
+    void fullStream(const Stream& stream){
+        appendMediaDescription(mOut, stream.mediaDescription);
+        appendLengthPrefixed(mOut, stream.title);
+        appendConnectionData(mOut, stream.connectionData);
+        appendBandwidth(mOut, stream.bandwidth);
+        appendEncryption(mOut, stream.encryption);
+        attributes(AttributeList(), stream.attributes);
+    }
+
+    bool sameAttribute(const Attribute& a, const Attribute& b){
+        if(&a == &b)
+            return true;
+
+        return attributeLine(a, mScratchA) == attributeLine(b, mScratchB);
+    }
+
+    bool sameAttributes(const AttributeList& base, const AttributeList& next){
+        if(base.size() != next.size())
+            return false;
+
+        for(size_t i = 0; i < base.size(); i++){
+            if(!sameAttribute(*base[i], *next[i]))
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Index of next's attribute in base, searching from the expected position first.
+    size_t findInBase(const AttributeList& base, const Attribute& attr, size_t expected){
+        for(size_t i = expected; i < base.size(); i++){
+            if(sameAttribute(*base[i], attr))
+                return i;
+        }
+
+        for(size_t i = 0; i < expected && i < base.size(); i++){
+            if(sameAttribute(*base[i], attr))
+                return i;
+        }
+
+        return base.size();
+    }
+
+    void attributes(const AttributeList& base, const AttributeList& next){
+        mEntries.clear();
+
+        size_t expected = 0;
+        size_t i = 0;
+        while(i < next.size()){
+            size_t start = findInBase(base, *next[i], expected);
+            if(start == base.size()){
+                appendVarint(mEntries, 1);
+                appendLengthPrefixed(mEntries, attributeLine(*next[i], mScratchA));
+                mEntryCount++;
+                i++;
+                continue;
+            }
+
+            size_t run = 1;
+            while(i + run < next.size() && start + run < base.size() && sameAttribute(*base[start + run], *next[i + run]))
+                run++;
+
+            appendVarint(mEntries, (uint64_t)start << 1);
+            appendVarint(mEntries, run);
+            mEntryCount++;
+            i += run;
+            expected = start + run;
+        }
+
+        appendVarint(mOut, mEntryCount);
+        mOut += mEntries;
+        mEntryCount = 0;
+    }
+
+    string& mOut;
+    string mEntries;
+    size_t mEntryCount = 0;
+    string mScratchA;
+    string mScratchB;
+};
+
+[[noreturn]] void badDelta(const char* reason){
+    throw invalid_argument(string("Invalid SDP delta: ") + reason);
+}
+
+void applyAttributes(ByteReader& r, const AttributeList& base, AttributeList& out){
+    out.clear();
+
+    uint64_t entryCount = r.varint();
+    for(uint64_t e = 0; e < entryCount; e++){
+        uint64_t entry = r.varint();
+        if(entry == 1){
+            out.push_back(parseAttribute(r.lengthPrefixed().str()));
+            continue;
+        }
+
+        if(entry & 1)
+            badDelta("unknown attribute entry.");
+
+        uint64_t start = entry >> 1;
+        uint64_t run = r.varint();
+        if(start > base.size() || run > base.size() - start)
+            badDelta("attribute index out of range.");
+
+        out.insert(out.end(), base.begin() + start, base.begin() + start + run);
+    }
+}
+
+Stream readFullStream(ByteReader& r){
+    Stream stream;
+    stream.mediaDescription = readMediaDescription(r);
+    stream.title = r.lengthPrefixed().str();
+    stream.connectionData = readConnectionData(r);
+    stream.bandwidth = readBandwidth(r);
+    stream.encryption = readEncryption(r);
+    applyAttributes(r, AttributeList(), stream.attributes);
+    stream.reindexAttributes();
+
+    return stream;
+}
+
+} // namespace
+
+void encodeDelta(const Sdp& base, const Sdp& next, string& out){
+    DeltaEncoder(out).encode(base, next);
+}
+
+string encodeDelta(const Sdp& base, const Sdp& next){
+    string out;
+    encodeDelta(base, next, out);
+
+    return out;
+}
+
+Sdp applyDelta(const Sdp& base, StringView delta){
+    ByteReader r(delta);
+    if(delta.empty() || r.u8() != kSdpDeltaFormat)
+        badDelta("unsupported format.");
+
+    Sdp next;
+    uint64_t mask = r.varint();
+
+    next.version = mask & SF_Version ? (uint32_t)r.varint() : base.version;
+    if(mask & SF_Origin){
+        next.origin.username = r.lengthPrefixed().str();
+        next.origin.sessionID = r.lengthPrefixed().str();
+        next.origin.sessionVersion = r.lengthPrefixed().str();
+        next.origin.networkType = readEnum(r, NetworkType::IN);
+        next.origin.addressType = readEnum(r, AddressType::IP6);
+        next.origin.host = r.lengthPrefixed().str();
+    }
+    else
+        next.origin = base.origin;
+
+    next.sessionName = mask & SF_SessionName ? r.lengthPrefixed().str() : base.sessionName;
+    next.sessionInformation = mask & SF_SessionInformation ? r.lengthPrefixed().str() : base.sessionInformation;
+    next.uri = mask & SF_Uri ? r.lengthPrefixed().str() : base.uri;
+    next.email = mask & SF_Email ? r.lengthPrefixed().str() : base.email;
+    next.phoneNumber = mask & SF_PhoneNumber ? r.lengthPrefixed().str() : base.phoneNumber;
+    next.connectionData = mask & SF_ConnectionData ? readConnectionData(r) : base.connectionData;
+    next.bandwidth = mask & SF_Bandwidth ? readBandwidth(r) : base.bandwidth;
+    next.times = mask & SF_Times ? readTimes(r) : base.times;
+    next.timeZoneAdjustments = mask & SF_TimeZones ? readTimeZones(r) : base.timeZoneAdjustments;
+    next.encryption = mask & SF_Encryption ? readEncryption(r) : base.encryption;
+
+    applyAttributes(r, base.attributes, next.attributes);
+
+    uint64_t streamCount = r.varint();
+    if(streamCount > delta.size())
+        badDelta("stream count out of range.");
+
+    next.streams.reserve(streamCount);
+    for(uint64_t i = 0; i < streamCount; i++){
+        uint8_t op = r.u8();
+        if(op == SO_New){
+            next.streams.push_back(readFullStream(r));
+            continue;
+        }
+
+        if(i >= base.streams.size())
+            badDelta("stream index out of range.");
+
+        const Stream& baseStream = base.streams[i];
+        if(op == SO_Unchanged){
+            next.streams.push_back(baseStream);
+            continue;
+        }
+
+        if(op != SO_Changed)
+            badDelta("unknown stream operation.");
+
+        uint64_t streamMask = r.varint();
+        next.streams.emplace_back();
+        Stream& stream = next.streams.back();
+        stream.mediaDescription = streamMask & STF_MediaDescription ? readMediaDescription(r) : baseStream.mediaDescription;
+        stream.title = streamMask & STF_Title ? r.lengthPrefixed().str() : baseStream.title;
+        stream.connectionData = streamMask & STF_ConnectionData ? readConnectionData(r) : baseStream.connectionData;
+        stream.bandwidth = streamMask & STF_Bandwidth ? readBandwidth(r) : baseStream.bandwidth;
+        stream.encryption = streamMask & STF_Encryption ? readEncryption(r) : baseStream.encryption;
+
+        if(streamMask & STF_Attributes){
+            applyAttributes(r, baseStream.attributes, stream.attributes);
+            stream.reindexAttributes();
+        }
+        else{
+            stream.attributes = baseStream.attributes;
+            stream.attributeIndex = baseStream.attributeIndex;
+        }
+    }
+
+    if(!r.atEnd())
+        badDelta("trailing bytes.");
+
+    return next;
+}
+
+} // namespace zsdp
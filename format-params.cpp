@@ -0,0 +1,449 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/format-params.h>
+#include <algorithm>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+using namespace std;
+
+namespace zsdp {
+
+namespace {
+
+char lower(char c){
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+int compareIgnoreCase(StringView a, StringView b){
+    size_t n = a.size() < b.size() ? a.size() : b.size();
+    for(size_t i = 0; i < n; i++){
+        char ca = lower(a[i]);
+        char cb = lower(b[i]);
+        if(ca != cb)
+            return (uint8_t)ca < (uint8_t)cb ? -1 : 1;
+    }
+
+    return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+}
+
+StringView trim(StringView s){
+    size_t start = 0;
+    size_t end = s.size();
+    while(start < end && (s[start] == ' ' || s[start] == '\t'))
+        start++;
+
+    while(end > start && (s[end - 1] == ' ' || s[end - 1] == '\t'))
+        end--;
+
+    return s.substr(start, end - start);
+}
+
+bool parseDigits(StringView s, int base, uint64_t* value){
+    if(s.empty() || s.size() > 16)
+        return false;
+
+    uint64_t n = 0;
+    for(char c : s){
+        int digit;
+        if(c >= '0' && c <= '9')
+            digit = c - '0';
+        else if(base == 16 && lower(c) >= 'a' && lower(c) <= 'f')
+            digit = lower(c) - 'a' + 10;
+        else
+            return false;
+
+        n = n * base + digit;
+    }
+
+    *value = n;
+    return true;
+}
+
+/// Maps each character to its value, or -1 if it isn't in the alphabet.
+struct DecodeTables {
+    int8_t base64[256];
+    int8_t hex[256];
+
+    DecodeTables(){
+        memset(base64, -1, sizeof(base64));
+        memset(hex, -1, sizeof(hex));
+
+        for(int i = 0; i < 26; i++){
+            base64['A' + i] = (int8_t)i;
+            base64['a' + i] = (int8_t)(26 + i);
+        }
+
+        for(int i = 0; i < 10; i++){
+            base64['0' + i] = (int8_t)(52 + i);
+            hex['0' + i] = (int8_t)i;
+        }
+
+        base64['+'] = 62;
+        base64['/'] = 63;
+
+        for(int i = 0; i < 6; i++){
+            hex['a' + i] = (int8_t)(10 + i);
+            hex['A' + i] = (int8_t)(10 + i);
+        }
+    }
+};
+
+const DecodeTables& decodeTables(){
+    static const DecodeTables tables;
+    return tables;
+}
+
+#if defined(__SSE2__)
+/// 0xff in each byte of c that is in [low, high].
+inline __m128i inRange(__m128i c, char low, char high){
+    return _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(low - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8(high + 1)));
+}
+
+/// Decodes 16 base64 characters to 12 bytes. Returns false, writing nothing, if any of them is outside the alphabet.
+bool decodeBase64Block(const char* in, uint8_t* out){
+    __m128i c = _mm_loadu_si128((const __m128i*)in);
+
+    // Bytes >= 0x80 are negative as signed chars, so they fall in no range.
+    __m128i upper = inRange(c, 'A', 'Z');
+    __m128i lower = inRange(c, 'a', 'z');
+    __m128i digit = inRange(c, '0', '9');
+    __m128i plus = _mm_cmpeq_epi8(c, _mm_set1_epi8('+'));
+    __m128i slash = _mm_cmpeq_epi8(c, _mm_set1_epi8('/'));
+
+    __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+    if(_mm_movemask_epi8(valid) != 0xffff)
+        return false;
+
+    __m128i offset = _mm_or_si128(_mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')),
+                                               _mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))),
+                                  _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(52 - '0')),
+                                               _mm_or_si128(_mm_and_si128(plus, _mm_set1_epi8(62 - '+')),
+                                                            _mm_and_si128(slash, _mm_set1_epi8(63 - '/')))));
+    __m128i sextets = _mm_add_epi8(c, offset);
+
+    // Each 16-bit lane has two sextets, the first in its low byte; join them into 12 bits.
+    __m128i pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(sextets, _mm_set1_epi16(0x00ff)), 6),
+                                 _mm_srli_epi16(sextets, 8));
+
+    // Then each 32-bit lane's two halves into the 24 bits of one group.
+    __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+
+    uint32_t words[4];
+    _mm_storeu_si128((__m128i*)words, groups);
+    for(int i = 0; i < 4; i++){
+        out[i * 3] = (uint8_t)(words[i] >> 16);
+        out[i * 3 + 1] = (uint8_t)(words[i] >> 8);
+        out[i * 3 + 2] = (uint8_t)words[i];
+    }
+
+    return true;
+}
+
+/// Decodes 16 hex digits to 8 bytes. Returns false, writing nothing, if any of them isn't a hex digit.
+bool decodeHexBlock(const char* in, uint8_t* out){
+    __m128i c = _mm_loadu_si128((const __m128i*)in);
+
+    __m128i digit = inRange(c, '0', '9');
+    __m128i lower = inRange(c, 'a', 'f');
+    __m128i upper = inRange(c, 'A', 'F');
+
+    if(_mm_movemask_epi8(_mm_or_si128(digit, _mm_or_si128(lower, upper))) != 0xffff)
+        return false;
+
+    __m128i offset = _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(-'0')),
+                                  _mm_or_si128(_mm_and_si128(lower, _mm_set1_epi8(10 - 'a')),
+                                               _mm_and_si128(upper, _mm_set1_epi8(10 - 'A'))));
+    __m128i nibbles = _mm_add_epi8(c, offset);
+
+    // Each 16-bit lane has the high nibble in its low byte.
+    __m128i bytes = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00ff)), 4),
+                                 _mm_srli_epi16(nibbles, 8));
+
+    _mm_storel_epi64((__m128i*)out, _mm_packus_epi16(bytes, bytes));
+    return true;
+}
+#endif
+
+} // namespace
+
+FormatParamMap::FormatParamMap(StringView formatParams){
+    size_t start = 0;
+    while(start <= formatParams.size()){
+        size_t end = formatParams.find(';', start);
+        if(end == StringView::npos)
+            end = formatParams.size();
+
+        StringView param = trim(formatParams.substr(start, end - start));
+        if(!param.empty()){
+            size_t equals = param.find('=');
+
+            FormatParam p;
+            p.key = trim(param.substr(0, equals));
+            p.value = equals == StringView::npos ? StringView() : trim(param.substr(equals + 1));
+            mParams.push_back(p);
+        }
+
+        start = end + 1;
+    }
+
+    // Stable, so the first of two equal keys stays first and find() returns it.
+    stable_sort(mParams.begin(), mParams.end(), [](const FormatParam& a, const FormatParam& b){
+        return compareIgnoreCase(a.key, b.key) < 0;
+    });
+}
+
+const FormatParam* FormatParamMap::find(StringView key) const{
+    auto it = lower_bound(mParams.begin(), mParams.end(), key, [](const FormatParam& p, StringView k){
+        return compareIgnoreCase(p.key, k) < 0;
+    });
+
+    return it != mParams.end() && compareIgnoreCase(it->key, key) == 0 ? it : NULL;
+}
+
+StringView FormatParamMap::get(StringView key, StringView fallback) const{
+    const FormatParam* param = find(key);
+    return param != NULL ? param->value : fallback;
+}
+
+bool FormatParamMap::getInt(StringView key, int64_t* value) const{
+    const FormatParam* param = find(key);
+    if(param == NULL)
+        return false;
+
+    StringView s = param->value;
+    bool negative = !s.empty() && s[0] == '-';
+    uint64_t n = 0;
+    if(!parseDigits(negative ? s.substr(1) : s, 10, &n) || n > (uint64_t)INT64_MAX)
+        return false;
+
+    *value = negative ? -(int64_t)n : (int64_t)n;
+    return true;
+}
+
+bool FormatParamMap::getHex(StringView key, uint64_t* value) const{
+    const FormatParam* param = find(key);
+    return param != NULL && parseDigits(param->value, 16, value);
+}
+
+bool FormatParamMap::getBool(StringView key, bool* value) const{
+    const FormatParam* param = find(key);
+    if(param == NULL)
+        return false;
+
+    if(param->value == "1" || param->value.equalsIgnoreCase("true"))
+        *value = true;
+    else if(param->value == "0" || param->value.equalsIgnoreCase("false"))
+        *value = false;
+    else
+        return false;
+
+    return true;
+}
+
+int64_t FormatParamMap::intOr(StringView key, int64_t fallback) const{
+    int64_t value = fallback;
+    getInt(key, &value);
+    return value;
+}
+
+bool FormatParamMap::boolOr(StringView key, bool fallback) const{
+    bool value = fallback;
+    getBool(key, &value);
+    return value;
+}
+
+
+bool parseH264Params(const FormatParamMap& params, H264Params* h264){
+    *h264 = H264Params();
+
+    const FormatParam* profileLevelId = params.find("profile-level-id");
+    if(profileLevelId != NULL){
+        uint64_t value = 0;
+        if(profileLevelId->value.size() != 6 || !parseDigits(profileLevelId->value, 16, &value))
+            return false;
+
+        h264->profileIdc = (uint8_t)(value >> 16);
+        h264->profileIop = (uint8_t)(value >> 8);
+        h264->levelIdc = (uint8_t)value;
+    }
+
+    h264->packetizationMode = (uint8_t)params.intOr("packetization-mode", 0);
+    h264->levelAsymmetryAllowed = params.boolOr("level-asymmetry-allowed", false);
+    return true;
+}
+
+OpusParams parseOpusParams(const FormatParamMap& params){
+    OpusParams opus;
+    opus.maxPlaybackRate = (uint32_t)params.intOr("maxplaybackrate", opus.maxPlaybackRate);
+    opus.spropMaxCaptureRate = (uint32_t)params.intOr("sprop-maxcapturerate", opus.spropMaxCaptureRate);
+    opus.maxAverageBitrate = (uint32_t)params.intOr("maxaveragebitrate", 0);
+    opus.minPTime = (uint32_t)params.intOr("minptime", 0);
+    opus.stereo = params.boolOr("stereo", false);
+    opus.spropStereo = params.boolOr("sprop-stereo", false);
+    opus.cbr = params.boolOr("cbr", false);
+    opus.useInbandFec = params.boolOr("useinbandfec", false);
+    opus.useDtx = params.boolOr("usedtx", false);
+
+    return opus;
+}
+
+int parseVp9ProfileId(const FormatParamMap& params){
+    if(!params.has("profile-id"))
+        return 0;
+
+    int64_t profileId = -1;
+    return params.getInt("profile-id", &profileId) && profileId >= 0 && profileId <= 3 ? (int)profileId : -1;
+}
+
+
+bool decodeBase64(StringView in, vector<uint8_t>& out){
+    size_t size = in.size();
+    if(size != 0 && size % 4 == 0){
+        if(in[size - 1] == '=')
+            size--;
+        if(in[size - 1] == '=')
+            size--;
+    }
+
+    if(size % 4 == 1)
+        return false;
+
+    size_t start = out.size();
+    out.resize(start + size / 4 * 3 + (size % 4 == 0 ? 0 : size % 4 - 1));
+
+    const int8_t* table = decodeTables().base64;
+    const char* p = in.data();
+    const char* end = p + size;
+    uint8_t* o = out.data() + start;
+
+#if defined(__SSE2__)
+    // A block that fails is left to the loop below, which finds the bad character.
+    while(end - p >= 16 && decodeBase64Block(p, o)){
+        p += 16;
+        o += 12;
+    }
+#endif
+
+    for(; end - p >= 4; p += 4, o += 3){
+        int a = table[(uint8_t)p[0]];
+        int b = table[(uint8_t)p[1]];
+        int c = table[(uint8_t)p[2]];
+        int d = table[(uint8_t)p[3]];
+        if((a | b | c | d) < 0){
+            out.resize(start);
+            return false;
+        }
+
+        uint32_t group = ((uint32_t)a << 18) | ((uint32_t)b << 12) | ((uint32_t)c << 6) | (uint32_t)d;
+        o[0] = (uint8_t)(group >> 16);
+        o[1] = (uint8_t)(group >> 8);
+        o[2] = (uint8_t)group;
+    }
+
+    // Two or three characters left: one or two bytes.
+    if(p < end){
+        int a = table[(uint8_t)p[0]];
+        int b = table[(uint8_t)p[1]];
+        int c = end - p == 3 ? table[(uint8_t)p[2]] : 0;
+        if((a | b | c) < 0){
+            out.resize(start);
+            return false;
+        }
+
+        uint32_t group = ((uint32_t)a << 18) | ((uint32_t)b << 12) | ((uint32_t)c << 6);
+        o[0] = (uint8_t)(group >> 16);
+        if(end - p == 3)
+            o[1] = (uint8_t)(group >> 8);
+    }
+
+    return true;
+}
+
+bool decodeHex(StringView in, vector<uint8_t>& out){
+    if(in.size() % 2 != 0)
+        return false;
+
+    size_t start = out.size();
+    out.resize(start + in.size() / 2);
+
+    const int8_t* table = decodeTables().hex;
+    const char* p = in.data();
+    const char* end = p + in.size();
+    uint8_t* o = out.data() + start;
+
+#if defined(__SSE2__)
+    while(end - p >= 16 && decodeHexBlock(p, o)){
+        p += 16;
+        o += 8;
+    }
+#endif
+
+    for(; p < end; p += 2, o++){
+        int high = table[(uint8_t)p[0]];
+        int low = table[(uint8_t)p[1]];
+        if((high | low) < 0){
+            out.resize(start);
+            return false;
+        }
+
+        *o = (uint8_t)((high << 4) | low);
+    }
+
+    return true;
+}
+
+sp<const BinaryParam> BinaryParam::decode(StringView value, BinaryEncoding encoding){
+    if(value.empty())
+        return NULL;
+
+    auto param = make_shared<BinaryParam>();
+    param->mBytes.reserve(encoding == BinaryEncoding::Base64 ? value.size() / 4 * 3 + 2 : value.size() / 2);
+
+    size_t start = 0;
+    while(start <= value.size()){
+        size_t end = value.find(',', start);
+        if(end == StringView::npos)
+            end = value.size();
+
+        StringView entry = value.substr(start, end - start);
+        bool decoded = encoding == BinaryEncoding::Base64 ? decodeBase64(entry, param->mBytes) : decodeHex(entry, param->mBytes);
+        if(entry.empty() || !decoded)
+            return NULL;
+
+        param->mEnds.push_back((uint32_t)param->mBytes.size());
+        start = end + 1;
+    }
+
+    return param;
+}
+
+BinaryParam::Unit BinaryParam::unit(size_t i) const{
+    size_t begin = i == 0 ? 0 : mEnds[i - 1];
+    Unit unit = { mBytes.data() + begin, mEnds[i] - begin };
+
+    return unit;
+}
+
+} // namespace zsdp
@@ -0,0 +1,589 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/frozen.h>
+#include "sdp-codec.h"
+#include <stdexcept>
+#include <unordered_map>
+
+
+using namespace std;
+
+namespace zsdp {
+
+namespace {
+
+/// A string in the pool.
+struct StrRef {
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct ConnectionRecord {
+    StrRef host;
+    uint32_t multicastAddressCount;
+    uint8_t networkType;
+    uint8_t addressType;
+    uint8_t multicastIPv4TTL;
+    uint8_t unused;
+};
+
+struct AttributeRecord {
+    StrRef line; /// everything after "a="
+    uint32_t keySize;
+};
+
+struct TimingRecord {
+    uint64_t start;
+    uint64_t end;
+    uint32_t firstRepeat;
+    uint32_t repeatCount;
+};
+
+struct RepeatRecord {
+    uint64_t interval;
+    uint64_t duration;
+    uint32_t firstOffset;
+    uint32_t offsetCount;
+};
+
+struct TimeZoneRecord {
+    uint64_t adjustAtTime;
+    int64_t adjustment;
+};
+
+} // namespace
+
+struct FrozenStreamRecord {
+    uint64_t bandwidthKbps;
+    StrRef codec;
+    StrRef title;
+    StrRef encryptionKey;
+    ConnectionRecord connection;
+    uint32_t firstAttribute;
+    uint32_t attributeCount;
+    uint32_t firstPayloadType;
+    uint32_t payloadTypeCount;
+    uint16_t port;
+    uint16_t portCount;
+    uint8_t mediaType;
+    uint8_t protocol;
+    uint8_t bandwidthType;
+    uint8_t encryptionType;
+};
+
+/// Starts the block. Section offsets are from the start of the block.
+struct FrozenSdp::Layout {
+    uint64_t bandwidthKbps;
+    StrRef originUsername;
+    StrRef originSessionID;
+    StrRef originSessionVersion;
+    StrRef originHost;
+    StrRef sessionName;
+    StrRef sessionInformation;
+    StrRef uri;
+    StrRef email;
+    StrRef phoneNumber;
+    StrRef encryptionKey;
+    ConnectionRecord connection;
+    uint32_t version;
+
+    uint32_t streams;
+    uint32_t streamCount;
+    uint32_t timings;
+    uint32_t timingCount;
+    uint32_t repeats;
+    uint32_t offsets;
+    uint32_t timeZones;
+    uint32_t timeZoneCount;
+    uint32_t attributes;
+    uint32_t sessionAttributeCount; /// session attributes come first, then each stream's
+    uint32_t payloadTypes;
+    uint32_t pool;
+
+    uint8_t originNetworkType;
+    uint8_t originAddressType;
+    uint8_t bandwidthType;
+    uint8_t encryptionType;
+};
+
+namespace {
+
+uint32_t checkedU32(size_t n){
+    if(n > UINT32_MAX)
+        throw length_error("SDP too large to freeze.");
+
+    return (uint32_t)n;
+}
+
+/// Collects distinct strings for the pool.
+class PoolBuilder {
+public:
+    StrRef add(StringView s){
+        if(s.empty())
+            return StrRef{ 0, 0 };
+
+        mKey.assign(s.data(), s.size());
+        auto it = mIndex.find(mKey);
+        if(it != mIndex.end())
+            return it->second;
+
+        StrRef ref = { checkedU32(mPool.size()), checkedU32(s.size()) };
+        mPool += s;
+        mIndex.emplace(mKey, ref);
+
+        return ref;
+    }
+
+    const string& pool() const { return mPool; }
+
+private:
+    string mPool;
+    string mKey;
+    unordered_map<string, StrRef> mIndex;
+};
+
+ConnectionRecord connectionRecord(PoolBuilder& pool, const ConnectionData& cd){
+    ConnectionRecord rec;
+    rec.host = pool.add(cd.host);
+    rec.multicastAddressCount = cd.multicastAddressCount;
+    rec.networkType = (uint8_t)cd.networkType;
+    rec.addressType = (uint8_t)cd.addressType;
+    rec.multicastIPv4TTL = cd.multicastIPv4TTL;
+    rec.unused = 0;
+
+    return rec;
+}
+
+void addAttributes(PoolBuilder& pool, string& scratch, const AttributeList& attributes, vector<AttributeRecord>& out){
+    for(const sp<Attribute>& attr : attributes){
+        StringView line = attributeLine(*attr, scratch);
+        size_t colon = line.find(':');
+
+        AttributeRecord rec;
+        rec.line = pool.add(line);
+        rec.keySize = checkedU32(colon == StringView::npos ? line.size() : colon);
+        out.push_back(rec);
+    }
+}
+
+size_t alignUp(size_t n, size_t alignment){
+    return (n + alignment - 1) & ~(alignment - 1);
+}
+
+/// Reserves an aligned section for count Ts and returns its offset.
+template<typename T>
+uint32_t section(size_t& size, size_t count){
+    size = alignUp(size, alignof(T));
+    uint32_t offset = checkedU32(size);
+    size += count * sizeof(T);
+
+    return offset;
+}
+
+template<typename T>
+void copySection(char* block, uint32_t offset, const vector<T>& items){
+    if(!items.empty())
+        memcpy(block + offset, items.data(), items.size() * sizeof(T));
+}
+
+template<typename T>
+const T* sectionAt(const char* block, uint32_t offset){
+    return (const T*)(block + offset);
+}
+
+StringView poolStr(const char* block, uint32_t pool, const StrRef& ref){
+    return StringView(block + pool + ref.offset, ref.size);
+}
+
+FrozenConnectionData connectionView(const char* block, uint32_t pool, const ConnectionRecord& rec){
+    FrozenConnectionData cd;
+    cd.networkType = (NetworkType)rec.networkType;
+    cd.addressType = (AddressType)rec.addressType;
+    cd.host = poolStr(block, pool, rec.host);
+    cd.multicastIPv4TTL = rec.multicastIPv4TTL;
+    cd.multicastAddressCount = rec.multicastAddressCount;
+
+    return cd;
+}
+
+ConnectionData toConnectionData(const FrozenConnectionData& view){
+    ConnectionData cd;
+    cd.networkType = view.networkType;
+    cd.addressType = view.addressType;
+    cd.host = view.host.str();
+    cd.multicastIPv4TTL = view.multicastIPv4TTL;
+    cd.multicastAddressCount = view.multicastAddressCount;
+
+    return cd;
+}
+
+Encryption toEncryption(const FrozenEncryption& view){
+    Encryption encryption;
+    encryption.type = view.type;
+    encryption.key = view.key.str();
+
+    return encryption;
+}
+
+} // namespace
+
+
+FrozenSdp::FrozenSdp(const Sdp& sdp){
+    PoolBuilder pool;
+    string scratch;
+
+    Layout layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.bandwidthKbps = sdp.bandwidth.kbps;
+    layout.originUsername = pool.add(sdp.origin.username);
+    layout.originSessionID = pool.add(sdp.origin.sessionID);
+    layout.originSessionVersion = pool.add(sdp.origin.sessionVersion);
+    layout.originHost = pool.add(sdp.origin.host);
+    layout.sessionName = pool.add(sdp.sessionName);
+    layout.sessionInformation = pool.add(sdp.sessionInformation);
+    layout.uri = pool.add(sdp.uri);
+    layout.email = pool.add(sdp.email);
+    layout.phoneNumber = pool.add(sdp.phoneNumber);
+    layout.encryptionKey = pool.add(sdp.encryption.key);
+    layout.connection = connectionRecord(pool, sdp.connectionData);
+    layout.version = sdp.version;
+    layout.originNetworkType = (uint8_t)sdp.origin.networkType;
+    layout.originAddressType = (uint8_t)sdp.origin.addressType;
+    layout.bandwidthType = (uint8_t)sdp.bandwidth.type;
+    layout.encryptionType = (uint8_t)sdp.encryption.type;
+
+    vector<TimingRecord> timings;
+    vector<RepeatRecord> repeats;
+    vector<uint64_t> offsets;
+    for(const Timing& timing : sdp.times){
+        TimingRecord rec = { timing.start, timing.end, checkedU32(repeats.size()), checkedU32(timing.repeatingTimes.size()) };
+        timings.push_back(rec);
+
+        for(const RepeatingTime& rt : timing.repeatingTimes){
+            RepeatRecord repeat = { rt.interval, rt.duration, checkedU32(offsets.size()), checkedU32(rt.offsetsFromStartTime.size()) };
+            repeats.push_back(repeat);
+            offsets.insert(offsets.end(), rt.offsetsFromStartTime.begin(), rt.offsetsFromStartTime.end());
+        }
+    }
+
+    vector<TimeZoneRecord> timeZones;
+    for(const TimeZoneAdjustment& adj : sdp.timeZoneAdjustments)
+        timeZones.push_back(TimeZoneRecord{ adj.adjustAtTime, adj.adjustment });
+
+    vector<AttributeRecord> attributes;
+    addAttributes(pool, scratch, sdp.attributes, attributes);
+    layout.sessionAttributeCount = checkedU32(attributes.size());
+
+    vector<FrozenStreamRecord> streams;
+    vector<uint8_t> payloadTypes;
+    for(const Stream& stream : sdp.streams){
+        const MediaDescription& md = stream.mediaDescription;
+
+        FrozenStreamRecord rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.bandwidthKbps = stream.bandwidth.kbps;
+        rec.codec = pool.add(md.codec.view());
+        rec.title = pool.add(stream.title);
+        rec.encryptionKey = pool.add(stream.encryption.key);
+        rec.connection = connectionRecord(pool, stream.connectionData);
+        rec.firstAttribute = checkedU32(attributes.size());
+        rec.attributeCount = checkedU32(stream.attributes.size());
+        rec.firstPayloadType = checkedU32(payloadTypes.size());
+        rec.payloadTypeCount = checkedU32(md.payloadTypes.size());
+        rec.port = md.port;
+        rec.portCount = md.portCount;
+        rec.mediaType = (uint8_t)md.mediaType;
+        rec.protocol = (uint8_t)md.protocol;
+        rec.bandwidthType = (uint8_t)stream.bandwidth.type;
+        rec.encryptionType = (uint8_t)stream.encryption.type;
+        streams.push_back(rec);
+
+        addAttributes(pool, scratch, stream.attributes, attributes);
+        payloadTypes.insert(payloadTypes.end(), md.payloadTypes.begin(), md.payloadTypes.end());
+    }
+
+    // 8-byte aligned sections first, then 4-byte, then bytes.
+    size_t size = sizeof(Layout);
+    layout.streams = section<FrozenStreamRecord>(size, streams.size());
+    layout.streamCount = checkedU32(streams.size());
+    layout.timings = section<TimingRecord>(size, timings.size());
+    layout.timingCount = checkedU32(timings.size());
+    layout.repeats = section<RepeatRecord>(size, repeats.size());
+    layout.offsets = section<uint64_t>(size, offsets.size());
+    layout.timeZones = section<TimeZoneRecord>(size, timeZones.size());
+    layout.timeZoneCount = checkedU32(timeZones.size());
+    layout.attributes = section<AttributeRecord>(size, attributes.size());
+    layout.payloadTypes = section<uint8_t>(size, payloadTypes.size());
+    layout.pool = section<char>(size, pool.pool().size());
+
+    mBlockSize = size;
+    mBlock = new char[size];
+    memcpy(mBlock, &layout, sizeof(layout));
+    copySection(mBlock, layout.streams, streams);
+    copySection(mBlock, layout.timings, timings);
+    copySection(mBlock, layout.repeats, repeats);
+    copySection(mBlock, layout.offsets, offsets);
+    copySection(mBlock, layout.timeZones, timeZones);
+    copySection(mBlock, layout.attributes, attributes);
+    copySection(mBlock, layout.payloadTypes, payloadTypes);
+    memcpy(mBlock + layout.pool, pool.pool().data(), pool.pool().size());
+}
+
+FrozenSdp::FrozenSdp(FrozenSdp&& other) noexcept : mBlock(other.mBlock), mBlockSize(other.mBlockSize) {
+    other.mBlock = NULL;
+    other.mBlockSize = 0;
+}
+
+FrozenSdp& FrozenSdp::operator=(FrozenSdp&& other) noexcept{
+    if(this != &other){
+        delete[] mBlock;
+        mBlock = other.mBlock;
+        mBlockSize = other.mBlockSize;
+        other.mBlock = NULL;
+        other.mBlockSize = 0;
+    }
+
+    return *this;
+}
+
+FrozenSdp::~FrozenSdp(){
+    delete[] mBlock;
+}
+
+uint32_t FrozenSdp::version() const{ return layout().version; }
+StringView FrozenSdp::originUsername() const{ return poolStr(mBlock, layout().pool, layout().originUsername); }
+StringView FrozenSdp::originSessionID() const{ return poolStr(mBlock, layout().pool, layout().originSessionID); }
+StringView FrozenSdp::originSessionVersion() const{ return poolStr(mBlock, layout().pool, layout().originSessionVersion); }
+NetworkType FrozenSdp::originNetworkType() const{ return (NetworkType)layout().originNetworkType; }
+AddressType FrozenSdp::originAddressType() const{ return (AddressType)layout().originAddressType; }
+StringView FrozenSdp::originHost() const{ return poolStr(mBlock, layout().pool, layout().originHost); }
+StringView FrozenSdp::sessionName() const{ return poolStr(mBlock, layout().pool, layout().sessionName); }
+StringView FrozenSdp::sessionInformation() const{ return poolStr(mBlock, layout().pool, layout().sessionInformation); }
+StringView FrozenSdp::uri() const{ return poolStr(mBlock, layout().pool, layout().uri); }
+StringView FrozenSdp::email() const{ return poolStr(mBlock, layout().pool, layout().email); }
+StringView FrozenSdp::phoneNumber() const{ return poolStr(mBlock, layout().pool, layout().phoneNumber); }
+
+FrozenConnectionData FrozenSdp::connectionData() const{
+    return connectionView(mBlock, layout().pool, layout().connection);
+}
+
+Bandwidth FrozenSdp::bandwidth() const{
+    Bandwidth bandwidth;
+    bandwidth.type = (BandwidthType)layout().bandwidthType;
+    bandwidth.kbps = layout().bandwidthKbps;
+
+    return bandwidth;
+}
+
+FrozenEncryption FrozenSdp::encryption() const{
+    return FrozenEncryption{ (EncryptionType)layout().encryptionType, poolStr(mBlock, layout().pool, layout().encryptionKey) };
+}
+
+size_t FrozenSdp::attributeCount() const{
+    return layout().sessionAttributeCount;
+}
+
+namespace {
+
+FrozenAttribute attributeAt(const char* block, uint32_t attributes, uint32_t pool, size_t index){
+    const AttributeRecord& rec = sectionAt<AttributeRecord>(block, attributes)[index];
+    StringView line = poolStr(block, pool, rec.line);
+
+    FrozenAttribute attr;
+    attr.key = line.substr(0, rec.keySize);
+    attr.hasValue = rec.keySize < line.size();
+    attr.value = attr.hasValue ? line.substr(rec.keySize + 1) : StringView();
+
+    return attr;
+}
+
+} // namespace
+
+FrozenAttribute FrozenSdp::attribute(size_t i) const{
+    if(i >= layout().sessionAttributeCount)
+        throw out_of_range("Attribute index " + to_string(i) + " is out-of-range.");
+
+    return attributeAt(mBlock, layout().attributes, layout().pool, i);
+}
+
+size_t FrozenSdp::streamCount() const{
+    return layout().streamCount;
+}
+
+FrozenStream FrozenSdp::stream(size_t i) const{
+    if(i >= layout().streamCount)
+        throw out_of_range("Stream index " + to_string(i) + " is out-of-range.");
+
+    return FrozenStream(this, sectionAt<FrozenStreamRecord>(mBlock, layout().streams) + i);
+}
+
+vector<Timing> FrozenSdp::times() const{
+    const TimingRecord* timings = sectionAt<TimingRecord>(mBlock, layout().timings);
+    const RepeatRecord* repeats = sectionAt<RepeatRecord>(mBlock, layout().repeats);
+    const uint64_t* offsets = sectionAt<uint64_t>(mBlock, layout().offsets);
+
+    vector<Timing> times(layout().timingCount);
+    for(size_t i = 0; i < times.size(); i++){
+        times[i].start = timings[i].start;
+        times[i].end = timings[i].end;
+
+        for(uint32_t j = 0; j < timings[i].repeatCount; j++){
+            const RepeatRecord& repeat = repeats[timings[i].firstRepeat + j];
+
+            RepeatingTime rt;
+            rt.interval = repeat.interval;
+            rt.duration = repeat.duration;
+            rt.offsetsFromStartTime.assign(offsets + repeat.firstOffset, offsets + repeat.firstOffset + repeat.offsetCount);
+            times[i].repeatingTimes.push_back(rt);
+        }
+    }
+
+    return times;
+}
+
+vector<TimeZoneAdjustment> FrozenSdp::timeZoneAdjustments() const{
+    const TimeZoneRecord* records = sectionAt<TimeZoneRecord>(mBlock, layout().timeZones);
+
+    vector<TimeZoneAdjustment> adjustments(layout().timeZoneCount);
+    for(size_t i = 0; i < adjustments.size(); i++){
+        adjustments[i].adjustAtTime = records[i].adjustAtTime;
+        adjustments[i].adjustment = records[i].adjustment;
+    }
+
+    return adjustments;
+}
+
+Sdp FrozenSdp::toSdp() const{
+    Sdp sdp;
+    sdp.version = version();
+    sdp.origin.username = originUsername().str();
+    sdp.origin.sessionID = originSessionID().str();
+    sdp.origin.sessionVersion = originSessionVersion().str();
+    sdp.origin.networkType = originNetworkType();
+    sdp.origin.addressType = originAddressType();
+    sdp.origin.host = originHost().str();
+    sdp.sessionName = sessionName().str();
+    sdp.sessionInformation = sessionInformation().str();
+    sdp.uri = uri().str();
+    sdp.email = email().str();
+    sdp.phoneNumber = phoneNumber().str();
+    sdp.connectionData = toConnectionData(connectionData());
+    sdp.bandwidth = bandwidth();
+    sdp.times = times();
+    sdp.timeZoneAdjustments = timeZoneAdjustments();
+    sdp.encryption = toEncryption(encryption());
+
+    for(size_t i = 0; i < attributeCount(); i++)
+        sdp.attributes.push_back(attribute(i).decode());
+
+    sdp.streams.reserve(streamCount());
+    for(size_t i = 0; i < streamCount(); i++)
+        sdp.streams.push_back(stream(i).toStream());
+
+    return sdp;
+}
+
+size_t FrozenSdp::memoryUsage() const{
+    return sizeof(*this) + mBlockSize;
+}
+
+
+MediaType FrozenStream::mediaType() const{ return (MediaType)mRecord->mediaType; }
+uint16_t FrozenStream::port() const{ return mRecord->port; }
+uint16_t FrozenStream::portCount() const{ return mRecord->portCount; }
+Protocol FrozenStream::protocol() const{ return (Protocol)mRecord->protocol; }
+size_t FrozenStream::payloadTypeCount() const{ return mRecord->payloadTypeCount; }
+
+uint8_t FrozenStream::payloadType(size_t i) const{
+    if(i >= mRecord->payloadTypeCount)
+        throw out_of_range("Payload type index " + to_string(i) + " is out-of-range.");
+
+    return sectionAt<uint8_t>(mSdp->mBlock, mSdp->layout().payloadTypes)[mRecord->firstPayloadType + i];
+}
+
+StringView FrozenStream::codec() const{ return poolStr(mSdp->mBlock, mSdp->layout().pool, mRecord->codec); }
+StringView FrozenStream::title() const{ return poolStr(mSdp->mBlock, mSdp->layout().pool, mRecord->title); }
+
+FrozenConnectionData FrozenStream::connectionData() const{
+    return connectionView(mSdp->mBlock, mSdp->layout().pool, mRecord->connection);
+}
+
+Bandwidth FrozenStream::bandwidth() const{
+    Bandwidth bandwidth;
+    bandwidth.type = (BandwidthType)mRecord->bandwidthType;
+    bandwidth.kbps = mRecord->bandwidthKbps;
+
+    return bandwidth;
+}
+
+FrozenEncryption FrozenStream::encryption() const{
+    return FrozenEncryption{ (EncryptionType)mRecord->encryptionType, poolStr(mSdp->mBlock, mSdp->layout().pool, mRecord->encryptionKey) };
+}
+
+size_t FrozenStream::attributeCount() const{
+    return mRecord->attributeCount;
+}
+
+FrozenAttribute FrozenStream::attribute(size_t i) const{
+    if(i >= mRecord->attributeCount)
+        throw out_of_range("Attribute index " + to_string(i) + " is out-of-range.");
+
+    return attributeAt(mSdp->mBlock, mSdp->layout().attributes, mSdp->layout().pool, mRecord->firstAttribute + i);
+}
+
+Stream FrozenStream::toStream() const{
+    Stream stream;
+    MediaDescription& md = stream.mediaDescription;
+    md.mediaType = mediaType();
+    md.port = port();
+    md.portCount = portCount();
+    md.protocol = protocol();
+    for(size_t i = 0; i < payloadTypeCount(); i++)
+        md.addPayloadType(payloadType(i));
+
+    md.codec = codec().str();
+    stream.title = title().str();
+    stream.connectionData = toConnectionData(connectionData());
+    stream.bandwidth = bandwidth();
+    stream.encryption = toEncryption(encryption());
+
+    stream.attributes.reserve(attributeCount());
+    for(size_t i = 0; i < attributeCount(); i++)
+        stream.attributes.push_back(attribute(i).decode());
+
+    stream.reindexAttributes();
+
+    return stream;
+}
+
+
+sp<Attribute> FrozenAttribute::decode() const{
+    string line;
+    line.reserve(key.size() + 1 + value.size());
+    line += key;
+    if(hasValue){
+        line += ':';
+        line += value;
+    }
+
+    return parseAttribute(line);
+}
+
+} // namespace zsdp
@@ -20,21 +20,99 @@
 #ifndef __ZSDP_ATTRIBUTES_H__
 #define __ZSDP_ATTRIBUTES_H__
 
+#include <atomic>
 #include <string>
 #include <zsdp/defs.h>
+#include <zsdp/format-params.h>
+#include <zsdp/string-view.h>
+#include <zsdp/symbol.h>
 
 
 namespace zsdp{
 
+/// The built-in attribute classes, so code can tell them apart without RTTI.
+enum class AttrId : uint8_t {
+    Other,          /// a class from registerAttribute()
+    Generic,        /// GenericAttribute
+    Category,
+    Keywords,
+    Tool,
+    PTime,
+    MaxPTime,
+    MediaDirection,
+    Orientation,
+    ConferenceType,
+    Charset,
+    SdpLanguage,
+    MediaLanguage,
+    Framerate,
+    Quality,
+    FormatParams,
+    RtpMap,
+    Capability,          /// RFC 5939, from registerCapabilityNegotiationAttributes()
+    TransportCapability,
+    PotentialConfig,
+    ActualConfig,
+    Count
+};
+
 class Attribute {
 public:
     virtual ~Attribute(){}
 
-    virtual std::string key() const = 0;
+    AttrId id() const{ return mId; }
+
+    /// The key of a built-in attribute is a constant, and a GenericAttribute's points into its line.
+    virtual StringView key() const = 0;
     virtual std::string value() const = 0;
 
     /// everything except a=
-    virtual std::string sdpLine() const{ return key() + ":" + value(); }
+    virtual std::string sdpLine() const{ return key().str() + ":" + value(); }
+
+    /// Appends sdpLine() to out.
+    virtual void appendSdpLine(std::string& out) const{ out += sdpLine(); }
+
+    /// This attribute as a T if id() is T::kId, otherwise NULL. A static_cast, not a dynamic_cast.
+    template<typename T>
+    const T* as() const{ return mId == T::kId ? static_cast<const T*>(this) : NULL; }
+
+    template<typename T>
+    T* as(){ return mId == T::kId ? static_cast<T*>(this) : NULL; }
+
+protected:
+    explicit Attribute(AttrId id = AttrId::Other) : mId(id) {}
+
+private:
+    AttrId mId;
+};
+
+
+/**
+ * An attribute kept exactly as it appeared after "a=". parseAttribute() returns
+ * one when no parser is registered for the key, and parseSdp() returns only
+ * these when ParseOptions::decodeAttributes is false. Writing it back out is a
+ * single append of the original text.
+ */
+class GenericAttribute : public Attribute {
+public:
+    static constexpr AttrId kId = AttrId::Generic;
+
+    explicit GenericAttribute(const std::string& line);
+    virtual ~GenericAttribute();
+
+    const std::string& line() const{ return mLine; }
+
+    virtual StringView key() const override;
+    virtual std::string value() const override;
+    virtual std::string sdpLine() const override;
+    virtual void appendSdpLine(std::string& out) const override;
+
+    /// Runs the registered parser for key() over the line, or returns NULL if there is none.
+    sp<Attribute> decode() const;
+
+private:
+    std::string mLine;
+    size_t mKeySize;
 };
 
 
@@ -45,29 +123,33 @@ typedef sp<Attribute> (*AttributeParseFnc)(const std::string& key,
 void registerAttribute(const std::string& key,
                        AttributeParseFnc parseFnc);
 
+/// Never returns NULL: unknown keys yield a GenericAttribute.
 sp<Attribute> parseAttribute(const std::string& line);
 
 
 
 
 
-#define SINGLE_ATTR_CLASS_DEF(CLASS_NAME, PARAM_TYPE, PARAM_NAME)  \
+#define SINGLE_ATTR_CLASS_DEF(CLASS_NAME, ID, PARAM_TYPE, PARAM_NAME) \
 class CLASS_NAME : public Attribute {                    \
 public:                                                  \
+    static constexpr AttrId kId = AttrId::ID;            \
+                                                         \
+    CLASS_NAME() : Attribute(kId) {}                     \
     virtual ~CLASS_NAME();                               \
     PARAM_TYPE PARAM_NAME;                               \
                                                          \
-    virtual std::string key() const override;            \
+    virtual StringView key() const override;             \
     virtual std::string value() const override;          \
 };
 
 
-SINGLE_ATTR_CLASS_DEF(AttrCategory, std::string, category)
-SINGLE_ATTR_CLASS_DEF(AttrKeywords, std::string, keywords)
-SINGLE_ATTR_CLASS_DEF(AttrTool,     std::string, tool)
+SINGLE_ATTR_CLASS_DEF(AttrCategory, Category, std::string, category)
+SINGLE_ATTR_CLASS_DEF(AttrKeywords, Keywords, std::string, keywords)
+SINGLE_ATTR_CLASS_DEF(AttrTool,     Tool,     std::string, tool)
 
-SINGLE_ATTR_CLASS_DEF(AttrPTime, uint64_t, packetDuration)
-SINGLE_ATTR_CLASS_DEF(AttrMaxPTime, uint64_t, maxPacketDuration)
+SINGLE_ATTR_CLASS_DEF(AttrPTime, PTime, uint64_t, packetDuration)
+SINGLE_ATTR_CLASS_DEF(AttrMaxPTime, MaxPTime, uint64_t, maxPacketDuration)
 
 enum class MediaDirection {
     SendRecv,
@@ -78,11 +160,14 @@ enum class MediaDirection {
 
 class AttrMediaDirection : public Attribute {
 public:
+    static constexpr AttrId kId = AttrId::MediaDirection;
+
+    AttrMediaDirection() : Attribute(kId) {}
     virtual ~AttrMediaDirection();
 
     MediaDirection direction;
 
-    virtual std::string key() const override;
+    virtual StringView key() const override;
     virtual std::string value() const override;
     virtual std::string sdpLine() const override;
 };
@@ -95,7 +180,7 @@ enum class Orientation {
     Seascape,
 };
 
-SINGLE_ATTR_CLASS_DEF(AttrOrientation, Orientation, orientation)
+SINGLE_ATTR_CLASS_DEF(AttrOrientation, Orientation, Orientation, orientation)
 
 
 constexpr const char *const kConferenceType_Broadcast = "broadcast";
@@ -104,38 +189,79 @@ constexpr const char *const kConferenceType_Moderated = "moderated";
 constexpr const char *const kConferenceType_Test = "test";
 constexpr const char *const kConferenceType_H332 = "H332";
 
-SINGLE_ATTR_CLASS_DEF(AttrConferenceType, std::string, conferenceType)
-SINGLE_ATTR_CLASS_DEF(AttrCharset, std::string, charset)
-SINGLE_ATTR_CLASS_DEF(AttrSdpLanguage, std::string, language)
-SINGLE_ATTR_CLASS_DEF(AttrMediaLanguage, std::string, language)
-SINGLE_ATTR_CLASS_DEF(AttrFramerate, double, framerate)
-SINGLE_ATTR_CLASS_DEF(AttrQuality, uint32_t, quality)
+SINGLE_ATTR_CLASS_DEF(AttrConferenceType, ConferenceType, Symbol, conferenceType)
+SINGLE_ATTR_CLASS_DEF(AttrCharset, Charset, Symbol, charset)
+SINGLE_ATTR_CLASS_DEF(AttrSdpLanguage, SdpLanguage, Symbol, language)
+SINGLE_ATTR_CLASS_DEF(AttrMediaLanguage, MediaLanguage, Symbol, language)
+SINGLE_ATTR_CLASS_DEF(AttrFramerate, Framerate, double, framerate)
+SINGLE_ATTR_CLASS_DEF(AttrQuality, Quality, uint32_t, quality)
 
 
 
 
 class AttrFormatParams : public Attribute {
 public:
+    static constexpr AttrId kId = AttrId::FormatParams;
+
+    AttrFormatParams() : Attribute(kId), mParsed(NULL) {}
+    AttrFormatParams(const AttrFormatParams& other);
+    AttrFormatParams& operator=(const AttrFormatParams& other);
     virtual ~AttrFormatParams();
 
     uint8_t payloadType = kPayloadType_NotSet;
     std::string formatParams;
 
-    virtual std::string key() const override;
+    /**
+     * formatParams split into sorted key/value pairs. Parsed on the first
+     * call and cached, so repeated lookups don't re-split the string; safe
+     * to call from several threads at once. The cache is checked against
+     * formatParams on each call and rebuilt if it changed; a map returned
+     * before the change stays valid until the attribute is destroyed.
+     */
+    const FormatParamMap& params() const;
+
+    /**
+     * The value of parameter key, decoded; NULL if there is no such
+     * parameter or it is malformed. Decoded on the first call for each key
+     * and cached with params(), so every caller, and every session sharing
+     * this attribute, gets the same buffer. Thread-safe, as params() is.
+     *
+     * For H.265 (RFC 7798) ask for sprop-vps, sprop-sps and sprop-pps as
+     * Base64.
+     */
+    sp<const BinaryParam> binaryParam(StringView key, BinaryEncoding encoding) const;
+
+    /// H.264 sprop-parameter-sets (RFC 6184): one unit per SPS or PPS NAL unit.
+    sp<const BinaryParam> spropParameterSets() const{ return binaryParam("sprop-parameter-sets", BinaryEncoding::Base64); }
+
+    /// MPEG4-GENERIC (RFC 3640) AudioSpecificConfig or MP4A-LATM (RFC 6416) StreamMuxConfig.
+    sp<const BinaryParam> config() const{ return binaryParam("config", BinaryEncoding::Hex); }
+
+    virtual StringView key() const override;
     virtual std::string value() const override;
+
+private:
+    struct Parsed;
+
+    Parsed& parsed() const;
+
+    mutable std::atomic<Parsed*> mParsed;
 };
 
 
 class AttrRtpMap : public Attribute {
 public:
+    static constexpr AttrId kId = AttrId::RtpMap;
+
+    AttrRtpMap() : Attribute(kId) {}
     virtual ~AttrRtpMap();
 
     uint8_t payloadType = kPayloadType_NotSet;
-    std::string encodingName;
+    Symbol encodingName;
     uint32_t clockRate = 0;
     uint32_t audioChannelCount = 0;
 
-    virtual std::string key() const override;
+    virtual StringView key() const override;
     virtual std::string value() const override;
 };
 
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_BINARY_H__
+#define __ZSDP_BINARY_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <zsdp/sdp.h>
+#include <zsdp/string-view.h>
+
+
+namespace zsdp {
+
+/**
+ * Binary SDP encoding, version 1. All integers are little-endian.
+ *
+ *   header          "ZSDB", u8 format version, 3 zero bytes,
+ *                   u32 stream count, u32 offset of the stream table
+ *   session record  v=, o=, s=, i=, u=, e=, p=, c=, b=, t=/r=, z=, k=, attributes
+ *   stream table    u32 offset of each stream record
+ *   stream records  m=, i=, c=, b=, k=, attributes
+ *
+ * Numbers are varints, strings are a varint length followed by the bytes,
+ * and enums are one byte. An attribute list is a varint count, a u32 offset
+ * per attribute and then the attributes, each a one-byte code for common
+ * keys (0 for a literal key) and its value. Offsets are from the start of
+ * the encoding, so a stream or attribute is reached without walking the
+ * ones before it.
+ */
+constexpr uint8_t kBinarySdpFormatVersion = 1;
+
+/// Appends the binary encoding of sdp to out.
+void encodeBinarySdp(const Sdp& sdp, std::string& out);
+
+
+/// An attribute inside a binary encoding.
+class BinaryAttributeView {
+public:
+    StringView key() const { return mKey; }
+    StringView value() const { return mValue; }
+    bool hasValue() const { return mHasValue; }
+
+    /// Decodes the attribute, as parseAttribute() would.
+    sp<Attribute> decode() const;
+
+private:
+    friend class BinaryAttributeList;
+
+    StringView mKey;
+    StringView mValue;
+    bool mHasValue = false;
+};
+
+class BinaryAttributeList {
+public:
+    size_t size() const { return mCount; }
+    bool empty() const { return mCount == 0; }
+    BinaryAttributeView operator[](size_t i) const;
+
+private:
+    friend class BinarySdpView;
+    friend class BinaryStreamView;
+
+    StringView mData;       /// the whole encoding
+    size_t mTableOffset = 0;
+    size_t mCount = 0;
+};
+
+struct BinaryConnectionData {
+    NetworkType networkType = NetworkType::NotSet;
+    AddressType addressType = AddressType::NotSet;
+    StringView host;
+    uint8_t multicastIPv4TTL = 0;
+    uint32_t multicastAddressCount = 0;
+};
+
+struct BinaryEncryption {
+    EncryptionType type = EncryptionType::NotSet;
+    StringView key;
+};
+
+/// An m-section inside a binary encoding. Scalar fields are read when the view is created; strings point into the encoding.
+class BinaryStreamView {
+public:
+    MediaType mediaType() const { return mMediaType; }
+    uint16_t port() const { return mPort; }
+    uint16_t portCount() const { return mPortCount; }
+    Protocol protocol() const { return mProtocol; }
+    size_t payloadTypeCount() const { return mPayloadTypes.size(); }
+    uint8_t payloadType(size_t i) const { return (uint8_t)mPayloadTypes[i]; }
+    StringView codec() const { return mCodec; }
+    StringView title() const { return mTitle; }
+    const BinaryConnectionData& connectionData() const { return mConnectionData; }
+    const Bandwidth& bandwidth() const { return mBandwidth; }
+    const BinaryEncryption& encryption() const { return mEncryption; }
+    const BinaryAttributeList& attributes() const { return mAttributes; }
+
+    Stream toStream() const;
+
+private:
+    friend class BinarySdpView;
+
+    MediaType mMediaType = MediaType::NotSet;
+    uint16_t mPort = 0;
+    uint16_t mPortCount = 0;
+    Protocol mProtocol = Protocol::NotSet;
+    StringView mPayloadTypes;
+    StringView mCodec;
+    StringView mTitle;
+    BinaryConnectionData mConnectionData;
+    Bandwidth mBandwidth;
+    BinaryEncryption mEncryption;
+    BinaryAttributeList mAttributes;
+};
+
+/**
+ * Reads a binary encoding in place, e.g. from an mmap'd file or shared
+ * memory. Nothing is copied; the buffer must outlive the view and every
+ * view or StringView taken from it. The header and session-level fields
+ * are checked on construction and streams when they are accessed; malformed
+ * or truncated input throws invalid_argument. The buffer needs no alignment.
+ */
+class BinarySdpView {
+public:
+    explicit BinarySdpView(StringView encoded);
+
+    uint8_t formatVersion() const { return (uint8_t)mData[4]; }
+
+    uint32_t version() const { return mVersion; }
+    StringView originUsername() const { return mOriginUsername; }
+    StringView originSessionID() const { return mOriginSessionID; }
+    StringView originSessionVersion() const { return mOriginSessionVersion; }
+    NetworkType originNetworkType() const { return mOriginNetworkType; }
+    AddressType originAddressType() const { return mOriginAddressType; }
+    StringView originHost() const { return mOriginHost; }
+    StringView sessionName() const { return mSessionName; }
+    StringView sessionInformation() const { return mSessionInformation; }
+    StringView uri() const { return mUri; }
+    StringView email() const { return mEmail; }
+    StringView phoneNumber() const { return mPhoneNumber; }
+    const BinaryConnectionData& connectionData() const { return mConnectionData; }
+    const Bandwidth& bandwidth() const { return mBandwidth; }
+    const BinaryEncryption& encryption() const { return mEncryption; }
+    const BinaryAttributeList& attributes() const { return mAttributes; }
+
+    /// Decoded on each call; t= and z= lines are rarely needed on a hot path.
+    std::vector<Timing> times() const;
+    std::vector<TimeZoneAdjustment> timeZoneAdjustments() const;
+
+    size_t streamCount() const { return mStreamCount; }
+    BinaryStreamView stream(size_t i) const;
+
+    Sdp toSdp() const;
+
+private:
+    StringView mData;
+    size_t mStreamCount;
+    size_t mStreamTableOffset;
+
+    uint32_t mVersion;
+    StringView mOriginUsername;
+    StringView mOriginSessionID;
+    StringView mOriginSessionVersion;
+    NetworkType mOriginNetworkType;
+    AddressType mOriginAddressType;
+    StringView mOriginHost;
+    StringView mSessionName;
+    StringView mSessionInformation;
+    StringView mUri;
+    StringView mEmail;
+    StringView mPhoneNumber;
+    BinaryConnectionData mConnectionData;
+    Bandwidth mBandwidth;
+    StringView mTimes;
+    StringView mTimeZones;
+    BinaryEncryption mEncryption;
+    BinaryAttributeList mAttributes;
+};
+
+} // namespace zsdp
+
+#endif // __ZSDP_BINARY_H__
@@ -0,0 +1,230 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_CAPABILITY_NEGOTIATION_H__
+#define __ZSDP_CAPABILITY_NEGOTIATION_H__
+
+#include <stdint.h>
+#include <string>
+#include <zsdp/sdp.h>
+#include <zsdp/small-vector.h>
+
+
+/*
+ * SDP Capability Negotiation (RFC 5939): capabilities are listed with
+ * a=acap (attribute capabilities) and a=tcap (transport protocol
+ * capabilities), an offer lists the potential configurations that may use
+ * them with a=pcfg, and an answer names the one it chose with a=acfg.
+ */
+namespace zsdp {
+
+/**
+ * Registers parsers for acap, tcap, pcfg and acfg with registerAttribute(),
+ * so parseSdp() decodes them into the classes below. Safe to call more
+ * than once. ConfigurationEnumerator works without it; it decodes
+ * undecoded lines itself.
+ */
+void registerCapabilityNegotiationAttributes();
+
+/// a=acap: an attribute that a potential configuration may add.
+class AttrCapability : public Attribute {
+public:
+    static constexpr AttrId kId = AttrId::Capability;
+
+    AttrCapability() : Attribute(kId) {}
+    virtual ~AttrCapability();
+
+    uint32_t number = 0;
+    sp<Attribute> attribute; /// Decoded with parseAttribute().
+
+    virtual StringView key() const override;
+    virtual std::string value() const override;
+};
+
+/// a=tcap: transport protocols, numbered consecutively from firstNumber.
+class AttrTransportCapability : public Attribute {
+public:
+    static constexpr AttrId kId = AttrId::TransportCapability;
+
+    AttrTransportCapability() : Attribute(kId) {}
+    virtual ~AttrTransportCapability();
+
+    uint32_t firstNumber = 0;
+    SmallVector<Symbol, 2> protocols;
+
+    virtual StringView key() const override;
+    virtual std::string value() const override;
+};
+
+/// The delete-attributes flags of a configuration ("a=-m:", "a=-s:", "a=-ms:").
+enum DeleteAttributes : uint8_t {
+    kDeleteAttributes_None = 0,
+    kDeleteAttributes_Media = 1,
+    kDeleteAttributes_Session = 2,
+};
+
+/// One alternative of a configuration's attribute list: "1,2,[3]" is mandatory 1 and 2, optional 3.
+struct AttributeCapabilityList {
+    SmallVector<uint32_t, 4> mandatory;
+    SmallVector<uint32_t, 2> optional;
+};
+
+/**
+ * a=pcfg: one potential configuration, "1 a=1,[2]|3 t=1|2". Alternatives
+ * separated by '|' are listed most preferred first. Extension lists other
+ * than a= and t= are kept as text; if one is mandatory (starts with '+'),
+ * the configuration can't be used, since none are understood.
+ */
+class AttrPotentialConfig : public Attribute {
+public:
+    static constexpr AttrId kId = AttrId::PotentialConfig;
+
+    AttrPotentialConfig() : Attribute(kId) {}
+    virtual ~AttrPotentialConfig();
+
+    uint32_t configNumber = 0; /// Lower numbers are preferred.
+    uint8_t deleteAttributes = kDeleteAttributes_None;
+    SmallVector<AttributeCapabilityList, 2> attributeLists; /// Empty if there is no a= list.
+    SmallVector<uint32_t, 2> transports;                    /// Empty if there is no t= list.
+    SmallVector<std::string, 1> extensions;
+
+    bool hasMandatoryExtension() const;
+
+    virtual StringView key() const override;
+    virtual std::string value() const override;
+};
+
+/// a=acfg: the configuration an answer (or the offerer's final offer) uses, "1 t=1 a=1,2".
+class AttrActualConfig : public Attribute {
+public:
+    static constexpr AttrId kId = AttrId::ActualConfig;
+
+    AttrActualConfig() : Attribute(kId) {}
+    virtual ~AttrActualConfig();
+
+    uint32_t configNumber = 0;
+    uint8_t deleteAttributes = kDeleteAttributes_None;
+    SmallVector<uint32_t, 4> attributes; /// The acap numbers used, optional ones included.
+    uint32_t transport = 0;              /// The tcap number used, 0 if none.
+    SmallVector<std::string, 1> extensions;
+
+    virtual StringView key() const override;
+    virtual std::string value() const override;
+};
+
+
+/**
+ * Which capabilities the local side supports, asked once per capability
+ * that a visited configuration refers to. By default every attribute is
+ * accepted, and every transport protocol the object model can represent.
+ */
+class CapabilityCheck {
+public:
+    virtual ~CapabilityCheck(){}
+
+    virtual bool acceptsTransport(Symbol protocolName, Protocol protocol) const{ return protocol != Protocol::NotSet; }
+    virtual bool acceptsAttribute(const Attribute& attribute) const{ return true; }
+};
+
+/// A configuration from ConfigurationEnumerator. Its pointers are valid while the enumerator and the Sdp are.
+struct PotentialConfiguration {
+    uint32_t configNumber = 0;
+    uint8_t deleteAttributes = kDeleteAttributes_None;
+
+    uint32_t transportNumber = 0;          /// The tcap number, or 0 if the m= line's protocol is kept.
+    Protocol protocol = Protocol::NotSet;  /// The tcap protocol, NotSet if transportNumber is 0.
+
+    /// The capabilities to add: the mandatory ones, then the optional ones the CapabilityCheck accepted.
+    SmallVector<const AttrCapability*, 4> attributes;
+
+    /// The a=acfg line that selects this configuration.
+    sp<AttrActualConfig> actualConfig() const;
+};
+
+/**
+ * Enumerates the potential configurations of one m-section, most preferred
+ * first: by configuration number, then by transport alternative, then by
+ * attribute alternative. Nothing is expanded up front; each call to next()
+ * builds one configuration. Alternatives that need a capability that is
+ * undefined or that the CapabilityCheck rejects are skipped, and a
+ * configuration is passed over whole as soon as either of its lists has no
+ * usable alternative, so the cross product of a rejected list is never
+ * visited.
+ *
+ * The Sdp and the CapabilityCheck must outlive the enumerator.
+ */
+class ConfigurationEnumerator {
+public:
+    ConfigurationEnumerator(const Sdp& sdp, size_t streamIndex);
+    ConfigurationEnumerator(const Sdp& sdp, size_t streamIndex, const CapabilityCheck& check);
+
+    /// Fills in configuration and returns true, or returns false when there are no more.
+    bool next(PotentialConfiguration& configuration);
+
+    /// Starts over from the most preferred configuration.
+    void reset();
+
+private:
+    struct AttributeCap {
+        uint32_t number;
+        const AttrCapability* capability;
+        mutable int8_t accepted; /// -1 until asked.
+    };
+
+    struct TransportCap {
+        uint32_t number;
+        Symbol name;
+        Protocol protocol;
+        mutable int8_t accepted;
+    };
+
+    static constexpr uint16_t kNoList = UINT16_MAX;
+
+    void collect(const AttributeList& attributes, bool mediaLevel);
+    const AttributeCap* attributeCap(uint32_t number) const;
+    const TransportCap* transportCap(uint32_t number) const;
+    bool usable(const AttributeCap* cap) const;
+    bool usable(const TransportCap* cap) const;
+    void enter(const AttrPotentialConfig& config);
+
+    const CapabilityCheck& mCheck;
+    SmallVector<AttributeCap, 8> mAttributeCaps;       /// Sorted by number.
+    SmallVector<TransportCap, 4> mTransportCaps;       /// Sorted by number.
+    SmallVector<const AttrPotentialConfig*, 4> mConfigs; /// Sorted by configNumber.
+    SmallVector<sp<Attribute>, 4> mDecoded;             /// Lines decoded here because they weren't registered.
+
+    size_t mConfig;
+    bool mEntered;
+    SmallVector<uint16_t, 4> mUsableLists;      /// Indices into attributeLists, or kNoList.
+    SmallVector<uint16_t, 4> mUsableTransports; /// Indices into transports, or kNoList.
+    size_t mList;
+    size_t mTransport;
+};
+
+/**
+ * stream with configuration applied: the transport protocol replaced, the
+ * media-level attributes removed if it deletes them, its capabilities
+ * added, and the capability negotiation attributes dropped. Deleting
+ * session-level attributes is left to the caller.
+ */
+Stream applyConfiguration(const Stream& stream, const PotentialConfiguration& configuration);
+
+} // namespace zsdp
+
+#endif // __ZSDP_CAPABILITY_NEGOTIATION_H__
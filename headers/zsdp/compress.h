@@ -0,0 +1,51 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_COMPRESS_H__
+#define __ZSDP_COMPRESS_H__
+
+#include <stdint.h>
+#include <string>
+#include <zsdp/string-view.h>
+
+
+namespace zsdp {
+
+/**
+ * Compression tuned for SDP text. It is an LZ77 coder whose window starts
+ * with a built-in dictionary of common SDP lines and tokens ("IN IP4",
+ * "a=rtpmap:", codec names, WebRTC attributes, ...), in the spirit of the
+ * RFC 3485 SIP/SDP static dictionary. Even a short offer can then be coded
+ * mostly as references, where a generic compressor would first have to
+ * see each string once. Works on any bytes, not only valid SDP.
+ *
+ * The output starts with a format byte that also identifies the
+ * dictionary, so stored data stays readable when either changes.
+ */
+constexpr uint8_t kSdpCompressionFormat = 1;
+
+/// Appends the compressed form of sdp to out.
+void compressSdp(StringView sdp, std::string& out);
+
+/// Appends the decompressed text to out. Throws invalid_argument on corrupt input or an unknown format byte.
+void decompressSdp(StringView compressed, std::string& out);
+
+} // namespace zsdp
+
+#endif // __ZSDP_COMPRESS_H__
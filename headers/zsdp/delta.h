@@ -0,0 +1,57 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_DELTA_H__
+#define __ZSDP_DELTA_H__
+
+#include <stdint.h>
+#include <string>
+#include <zsdp/sdp.h>
+#include <zsdp/string-view.h>
+
+
+namespace zsdp {
+
+/**
+ * Binary delta between two versions of a session, e.g. before and after a
+ * re-offer that bumped sessionVersion. Only the session fields that differ
+ * are written. Streams are matched by position: an unchanged stream costs
+ * one byte, and a changed one carries only its changed fields. Attribute
+ * lists are written as runs of base attribute indexes plus the new lines.
+ *
+ * The delta does not identify its base: it must be applied to the same
+ * Sdp it was encoded against.
+ */
+constexpr uint8_t kSdpDeltaFormat = 1;
+
+/// Appends to out the delta that turns base into next.
+void encodeDelta(const Sdp& base, const Sdp& next, std::string& out);
+std::string encodeDelta(const Sdp& base, const Sdp& next);
+
+/**
+ * Rebuilds next from base and a delta from encodeDelta(). Attributes that
+ * were not changed are shared with base rather than reparsed. Throws
+ * invalid_argument if the delta is malformed or refers past the end of
+ * base's streams or attributes.
+ */
+Sdp applyDelta(const Sdp& base, StringView delta);
+
+} // namespace zsdp
+
+#endif // __ZSDP_DELTA_H__
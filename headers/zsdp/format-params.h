@@ -0,0 +1,161 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_FORMAT_PARAMS_H__
+#define __ZSDP_FORMAT_PARAMS_H__
+
+#include <stdint.h>
+#include <vector>
+#include <zsdp/defs.h>
+#include <zsdp/small-vector.h>
+#include <zsdp/string-view.h>
+
+
+namespace zsdp {
+
+struct FormatParam {
+    StringView key;
+    StringView value;
+};
+
+/**
+ * The parameters of an fmtp line ("profile-level-id=42e01f;packetization-mode=1")
+ * as a flat array of key/value views, sorted by key (case-insensitively,
+ * as parameter names are compared) so lookups are a binary search.
+ *
+ * The views point into the string the map was built from. A parameter
+ * without '=' (telephone-event's "0-15") is kept as a key with an empty
+ * value. When a key repeats, the first one wins.
+ */
+class FormatParamMap {
+public:
+    typedef SmallVector<FormatParam, 8> List;
+
+    FormatParamMap() {}
+    explicit FormatParamMap(StringView formatParams);
+
+    List::const_iterator begin() const{ return mParams.begin(); }
+    List::const_iterator end() const{ return mParams.end(); }
+    size_t size() const{ return mParams.size(); }
+    bool empty() const{ return mParams.empty(); }
+
+    /// The parameter with this key, or NULL.
+    const FormatParam* find(StringView key) const;
+
+    bool has(StringView key) const{ return find(key) != NULL; }
+
+    /// The value for key, or fallback if there is no such parameter.
+    StringView get(StringView key, StringView fallback = StringView()) const;
+
+    /// Each returns false, leaving value unchanged, if key is missing or its value doesn't parse.
+    bool getInt(StringView key, int64_t* value) const;
+    bool getHex(StringView key, uint64_t* value) const;
+    bool getBool(StringView key, bool* value) const; /// 1/0, as in RFC 7587, or true/false.
+
+    /// getInt(), or fallback.
+    int64_t intOr(StringView key, int64_t fallback) const;
+    bool boolOr(StringView key, bool fallback) const;
+
+private:
+    List mParams;
+};
+
+
+/// H.264 parameters (RFC 6184 section 8.1), with the defaults it gives for missing ones.
+struct H264Params {
+    uint8_t profileIdc = 0x42; /// Constrained Baseline/Baseline unless profile-level-id says otherwise.
+    uint8_t profileIop = 0x00;
+    uint8_t levelIdc = 0x0a;   /// Level 1.
+    uint8_t packetizationMode = 0;
+    bool levelAsymmetryAllowed = false;
+
+    /**
+     * True when both describe the same H.264 profile and packetization
+     * mode, which RFC 6184 requires for the two to be the same codec;
+     * the level may differ.
+     */
+    bool sameCodec(const H264Params& other) const{
+        return profileIdc == other.profileIdc && profileIop == other.profileIop && packetizationMode == other.packetizationMode;
+    }
+};
+
+/// Returns false if profile-level-id is present but isn't six hex digits.
+bool parseH264Params(const FormatParamMap& params, H264Params* h264);
+
+/// Opus parameters (RFC 7587 section 6.1), with its defaults.
+struct OpusParams {
+    uint32_t maxPlaybackRate = 48000;
+    uint32_t spropMaxCaptureRate = 48000;
+    uint32_t maxAverageBitrate = 0; /// 0 when not given.
+    uint32_t minPTime = 0;          /// minptime, 0 when not given. Not in RFC 7587, but sent by WebRTC endpoints.
+    bool stereo = false;
+    bool spropStereo = false;
+    bool cbr = false;
+    bool useInbandFec = false;
+    bool useDtx = false;
+};
+
+OpusParams parseOpusParams(const FormatParamMap& params);
+
+/// VP9 profile-id (draft-ietf-payload-vp9), 0 when not given. Returns -1 if it doesn't parse.
+int parseVp9ProfileId(const FormatParamMap& params);
+
+
+enum class BinaryEncoding {
+    Base64, /// RFC 4648 section 4, as in sprop-parameter-sets.
+    Hex,    /// As in MPEG4-GENERIC and MP4A-LATM config.
+};
+
+/**
+ * Appends the decoded bytes of in to out. Base64 padding is optional;
+ * whitespace is not allowed. Returns false if in is malformed, leaving
+ * out with whatever was decoded before the error.
+ */
+bool decodeBase64(StringView in, std::vector<uint8_t>& out);
+bool decodeHex(StringView in, std::vector<uint8_t>& out);
+
+/**
+ * A binary fmtp value, decoded. Values that are comma-separated lists of
+ * blobs (sprop-parameter-sets lists one NAL unit per entry) are decoded
+ * into one buffer, with each entry a unit of it.
+ */
+class BinaryParam {
+public:
+    struct Unit {
+        const uint8_t* data;
+        size_t size;
+    };
+
+    /// Returns NULL if value is malformed.
+    static sp<const BinaryParam> decode(StringView value, BinaryEncoding encoding);
+
+    /// Every unit, back to back.
+    const std::vector<uint8_t>& bytes() const{ return mBytes; }
+
+    size_t unitCount() const{ return mEnds.size(); }
+    Unit unit(size_t i) const;
+
+private:
+    std::vector<uint8_t> mBytes;
+    SmallVector<uint32_t, 4> mEnds;
+};
+
+} // namespace zsdp
+
+#endif // __ZSDP_FORMAT_PARAMS_H__
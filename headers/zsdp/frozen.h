@@ -0,0 +1,146 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_FROZEN_H__
+#define __ZSDP_FROZEN_H__
+
+#include <stdint.h>
+#include <zsdp/sdp.h>
+#include <zsdp/string-view.h>
+
+
+namespace zsdp {
+
+class FrozenSdp;
+struct FrozenStreamRecord;
+
+struct FrozenConnectionData {
+    NetworkType networkType;
+    AddressType addressType;
+    StringView host;
+    uint8_t multicastIPv4TTL;
+    uint32_t multicastAddressCount;
+};
+
+struct FrozenEncryption {
+    EncryptionType type;
+    StringView key;
+};
+
+/// An a= line: key, and the value after ':' when there is one.
+struct FrozenAttribute {
+    StringView key;
+    StringView value;
+    bool hasValue;
+
+    /// Decodes the attribute, as parseAttribute() would.
+    sp<Attribute> decode() const;
+};
+
+/// An m-section of a FrozenSdp. Only valid while the FrozenSdp is.
+class FrozenStream {
+public:
+    MediaType mediaType() const;
+    uint16_t port() const;
+    uint16_t portCount() const;
+    Protocol protocol() const;
+    size_t payloadTypeCount() const;
+    uint8_t payloadType(size_t i) const;
+    StringView codec() const;
+    StringView title() const;
+    FrozenConnectionData connectionData() const;
+    Bandwidth bandwidth() const;
+    FrozenEncryption encryption() const;
+    size_t attributeCount() const;
+    FrozenAttribute attribute(size_t i) const;
+
+    Stream toStream() const;
+
+private:
+    friend class FrozenSdp;
+    FrozenStream(const FrozenSdp* sdp, const FrozenStreamRecord* record) : mSdp(sdp), mRecord(record) {}
+
+    const FrozenSdp* mSdp;
+    const FrozenStreamRecord* mRecord;
+};
+
+/**
+ * A read-only copy of an Sdp for long-lived storage. Everything lives in
+ * one heap block: fixed-size records for the session, streams, attributes
+ * and times with one-byte enums, followed by a pool holding each distinct
+ * string once. Accessors return views into that block.
+ *
+ * An Sdp spends most of its memory on per-object overhead (a std::string,
+ * vector or shared_ptr control block per field), so a FrozenSdp is
+ * typically several times smaller. Move-only; share it through sp<> if
+ * several owners need it.
+ */
+class FrozenSdp {
+public:
+    explicit FrozenSdp(const Sdp& sdp);
+    FrozenSdp(FrozenSdp&& other) noexcept;
+    FrozenSdp& operator=(FrozenSdp&& other) noexcept;
+    FrozenSdp(const FrozenSdp&) = delete;
+    FrozenSdp& operator=(const FrozenSdp&) = delete;
+    ~FrozenSdp();
+
+    uint32_t version() const;
+    StringView originUsername() const;
+    StringView originSessionID() const;
+    StringView originSessionVersion() const;
+    NetworkType originNetworkType() const;
+    AddressType originAddressType() const;
+    StringView originHost() const;
+    StringView sessionName() const;
+    StringView sessionInformation() const;
+    StringView uri() const;
+    StringView email() const;
+    StringView phoneNumber() const;
+    FrozenConnectionData connectionData() const;
+    Bandwidth bandwidth() const;
+    FrozenEncryption encryption() const;
+
+    size_t attributeCount() const;
+    FrozenAttribute attribute(size_t i) const;
+
+    size_t streamCount() const;
+    FrozenStream stream(size_t i) const;
+
+    /// These allocate; t=, r= and z= lines are rarely needed after freezing.
+    std::vector<Timing> times() const;
+    std::vector<TimeZoneAdjustment> timeZoneAdjustments() const;
+
+    Sdp toSdp() const;
+
+    /// Bytes used: this object plus its block (allocator bookkeeping not included).
+    size_t memoryUsage() const;
+
+private:
+    friend class FrozenStream;
+    struct Layout;
+
+    const Layout& layout() const { return *(const Layout*)mBlock; }
+
+    char* mBlock;
+    size_t mBlockSize;
+};
+
+} // namespace zsdp
+
+#endif // __ZSDP_FROZEN_H__
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_INTERN_H__
+#define __ZSDP_INTERN_H__
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <zsdp/sdp.h>
+#include <zsdp/string-view.h>
+
+
+namespace zsdp {
+
+struct InternStats {
+    size_t attributeLookups = 0;
+    size_t distinctAttributes = 0;
+    size_t streamLookups = 0;
+    size_t distinctStreams = 0;
+
+    /// Lookups per distinct instance; 1.0 means nothing was shared.
+    double attributeDedupRatio() const;
+    double streamDedupRatio() const;
+};
+
+/**
+ * Hash-consing pool for attributes and m-sections that repeat across
+ * sessions, e.g. the same rtpmap, fmtp and extmap lines in every call an
+ * SFU handles. Set ParseOptions::internPool and parseSdp() takes each a=
+ * line's Attribute from the pool, so identical lines in any number of
+ * Sdps share one instance.
+ *
+ * Interned instances are shared: treat them as immutable. To change an
+ * attribute of a parsed Sdp, replace its sp<Attribute> rather than
+ * modifying it. Thread-safe.
+ *
+ * Entries live until prune() or clear(), so a long-running process should
+ * prune() periodically once old sessions are released.
+ */
+class InternPool {
+public:
+    /// The shared instance for an a= line (without "a="), decoded as parseSdp() would.
+    sp<Attribute> attribute(StringView line, bool decode = true);
+
+    /// The shared instance equal to attr, which becomes the shared instance if it is new.
+    sp<Attribute> intern(const sp<Attribute>& attr);
+
+    /**
+     * The shared instance of an m-section with the same lines as stream.
+     * Sdp holds its streams by value, so this is for tables that keep
+     * m-sections on their own; the stream's attributes are interned too.
+     */
+    sp<const Stream> intern(const Stream& stream);
+
+    /// Drops entries that nothing outside the pool refers to. Returns how many were dropped.
+    size_t prune();
+    void clear();
+
+    size_t attributeCount() const;
+    size_t streamCount() const;
+    InternStats stats() const;
+
+private:
+    sp<Attribute> findOrAdd(bool decode, StringView line, const sp<Attribute>& candidate);
+
+    mutable std::mutex mMutex;
+    std::string mKey;
+    std::unordered_map<std::string, sp<Attribute>> mAttributes;
+    std::unordered_map<std::string, sp<const Stream>> mStreams;
+    InternStats mStats;
+};
+
+} // namespace zsdp
+
+#endif // __ZSDP_INTERN_H__
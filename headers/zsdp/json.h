@@ -0,0 +1,43 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_JSON_H__
+#define __ZSDP_JSON_H__
+
+#include <string>
+#include <zsdp/sdp.h>
+#include <zsdp/string-view.h>
+
+
+namespace zsdp {
+
+/**
+ * Appends the JSON form of sdp to out. Field names follow sdp.h ("origin",
+ * "connectionData", "streams", ...). Empty strings and unset optional
+ * fields are left out. rtpmap, fmtp and direction attributes are written
+ * with typed fields; every other attribute is {"key": ..., "value": ...}.
+ */
+void sdpToJson(const Sdp& sdp, std::string& out);
+
+/// Builds an Sdp from the output of sdpToJson(). Unknown fields are ignored. Throws invalid_argument on malformed input.
+Sdp sdpFromJson(StringView json);
+
+} // namespace zsdp
+
+#endif // __ZSDP_JSON_H__
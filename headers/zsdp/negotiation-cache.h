@@ -0,0 +1,96 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_NEGOTIATION_CACHE_H__
+#define __ZSDP_NEGOTIATION_CACHE_H__
+
+#include <mutex>
+#include <unordered_map>
+#include <zsdp/negotiator.h>
+
+
+namespace zsdp {
+
+/**
+ * A 64-bit hash of the parts of offer that negotiation depends on: the
+ * number of m-sections and, for each, its media type, protocol, whether
+ * it is rejected (port 0), its format list, and its rtpmap, fmtp and
+ * direction attributes, plus the session-level direction. Addresses,
+ * ports, o= and t= lines and all other attributes are left out, so
+ * offers that differ only in those have the same fingerprint.
+ */
+uint64_t negotiationFingerprint(const Sdp& offer);
+
+struct NegotiationCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t entries = 0;
+
+    double hitRatio() const;
+};
+
+/**
+ * Memoizes Negotiator::answer() by (negotiationFingerprint(offer),
+ * Negotiator::profileId()). An entry is the answer's skeleton: everything
+ * but the t= line, which is copied from each offer, and the addresses and
+ * ports, which come from the Negotiator or an AnswerTransport. A hit costs
+ * the fingerprint and a copy of the skeleton, with no codec matching.
+ *
+ * Skeletons share their attributes with every answer built from them:
+ * treat those as immutable, as with InternPool.
+ *
+ * The cache is emptied when it reaches capacity. Thread-safe.
+ */
+class NegotiationCache {
+public:
+    explicit NegotiationCache(size_t capacity = 1024);
+
+    /// Equivalent to negotiator.answer(offer).
+    Sdp answer(const Negotiator& negotiator, const Sdp& offer);
+
+    /// Equivalent to negotiator.answer(offer, transport).
+    Sdp answer(const Negotiator& negotiator, const Sdp& offer, const AnswerTransport& transport);
+
+    void clear();
+    size_t size() const;
+    NegotiationCacheStats stats() const;
+
+private:
+    struct Key {
+        uint64_t fingerprint;
+        uint64_t profileId;
+
+        bool operator==(const Key& other) const{ return fingerprint == other.fingerprint && profileId == other.profileId; }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const{ return (size_t)(key.fingerprint ^ (key.profileId * 0x9e3779b97f4a7c15ULL)); }
+    };
+
+    sp<const Sdp> skeleton(const Negotiator& negotiator, const Sdp& offer);
+
+    size_t mCapacity;
+    mutable std::mutex mMutex;
+    std::unordered_map<Key, sp<const Sdp>, KeyHash> mEntries;
+    NegotiationCacheStats mStats;
+};
+
+} // namespace zsdp
+
+#endif // __ZSDP_NEGOTIATION_CACHE_H__
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_NEGOTIATOR_H__
+#define __ZSDP_NEGOTIATOR_H__
+
+#include <vector>
+#include <zsdp/format-params.h>
+#include <zsdp/sdp.h>
+
+
+namespace zsdp {
+
+/// A codec the local side supports, described as an rtpmap line describes it.
+struct LocalCodec {
+    MediaType mediaType = MediaType::NotSet;
+    Symbol encodingName; /// Matched case-insensitively.
+    uint32_t clockRate = 0;
+    uint32_t channels = 1; /// As AttrRtpMap::audioChannelCount, which is 1 when an rtpmap leaves it out.
+    std::string formatParams; /// Sent as a=fmtp in answers when not empty.
+};
+
+struct LocalCapabilities {
+    std::vector<LocalCodec> codecs;
+
+    /// o= of the answer.
+    Origin origin;
+
+    /// c= of the answer, at session level and in every m-section.
+    ConnectionData connectionData;
+
+    std::string sessionName = "-";
+
+    /// What the local side is willing to do; the answer never exceeds it.
+    MediaDirection direction = MediaDirection::SendRecv;
+
+    /// The answer's m-section i gets port firstPort + i * portSpacing.
+    uint16_t firstPort = 9;
+    uint16_t portSpacing = 2;
+};
+
+/// The per-call parts of an answer, for answering many calls with one Negotiator.
+struct AnswerTransport {
+    Origin origin;
+    ConnectionData connectionData;
+    uint16_t firstPort = 9;
+    uint16_t portSpacing = 2;
+};
+
+/// Sets answer's o= and c= lines, and the port of each m-section that is not rejected (port 0).
+void applyTransport(Sdp& answer, const AnswerTransport& transport);
+
+/**
+ * Generates RFC 3264 answers to remote offers from a fixed set of local
+ * capabilities. The constructor compiles the local codecs into per-media
+ * type lookup tables: a sorted array keyed by a case-insensitive hash of
+ * the encoding name for rtpmap'd payload types, and a 128-entry table for
+ * the static payload types offers use without an rtpmap. answer() then
+ * matches each offered payload type with one table probe.
+ *
+ * For each offered m-section, the answer:
+ *  - keeps the offered payload types that match a local codec by
+ *    encoding name, clock rate and channels, in the offer's order and
+ *    with the offer's payload type numbers (RFC 3264 section 6.1);
+ *    H.264 must also have the same profile and packetization mode
+ *    (RFC 6184 section 8.2.2),
+ *  - inverts the offered direction (sendonly becomes recvonly) and
+ *    limits it to LocalCapabilities::direction,
+ *  - rejects the m-section with port 0 when the offer did, when its
+ *    protocol is not RTP/AVP or RTP/SAVP, or when no codec matches.
+ *
+ * The answer's direction attributes are shared by every answer from the
+ * same Negotiator: treat them as immutable, as with InternPool.
+ *
+ * A Negotiator is immutable once built, so any number of threads can use one.
+ */
+class Negotiator {
+public:
+    explicit Negotiator(const LocalCapabilities& local);
+
+    Sdp answer(const Sdp& offer) const;
+
+    /// answer(offer) with the addresses and ports of transport instead of those in local().
+    Sdp answer(const Sdp& offer, const AnswerTransport& transport) const;
+
+    /// The local codec that offered payload type pt of stream matches, or NULL.
+    const LocalCodec* match(const Stream& stream, uint8_t pt) const;
+
+    const LocalCapabilities& local() const{ return mLocal; }
+
+    /// Unique to this Negotiator within the process, unlike its address. Keys NegotiationCache entries.
+    uint64_t profileId() const{ return mProfileId; }
+
+private:
+    static constexpr size_t kMediaTypeCount = (size_t)MediaType::Message + 1;
+    static constexpr uint8_t kNoCodec = 255;
+
+    struct CompiledCodec {
+        uint32_t nameHash;
+        uint32_t clockRate;
+        uint32_t channels;
+        uint8_t codec; /// Index into mLocal.codecs.
+        bool isH264;
+    };
+
+    /// Index into mLocal.codecs, or kNoCodec.
+    uint8_t lookup(const Stream& stream, const AttrRtpMap& rtpMap) const;
+
+    /// Fills codecFor[pt] for each offered payload type of stream.
+    void matchAll(const Stream& stream, uint8_t codecFor[kMaxPayloadType + 1]) const;
+
+    void answerStream(const Stream& offered, MediaDirection offeredDirection, size_t index, Stream& answer) const;
+
+    LocalCapabilities mLocal;
+    uint64_t mProfileId;
+
+    /// Sorted by nameHash.
+    std::vector<CompiledCodec> mCompiled[kMediaTypeCount];
+
+    /// The parsed fmtp of each local codec, for those that are H.264.
+    std::vector<H264Params> mH264;
+
+    /// The local codec each static payload type stands for.
+    uint8_t mStatic[kMediaTypeCount][kMaxPayloadType + 1];
+
+    sp<Attribute> mDirections[4];
+};
+
+} // namespace zsdp
+
+#endif // __ZSDP_NEGOTIATOR_H__
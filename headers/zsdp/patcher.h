@@ -0,0 +1,92 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_PATCHER_H__
+#define __ZSDP_PATCHER_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <zsdp/sdp.h>
+#include <zsdp/string-view.h>
+
+
+namespace zsdp {
+
+/**
+ * Rewrites the o= address, c= addresses and m= ports of raw SDP text without
+ * parsing it into an Sdp. Configure the replacements once, then call apply()
+ * for each message; everything that is not patched is copied through as-is.
+ */
+class SdpPatcher {
+public:
+    /// Replaces the unicast address (and address type) of the o= line.
+    void setOriginAddress(const std::string& host, AddressType addressType = AddressType::IP4);
+
+    /// Replaces the address of every c= line that has no more specific replacement.
+    void setConnectionAddress(const std::string& host, AddressType addressType = AddressType::IP4);
+
+    /// Replaces the address of the session-level c= line.
+    void setSessionConnectionAddress(const std::string& host, AddressType addressType = AddressType::IP4);
+
+    /// Replaces the address of the c= line(s) in the streamIndex'th m-section.
+    void setMediaConnectionAddress(size_t streamIndex,
+                                   const std::string& host,
+                                   AddressType addressType = AddressType::IP4);
+
+    /// Replaces the port of the streamIndex'th m= line. A "/<count>" suffix is kept.
+    void setMediaPort(size_t streamIndex, uint16_t port);
+
+    /// Removes all replacements.
+    void clear();
+
+    /**
+     * Writes the patched SDP to out, replacing its contents. Fields that are
+     * missing or malformed in the input are left alone.
+     *
+     * @return The number of fields that were replaced.
+     */
+    size_t apply(StringView sdp, std::string& out) const;
+
+private:
+    struct AddressPatch {
+        bool set = false;
+        std::string replacement; /// "<addrtype> <host>"
+
+        void assign(const std::string& host, AddressType addressType);
+    };
+
+    struct StreamPatch {
+        AddressPatch connection;
+        bool hasPort = false;
+        uint8_t portSize = 0;
+        char port[5];
+    };
+
+    StreamPatch& streamPatch(size_t streamIndex);
+
+    AddressPatch mOrigin;
+    AddressPatch mConnection;
+    AddressPatch mSessionConnection;
+    std::vector<StreamPatch> mStreams;
+};
+
+} // namespace zsdp
+
+#endif // __ZSDP_PATCHER_H__
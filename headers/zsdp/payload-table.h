@@ -0,0 +1,92 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_PAYLOAD_TABLE_H__
+#define __ZSDP_PAYLOAD_TABLE_H__
+
+#include <zsdp/sdp.h>
+
+
+namespace zsdp {
+
+/// a=rtcp-fb types, as bits of PayloadInfo::rtcpFeedback.
+enum RtcpFeedback : uint8_t {
+    kRtcpFeedback_Nack        = 1 << 0, /// nack
+    kRtcpFeedback_Pli         = 1 << 1, /// nack pli
+    kRtcpFeedback_Fir         = 1 << 2, /// ccm fir
+    kRtcpFeedback_Remb        = 1 << 3, /// goog-remb
+    kRtcpFeedback_TransportCc = 1 << 4, /// transport-cc
+    kRtcpFeedback_Other       = 1 << 7, /// Any other type.
+};
+
+struct PayloadInfo {
+    /// False for payload types the m= line doesn't list; the other fields are then empty.
+    bool defined = false;
+
+    /// True when the values come from the RFC 3551 static assignment rather than an a=rtpmap.
+    bool isStatic = false;
+
+    /// RtcpFeedback bits, from a=rtcp-fb lines for this payload type or for "*".
+    uint8_t rtcpFeedback = 0;
+
+    Symbol encodingName;
+    uint32_t clockRate = 0;
+    uint32_t channels = 0; /// As AttrRtpMap::audioChannelCount; 0 for static video payload types.
+    std::string formatParams;
+};
+
+/**
+ * What a Stream says about each RTP payload type, laid out densely by
+ * payload type so the media path can look one up per packet with a
+ * single indexed load instead of walking Stream::attributes.
+ *
+ * Built once per negotiated Stream; it copies what it needs and does
+ * not refer to the Stream afterwards.
+ */
+class PayloadTable {
+public:
+    PayloadTable() {}
+    explicit PayloadTable(const Stream& stream);
+
+    /// Entry for pt. pt is masked to 7 bits, as it is in the RTP header.
+    const PayloadInfo& operator[](uint8_t pt) const{ return mEntries[pt & kMaxPayloadType]; }
+
+    /// The entry for pt, or NULL if the stream doesn't list it.
+    const PayloadInfo* find(uint8_t pt) const{
+        const PayloadInfo& info = (*this)[pt];
+        return pt <= kMaxPayloadType && info.defined ? &info : NULL;
+    }
+
+    /// Number of defined entries.
+    size_t size() const{ return mSize; }
+
+    /**
+     * The RFC 3551 static assignment for pt, with defined set, or an
+     * entry with defined clear for dynamic and unassigned payload types.
+     */
+    static const PayloadInfo& staticPayloadType(uint8_t pt);
+
+private:
+    PayloadInfo mEntries[kMaxPayloadType + 1];
+    size_t mSize = 0;
+};
+
+} // namespace zsdp
+
+#endif // __ZSDP_PAYLOAD_TABLE_H__
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_PAYLOAD_TYPE_SET_H__
+#define __ZSDP_PAYLOAD_TYPE_SET_H__
+
+#include <initializer_list>
+#include <stddef.h>
+#include <stdint.h>
+#include <zsdp/defs.h>
+
+
+namespace zsdp {
+
+/**
+ * A set of RTP payload types (0-127) as a 128-bit mask. Intersection,
+ * union and difference are two 64-bit operations each, so comparing
+ * what two parties support costs the same however many codecs they list.
+ *
+ * Values outside 0-127 are never members; inserting one does nothing.
+ */
+class PayloadTypeSet {
+public:
+    PayloadTypeSet() : mBits{ 0, 0 } {}
+
+    PayloadTypeSet(std::initializer_list<uint8_t> payloadTypes) : PayloadTypeSet(){
+        for(uint8_t pt : payloadTypes)
+            insert(pt);
+    }
+
+    /// The payload types in a PayloadTypeList or any other range of integers.
+    template<typename Range>
+    static PayloadTypeSet of(const Range& payloadTypes){
+        PayloadTypeSet set;
+        for(auto pt : payloadTypes)
+            set.insert(pt);
+
+        return set;
+    }
+
+    bool contains(int pt) const{
+        return pt >= 0 && pt <= kMaxPayloadType && (mBits[pt >> 6] & bit(pt)) != 0;
+    }
+
+    void insert(int pt){
+        if(pt >= 0 && pt <= kMaxPayloadType)
+            mBits[pt >> 6] |= bit(pt);
+    }
+
+    void erase(int pt){
+        if(pt >= 0 && pt <= kMaxPayloadType)
+            mBits[pt >> 6] &= ~bit(pt);
+    }
+
+    void clear(){ mBits[0] = mBits[1] = 0; }
+
+    bool empty() const{ return (mBits[0] | mBits[1]) == 0; }
+    size_t size() const{ return popcount(mBits[0]) + popcount(mBits[1]); }
+
+    /// The lowest member, or kPayloadType_NotSet when empty.
+    uint8_t first() const{
+        if(mBits[0] != 0)
+            return lowestBit(mBits[0]);
+
+        return mBits[1] != 0 ? 64 + lowestBit(mBits[1]) : kPayloadType_NotSet;
+    }
+
+    bool intersects(const PayloadTypeSet& other) const{ return !(*this & other).empty(); }
+    bool isSubsetOf(const PayloadTypeSet& other) const{ return (*this - other).empty(); }
+
+    /// Calls fnc(uint8_t) for each member in ascending order.
+    template<typename Fnc>
+    void forEach(Fnc fnc) const{
+        for(size_t word = 0; word < 2; word++){
+            for(uint64_t bits = mBits[word]; bits != 0; bits &= bits - 1)
+                fnc((uint8_t)(word * 64 + lowestBit(bits)));
+        }
+    }
+
+    PayloadTypeSet& operator&=(const PayloadTypeSet& other){
+        mBits[0] &= other.mBits[0];
+        mBits[1] &= other.mBits[1];
+        return *this;
+    }
+
+    PayloadTypeSet& operator|=(const PayloadTypeSet& other){
+        mBits[0] |= other.mBits[0];
+        mBits[1] |= other.mBits[1];
+        return *this;
+    }
+
+    /// Removes other's members.
+    PayloadTypeSet& operator-=(const PayloadTypeSet& other){
+        mBits[0] &= ~other.mBits[0];
+        mBits[1] &= ~other.mBits[1];
+        return *this;
+    }
+
+    friend PayloadTypeSet operator&(PayloadTypeSet a, const PayloadTypeSet& b){ return a &= b; }
+    friend PayloadTypeSet operator|(PayloadTypeSet a, const PayloadTypeSet& b){ return a |= b; }
+    friend PayloadTypeSet operator-(PayloadTypeSet a, const PayloadTypeSet& b){ return a -= b; }
+
+    friend bool operator==(const PayloadTypeSet& a, const PayloadTypeSet& b){
+        return a.mBits[0] == b.mBits[0] && a.mBits[1] == b.mBits[1];
+    }
+
+    friend bool operator!=(const PayloadTypeSet& a, const PayloadTypeSet& b){ return !(a == b); }
+
+    /// Bits 0-63 hold payload types 0-63; bits 64-127 hold 64-127.
+    uint64_t word(size_t i) const{ return mBits[i]; }
+
+private:
+    static uint64_t bit(int pt){ return 1ULL << (pt & 63); }
+
+    static size_t popcount(uint64_t bits){
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(bits);
+#else
+        size_t count = 0;
+        for(; bits != 0; bits &= bits - 1)
+            count++;
+
+        return count;
+#endif
+    }
+
+    /// Index of the lowest set bit. bits must be non-zero.
+    static uint8_t lowestBit(uint64_t bits){
+#if defined(__GNUC__) || defined(__clang__)
+        return (uint8_t)__builtin_ctzll(bits);
+#else
+        uint8_t i = 0;
+        for(; (bits & 1) == 0; bits >>= 1)
+            i++;
+
+        return i;
+#endif
+    }
+
+    uint64_t mBits[2];
+};
+
+} // namespace zsdp
+
+#endif // __ZSDP_PAYLOAD_TYPE_SET_H__
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_PIPELINE_H__
+#define __ZSDP_PIPELINE_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <zsdp/attributes.h>
+#include <zsdp/defs.h>
+#include <zsdp/payload-type-set.h>
+#include <zsdp/string-view.h>
+
+
+namespace zsdp {
+
+constexpr size_t kSessionLevel = (size_t)-1;
+
+class SdpPipeline;
+struct PipelineRunState;
+
+/**
+ * A line travelling through an SdpPipeline. value is everything after "x="
+ * and does not include the line ending.
+ */
+struct SdpLineEvent {
+    char type;
+    StringView value;
+    size_t streamIndex; /// kSessionLevel before the first m= line
+
+    /**
+     * The unmodified input text of the enclosing m-section, from its m= line up
+     * to the next one. Filters can scan it to look ahead (e.g. at a=rtpmap
+     * lines while handling m=). Empty at session level.
+     */
+    StringView mediaSection() const;
+
+private:
+    friend class SdpPipeline;
+    PipelineRunState* mRun = NULL;
+};
+
+/// Where a filter sends its output lines: the next filter, or the output buffer.
+class SdpLineSink {
+public:
+    virtual void emit(char type, StringView value) = 0;
+
+protected:
+    ~SdpLineSink(){}
+};
+
+/**
+ * One stage of an SdpPipeline. A filter sees each line once and emits zero or
+ * more lines to the next stage. Filters may keep per-run state; reset() is
+ * called before every run.
+ */
+class SdpFilter {
+public:
+    virtual ~SdpFilter(){}
+
+    virtual void reset(){}
+    virtual void onLine(const SdpLineEvent& line, SdpLineSink& next) = 0;
+
+    /// Called after the last line of each m-section has passed this filter.
+    virtual void endSection(size_t streamIndex, SdpLineSink& next){}
+};
+
+/**
+ * Applies a chain of filters to raw SDP text in a single pass. Each input line
+ * is pushed through all filters before the next line is read, and the last
+ * filter writes straight into the output buffer, so no Sdp and no per-stage
+ * buffers are built.
+ *
+ * A pipeline (and its filters) must not be run from two threads at once.
+ */
+class SdpPipeline {
+public:
+    SdpPipeline& add(const sp<SdpFilter>& filter);
+
+    /// Writes the filtered SDP to out, replacing its contents. Lines are written with CRLF endings.
+    void run(StringView sdp, std::string& out) const;
+
+private:
+    class Link;
+
+    std::vector<sp<SdpFilter>> mFilters;
+};
+
+
+/// Removes the listed codecs (by rtpmap encoding name, case-insensitive) from m= lines along with their rtpmap/fmtp/rtcp-fb lines.
+class DropCodecsFilter : public SdpFilter {
+public:
+    explicit DropCodecsFilter(const std::vector<std::string>& encodingNames);
+
+    virtual void reset() override;
+    virtual void onLine(const SdpLineEvent& line, SdpLineSink& next) override;
+
+private:
+    std::vector<std::string> mEncodingNames;
+    PayloadTypeSet mDropped;
+    std::string mScratch;
+};
+
+/// Removes a= lines whose key is in the list.
+class StripAttributesFilter : public SdpFilter {
+public:
+    explicit StripAttributesFilter(const std::vector<std::string>& keys);
+
+    virtual void onLine(const SdpLineEvent& line, SdpLineSink& next) override;
+
+private:
+    std::vector<std::string> mKeys;
+};
+
+/// Moves payload types whose rtpmap encoding name is listed to the front of each m= line, in list order.
+class ReorderPayloadTypesFilter : public SdpFilter {
+public:
+    explicit ReorderPayloadTypesFilter(const std::vector<std::string>& preferredEncodingNames);
+
+    virtual void onLine(const SdpLineEvent& line, SdpLineSink& next) override;
+
+private:
+    std::vector<std::string> mPreferred;
+    std::string mScratch;
+};
+
+/// Replaces every direction attribute with the given one and adds it to m-sections that had none.
+class ForceDirectionFilter : public SdpFilter {
+public:
+    explicit ForceDirectionFilter(MediaDirection direction);
+
+    virtual void reset() override;
+    virtual void onLine(const SdpLineEvent& line, SdpLineSink& next) override;
+    virtual void endSection(size_t streamIndex, SdpLineSink& next) override;
+
+private:
+    MediaDirection mDirection;
+    bool mSectionHasDirection = false;
+};
+
+/// Lowers b=AS values above the cap to the cap.
+class CapBandwidthFilter : public SdpFilter {
+public:
+    explicit CapBandwidthFilter(uint64_t maxKbps);
+
+    virtual void onLine(const SdpLineEvent& line, SdpLineSink& next) override;
+
+private:
+    uint64_t mMaxKbps;
+    std::string mScratch;
+};
+
+} // namespace zsdp
+
+#endif // __ZSDP_PIPELINE_H__
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_SDP_FIXED_H__
+#define __ZSDP_SDP_FIXED_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zsdp/sdp.h>
+#include <zsdp/string-view.h>
+
+
+namespace zsdp {
+
+enum class FixedStatus : uint8_t {
+    Ok,
+    NotSdp,     /// the input does not start with "v="
+    Malformed,  /// a line could not be parsed
+    OutOfOrder, /// lines are out of RFC 4566 order, or a required line is missing
+    Overflow,   /// a capacity of the SdpFixed, or of the output buffer, was exceeded
+};
+
+const char* fixedStatusToString(FixedStatus status) noexcept;
+
+/// t= lines an SdpFixed keeps. Realtime endpoints rarely send more than "t=0 0".
+constexpr size_t kFixedMaxTimes = 4;
+
+/// A run of an SdpFixed's text buffer.
+struct FixedText {
+    uint32_t offset = 0;
+    uint32_t size = 0;
+
+    bool empty() const noexcept { return size == 0; }
+};
+
+struct FixedOrigin {
+    FixedText username;
+    FixedText sessionID;
+    FixedText sessionVersion;
+    NetworkType networkType = NetworkType::IN;
+    AddressType addressType = AddressType::IP4;
+    FixedText host;
+};
+
+struct FixedConnectionData {
+    NetworkType networkType = NetworkType::IN;
+    AddressType addressType = AddressType::IP4;
+    FixedText host;
+};
+
+struct FixedEncryption {
+    EncryptionType type = EncryptionType::NotSet;
+    FixedText key;
+};
+
+struct FixedTiming {
+    uint64_t start = 0;
+    uint64_t end = 0;
+    FixedText repeats; /// the values of the r= lines as written, separated by '\n'
+};
+
+struct FixedStream {
+    MediaType mediaType = MediaType::NotSet;
+    uint16_t port = 0;
+    uint16_t portCount = 0;
+    Protocol protocol = Protocol::NotSet;
+    FixedText codec; /// For udp only
+    FixedText title;
+    FixedConnectionData connectionData;
+    Bandwidth bandwidth;
+    FixedEncryption encryption;
+    uint32_t payloadTypeCount = 0;
+    uint32_t attributeCount = 0;
+};
+
+struct FixedSession {
+    uint32_t version = VersionNumber;
+    FixedOrigin origin;
+    FixedText sessionName;
+    FixedText sessionInformation;
+    FixedText uri;
+    FixedText email;
+    FixedText phoneNumber;
+    FixedConnectionData connectionData;
+    Bandwidth bandwidth;
+    FixedTiming times[kFixedMaxTimes];
+    uint32_t timeCount = 0;
+    FixedText timeZones; /// the values of the z= lines as written, separated by ' '
+    FixedEncryption encryption;
+    uint32_t attributeCount = 0;
+    uint32_t streamCount = 0;
+};
+
+/**
+ * The arrays of an SdpFixed, so the parser and writer need not be templates.
+ * Attributes are stored maxAttributesPerSection per section, session first,
+ * and payload types maxPayloadTypes per stream.
+ */
+struct FixedStorage {
+    FixedSession* session;
+    FixedStream* streams;
+    size_t maxStreams;
+    FixedText* attributes;
+    size_t maxAttributesPerSection;
+    uint8_t* payloadTypes;
+    size_t maxPayloadTypes;
+    char* text;
+    size_t maxTextBytes;
+    uint32_t* textSize;
+};
+
+/// Parses sdp into storage, with the same line rules as parseSdp().
+FixedStatus parseSdpFixed(StringView sdp, const FixedStorage& storage) noexcept;
+
+/// Writes storage as SDP text to out. *size is set to the bytes written, or needed on Overflow.
+FixedStatus writeSdpFixed(const FixedStorage& storage, char* out, size_t capacity, size_t* size) noexcept;
+
+/**
+ * An Sdp for threads that may not allocate or throw, such as a media
+ * engine's realtime thread. Everything lives inside the object: up to
+ * MaxStreams m-sections, MaxAttrsPerStream a= lines per section (the
+ * session counts as a section), MaxPayloadTypes payload types per m= line,
+ * and MaxTextBytes of text for all string fields. Parsing input that does
+ * not fit returns FixedStatus::Overflow instead of growing.
+ *
+ * Attributes are kept as their text after "a=" and are not decoded; pass
+ * one to parseAttribute() off the realtime thread when needed. r= and z=
+ * lines are kept as written. Otherwise serialize() writes the same text as
+ * sdpToString() of the equivalent Sdp.
+ */
+template<size_t MaxStreams, size_t MaxAttrsPerStream, size_t MaxPayloadTypes, size_t MaxTextBytes>
+class SdpFixed {
+    static_assert(MaxStreams > 0 && MaxAttrsPerStream > 0 && MaxPayloadTypes > 0 && MaxTextBytes > 0,
+                  "SdpFixed capacities must be non-zero.");
+    static_assert(MaxTextBytes <= UINT32_MAX, "SdpFixed text is addressed with 32-bit offsets.");
+
+public:
+    SdpFixed() noexcept : mTextSize(0) {}
+
+    /**
+     * Parses sdp, replacing the current contents. Unless Ok is returned, the
+     * contents are unspecified until the next successful parse.
+     */
+    FixedStatus parse(StringView sdp) noexcept {
+        return parseSdpFixed(sdp, storage());
+    }
+
+    /**
+     * Writes the SDP to out. *size is set to the bytes written, or on
+     * Overflow to the capacity that would have been needed.
+     */
+    FixedStatus serialize(char* out, size_t capacity, size_t* size) const noexcept {
+        return writeSdpFixed(const_cast<SdpFixed*>(this)->storage(), out, capacity, size);
+    }
+
+    const FixedSession& session() const noexcept { return mSession; }
+
+    size_t attributeCount() const noexcept { return mSession.attributeCount; }
+    StringView attribute(size_t i) const noexcept { return text(mAttributes[i]); }
+
+    size_t streamCount() const noexcept { return mSession.streamCount; }
+    const FixedStream& stream(size_t i) const noexcept { return mStreams[i]; }
+
+    uint8_t payloadType(size_t stream, size_t i) const noexcept { return mPayloadTypes[stream * MaxPayloadTypes + i]; }
+    StringView streamAttribute(size_t stream, size_t i) const noexcept { return text(mAttributes[(stream + 1) * MaxAttrsPerStream + i]); }
+
+    StringView text(FixedText t) const noexcept { return StringView(mText + t.offset, t.size); }
+
+    /// Bytes of the text buffer in use.
+    size_t textSize() const noexcept { return mTextSize; }
+
+private:
+    /// Non-const for parse(); writeSdpFixed() only reads through it.
+    FixedStorage storage() noexcept {
+        return { &mSession,
+                 mStreams, MaxStreams,
+                 mAttributes, MaxAttrsPerStream,
+                 mPayloadTypes, MaxPayloadTypes,
+                 mText, MaxTextBytes, &mTextSize };
+    }
+
+    FixedSession mSession;
+    FixedStream mStreams[MaxStreams];
+    FixedText mAttributes[(MaxStreams + 1) * MaxAttrsPerStream];
+    uint8_t mPayloadTypes[MaxStreams * MaxPayloadTypes];
+    uint32_t mTextSize;
+    char mText[MaxTextBytes];
+};
+
+} // namespace zsdp
+
+#endif // __ZSDP_SDP_FIXED_H__
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_SDP_MERGE_H__
+#define __ZSDP_SDP_MERGE_H__
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <zsdp/payload-type-set.h>
+#include <zsdp/sdp.h>
+#include <zsdp/snapshot.h>
+
+
+namespace zsdp {
+
+/**
+ * Composes one Sdp out of m-sections taken from others, as an SFU builds a
+ * subscriber offer from its publishers' sections, and bundles them (RFC
+ * 8843). Sections are held through sp<const Stream>, as SdpSnapshot hands
+ * them out, and are never copied.
+ *
+ * Within a BUNDLE group a payload type, and an extmap ID, must mean the
+ * same thing in every section. add() keeps each section's numbers where
+ * they don't clash and otherwise picks free ones: payload types with the
+ * same codec (encoding name, clock rate, channels and fmtp) share a
+ * number, and so do extmap IDs with the same URI. Every section gets a
+ * unique a=mid, its own if that is free. Sections with port 0 are left
+ * out of the group.
+ *
+ * write() emits sections that need no change exactly as SdpWriter would,
+ * and in the others rewrites only the m= line and the rtpmap, fmtp
+ * (including RTX apt=), rtcp-fb, extmap and mid lines.
+ */
+class SdpMerger {
+public:
+    /**
+     * session supplies the result's session-level fields and attributes.
+     * Its streams are ignored, and any a=group:BUNDLE in it is replaced.
+     */
+    explicit SdpMerger(const Sdp& session);
+
+    /// Appends section as the next m-section and returns its index. Throws runtime_error when payload types or extmap IDs run out.
+    size_t add(sp<const Stream> section);
+
+    /// Appends stream streamIndex of source.
+    size_t add(const SdpSnapshot& source, size_t streamIndex);
+
+    size_t size() const{ return mSections.size(); }
+
+    const sp<const Stream>& section(size_t i) const{ return mSections[i].stream; }
+    const std::string& mid(size_t i) const{ return mSections[i].mid; }
+
+    /// The payload type section i's pt is written as, or kPayloadType_NotSet if the section doesn't list pt.
+    uint8_t payloadType(size_t i, uint8_t pt) const;
+
+    /// The ID section i's extmap id is written as, or 0 if the section has no such extmap.
+    uint16_t extmapId(size_t i, uint16_t id) const;
+
+    /// False when write() has to rewrite some of section i's lines.
+    bool unchanged(size_t i) const{ return mSections[i].unchanged; }
+
+    /// Appends the merged SDP to out.
+    void write(std::string& out) const;
+    std::string toString() const;
+
+    /// The merged Sdp as an object model. Unlike write(), this copies every section.
+    Sdp toSdp() const;
+
+private:
+    template<typename T>
+    struct Remap {
+        T from;
+        T to;
+    };
+
+    struct Section {
+        sp<const Stream> stream;
+        std::string mid;
+        bool hasMid = false;    /// The source has an a=mid line.
+        bool unchanged = true;
+        SmallVector<Remap<uint8_t>, 4> payloadTypes;  /// Only the payload types whose number changes.
+        SmallVector<Remap<uint16_t>, 4> extmapIds;    /// Likewise.
+        PayloadTypeSet listed;
+    };
+
+    struct Codec {
+        uint64_t hash;
+        Symbol encodingName;
+        uint32_t clockRate;
+        uint32_t channels;
+        std::string formatParams; /// With apt= already remapped.
+        uint8_t payloadType;
+    };
+
+    struct Extension {
+        std::string uri;
+        uint16_t id;
+    };
+
+    uint8_t assignPayloadType(uint8_t pt,
+                              bool fixed,
+                              const PayloadTypeSet& taken,
+                              const Symbol& encodingName,
+                              uint32_t clockRate,
+                              uint32_t channels,
+                              StringView formatParams);
+    uint16_t assignExtmapId(uint16_t id, StringView uri);
+    std::string assignMid(StringView preferred, size_t section);
+    bool midTaken(StringView mid, uint64_t hash) const;
+
+    static uint8_t mappedPayloadType(const Section& section, uint8_t pt);
+    static uint16_t mappedExtmapId(const Section& section, uint16_t id);
+
+    /// Remaps the apt= values in the fmtp parameters that start at params[pos]. Returns true if any changed.
+    static bool rewriteApt(const Section& section, std::string& params, size_t pos);
+
+    /// Appends attr's line, without "a=", to line, rewritten for section. Returns true if it differs from attr's own.
+    bool rewrite(const Section& section, const Attribute& attr, std::string& line) const;
+    void writeSection(std::string& out, const Section& section) const;
+    AttributeList sessionAttributes() const;
+
+    Sdp mSession;
+    std::vector<Section> mSections;
+    std::vector<Codec> mCodecs;
+    std::vector<Extension> mExtensions;
+    PayloadTypeSet mUsedPayloadTypes;
+    std::vector<bool> mUsedExtmapIds;
+    std::vector<std::pair<uint64_t, size_t>> mMidIndex; /// (hash of mid, section), sorted.
+    size_t mNextMid = 0;
+};
+
+} // namespace zsdp
+
+#endif // __ZSDP_SDP_MERGE_H__
@@ -29,6 +29,9 @@
 #include <sys/socket.h>
 #include <zsdp/attributes.h>
 #include <zsdp/defs.h>
+#include <zsdp/payload-type-set.h>
+#include <zsdp/small-vector.h>
+#include <zsdp/string-view.h>
 
 
 namespace zsdp {
@@ -83,6 +86,14 @@ enum class Protocol {
 std::string protocolToString(Protocol p);
 
 
+/*
+ * Inline capacities sized for typical sessions: most have 1-3 m= lines, a
+ * few payload types per m= line and fewer than 16 attributes per section.
+ */
+typedef SmallVector<uint8_t, 8> PayloadTypeList;
+typedef SmallVector<sp<Attribute>, 16> AttributeList;
+
+
 constexpr uint32_t VersionNumber = 0;
 constexpr const char* MimeType = "application/sdp";
 
@@ -112,10 +123,25 @@ struct MediaDescription {
     uint16_t port = 0;
     uint16_t portCount = 0;
     Protocol protocol = Protocol::NotSet;
-    std::vector<uint8_t> payloadTypes; /// For RTP/AVP and RTP/SAVP only, typically only one payload type
-    std::string codec; /// For udp only (Not used with RTP/AVP or RTP/SAVP).
+    PayloadTypeList payloadTypes; /// For RTP/AVP and RTP/SAVP only, typically only one payload type
+    Symbol codec; /// For udp only (Not used with RTP/AVP or RTP/SAVP).
+
+    /**
+     * The members of payloadTypes, for set operations. Filled in by
+     * parseSdp() and the other decoders; after changing payloadTypes
+     * directly, call reindexPayloadTypes().
+     */
+    PayloadTypeSet payloadTypeSet;
 
     std::string toString() const;
+
+    /// Appends pt to payloadTypes and payloadTypeSet.
+    void addPayloadType(uint8_t pt){
+        payloadTypes.push_back(pt);
+        payloadTypeSet.insert(pt);
+    }
+
+    void reindexPayloadTypes(){ payloadTypeSet = PayloadTypeSet::of(payloadTypes); }
 };
 
 struct RepeatingTime {
@@ -129,7 +155,7 @@ struct RepeatingTime {
 struct Timing {
     uint64_t start = 0; // Times are NTP: seconds since January 1, 1900.
     uint64_t end = 0; // set to 0 for a session without a defined end-time.
-    std::vector<RepeatingTime> repeatingTimes;
+    SmallVector<RepeatingTime, 1> repeatingTimes;
 
     std::string toString() const;
 };
@@ -161,6 +187,8 @@ enum class BandwidthType {
     ApplicationSpecific,
 };
 
+std::string bandwidthTypeToString(BandwidthType t);
+
 struct Bandwidth {
     BandwidthType type = BandwidthType::NotSet;
     uint64_t kbps = 0;
@@ -168,17 +196,110 @@ struct Bandwidth {
     std::string toString() const;
 };
 
+/**
+ * Positions of the built-in attributes in an AttributeList: the first one
+ * of each AttrId, and from each position the next one with the same AttrId.
+ */
+class AttributeIndex {
+public:
+    static constexpr uint16_t kNone = UINT16_MAX;
+
+    AttributeIndex();
+
+    void build(const AttributeList& attributes);
+    void clear();
+
+    /// False once attributes has grown or shrunk since build().
+    bool covers(const AttributeList& attributes) const{ return mSize == attributes.size(); }
+
+    uint16_t first(AttrId id) const{ return mFirst[(size_t)id]; }
+    uint16_t next(size_t position) const{ return mNext[position]; }
+
+private:
+    uint16_t mFirst[(size_t)AttrId::Count];
+    SmallVector<uint16_t, 16> mNext;
+    size_t mSize;
+};
+
+template<typename T>
+class AttributeRange;
+
 struct Stream {
     MediaDescription mediaDescription;
     std::string title;
-    std::vector<sp<Attribute>> attributes;
+    AttributeList attributes;
     ConnectionData connectionData;
     Bandwidth bandwidth;
     Encryption encryption;
 
+    /**
+     * Built by parseSdp() and the other decoders. After changing attributes,
+     * call reindexAttributes(): lookups notice added or removed attributes
+     * and fall back to a scan, but not one replaced in place.
+     */
+    AttributeIndex attributeIndex;
+
     std::string sdpLines() const;
+
+    void reindexAttributes(){ attributeIndex.build(attributes); }
+
+    /// The first attribute of class T (e.g. AttrRtpMap), or NULL. Undecoded GenericAttributes never match.
+    template<typename T>
+    const T* find() const{
+        size_t position = firstAttribute(T::kId);
+        return position < attributes.size() ? static_cast<const T*>(attributes[position].get()) : NULL;
+    }
+
+    /// Every attribute of class T, in order.
+    template<typename T>
+    AttributeRange<T> findAll() const;
+
+    /// Position of the first attribute with the given id, or attributes.size().
+    size_t firstAttribute(AttrId id) const;
+
+    /// Position of the next attribute after position with the same id, or attributes.size().
+    size_t nextAttribute(size_t position) const;
 };
 
+/// The attributes of one class in a Stream, from Stream::findAll(). Only valid while the Stream is unchanged.
+template<typename T>
+class AttributeRange {
+public:
+    class iterator {
+    public:
+        iterator(const Stream* stream, size_t position) : mStream(stream), mPosition(position) {}
+
+        const T& operator*() const{ return static_cast<const T&>(*mStream->attributes[mPosition]); }
+        const T* operator->() const{ return &**this; }
+
+        iterator& operator++(){
+            mPosition = mStream->nextAttribute(mPosition);
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const{ return mPosition == other.mPosition; }
+        bool operator!=(const iterator& other) const{ return mPosition != other.mPosition; }
+
+    private:
+        const Stream* mStream;
+        size_t mPosition;
+    };
+
+    explicit AttributeRange(const Stream& stream) : mStream(stream) {}
+
+    iterator begin() const{ return iterator(&mStream, mStream.firstAttribute(T::kId)); }
+    iterator end() const{ return iterator(&mStream, mStream.attributes.size()); }
+    bool empty() const{ return begin() == end(); }
+
+private:
+    const Stream& mStream;
+};
+
+template<typename T>
+AttributeRange<T> Stream::findAll() const{
+    return AttributeRange<T>(*this);
+}
+
 
 struct Sdp {
     uint32_t version = VersionNumber; // v=
@@ -196,13 +317,58 @@ struct Sdp {
     std::vector<TimeZoneAdjustment> timeZoneAdjustments;
     Encryption encryption;
 
-    std::vector<sp<Attribute>> attributes;
+    AttributeList attributes;
+
+    SmallVector<Stream, 3> streams; // m=
+};
+
+enum class InputEncoding {
+    Raw,
+    JsonString, /// The body of a JSON string literal, e.g. "v=0\r\no=...". The surrounding quotes are optional.
+};
+
+class InternPool;
+
+struct ParseOptions {
+    /// When false, every a= line is kept as a GenericAttribute and only decoded on request.
+    bool decodeAttributes = true;
 
-    std::vector<Stream> streams; // m=
+    /// When set, attributes come from the pool and are shared with other Sdps parsed with it. See intern.h.
+    InternPool* internPool = NULL;
+
+    /**
+     * With JsonString, lines end at \r\n or \n escapes and only the lines
+     * that contain other escapes are unescaped, so a signalling payload can
+     * be parsed without first copying it into an unescaped string.
+     */
+    InputEncoding inputEncoding = InputEncoding::Raw;
 };
 
 std::string sdpToString(const Sdp* sdp);
+
+/// Appends the serialized SDP to out, so a buffer can be reused across calls.
+void sdpToString(const Sdp* sdp, std::string& out);
+
 Sdp parseSdp(const std::string& sdpStr);
+Sdp parseSdp(StringView sdpStr, const ParseOptions& options);
+
+/// Scratch space kept between parseSdpInto() calls so it only grows, never reallocates per call.
+struct ParseContext {
+    std::string scratch;
+    std::vector<uint32_t> attributeCounts; /// a= lines per section, from the prescan
+};
+
+/// The calling thread's ParseContext. parseSdp() uses it.
+ParseContext& threadParseContext();
+
+/**
+ * Parses into reuse, which is cleared first but keeps the capacity of its
+ * strings and vectors, including those of its existing streams. Parsing a
+ * stream of similar SDPs into the same Sdp allocates little beyond the
+ * attributes themselves (and nothing for those already in an InternPool).
+ * If parsing throws, reuse is left valid but unspecified.
+ */
+void parseSdpInto(Sdp& reuse, StringView sdpStr, ParseContext& context, const ParseOptions& options = ParseOptions());
 
 } // namespace zsdp
 
@@ -0,0 +1,326 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_SMALL_VECTOR_H__
+#define __ZSDP_SMALL_VECTOR_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+
+namespace zsdp {
+
+/**
+ * A vector that stores up to N elements inside the object and only moves
+ * to the heap when it grows past that. The object model uses it for lists
+ * that are almost always short (streams, payload types, attributes), so a
+ * typical Sdp needs no allocations for its containers.
+ *
+ * Follows the std::vector interface for the operations the library uses.
+ * Iterators are pointers. Unlike std::vector, moving a SmallVector whose
+ * elements are inline moves each element, and clear() never releases heap
+ * storage.
+ */
+template<typename T, size_t N>
+class SmallVector {
+    static_assert(N > 0, "SmallVector needs an inline capacity of at least one element.");
+
+public:
+    typedef T value_type;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    static constexpr size_t kInlineCapacity = N;
+
+    SmallVector() : mData(inlineData()), mSize(0), mCapacity(N) {}
+
+    explicit SmallVector(size_t count, const T& value = T()) : SmallVector() {
+        resize(count, value);
+    }
+
+    SmallVector(std::initializer_list<T> init) : SmallVector() {
+        assign(init.begin(), init.end());
+    }
+
+    SmallVector(const SmallVector& other) : SmallVector() {
+        assign(other.begin(), other.end());
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) : SmallVector() {
+        takeFrom(other);
+    }
+
+    ~SmallVector(){
+        destroyAll();
+        releaseHeap();
+    }
+
+    SmallVector& operator=(const SmallVector& other){
+        if(this != &other)
+            assign(other.begin(), other.end());
+
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value){
+        if(this != &other){
+            destroyAll();
+            releaseHeap();
+            takeFrom(other);
+        }
+
+        return *this;
+    }
+
+    SmallVector& operator=(std::initializer_list<T> init){
+        assign(init.begin(), init.end());
+        return *this;
+    }
+
+    iterator begin(){ return mData; }
+    iterator end(){ return mData + mSize; }
+    const_iterator begin() const{ return mData; }
+    const_iterator end() const{ return mData + mSize; }
+    const_iterator cbegin() const{ return mData; }
+    const_iterator cend() const{ return mData + mSize; }
+
+    T* data(){ return mData; }
+    const T* data() const{ return mData; }
+    size_t size() const{ return mSize; }
+    bool empty() const{ return mSize == 0; }
+    size_t capacity() const{ return mCapacity; }
+
+    /// True while the elements are stored inside the object.
+    bool isInline() const{ return mData == inlineData(); }
+
+    T& operator[](size_t i){ return mData[i]; }
+    const T& operator[](size_t i) const{ return mData[i]; }
+
+    T& at(size_t i){
+        if(i >= mSize)
+            throw std::out_of_range("SmallVector index out-of-range.");
+
+        return mData[i];
+    }
+
+    const T& at(size_t i) const{
+        if(i >= mSize)
+            throw std::out_of_range("SmallVector index out-of-range.");
+
+        return mData[i];
+    }
+
+    T& front(){ return mData[0]; }
+    const T& front() const{ return mData[0]; }
+    T& back(){ return mData[mSize - 1]; }
+    const T& back() const{ return mData[mSize - 1]; }
+
+    void reserve(size_t capacity){
+        if(capacity > mCapacity)
+            reallocate(capacity);
+    }
+
+    void clear(){
+        destroyAll();
+    }
+
+    void push_back(const T& value){
+        emplace_back(value);
+    }
+
+    void push_back(T&& value){
+        emplace_back(std::move(value));
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args){
+        if(mSize == mCapacity){
+            // value may refer to an element, so construct it before the old storage goes away.
+            T value(std::forward<Args>(args)...);
+            reallocate(grownCapacity(mSize + 1));
+            new(mData + mSize) T(std::move(value));
+        }
+        else{
+            new(mData + mSize) T(std::forward<Args>(args)...);
+        }
+
+        return mData[mSize++];
+    }
+
+    void pop_back(){
+        mData[--mSize].~T();
+    }
+
+    void resize(size_t count){
+        resizeWith(count, [](T* p){ new(p) T(); });
+    }
+
+    void resize(size_t count, const T& value){
+        resizeWith(count, [&value](T* p){ new(p) T(value); });
+    }
+
+    template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+    void assign(It first, It last){
+        clear();
+        insert(end(), first, last);
+    }
+
+    void assign(std::initializer_list<T> init){
+        assign(init.begin(), init.end());
+    }
+
+    iterator insert(const_iterator pos, const T& value){
+        const T* values = &value;
+        return insert(pos, values, values + 1);
+    }
+
+    template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+    iterator insert(const_iterator pos, It first, It last){
+        size_t index = pos - begin();
+        size_t oldSize = mSize;
+
+        // Append, then rotate the new elements into place.
+        for(; first != last; ++first)
+            emplace_back(*first);
+
+        std::rotate(begin() + index, begin() + oldSize, end());
+
+        return begin() + index;
+    }
+
+    iterator erase(const_iterator pos){
+        return erase(pos, pos + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last){
+        iterator from = begin() + (first - cbegin());
+        iterator to = begin() + (last - cbegin());
+        iterator newEnd = std::move(to, end(), from);
+
+        while(end() != newEnd)
+            pop_back();
+
+        return from;
+    }
+
+    void swap(SmallVector& other){
+        SmallVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+private:
+    T* inlineData(){ return reinterpret_cast<T*>(&mInline); }
+    const T* inlineData() const{ return reinterpret_cast<const T*>(&mInline); }
+
+    size_t grownCapacity(size_t minCapacity) const{
+        return std::max(minCapacity, (size_t)mCapacity * 2);
+    }
+
+    void reallocate(size_t capacity){
+        if(capacity > UINT32_MAX)
+            throw std::length_error("SmallVector too large.");
+
+        T* data = static_cast<T*>(::operator new(capacity * sizeof(T)));
+        for(size_t i = 0; i < mSize; i++){
+            new(data + i) T(std::move_if_noexcept(mData[i]));
+            mData[i].~T();
+        }
+
+        releaseHeap();
+        mData = data;
+        mCapacity = (uint32_t)capacity;
+    }
+
+    template<typename Construct>
+    void resizeWith(size_t count, Construct construct){
+        while(mSize > count)
+            pop_back();
+
+        reserve(count);
+        for(; mSize < count; mSize++)
+            construct(mData + mSize);
+    }
+
+    void destroyAll(){
+        for(size_t i = 0; i < mSize; i++)
+            mData[i].~T();
+
+        mSize = 0;
+    }
+
+    void releaseHeap(){
+        if(!isInline())
+            ::operator delete(mData);
+
+        mData = inlineData();
+        mCapacity = N;
+    }
+
+    /// Takes other's elements, leaving it empty. This object must be empty and inline.
+    void takeFrom(SmallVector& other){
+        if(other.isInline()){
+            for(size_t i = 0; i < other.mSize; i++)
+                new(mData + i) T(std::move(other.mData[i]));
+
+            mSize = other.mSize;
+            other.destroyAll();
+        }
+        else{
+            mData = other.mData;
+            mSize = other.mSize;
+            mCapacity = other.mCapacity;
+            other.mData = other.inlineData();
+            other.mSize = 0;
+            other.mCapacity = N;
+        }
+    }
+
+    T* mData;
+    uint32_t mSize;
+    uint32_t mCapacity;
+    typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type mInline;
+};
+
+template<typename T, size_t N>
+bool operator==(const SmallVector<T, N>& a, const SmallVector<T, N>& b){
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+template<typename T, size_t N>
+bool operator!=(const SmallVector<T, N>& a, const SmallVector<T, N>& b){
+    return !(a == b);
+}
+
+} // namespace zsdp
+
+#endif // __ZSDP_SMALL_VECTOR_H__
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_SNAPSHOT_H__
+#define __ZSDP_SNAPSHOT_H__
+
+#include <atomic>
+#include <mutex>
+#include <zsdp/sdp.h>
+
+
+namespace zsdp {
+
+/**
+ * An immutable Sdp that shares its parts with the versions it was derived
+ * from. The session-level fields, the session attribute list, the stream
+ * list and each stream are held separately through sp<const ...>, so
+ * copying a snapshot is one reference count increment and the update*()
+ * methods copy only the parts they change: updating one stream copies
+ * that stream and the list of stream pointers, and shares everything else.
+ *
+ * A snapshot is never modified after it is built, so any number of
+ * threads can read it. Publish it to them through AtomicSdpSnapshot.
+ */
+class SdpSnapshot {
+public:
+    typedef SmallVector<sp<const Stream>, 3> StreamList;
+
+    /// An empty Sdp.
+    SdpSnapshot();
+    explicit SdpSnapshot(const Sdp& sdp);
+
+    /// The session-level fields. Its attributes and streams are always empty; see attributes() and stream().
+    const Sdp& session() const { return *mData->session; }
+    const AttributeList& attributes() const { return *mData->attributes; }
+
+    size_t streamCount() const { return mData->streams->size(); }
+    const Stream& stream(size_t i) const { return *(*mData->streams)[i]; }
+
+    /// Lets a caller keep one m-section without the rest of the snapshot.
+    const sp<const Stream>& sharedStream(size_t i) const { return (*mData->streams)[i]; }
+
+    /// A full, unshared copy.
+    Sdp toSdp() const;
+
+    /// Calls fnc(Sdp&) on a copy of the session-level fields. Changes to its attributes or streams are ignored.
+    template<typename Fnc>
+    SdpSnapshot updateSession(Fnc fnc) const {
+        Sdp session = this->session();
+        fnc(session);
+        return replaceSession(std::move(session));
+    }
+
+    /// Calls fnc(AttributeList&) on a copy of the session attributes.
+    template<typename Fnc>
+    SdpSnapshot updateAttributes(Fnc fnc) const {
+        AttributeList attributes = this->attributes();
+        fnc(attributes);
+        return replaceAttributes(std::move(attributes));
+    }
+
+    /// Calls fnc(Stream&) on a copy of stream i.
+    template<typename Fnc>
+    SdpSnapshot updateStream(size_t i, Fnc fnc) const {
+        Stream stream = this->stream(i);
+        fnc(stream);
+        return replaceStream(i, std::move(stream));
+    }
+
+    SdpSnapshot replaceSession(Sdp session) const;
+    SdpSnapshot replaceAttributes(AttributeList attributes) const;
+    SdpSnapshot replaceStream(size_t i, Stream stream) const;
+    SdpSnapshot addStream(Stream stream) const;
+    SdpSnapshot removeStream(size_t i) const;
+
+    /// True if both are the same version, not merely equal.
+    bool sameAs(const SdpSnapshot& other) const { return mData == other.mData; }
+
+private:
+    struct Data {
+        sp<const Sdp> session;
+        sp<const AttributeList> attributes;
+        sp<const StreamList> streams;
+    };
+
+    explicit SdpSnapshot(sp<const Data> data) : mData(std::move(data)) {}
+
+    SdpSnapshot withStreams(StreamList streams) const;
+
+    sp<const Data> mData;
+};
+
+/**
+ * The current SdpSnapshot, shared between threads. load() never blocks or
+ * takes a lock, so readers are not held up by a renegotiation in progress.
+ * store() publishes a new version; concurrent stores are serialized, and a
+ * store waits for loads that started before it to take their reference to
+ * the old version before releasing it.
+ */
+class AtomicSdpSnapshot {
+public:
+    AtomicSdpSnapshot();
+    explicit AtomicSdpSnapshot(SdpSnapshot initial);
+    AtomicSdpSnapshot(const AtomicSdpSnapshot&) = delete;
+    AtomicSdpSnapshot& operator=(const AtomicSdpSnapshot&) = delete;
+    ~AtomicSdpSnapshot();
+
+    SdpSnapshot load() const;
+    void store(SdpSnapshot snapshot);
+
+private:
+    std::atomic<const SdpSnapshot*> mCurrent;
+
+    /*
+     * Loads in progress, by epoch. store() flips mEpoch after swapping in
+     * the new version and then waits for the old epoch's loads to finish;
+     * loads that start later only see the new version.
+     */
+    mutable std::atomic<uint32_t> mLoads[2];
+    std::atomic<uint32_t> mEpoch;
+    std::mutex mStoreMutex;
+};
+
+} // namespace zsdp
+
+#endif // __ZSDP_SNAPSHOT_H__
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_STRING_VIEW_H__
+#define __ZSDP_STRING_VIEW_H__
+
+#include <stddef.h>
+#include <string.h>
+#include <ostream>
+#include <string>
+
+
+namespace zsdp {
+
+/**
+ * Non-owning reference to a run of characters (C++11 stand-in for std::string_view).
+ * The referenced memory must outlive the view.
+ */
+class StringView {
+public:
+    static constexpr size_t npos = (size_t)-1;
+
+    constexpr StringView() : mData(""), mSize(0) {}
+    constexpr StringView(const char* data, size_t size) : mData(data), mSize(size) {}
+    StringView(const char* cStr) : mData(cStr), mSize(strlen(cStr)) {}
+    StringView(const std::string& s) : mData(s.data()), mSize(s.size()) {}
+
+    constexpr const char* data() const { return mData; }
+    constexpr size_t size() const { return mSize; }
+    constexpr bool empty() const { return mSize == 0; }
+    constexpr const char* begin() const { return mData; }
+    constexpr const char* end() const { return mData + mSize; }
+    constexpr char operator[](size_t i) const { return mData[i]; }
+    char front() const { return mData[0]; }
+    char back() const { return mData[mSize - 1]; }
+
+    std::string str() const { return std::string(mData, mSize); }
+
+    StringView substr(size_t pos, size_t count = npos) const {
+        if(pos > mSize)
+            pos = mSize;
+
+        if(count > mSize - pos)
+            count = mSize - pos;
+
+        return StringView(mData + pos, count);
+    }
+
+    size_t find(char c, size_t pos = 0) const {
+        if(pos >= mSize)
+            return npos;
+
+        const void* found = memchr(mData + pos, c, mSize - pos);
+        return found ? (const char*)found - mData : npos;
+    }
+
+    size_t find(StringView needle, size_t pos = 0) const {
+        if(needle.mSize == 0)
+            return pos <= mSize ? pos : npos;
+
+        while(pos + needle.mSize <= mSize){
+            pos = find(needle.mData[0], pos);
+            if(pos == npos || pos + needle.mSize > mSize)
+                return npos;
+
+            if(memcmp(mData + pos, needle.mData, needle.mSize) == 0)
+                return pos;
+
+            pos++;
+        }
+
+        return npos;
+    }
+
+    bool startsWith(StringView prefix) const {
+        return prefix.mSize <= mSize && memcmp(mData, prefix.mData, prefix.mSize) == 0;
+    }
+
+    bool equalsIgnoreCase(StringView other) const;
+
+    int compare(StringView other) const {
+        size_t n = mSize < other.mSize ? mSize : other.mSize;
+        int cmp = n == 0 ? 0 : memcmp(mData, other.mData, n);
+        if(cmp != 0)
+            return cmp;
+
+        return mSize < other.mSize ? -1 : (mSize > other.mSize ? 1 : 0);
+    }
+
+private:
+    const char* mData;
+    size_t mSize;
+};
+
+inline bool operator==(StringView a, StringView b){
+    return a.size() == b.size() && (a.size() == 0 || memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+inline bool operator!=(StringView a, StringView b){ return !(a == b); }
+inline bool operator<(StringView a, StringView b){ return a.compare(b) < 0; }
+
+inline bool operator==(StringView a, const char* b){ return a == StringView(b); }
+inline bool operator==(const char* a, StringView b){ return StringView(a) == b; }
+inline bool operator!=(StringView a, const char* b){ return !(a == b); }
+inline bool operator==(StringView a, const std::string& b){ return a == StringView(b); }
+inline bool operator==(const std::string& a, StringView b){ return StringView(a) == b; }
+inline bool operator!=(StringView a, const std::string& b){ return !(a == b); }
+
+inline bool StringView::equalsIgnoreCase(StringView other) const {
+    if(mSize != other.mSize)
+        return false;
+
+    for(size_t i = 0; i < mSize; i++){
+        char a = mData[i];
+        char b = other.mData[i];
+        if(a >= 'A' && a <= 'Z')
+            a += 'a' - 'A';
+
+        if(b >= 'A' && b <= 'Z')
+            b += 'a' - 'A';
+
+        if(a != b)
+            return false;
+    }
+
+    return true;
+}
+
+inline std::string& operator+=(std::string& s, StringView v){
+    return s.append(v.data(), v.size());
+}
+
+inline std::ostream& operator<<(std::ostream& out, StringView v){
+    return out.write(v.data(), v.size());
+}
+
+} // namespace zsdp
+
+#endif // __ZSDP_STRING_VIEW_H__
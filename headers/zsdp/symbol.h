@@ -0,0 +1,115 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_SYMBOL_H__
+#define __ZSDP_SYMBOL_H__
+
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <zsdp/string-view.h>
+
+
+namespace zsdp {
+
+/**
+ * An immutable string from a small vocabulary: encoding names, charsets,
+ * language tags. Values are interned in a global lock-free table, so a
+ * Symbol is one pointer and two equal Symbols share their text. Comparing
+ * two interned Symbols is a pointer compare.
+ *
+ * The table is bounded: once it is full, or for values longer than
+ * kMaxInternedSize, a Symbol owns a reference-counted copy of its text
+ * instead and compares by content. Interned text lives until exit.
+ */
+class Symbol {
+public:
+    static constexpr size_t kMaxInternedSize = 64;
+
+    Symbol();
+    Symbol(const char* s);
+    Symbol(const std::string& s);
+    Symbol(StringView s);
+    Symbol(const Symbol& other);
+    Symbol(Symbol&& other) noexcept;
+    ~Symbol();
+
+    Symbol& operator=(const Symbol& other);
+    Symbol& operator=(Symbol&& other) noexcept;
+
+    const std::string& str() const{ return mEntry->text; }
+    operator const std::string&() const{ return mEntry->text; }
+    StringView view() const{ return StringView(mEntry->text); }
+    const char* c_str() const{ return mEntry->text.c_str(); }
+    size_t size() const{ return mEntry->text.size(); }
+    bool empty() const{ return mEntry->text.empty(); }
+
+    bool isInterned() const{ return mEntry->interned; }
+
+    /// ASCII case-insensitive match, as encoding names are compared (RFC 4855).
+    bool equalsIgnoreCase(const Symbol& other) const;
+
+    friend bool operator==(const Symbol& a, const Symbol& b){
+        if(a.mEntry == b.mEntry)
+            return true;
+
+        // Two distinct interned entries never hold the same text.
+        return !(a.mEntry->interned && b.mEntry->interned) && a.mEntry->text == b.mEntry->text;
+    }
+
+    /// Number of values in the global table.
+    static size_t internedCount();
+
+private:
+    struct Entry {
+        Entry(StringView s, bool isInterned) : text(s.data(), s.size()), interned(isInterned), refs(1) {}
+
+        std::string text;
+        bool interned;
+        mutable std::atomic<uint32_t> refs; /// Only used when !interned.
+    };
+
+    static const Entry* entryFor(StringView s);
+    void retain() const;
+    void release() const;
+
+    const Entry* mEntry;
+};
+
+inline bool operator!=(const Symbol& a, const Symbol& b){ return !(a == b); }
+inline bool operator<(const Symbol& a, const Symbol& b){ return a.str() < b.str(); }
+
+inline bool operator==(const Symbol& a, const std::string& b){ return a.str() == b; }
+inline bool operator==(const std::string& a, const Symbol& b){ return a == b.str(); }
+inline bool operator!=(const Symbol& a, const std::string& b){ return a.str() != b; }
+inline bool operator!=(const std::string& a, const Symbol& b){ return a != b.str(); }
+inline bool operator==(const Symbol& a, const char* b){ return a.str() == b; }
+inline bool operator==(const char* a, const Symbol& b){ return a == b.str(); }
+inline bool operator!=(const Symbol& a, const char* b){ return a.str() != b; }
+inline bool operator!=(const char* a, const Symbol& b){ return a != b.str(); }
+inline bool operator==(const Symbol& a, StringView b){ return a.view() == b; }
+inline bool operator==(StringView a, const Symbol& b){ return a == b.view(); }
+inline bool operator!=(const Symbol& a, StringView b){ return !(a.view() == b); }
+inline bool operator!=(StringView a, const Symbol& b){ return !(a == b.view()); }
+
+inline std::ostream& operator<<(std::ostream& out, const Symbol& symbol){ return out << symbol.str(); }
+
+} // namespace zsdp
+
+#endif // __ZSDP_SYMBOL_H__
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/intern.h>
+#include "sdp-codec.h"
+
+
+using namespace std;
+
+namespace zsdp {
+
+namespace {
+
+/// Decoded and generic instances of the same line are kept apart.
+const char kDecodedTag = 'd';
+const char kGenericTag = 'g';
+
+double ratio(size_t lookups, size_t distinct){
+    return distinct == 0 ? 1.0 : (double)lookups / distinct;
+}
+
+} // namespace
+
+double InternStats::attributeDedupRatio() const{
+    return ratio(attributeLookups, distinctAttributes);
+}
+
+double InternStats::streamDedupRatio() const{
+    return ratio(streamLookups, distinctStreams);
+}
+
+sp<Attribute> InternPool::findOrAdd(bool decode, StringView line, const sp<Attribute>& candidate){
+    mKey.clear();
+    mKey += decode ? kDecodedTag : kGenericTag;
+    mKey += line;
+
+    mStats.attributeLookups++;
+
+    auto it = mAttributes.find(mKey);
+    if(it != mAttributes.end())
+        return it->second;
+
+    sp<Attribute> attr = candidate;
+    if(!attr){
+        string lineStr = line.str();
+        attr = decode ? parseAttribute(lineStr) : make_shared<GenericAttribute>(lineStr);
+    }
+
+    mAttributes.emplace(mKey, attr);
+    mStats.distinctAttributes++;
+
+    return attr;
+}
+
+sp<Attribute> InternPool::attribute(StringView line, bool decode){
+    lock_guard<mutex> lock(mMutex);
+
+    return findOrAdd(decode, line, NULL);
+}
+
+sp<Attribute> InternPool::intern(const sp<Attribute>& attr){
+    bool decode = attr->id() != AttrId::Generic;
+    string scratch;
+    StringView line = attributeLine(*attr, scratch);
+
+    lock_guard<mutex> lock(mMutex);
+
+    return findOrAdd(decode, line, attr);
+}
+
+sp<const Stream> InternPool::intern(const Stream& stream){
+    string key = stream.sdpLines();
+    string scratch;
+
+    lock_guard<mutex> lock(mMutex);
+    mStats.streamLookups++;
+
+    auto it = mStreams.find(key);
+    if(it != mStreams.end())
+        return it->second;
+
+    sp<Stream> shared = make_shared<Stream>(stream);
+    for(sp<Attribute>& attr : shared->attributes){
+        bool decode = attr->id() != AttrId::Generic;
+        attr = findOrAdd(decode, attributeLine(*attr, scratch), attr);
+    }
+
+    mStreams.emplace(std::move(key), shared);
+    mStats.distinctStreams++;
+
+    return shared;
+}
+
+size_t InternPool::prune(){
+    lock_guard<mutex> lock(mMutex);
+    size_t dropped = 0;
+
+    // Streams first: they hold references to attributes.
+    for(auto it = mStreams.begin(); it != mStreams.end();){
+        if(it->second.use_count() == 1){
+            it = mStreams.erase(it);
+            dropped++;
+        }
+        else{
+            ++it;
+        }
+    }
+
+    for(auto it = mAttributes.begin(); it != mAttributes.end();){
+        if(it->second.use_count() == 1){
+            it = mAttributes.erase(it);
+            dropped++;
+        }
+        else{
+            ++it;
+        }
+    }
+
+    return dropped;
+}
+
+void InternPool::clear(){
+    lock_guard<mutex> lock(mMutex);
+    mAttributes.clear();
+    mStreams.clear();
+}
+
+size_t InternPool::attributeCount() const{
+    lock_guard<mutex> lock(mMutex);
+
+    return mAttributes.size();
+}
+
+size_t InternPool::streamCount() const{
+    lock_guard<mutex> lock(mMutex);
+
+    return mStreams.size();
+}
+
+InternStats InternPool::stats() const{
+    lock_guard<mutex> lock(mMutex);
+
+    return mStats;
+}
+
+} // namespace zsdp
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "json-util.h"
+#include <stdexcept>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+using namespace std;
+
+namespace zsdp {
+
+static inline bool needsEscape(uint8_t c){
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+/// Returns the length of the prefix of [p, end) that needs no escaping.
+static size_t cleanPrefixSize(const char* p, const char* end){
+    const char* start = p;
+
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i maxControl = _mm_set1_epi8(0x1f);
+
+    while(end - p >= 16){
+        __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+        __m128i isControl = _mm_cmpeq_epi8(_mm_min_epu8(chunk, maxControl), chunk);
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                    _mm_cmpeq_epi8(chunk, backslash)),
+                                       isControl);
+
+        int mask = _mm_movemask_epi8(special);
+        if(mask != 0)
+            return (p - start) + __builtin_ctz(mask);
+
+        p += 16;
+    }
+#endif
+
+    while(p < end && !needsEscape((uint8_t)*p))
+        p++;
+
+    return p - start;
+}
+
+void appendJsonString(string& out, StringView s){
+    static const char hexDigits[] = "0123456789abcdef";
+
+    out += '"';
+
+    const char* p = s.begin();
+    const char* end = s.end();
+    while(p < end){
+        size_t clean = cleanPrefixSize(p, end);
+        out.append(p, clean);
+        p += clean;
+
+        if(p == end)
+            break;
+
+        uint8_t c = (uint8_t)*p++;
+        switch(c){
+            case '"': out.append("\\\"", 2); break;
+            case '\\': out.append("\\\\", 2); break;
+            case '\n': out.append("\\n", 2); break;
+            case '\r': out.append("\\r", 2); break;
+            case '\t': out.append("\\t", 2); break;
+            case '\b': out.append("\\b", 2); break;
+            case '\f': out.append("\\f", 2); break;
+            default: {
+                char escaped[6] = { '\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xf] };
+                out.append(escaped, sizeof(escaped));
+            }
+        }
+    }
+
+    out += '"';
+}
+
+static uint32_t parseHex4(const char* p){
+    uint32_t value = 0;
+    for(int i = 0; i < 4; i++){
+        char c = p[i];
+        value <<= 4;
+
+        if(c >= '0' && c <= '9')
+            value |= c - '0';
+        else if(c >= 'a' && c <= 'f')
+            value |= c - 'a' + 10;
+        else if(c >= 'A' && c <= 'F')
+            value |= c - 'A' + 10;
+        else
+            throw invalid_argument("Invalid \\u escape in JSON string.");
+    }
+
+    return value;
+}
+
+static void appendUtf8(string& out, uint32_t codePoint){
+    if(codePoint < 0x80)
+        out += (char)codePoint;
+    else if(codePoint < 0x800){
+        out += (char)(0xc0 | (codePoint >> 6));
+        out += (char)(0x80 | (codePoint & 0x3f));
+    }
+    else if(codePoint < 0x10000){
+        out += (char)(0xe0 | (codePoint >> 12));
+        out += (char)(0x80 | ((codePoint >> 6) & 0x3f));
+        out += (char)(0x80 | (codePoint & 0x3f));
+    }
+    else{
+        out += (char)(0xf0 | (codePoint >> 18));
+        out += (char)(0x80 | ((codePoint >> 12) & 0x3f));
+        out += (char)(0x80 | ((codePoint >> 6) & 0x3f));
+        out += (char)(0x80 | (codePoint & 0x3f));
+    }
+}
+
+void appendJsonUnescaped(string& out, StringView escaped){
+    const char* p = escaped.begin();
+    const char* end = escaped.end();
+
+    while(p < end){
+        const char* backslash = (const char*)memchr(p, '\\', end - p);
+        if(backslash == NULL){
+            out.append(p, end - p);
+            return;
+        }
+
+        out.append(p, backslash - p);
+        p = backslash + 1;
+        if(p == end)
+            throw invalid_argument("Unterminated escape in JSON string.");
+
+        char c = *p++;
+        switch(c){
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                if(end - p < 4)
+                    throw invalid_argument("Truncated \\u escape in JSON string.");
+
+                uint32_t codePoint = parseHex4(p);
+                p += 4;
+
+                if(codePoint >= 0xd800 && codePoint <= 0xdbff
+                   && end - p >= 6 && p[0] == '\\' && p[1] == 'u'){
+                    uint32_t low = parseHex4(p + 2);
+                    if(low >= 0xdc00 && low <= 0xdfff){
+                        codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+                        p += 6;
+                    }
+                }
+
+                if(codePoint >= 0xd800 && codePoint <= 0xdfff)
+                    throw invalid_argument("Unpaired surrogate in JSON string.");
+
+                appendUtf8(out, codePoint);
+                break;
+            }
+            default:
+                throw invalid_argument(string("Invalid escape '\\") + c + "' in JSON string.");
+        }
+    }
+}
+
+} // namespace zsdp
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_JSON_UTIL_H__
+#define __ZSDP_JSON_UTIL_H__
+
+#include <zsdp/string-view.h>
+#include <string>
+
+
+namespace zsdp {
+
+/// Appends s as a quoted JSON string, escaping '"', '\' and control characters.
+void appendJsonString(std::string& out, StringView s);
+
+/**
+ * Unescapes the body of a JSON string (without the quotes) and appends it to
+ * out. \uXXXX escapes, including surrogate pairs, are written as UTF-8.
+ * Throws invalid_argument on malformed escapes.
+ */
+void appendJsonUnescaped(std::string& out, StringView escaped);
+
+} // namespace zsdp
+
+#endif /* __ZSDP_JSON_UTIL_H__ */
@@ -0,0 +1,681 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/json.h>
+#include "json-util.h"
+#include "parsing.h"
+#include "string-util.h"
+#include <stdexcept>
+
+
+using namespace std;
+
+namespace zsdp {
+
+namespace {
+
+/// Writes the members of one JSON object, taking care of the commas.
+class ObjectWriter {
+public:
+    explicit ObjectWriter(string& out) : mOut(out) {
+        mOut += '{';
+    }
+
+    void end(){
+        mOut += '}';
+    }
+
+    string& key(StringView k){
+        if(!mFirst)
+            mOut += ',';
+
+        mFirst = false;
+        mOut += '"';
+        mOut += k;
+        mOut.append("\":", 2);
+
+        return mOut;
+    }
+
+    void field(StringView k, StringView value){
+        appendJsonString(key(k), value);
+    }
+
+    void fieldIfSet(StringView k, const string& value){
+        if(!value.empty())
+            field(k, value);
+    }
+
+    void field(StringView k, uint64_t value){
+        appendUInt(key(k), value);
+    }
+
+    void signedField(StringView k, int64_t value){
+        appendInt(key(k), value);
+    }
+
+private:
+    string& mOut;
+    bool mFirst = true;
+};
+
+void writeConnectionData(string& out, const ConnectionData& cd){
+    ObjectWriter obj(out);
+    obj.field("networkType", networkTypeToString(cd.networkType));
+    obj.field("addressType", addressTypeToString(cd.addressType));
+    obj.field("host", cd.host);
+
+    if(cd.multicastIPv4TTL != 0)
+        obj.field("multicastIPv4TTL", cd.multicastIPv4TTL);
+
+    if(cd.multicastAddressCount != 0)
+        obj.field("multicastAddressCount", cd.multicastAddressCount);
+
+    obj.end();
+}
+
+void writeBandwidth(string& out, const Bandwidth& bandwidth){
+    ObjectWriter obj(out);
+    obj.field("type", bandwidthTypeToString(bandwidth.type));
+    obj.field("kbps", bandwidth.kbps);
+    obj.end();
+}
+
+void writeEncryption(string& out, const Encryption& encryption){
+    ObjectWriter obj(out);
+    obj.field("type", encryptionTypeToString(encryption.type));
+    obj.fieldIfSet("key", encryption.key);
+    obj.end();
+}
+
+void writeAttribute(string& out, const Attribute& attr){
+    ObjectWriter obj(out);
+
+    if(auto rtpMap = attr.as<AttrRtpMap>()){
+        obj.field("key", "rtpmap");
+        obj.field("payloadType", rtpMap->payloadType);
+        obj.field("encodingName", rtpMap->encodingName.view());
+        obj.field("clockRate", rtpMap->clockRate);
+        obj.field("channels", rtpMap->audioChannelCount);
+    }
+    else if(auto fmtp = attr.as<AttrFormatParams>()){
+        obj.field("key", "fmtp");
+        obj.field("payloadType", fmtp->payloadType);
+        obj.field("parameters", fmtp->formatParams);
+    }
+    else if(attr.id() == AttrId::MediaDirection){
+        obj.field("key", attr.key());
+    }
+    else if(auto ptime = attr.as<AttrPTime>()){
+        obj.field("key", "ptime");
+        obj.field("value", ptime->packetDuration);
+    }
+    else if(auto maxPTime = attr.as<AttrMaxPTime>()){
+        obj.field("key", "maxptime");
+        obj.field("value", maxPTime->maxPacketDuration);
+    }
+    else{
+        string line;
+        attr.appendSdpLine(line);
+
+        size_t colon = line.find(':');
+        StringView lineView(line);
+        obj.field("key", lineView.substr(0, colon));
+        if(colon != string::npos)
+            obj.field("value", lineView.substr(colon + 1));
+    }
+
+    obj.end();
+}
+
+void writeAttributes(string& out, const AttributeList& attributes){
+    out += '[';
+    for(size_t i = 0; i < attributes.size(); i++){
+        if(i > 0)
+            out += ',';
+
+        writeAttribute(out, *attributes[i]);
+    }
+
+    out += ']';
+}
+
+void writeStream(string& out, const Stream& stream){
+    ObjectWriter obj(out);
+
+    const MediaDescription& md = stream.mediaDescription;
+    ObjectWriter mdObj(obj.key("mediaDescription"));
+    mdObj.field("mediaType", mediaTypeToString(md.mediaType));
+    mdObj.field("port", md.port);
+    if(md.portCount != 0)
+        mdObj.field("portCount", md.portCount);
+
+    mdObj.field("protocol", protocolToString(md.protocol));
+
+    string& pts = mdObj.key("payloadTypes");
+    pts += '[';
+    for(size_t i = 0; i < md.payloadTypes.size(); i++){
+        if(i > 0)
+            pts += ',';
+
+        appendUInt(pts, md.payloadTypes[i]);
+    }
+
+    pts += ']';
+    mdObj.fieldIfSet("codec", md.codec);
+    mdObj.end();
+
+    obj.fieldIfSet("title", stream.title);
+
+    if(stream.connectionData.addressType != AddressType::NotSet)
+        writeConnectionData(obj.key("connectionData"), stream.connectionData);
+
+    if(stream.bandwidth.type != BandwidthType::NotSet)
+        writeBandwidth(obj.key("bandwidth"), stream.bandwidth);
+
+    if(stream.encryption.type != EncryptionType::NotSet)
+        writeEncryption(obj.key("encryption"), stream.encryption);
+
+    writeAttributes(obj.key("attributes"), stream.attributes);
+    obj.end();
+}
+
+} // namespace
+
+void sdpToJson(const Sdp& sdp, string& out){
+    ObjectWriter obj(out);
+    obj.field("version", sdp.version);
+
+    ObjectWriter origin(obj.key("origin"));
+    origin.field("username", sdp.origin.username);
+    origin.field("sessionID", sdp.origin.sessionID);
+    origin.field("sessionVersion", sdp.origin.sessionVersion);
+    origin.field("networkType", networkTypeToString(sdp.origin.networkType));
+    origin.field("addressType", addressTypeToString(sdp.origin.addressType));
+    origin.field("host", sdp.origin.host);
+    origin.end();
+
+    obj.field("sessionName", sdp.sessionName);
+    obj.fieldIfSet("sessionInformation", sdp.sessionInformation);
+    obj.fieldIfSet("uri", sdp.uri);
+    obj.fieldIfSet("email", sdp.email);
+    obj.fieldIfSet("phoneNumber", sdp.phoneNumber);
+
+    if(sdp.connectionData.addressType != AddressType::NotSet)
+        writeConnectionData(obj.key("connectionData"), sdp.connectionData);
+
+    if(sdp.bandwidth.type != BandwidthType::NotSet)
+        writeBandwidth(obj.key("bandwidth"), sdp.bandwidth);
+
+    string& times = obj.key("times");
+    times += '[';
+    for(size_t i = 0; i < sdp.times.size(); i++){
+        if(i > 0)
+            times += ',';
+
+        const Timing& timing = sdp.times[i];
+        ObjectWriter timingObj(times);
+        timingObj.field("start", timing.start);
+        timingObj.field("end", timing.end);
+
+        if(!timing.repeatingTimes.empty()){
+            string& repeats = timingObj.key("repeatingTimes");
+            repeats += '[';
+            for(size_t j = 0; j < timing.repeatingTimes.size(); j++){
+                if(j > 0)
+                    repeats += ',';
+
+                const RepeatingTime& rt = timing.repeatingTimes[j];
+                ObjectWriter rtObj(repeats);
+                rtObj.field("interval", rt.interval);
+                rtObj.field("duration", rt.duration);
+
+                string& offsets = rtObj.key("offsetsFromStartTime");
+                offsets += '[';
+                for(size_t k = 0; k < rt.offsetsFromStartTime.size(); k++){
+                    if(k > 0)
+                        offsets += ',';
+
+                    appendUInt(offsets, rt.offsetsFromStartTime[k]);
+                }
+
+                offsets += ']';
+                rtObj.end();
+            }
+
+            repeats += ']';
+        }
+
+        timingObj.end();
+    }
+
+    times += ']';
+
+    if(!sdp.timeZoneAdjustments.empty()){
+        string& adjustments = obj.key("timeZoneAdjustments");
+        adjustments += '[';
+        for(size_t i = 0; i < sdp.timeZoneAdjustments.size(); i++){
+            if(i > 0)
+                adjustments += ',';
+
+            ObjectWriter adjObj(adjustments);
+            adjObj.field("adjustAtTime", sdp.timeZoneAdjustments[i].adjustAtTime);
+            adjObj.signedField("adjustment", sdp.timeZoneAdjustments[i].adjustment);
+            adjObj.end();
+        }
+
+        adjustments += ']';
+    }
+
+    if(sdp.encryption.type != EncryptionType::NotSet)
+        writeEncryption(obj.key("encryption"), sdp.encryption);
+
+    writeAttributes(obj.key("attributes"), sdp.attributes);
+
+    string& streams = obj.key("streams");
+    streams += '[';
+    for(size_t i = 0; i < sdp.streams.size(); i++){
+        if(i > 0)
+            streams += ',';
+
+        writeStream(streams, sdp.streams[i]);
+    }
+
+    streams += ']';
+    obj.end();
+}
+
+
+namespace {
+
+/// Pull parser over a JSON document. String values are unescaped only when they contain escapes.
+class JsonReader {
+public:
+    explicit JsonReader(StringView json) : mPos(json.begin()), mEnd(json.end()) {}
+
+    char peek(){
+        skipWhitespace();
+        if(mPos == mEnd)
+            fail("Unexpected end of JSON.");
+
+        return *mPos;
+    }
+
+    void expect(char c){
+        if(peek() != c)
+            fail(string("Expected '") + c + "' in JSON.");
+
+        mPos++;
+    }
+
+    bool tryConsume(char c){
+        if(peek() != c)
+            return false;
+
+        mPos++;
+        return true;
+    }
+
+    void expectEnd(){
+        skipWhitespace();
+        if(mPos != mEnd)
+            fail("Trailing characters after JSON document.");
+    }
+
+    /// Calls onMember(key) for each member; onMember must consume the value.
+    template<typename Fnc>
+    void readObject(Fnc onMember){
+        expect('{');
+        if(tryConsume('}'))
+            return;
+
+        do {
+            StringView key = readRawString();
+            expect(':');
+            onMember(key);
+        } while(tryConsume(','));
+
+        expect('}');
+    }
+
+    /// Calls onElement() for each element; onElement must consume the value.
+    template<typename Fnc>
+    void readArray(Fnc onElement){
+        expect('[');
+        if(tryConsume(']'))
+            return;
+
+        do {
+            onElement();
+        } while(tryConsume(','));
+
+        expect(']');
+    }
+
+    void readString(string& out){
+        out.clear();
+        appendJsonUnescaped(out, readRawString());
+    }
+
+    string readString(){
+        string s;
+        readString(s);
+
+        return s;
+    }
+
+    uint64_t readUInt(){
+        StringView digits = readNumberToken();
+        if(digits.empty() || digits[0] == '-')
+            fail("Expected an unsigned integer in JSON.");
+
+        uint64_t value = 0;
+        for(char c : digits){
+            if(c < '0' || c > '9' || value > (UINT64_MAX - 9) / 10)
+                fail("Expected an unsigned integer in JSON.");
+
+            value = value * 10 + (c - '0');
+        }
+
+        return value;
+    }
+
+    int64_t readInt(){
+        if(peek() != '-')
+            return (int64_t)readUInt();
+
+        mPos++;
+        return -(int64_t)readUInt();
+    }
+
+    /// A string or number value, as text.
+    void readScalarText(string& out){
+        if(peek() == '"')
+            readString(out);
+        else{
+            StringView token = readNumberToken();
+            out.assign(token.data(), token.size());
+        }
+    }
+
+    void skipValue(){
+        char c = peek();
+        if(c == '{')
+            readObject([&](StringView){ skipValue(); });
+        else if(c == '[')
+            readArray([&](){ skipValue(); });
+        else if(c == '"')
+            readRawString();
+        else
+            readNumberToken();
+    }
+
+private:
+    void skipWhitespace(){
+        while(mPos < mEnd && (*mPos == ' ' || *mPos == '\t' || *mPos == '\n' || *mPos == '\r'))
+            mPos++;
+    }
+
+    /// The still-escaped body of a string value.
+    StringView readRawString(){
+        expect('"');
+        const char* start = mPos;
+
+        while(true){
+            const char* quote = (const char*)memchr(mPos, '"', mEnd - mPos);
+            if(quote == NULL)
+                fail("Unterminated string in JSON.");
+
+            // The quote is escaped if preceded by an odd number of backslashes.
+            size_t backslashes = 0;
+            while(quote - backslashes > start && quote[-1 - (ptrdiff_t)backslashes] == '\\')
+                backslashes++;
+
+            mPos = quote + 1;
+            if(backslashes % 2 == 0)
+                return StringView(start, quote - start);
+        }
+    }
+
+    /// Numbers, true, false and null.
+    StringView readNumberToken(){
+        skipWhitespace();
+        const char* start = mPos;
+        while(mPos < mEnd && *mPos != ',' && *mPos != '}' && *mPos != ']'
+              && *mPos != ' ' && *mPos != '\n' && *mPos != '\r' && *mPos != '\t')
+            mPos++;
+
+        if(mPos == start)
+            fail("Expected a value in JSON.");
+
+        return StringView(start, mPos - start);
+    }
+
+    [[noreturn]] void fail(const string& message){
+        throw invalid_argument(message);
+    }
+
+    const char* mPos;
+    const char* mEnd;
+};
+
+void readConnectionData(JsonReader& r, ConnectionData& cd){
+    string s;
+    r.readObject([&](StringView key){
+        if(key == "networkType"){ r.readString(s); cd.networkType = networkTypeForStr(s); }
+        else if(key == "addressType"){ r.readString(s); cd.addressType = addressTypeForStr(s); }
+        else if(key == "host") r.readString(cd.host);
+        else if(key == "multicastIPv4TTL") cd.multicastIPv4TTL = (uint8_t)r.readUInt();
+        else if(key == "multicastAddressCount") cd.multicastAddressCount = (uint32_t)r.readUInt();
+        else r.skipValue();
+    });
+}
+
+void readBandwidth(JsonReader& r, Bandwidth& bandwidth){
+    string s;
+    r.readObject([&](StringView key){
+        if(key == "type"){ r.readString(s); bandwidth.type = bandwidthTypeForStr(s); }
+        else if(key == "kbps") bandwidth.kbps = r.readUInt();
+        else r.skipValue();
+    });
+}
+
+void readEncryption(JsonReader& r, Encryption& encryption){
+    string s;
+    r.readObject([&](StringView key){
+        if(key == "type"){ r.readString(s); encryption.type = encryptionTypeForStr(s); }
+        else if(key == "key") r.readString(encryption.key);
+        else r.skipValue();
+    });
+}
+
+sp<Attribute> readAttribute(JsonReader& r){
+    string key;
+    string value;
+    string encodingName;
+    bool hasValue = false;
+    bool hasEncodingName = false;
+    bool hasParameters = false;
+    uint8_t payloadType = kPayloadType_NotSet;
+    uint32_t clockRate = 0;
+    uint32_t channels = 0;
+
+    r.readObject([&](StringView field){
+        if(field == "key") r.readString(key);
+        else if(field == "value"){ r.readScalarText(value); hasValue = true; }
+        else if(field == "parameters"){ r.readString(value); hasParameters = true; }
+        else if(field == "payloadType") payloadType = (uint8_t)r.readUInt();
+        else if(field == "encodingName"){ r.readString(encodingName); hasEncodingName = true; }
+        else if(field == "clockRate") clockRate = (uint32_t)r.readUInt();
+        else if(field == "channels") channels = (uint32_t)r.readUInt();
+        else r.skipValue();
+    });
+
+    if(key.empty())
+        throw invalid_argument("JSON attribute without a key.");
+
+    if(key == "rtpmap" && hasEncodingName){
+        auto attr = make_shared<AttrRtpMap>();
+        attr->payloadType = payloadType;
+        attr->encodingName = encodingName;
+        attr->clockRate = clockRate;
+        attr->audioChannelCount = channels;
+
+        return attr;
+    }
+
+    if(key == "fmtp" && hasParameters){
+        auto attr = make_shared<AttrFormatParams>();
+        attr->payloadType = payloadType;
+        attr->formatParams = value;
+
+        return attr;
+    }
+
+    if(hasValue){
+        key += ':';
+        key += value;
+    }
+
+    return parseAttribute(key);
+}
+
+void readAttributes(JsonReader& r, AttributeList& attributes){
+    r.readArray([&](){
+        attributes.push_back(readAttribute(r));
+    });
+}
+
+void readStream(JsonReader& r, Stream& stream){
+    string s;
+    MediaDescription& md = stream.mediaDescription;
+
+    r.readObject([&](StringView key){
+        if(key == "mediaDescription"){
+            r.readObject([&](StringView mdKey){
+                if(mdKey == "mediaType"){ r.readString(s); md.mediaType = mediaTypeForStr(s); }
+                else if(mdKey == "port") md.port = (uint16_t)r.readUInt();
+                else if(mdKey == "portCount") md.portCount = (uint16_t)r.readUInt();
+                else if(mdKey == "protocol"){ r.readString(s); md.protocol = protocolForStr(s); }
+                else if(mdKey == "payloadTypes"){
+                    r.readArray([&](){
+                        uint64_t pt = r.readUInt();
+                        if(pt > kMaxPayloadType)
+                            throw out_of_range("Payload type " + to_string(pt) + " is out-of-range.");
+
+                        md.addPayloadType((uint8_t)pt);
+                    });
+                }
+                else if(mdKey == "codec"){ r.readString(s); md.codec = s; }
+                else r.skipValue();
+            });
+        }
+        else if(key == "title") r.readString(stream.title);
+        else if(key == "connectionData") readConnectionData(r, stream.connectionData);
+        else if(key == "bandwidth") readBandwidth(r, stream.bandwidth);
+        else if(key == "encryption") readEncryption(r, stream.encryption);
+        else if(key == "attributes") readAttributes(r, stream.attributes);
+        else r.skipValue();
+    });
+}
+
+} // namespace
+
+Sdp sdpFromJson(StringView json){
+    JsonReader r(json);
+    Sdp sdp;
+    string s;
+
+    r.readObject([&](StringView key){
+        if(key == "version") sdp.version = (uint32_t)r.readUInt();
+        else if(key == "origin"){
+            r.readObject([&](StringView originKey){
+                Origin& origin = sdp.origin;
+                if(originKey == "username") r.readString(origin.username);
+                else if(originKey == "sessionID") r.readString(origin.sessionID);
+                else if(originKey == "sessionVersion") r.readString(origin.sessionVersion);
+                else if(originKey == "networkType"){ r.readString(s); origin.networkType = networkTypeForStr(s); }
+                else if(originKey == "addressType"){ r.readString(s); origin.addressType = addressTypeForStr(s); }
+                else if(originKey == "host") r.readString(origin.host);
+                else r.skipValue();
+            });
+        }
+        else if(key == "sessionName") r.readString(sdp.sessionName);
+        else if(key == "sessionInformation") r.readString(sdp.sessionInformation);
+        else if(key == "uri") r.readString(sdp.uri);
+        else if(key == "email") r.readString(sdp.email);
+        else if(key == "phoneNumber") r.readString(sdp.phoneNumber);
+        else if(key == "connectionData") readConnectionData(r, sdp.connectionData);
+        else if(key == "bandwidth") readBandwidth(r, sdp.bandwidth);
+        else if(key == "times"){
+            r.readArray([&](){
+                sdp.times.emplace_back();
+                Timing& timing = sdp.times.back();
+
+                r.readObject([&](StringView timingKey){
+                    if(timingKey == "start") timing.start = r.readUInt();
+                    else if(timingKey == "end") timing.end = r.readUInt();
+                    else if(timingKey == "repeatingTimes"){
+                        r.readArray([&](){
+                            timing.repeatingTimes.emplace_back();
+                            RepeatingTime& rt = timing.repeatingTimes.back();
+
+                            r.readObject([&](StringView rtKey){
+                                if(rtKey == "interval") rt.interval = r.readUInt();
+                                else if(rtKey == "duration") rt.duration = r.readUInt();
+                                else if(rtKey == "offsetsFromStartTime")
+                                    r.readArray([&](){ rt.offsetsFromStartTime.push_back(r.readUInt()); });
+                                else r.skipValue();
+                            });
+                        });
+                    }
+                    else r.skipValue();
+                });
+            });
+        }
+        else if(key == "timeZoneAdjustments"){
+            r.readArray([&](){
+                TimeZoneAdjustment adj;
+                r.readObject([&](StringView adjKey){
+                    if(adjKey == "adjustAtTime") adj.adjustAtTime = r.readUInt();
+                    else if(adjKey == "adjustment") adj.adjustment = r.readInt();
+                    else r.skipValue();
+                });
+
+                sdp.timeZoneAdjustments.push_back(adj);
+            });
+        }
+        else if(key == "encryption") readEncryption(r, sdp.encryption);
+        else if(key == "attributes") readAttributes(r, sdp.attributes);
+        else if(key == "streams"){
+            r.readArray([&](){
+                sdp.streams.emplace_back();
+                readStream(r, sdp.streams.back());
+                sdp.streams.back().reindexAttributes();
+            });
+        }
+        else r.skipValue();
+    });
+
+    r.expectEnd();
+
+    return sdp;
+}
+
+} // namespace zsdp
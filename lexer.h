@@ -0,0 +1,165 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_LEXER_H__
+#define __ZSDP_LEXER_H__
+
+#include <zsdp/string-view.h>
+#include "json-util.h"
+#include <string.h>
+#include <string>
+
+
+namespace zsdp {
+
+/**
+ * One "<type>=<value>" line. type is 0 for lines that are not of that form.
+ */
+struct SdpLine {
+    char type = 0;
+    StringView value;
+    StringView raw; /// the whole line, without its line ending
+};
+
+/**
+ * Splits an SDP buffer into lines without copying. Accepts CRLF and bare LF
+ * line endings and skips empty lines. Never allocates or throws.
+ */
+class SdpLexer {
+public:
+    SdpLexer(const char* data, size_t size) noexcept
+        : mPos(data), mEnd(data + size) {}
+
+    explicit SdpLexer(StringView sdp) noexcept
+        : SdpLexer(sdp.data(), sdp.size()) {}
+
+    bool next(SdpLine* line) noexcept {
+        while(mPos < mEnd){
+            const char* lineStart = mPos;
+            const char* nl = (const char*)memchr(mPos, '\n', mEnd - mPos);
+            const char* lineEnd = nl ? nl : mEnd;
+            mPos = nl ? nl + 1 : mEnd;
+
+            if(lineEnd > lineStart && lineEnd[-1] == '\r')
+                lineEnd--;
+
+            size_t size = lineEnd - lineStart;
+            if(size == 0)
+                continue;
+
+            line->raw = StringView(lineStart, size);
+            if(size >= 2 && lineStart[1] == '='){
+                line->type = lineStart[0];
+                line->value = StringView(lineStart + 2, size - 2);
+            }
+            else{
+                line->type = 0;
+                line->value = line->raw;
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    /// The next unread byte.
+    const char* position() const noexcept { return mPos; }
+
+private:
+    const char* mPos;
+    const char* mEnd;
+};
+
+/**
+ * SdpLexer for the body of a JSON string literal. Lines end at "\r\n", "\n"
+ * or "\r" escapes. A line without any other escape is returned as a view into
+ * the input; only lines containing escapes are unescaped, into a buffer owned
+ * by the lexer that is overwritten by the next call. Throws invalid_argument
+ * on malformed escapes.
+ */
+class JsonStringLexer {
+public:
+    JsonStringLexer(const char* data, size_t size)
+        : mPos(data), mEnd(data + size) {}
+
+    explicit JsonStringLexer(StringView escapedSdp)
+        : JsonStringLexer(escapedSdp.data(), escapedSdp.size()) {}
+
+    bool next(SdpLine* line){
+        while(mPos < mEnd){
+            const char* lineStart = mPos;
+            const char* lineEnd = mEnd;
+            const char* nextLine = mEnd;
+            bool hasEscapes = false;
+
+            const char* p = mPos;
+            while(p < mEnd){
+                const char* backslash = (const char*)memchr(p, '\\', mEnd - p);
+                if(backslash == NULL)
+                    break;
+
+                char escaped = backslash + 1 < mEnd ? backslash[1] : 0;
+                if(escaped == 'n' || escaped == 'r'){
+                    lineEnd = backslash;
+                    nextLine = backslash + 2;
+                    break;
+                }
+
+                // Skipping the escaped character keeps "\\n" (a backslash, then 'n') on this line.
+                hasEscapes = true;
+                p = backslash + 2;
+            }
+
+            mPos = nextLine;
+            if(lineEnd == lineStart)
+                continue;
+
+            StringView raw(lineStart, lineEnd - lineStart);
+            if(hasEscapes){
+                mScratch.clear();
+                appendJsonUnescaped(mScratch, raw);
+                raw = StringView(mScratch);
+            }
+
+            line->raw = raw;
+            if(raw.size() >= 2 && raw[1] == '='){
+                line->type = raw[0];
+                line->value = raw.substr(2);
+            }
+            else{
+                line->type = 0;
+                line->value = raw;
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    const char* mPos;
+    const char* mEnd;
+    std::string mScratch;
+};
+
+} // namespace zsdp
+
+#endif /* __ZSDP_LEXER_H__ */
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/negotiation-cache.h>
+#include <string.h>
+
+
+using namespace std;
+
+namespace zsdp {
+
+namespace {
+
+/// A multiply-xorshift hash taken 8 bytes at a time. Strings are length-prefixed so adjacent fields can't run together.
+class Fingerprint {
+public:
+    void add(uint64_t value){
+        mHash = (mHash ^ value) * 0x9e3779b97f4a7c15ULL;
+        mHash ^= mHash >> 29;
+    }
+
+    void add(StringView s){
+        add((uint64_t)s.size());
+
+        size_t i = 0;
+        for(; i + 8 <= s.size(); i += 8){
+            uint64_t word;
+            memcpy(&word, s.data() + i, 8);
+            add(word);
+        }
+
+        if(i < s.size()){
+            uint64_t word = 0;
+            memcpy(&word, s.data() + i, s.size() - i);
+            add(word);
+        }
+    }
+
+    uint64_t value() const{ return mHash; }
+
+private:
+    uint64_t mHash = 14695981039346656037ULL;
+};
+
+/// Adds the attributes negotiation looks at, tagged with their AttrId.
+void addAttributes(Fingerprint& fingerprint, const AttributeList& attributes){
+    for(const sp<Attribute>& attr : attributes){
+        switch(attr->id()){
+            case AttrId::RtpMap: {
+                const AttrRtpMap& rtpMap = static_cast<const AttrRtpMap&>(*attr);
+                fingerprint.add((uint64_t)AttrId::RtpMap);
+                fingerprint.add(rtpMap.payloadType);
+                fingerprint.add(rtpMap.encodingName.view());
+                fingerprint.add(((uint64_t)rtpMap.clockRate << 32) | rtpMap.audioChannelCount);
+                break;
+            }
+            case AttrId::FormatParams: {
+                const AttrFormatParams& fmtp = static_cast<const AttrFormatParams&>(*attr);
+                fingerprint.add((uint64_t)AttrId::FormatParams);
+                fingerprint.add(fmtp.payloadType);
+                fingerprint.add(fmtp.formatParams);
+                break;
+            }
+            case AttrId::MediaDirection:
+                fingerprint.add((uint64_t)AttrId::MediaDirection);
+                fingerprint.add((uint64_t)static_cast<const AttrMediaDirection&>(*attr).direction);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+} // namespace
+
+uint64_t negotiationFingerprint(const Sdp& offer){
+    Fingerprint fingerprint;
+    addAttributes(fingerprint, offer.attributes);
+    fingerprint.add(offer.streams.size());
+
+    for(const Stream& stream : offer.streams){
+        const MediaDescription& md = stream.mediaDescription;
+        fingerprint.add(((uint64_t)md.mediaType << 16) | ((uint64_t)md.protocol << 8) | (md.port == 0 ? 1 : 0));
+        fingerprint.add(StringView((const char*)md.payloadTypes.data(), md.payloadTypes.size()));
+        fingerprint.add(md.codec.view());
+        addAttributes(fingerprint, stream.attributes);
+    }
+
+    return fingerprint.value();
+}
+
+double NegotiationCacheStats::hitRatio() const{
+    size_t lookups = hits + misses;
+    return lookups == 0 ? 0.0 : (double)hits / lookups;
+}
+
+NegotiationCache::NegotiationCache(size_t capacity) : mCapacity(capacity) {}
+
+sp<const Sdp> NegotiationCache::skeleton(const Negotiator& negotiator, const Sdp& offer){
+    Key key = { negotiationFingerprint(offer), negotiator.profileId() };
+
+    {
+        lock_guard<mutex> lock(mMutex);
+        auto it = mEntries.find(key);
+        if(it != mEntries.end()){
+            mStats.hits++;
+            return it->second;
+        }
+
+        mStats.misses++;
+    }
+
+    // Negotiate outside the lock; two threads missing on the same key both do, and one result is kept.
+    auto answer = make_shared<Sdp>(negotiator.answer(offer));
+    answer->times.clear();
+
+    lock_guard<mutex> lock(mMutex);
+    if(mEntries.size() >= mCapacity)
+        mEntries.clear();
+
+    return mEntries.emplace(key, std::move(answer)).first->second;
+}
+
+Sdp NegotiationCache::answer(const Negotiator& negotiator, const Sdp& offer){
+    Sdp answer = *skeleton(negotiator, offer);
+
+    // The t= line must match the offer's (RFC 3264 section 6).
+    answer.times = offer.times;
+    if(answer.times.empty())
+        answer.times.emplace_back();
+
+    return answer;
+}
+
+Sdp NegotiationCache::answer(const Negotiator& negotiator, const Sdp& offer, const AnswerTransport& transport){
+    Sdp result = answer(negotiator, offer);
+    applyTransport(result, transport);
+
+    return result;
+}
+
+void NegotiationCache::clear(){
+    lock_guard<mutex> lock(mMutex);
+    mEntries.clear();
+}
+
+size_t NegotiationCache::size() const{
+    lock_guard<mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+NegotiationCacheStats NegotiationCache::stats() const{
+    lock_guard<mutex> lock(mMutex);
+    NegotiationCacheStats stats = mStats;
+    stats.entries = mEntries.size();
+
+    return stats;
+}
+
+} // namespace zsdp
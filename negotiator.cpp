@@ -0,0 +1,328 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/negotiator.h>
+#include <zsdp/payload-table.h>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string.h>
+
+
+using namespace std;
+
+namespace zsdp {
+
+constexpr size_t Negotiator::kMediaTypeCount;
+constexpr uint8_t Negotiator::kNoCodec;
+
+namespace {
+
+/// FNV-1a over the lower-cased name, so names that differ only in case collide on purpose.
+uint32_t nameHash(StringView name){
+    uint32_t hash = 2166136261u;
+    for(char c : name){
+        if(c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+
+        hash = (hash ^ (uint8_t)c) * 16777619u;
+    }
+
+    return hash;
+}
+
+enum DirectionBits : uint8_t {
+    kSend = 1,
+    kReceive = 2,
+};
+
+uint8_t directionBits(MediaDirection direction){
+    switch(direction){
+        case MediaDirection::SendRecv: return kSend | kReceive;
+        case MediaDirection::SendOnly: return kSend;
+        case MediaDirection::RecvOnly: return kReceive;
+        default: return 0;
+    }
+}
+
+MediaDirection directionFromBits(uint8_t bits){
+    switch(bits){
+        case kSend | kReceive: return MediaDirection::SendRecv;
+        case kSend: return MediaDirection::SendOnly;
+        case kReceive: return MediaDirection::RecvOnly;
+        default: return MediaDirection::Inactive;
+    }
+}
+
+/// The direction attribute in attributes, or fallback if there is none.
+MediaDirection directionIn(const AttributeList& attributes, MediaDirection fallback){
+    for(const sp<Attribute>& attr : attributes){
+        if(const AttrMediaDirection* direction = attr->as<AttrMediaDirection>())
+            return direction->direction;
+    }
+
+    return fallback;
+}
+
+bool isRtp(Protocol protocol){
+    return protocol == Protocol::RTP_AVP || protocol == Protocol::RTP_SAVP;
+}
+
+atomic<uint64_t> gNextProfileId(1);
+
+/// The offered H.264 parameters for pt; RFC 6184's defaults if it has no fmtp.
+H264Params offeredH264Params(const Stream& stream, uint8_t pt){
+    H264Params h264;
+    for(const AttrFormatParams& fmtp : stream.findAll<AttrFormatParams>()){
+        if(fmtp.payloadType == pt){
+            parseH264Params(fmtp.params(), &h264);
+            break;
+        }
+    }
+
+    return h264;
+}
+
+} // namespace
+
+void applyTransport(Sdp& answer, const AnswerTransport& transport){
+    answer.origin = transport.origin;
+    answer.connectionData = transport.connectionData;
+
+    for(size_t i = 0; i < answer.streams.size(); i++){
+        Stream& stream = answer.streams[i];
+        stream.connectionData = transport.connectionData;
+
+        if(stream.mediaDescription.port != 0)
+            stream.mediaDescription.port = (uint16_t)(transport.firstPort + i * transport.portSpacing);
+    }
+}
+
+Negotiator::Negotiator(const LocalCapabilities& local) : mLocal(local), mProfileId(gNextProfileId++) {
+    if(mLocal.codecs.size() >= kNoCodec)
+        throw invalid_argument("At most " + to_string(kNoCodec - 1) + " local codecs are supported.");
+
+    memset(mStatic, kNoCodec, sizeof(mStatic));
+    mH264.resize(mLocal.codecs.size());
+
+    for(size_t i = 0; i < mLocal.codecs.size(); i++){
+        const LocalCodec& codec = mLocal.codecs[i];
+        size_t type = (size_t)codec.mediaType;
+        if(codec.mediaType == MediaType::NotSet || type >= kMediaTypeCount)
+            throw invalid_argument("Local codec " + codec.encodingName.str() + " has no media type.");
+
+        CompiledCodec compiled;
+        compiled.nameHash = nameHash(codec.encodingName.view());
+        compiled.clockRate = codec.clockRate;
+        compiled.channels = codec.channels;
+        compiled.codec = (uint8_t)i;
+        compiled.isH264 = codec.encodingName.equalsIgnoreCase("H264");
+        mCompiled[type].push_back(compiled);
+
+        if(compiled.isH264 && !parseH264Params(FormatParamMap(codec.formatParams), &mH264[i]))
+            throw invalid_argument("Local H264 codec has an invalid profile-level-id: " + codec.formatParams);
+
+        // Offers may use a static payload type without an rtpmap; the first local codec that fits wins.
+        for(uint8_t pt = 0; pt <= kMaxPayloadType; pt++){
+            const PayloadInfo& info = PayloadTable::staticPayloadType(pt);
+            if(info.defined
+               && mStatic[type][pt] == kNoCodec
+               && info.clockRate == codec.clockRate
+               && (info.channels == 0 || info.channels == codec.channels)
+               && info.encodingName.equalsIgnoreCase(codec.encodingName))
+                mStatic[type][pt] = (uint8_t)i;
+        }
+    }
+
+    // stable_sort keeps the first of two identical local codecs first, so lookup() returns it.
+    for(vector<CompiledCodec>& compiled : mCompiled){
+        stable_sort(compiled.begin(), compiled.end(), [](const CompiledCodec& a, const CompiledCodec& b){
+            return a.nameHash < b.nameHash;
+        });
+    }
+
+    static const MediaDirection directions[] = {
+        MediaDirection::SendRecv, MediaDirection::SendOnly, MediaDirection::RecvOnly, MediaDirection::Inactive
+    };
+
+    for(MediaDirection direction : directions){
+        auto attr = make_shared<AttrMediaDirection>();
+        attr->direction = direction;
+        mDirections[(size_t)direction] = attr;
+    }
+}
+
+uint8_t Negotiator::lookup(const Stream& stream, const AttrRtpMap& rtpMap) const{
+    const vector<CompiledCodec>& compiled = mCompiled[(size_t)stream.mediaDescription.mediaType];
+    uint32_t hash = nameHash(rtpMap.encodingName.view());
+
+    auto it = lower_bound(compiled.begin(), compiled.end(), hash, [](const CompiledCodec& c, uint32_t h){
+        return c.nameHash < h;
+    });
+
+    bool haveH264 = false;
+    H264Params h264;
+
+    for(; it != compiled.end() && it->nameHash == hash; ++it){
+        if(it->clockRate != rtpMap.clockRate
+           || it->channels != rtpMap.audioChannelCount
+           || !mLocal.codecs[it->codec].encodingName.equalsIgnoreCase(rtpMap.encodingName))
+            continue;
+
+        if(it->isH264){
+            if(!haveH264){
+                h264 = offeredH264Params(stream, rtpMap.payloadType);
+                haveH264 = true;
+            }
+
+            if(!h264.sameCodec(mH264[it->codec]))
+                continue;
+        }
+
+        return it->codec;
+    }
+
+    return kNoCodec;
+}
+
+void Negotiator::matchAll(const Stream& stream, uint8_t codecFor[kMaxPayloadType + 1]) const{
+    memset(codecFor, kNoCodec, kMaxPayloadType + 1);
+
+    MediaType mediaType = stream.mediaDescription.mediaType;
+    if((size_t)mediaType >= kMediaTypeCount)
+        return;
+
+    const PayloadTypeSet& offered = stream.mediaDescription.payloadTypeSet;
+    PayloadTypeSet mapped;
+
+    for(const AttrRtpMap& rtpMap : stream.findAll<AttrRtpMap>()){
+        if(!offered.contains(rtpMap.payloadType) || mapped.contains(rtpMap.payloadType))
+            continue;
+
+        mapped.insert(rtpMap.payloadType);
+        codecFor[rtpMap.payloadType] = lookup(stream, rtpMap);
+    }
+
+    (offered - mapped).forEach([&](uint8_t pt){
+        codecFor[pt] = mStatic[(size_t)mediaType][pt];
+    });
+}
+
+const LocalCodec* Negotiator::match(const Stream& stream, uint8_t pt) const{
+    if(pt > kMaxPayloadType)
+        return NULL;
+
+    uint8_t codecFor[kMaxPayloadType + 1];
+    matchAll(stream, codecFor);
+
+    return codecFor[pt] == kNoCodec ? NULL : &mLocal.codecs[codecFor[pt]];
+}
+
+void Negotiator::answerStream(const Stream& offered, MediaDirection offeredDirection, size_t index, Stream& answer) const{
+    const MediaDescription& offeredMd = offered.mediaDescription;
+    MediaDescription& md = answer.mediaDescription;
+    md.mediaType = offeredMd.mediaType;
+    md.protocol = offeredMd.protocol;
+    answer.connectionData = mLocal.connectionData;
+
+    if(offeredMd.port != 0 && isRtp(offeredMd.protocol)){
+        uint8_t codecFor[kMaxPayloadType + 1];
+        matchAll(offered, codecFor);
+
+        for(uint8_t pt : offeredMd.payloadTypes){
+            uint8_t codec = codecFor[pt & kMaxPayloadType];
+            if(codec == kNoCodec || md.payloadTypeSet.contains(pt))
+                continue;
+
+            const LocalCodec& local = mLocal.codecs[codec];
+            md.addPayloadType(pt);
+
+            auto rtpMap = make_shared<AttrRtpMap>();
+            rtpMap->payloadType = pt;
+            rtpMap->encodingName = local.encodingName;
+            rtpMap->clockRate = local.clockRate;
+            rtpMap->audioChannelCount = local.channels;
+            answer.attributes.push_back(std::move(rtpMap));
+
+            if(!local.formatParams.empty()){
+                auto fmtp = make_shared<AttrFormatParams>();
+                fmtp->payloadType = pt;
+                fmtp->formatParams = local.formatParams;
+                answer.attributes.push_back(std::move(fmtp));
+            }
+        }
+    }
+
+    if(md.payloadTypes.empty()){
+        // Rejected: port 0, but still a valid m= line with one of the offered formats (RFC 3264 section 6).
+        md.port = 0;
+        answer.attributes.clear();
+
+        if(isRtp(offeredMd.protocol) && !offeredMd.payloadTypes.empty())
+            md.addPayloadType(offeredMd.payloadTypes[0]);
+        else
+            md.codec = offeredMd.codec;
+
+        answer.reindexAttributes();
+        return;
+    }
+
+    md.port = (uint16_t)(mLocal.firstPort + index * mLocal.portSpacing);
+
+    // What they send, we receive, and the other way round.
+    uint8_t theirs = directionBits(offeredDirection);
+    uint8_t inverted = ((theirs & kSend) ? kReceive : 0) | ((theirs & kReceive) ? kSend : 0);
+    MediaDirection direction = directionFromBits(inverted & directionBits(mLocal.direction));
+    answer.attributes.push_back(mDirections[(size_t)direction]);
+
+    answer.reindexAttributes();
+}
+
+Sdp Negotiator::answer(const Sdp& offer) const{
+    Sdp answer;
+    answer.origin = mLocal.origin;
+    answer.sessionName = mLocal.sessionName;
+    answer.connectionData = mLocal.connectionData;
+
+    // The t= line must match the offer's (RFC 3264 section 6).
+    answer.times = offer.times;
+    if(answer.times.empty())
+        answer.times.emplace_back();
+
+    MediaDirection sessionDirection = directionIn(offer.attributes, MediaDirection::SendRecv);
+
+    answer.streams.resize(offer.streams.size());
+    for(size_t i = 0; i < offer.streams.size(); i++){
+        const Stream& offered = offer.streams[i];
+        const AttrMediaDirection* direction = offered.find<AttrMediaDirection>();
+
+        answerStream(offered, direction != NULL ? direction->direction : sessionDirection, i, answer.streams[i]);
+    }
+
+    return answer;
+}
+
+Sdp Negotiator::answer(const Sdp& offer, const AnswerTransport& transport) const{
+    Sdp result = answer(offer);
+    applyTransport(result, transport);
+
+    return result;
+}
+
+} // namespace zsdp
@@ -20,6 +20,9 @@
 #include "parsing.h"
 #include "string-util.h"
 #include "net-util.h"
+#include "lexer.h"
+#include <zsdp/intern.h>
+#include <stdexcept>
 
 
 using namespace std;
@@ -27,6 +30,99 @@ using namespace std;
 
 namespace zsdp {
 
+namespace {
+
+/// Assigns without giving up the capacity s already has.
+void assignView(string& s, StringView v){
+    s.assign(v.data(), v.size());
+}
+
+const string& scratchText(string& scratch, StringView v){
+    assignView(scratch, v);
+    return scratch;
+}
+
+/*
+ * The *Into() parsers fill an existing object, reusing its strings and
+ * vectors, and only use scratch for the short tokens passed to the
+ * string-based helpers. parseSdpInto() relies on them to avoid allocating.
+ */
+
+void parseOriginInto(StringView line, Origin& origin, string& scratch){
+    StringView tokens[6];
+    if(splitFields(line, ' ', tokens, 6) < 6)
+        throw invalid_argument("Failed to parse origin.");
+
+    assignView(origin.username, tokens[0]);
+    assignView(origin.sessionID, tokens[1]);
+    assignView(origin.sessionVersion, tokens[2]);
+    origin.networkType = networkTypeForStr(scratchText(scratch, tokens[3]));
+    origin.addressType = addressTypeForStr(scratchText(scratch, tokens[4]));
+    assignView(origin.host, tokens[5]);
+}
+
+void parseConnectionDataInto(StringView line, ConnectionData& cd, string& scratch){
+    StringView tokens[3];
+    if(splitFields(line, ' ', tokens, 3) < 3){
+        throw invalid_argument("Error parrsing connection data: " + line.str());
+    }
+
+    cd.networkType = networkTypeForStr(scratchText(scratch, tokens[0]));
+    cd.addressType = addressTypeForStr(scratchText(scratch, tokens[1]));
+    assignView(cd.host, tokens[2]);
+    cd.multicastIPv4TTL = 0;
+    cd.multicastAddressCount = 0;
+}
+
+void parseBandwidthInto(StringView line, Bandwidth& bandwidth, string& scratch){
+    StringView tokens[2];
+    if(splitFields(line, ':', tokens, 2) != 2)
+        throw invalid_argument("Error parsing bandwidth '" + line.str() + "'.");
+
+    bandwidth.type = bandwidthTypeForStr(scratchText(scratch, tokens[0]));
+    bandwidth.kbps = stoull(scratchText(scratch, tokens[1]));
+}
+
+void parseTimingInto(StringView line, Timing& timing, string& scratch){
+    StringView tokens[2];
+    if(splitFields(line, ' ', tokens, 2) != 2)
+        throw invalid_argument("Error parsing timing '" + line.str() + "'.");
+
+    timing.start = stoull(scratchText(scratch, tokens[0]));
+    timing.end = stoull(scratchText(scratch, tokens[1]));
+}
+
+/// Fills the m= line fields of stream, whose other fields are left as they are.
+void parseMediaDescInto(StringView line, Stream& stream, string& scratch){
+    StringView tokens[4];
+    if(splitFields(line, ' ', tokens, 4) < 4)
+        throw invalid_argument("Error parsing media description '" + line.str() + "'.");
+
+    MediaDescription& md = stream.mediaDescription;
+    md.mediaType = mediaTypeForStr(scratchText(scratch, tokens[0]));
+    md.port = stou16(scratchText(scratch, tokens[1]));
+
+    Protocol protocol = protocolForStr(scratchText(scratch, tokens[2]));
+    md.protocol = protocol;
+    md.payloadTypes.clear();
+    md.payloadTypeSet.clear();
+    md.codec = Symbol();
+
+    if(protocol == Protocol::RTP_AVP || protocol == Protocol::RTP_SAVP){
+        FieldReader reader(line, ' ');
+        StringView field;
+        for(size_t i = 0; reader.next(field); i++){
+            if(i >= 3)
+                md.addPayloadType(parsePayloadType(scratchText(scratch, field)));
+        }
+    }
+    else if(protocol == Protocol::UnknownUDP){
+        md.codec = tokens[3];
+    }
+}
+
+} // namespace
+
 uint32_t parseVersion(const string& line){
     uint64_t version = stou32(line);
 
@@ -52,16 +148,8 @@ AddressType addressTypeForStr(const string& s){
 
 Origin parseOrigin(const string& line){
     Origin origin;
-    vector<string> tokens = split(line, " ");
-    if(tokens.size() < 6)
-        throw invalid_argument("Failed to parse origin.");
-
-    origin.username = tokens[0];
-    origin.sessionID = tokens[1];
-    origin.sessionVersion = tokens[2];
-    origin.networkType = networkTypeForStr(tokens[3]);
-    origin.addressType = addressTypeForStr(tokens[4]);
-    origin.host = tokens[5];
+    string scratch;
+    parseOriginInto(line, origin, scratch);
 
     return origin;
 }
@@ -69,14 +157,8 @@ Origin parseOrigin(const string& line){
 ConnectionData parseConnectionData(const string& line)
 {
     ConnectionData cd;
-    vector<string> tokens = split(line, " ");
-    if(tokens.size() < 3){
-        throw invalid_argument("Error parrsing connection data: " + line);
-    }
-
-    cd.networkType = networkTypeForStr(tokens[0]);
-    cd.addressType = addressTypeForStr(tokens[1]);
-    cd.host = tokens[2];
+    string scratch;
+    parseConnectionDataInto(line, cd, scratch);
 
     return cd;
 }
@@ -94,31 +176,25 @@ BandwidthType bandwidthTypeForStr(const string& s){
 
 Bandwidth parseBandwidth(const string& line){
     Bandwidth bandwidth;
-
-    vector<string> tokens = split(line, ":");
-    if(tokens.size() != 2)
-        throw invalid_argument("Error parsing bandwidth '" + line + "'.");
-
-    bandwidth.type = bandwidthTypeForStr(tokens[0]);
-    bandwidth.kbps = stoull(tokens[1]);
+    string scratch;
+    parseBandwidthInto(line, bandwidth, scratch);
 
     return bandwidth;
 }
 
 Timing parseTiming(const string& s){
-    vector<string> timeStrs = split(s, " ");
-    if(timeStrs.size() != 2)
-        throw invalid_argument("Error parsing timing '" + s + "'.");
-
     Timing t;
-    t.start = stoull(timeStrs[0]);
-    t.end = stoull(timeStrs[1]);
+    string scratch;
+    parseTimingInto(s, t, scratch);
 
     return t;
 }
 
 int64_t parseTimeStrSigned(const string& s){
-    char lastCh = *s.rend();
+    if(s.empty())
+        throw invalid_argument("Empty time value.");
+
+    char lastCh = s[s.size() - 1];
     int64_t multiplier = 1;
 
     string numStr = s;
@@ -138,7 +214,10 @@ int64_t parseTimeStrSigned(const string& s){
 }
 
 uint64_t parseTimeStrUnsigned(const string& s){
-    char lastCh = *s.rend();
+    if(s.empty())
+        throw invalid_argument("Empty time value.");
+
+    char lastCh = s[s.size() - 1];
     uint64_t multiplier = 1;
 
     string numStr = s;
@@ -218,24 +297,9 @@ Protocol protocolForStr(const string& s){
 }
 
 Stream parseMediaDesc(const string& line){
-    auto tokens = split(line, " ");
-    if(tokens.size() < 4)
-        throw invalid_argument("Error parsing media description '" + line + "'.");
-
     Stream stream;
-    stream.mediaDescription.mediaType = mediaTypeForStr(tokens[0]);
-    stream.mediaDescription.port = stou16(tokens[1]);
-
-    Protocol protocol = protocolForStr(tokens[2]);
-    stream.mediaDescription.protocol = protocol;
-
-    if(protocol == Protocol::RTP_AVP || protocol == Protocol::RTP_SAVP){
-        for(size_t i = 3; i < tokens.size(); i++)
-            stream.mediaDescription.payloadTypes.push_back(parsePayloadType(tokens[i]));
-    }
-    else if(protocol == Protocol::UnknownUDP){
-        stream.mediaDescription.codec = tokens[3];
-    }
+    string scratch;
+    parseMediaDescInto(line, stream, scratch);
 
     return stream;
 }
@@ -266,93 +330,422 @@ Encryption parseEncryption(const string& line){
     return enc;
 }
 
-Sdp parseSdp(const string& sdpString){
-    Sdp sdp;
-    Stream* currStream = NULL;
+/*
+ * parseSdp() is a table-driven state machine. Each line type byte is mapped to
+ * a LineClass, and kTransitions[state][class] gives both the handler for the
+ * line and the state that follows it. The states follow the line order of
+ * RFC 4566 section 5 (session -> time -> media), so a line in the wrong place
+ * lands on rejectLine() and every line costs one indirect call.
+ */
 
-    if(sdpString.size() < 2 || sdpString.compare(0, 2, "v=") != 0)
-        throw runtime_error("Not an SDP.");
+namespace {
+
+enum LineClass : uint8_t {
+    LC_Unknown,
+    LC_Malformed,
+    LC_V, LC_O, LC_S, LC_I, LC_U, LC_E, LC_P, LC_C, LC_B,
+    LC_T, LC_R, LC_Z, LC_K, LC_A, LC_M,
+    LC_Count
+};
+
+enum State : uint8_t {
+    ST_Start,
+    ST_Version,
+    ST_Origin,
+    ST_SessionName,
+    ST_SessionInfo,
+    ST_Uri,
+    ST_Email,
+    ST_Phone,
+    ST_SessionConnection,
+    ST_SessionBandwidth,
+    ST_Timing,          // first state that may legally end the description
+    ST_Repeat,
+    ST_TimeZone,
+    ST_SessionKey,
+    ST_SessionAttribute,
+    ST_Media,
+    ST_MediaTitle,
+    ST_MediaConnection,
+    ST_MediaBandwidth,
+    ST_MediaKey,
+    ST_MediaAttribute,
+    ST_Count
+};
+
+struct ParseTarget {
+    Sdp& sdp;
+    const ParseOptions& options;
+    ParseContext& context;
+
+    /// Streams parsed so far. sdp.streams may hold more, left over from an earlier parse for reuse.
+    size_t streamCount;
+
+    /// By index, since adding a stream may reallocate sdp.streams.
+    Stream& currStream(){ return sdp.streams[streamCount - 1]; }
+
+    const string& text(StringView v){ return scratchText(context.scratch, v); }
+};
+
+typedef void (*LineHandler)(ParseTarget& target, const SdpLine& line);
+
+struct Transition {
+    LineHandler handler;
+    State next;
+};
+
+void onVersion(ParseTarget& t, const SdpLine& l){ t.sdp.version = parseVersion(t.text(l.value)); }
+void onOrigin(ParseTarget& t, const SdpLine& l){ parseOriginInto(l.value, t.sdp.origin, t.context.scratch); }
+void onSessionName(ParseTarget& t, const SdpLine& l){ assignView(t.sdp.sessionName, l.value); }
+void onSessionInfo(ParseTarget& t, const SdpLine& l){ assignView(t.sdp.sessionInformation, l.value); }
+void onUri(ParseTarget& t, const SdpLine& l){ assignView(t.sdp.uri, l.value); }
+void onEmail(ParseTarget& t, const SdpLine& l){ assignView(t.sdp.email, l.value); }
+void onPhone(ParseTarget& t, const SdpLine& l){ assignView(t.sdp.phoneNumber, l.value); }
+void onSessionConnection(ParseTarget& t, const SdpLine& l){ parseConnectionDataInto(l.value, t.sdp.connectionData, t.context.scratch); }
+void onSessionBandwidth(ParseTarget& t, const SdpLine& l){ parseBandwidthInto(l.value, t.sdp.bandwidth, t.context.scratch); }
+
+void onTiming(ParseTarget& t, const SdpLine& l){
+    Timing timing;
+    parseTimingInto(l.value, timing, t.context.scratch);
+    t.sdp.times.push_back(timing);
+}
+
+void onRepeat(ParseTarget& t, const SdpLine& l){
+    // The transition table only allows r= after t=, so times is never empty here.
+    t.sdp.times.back().repeatingTimes.push_back(parseRepeatingTime(t.text(l.value)));
+}
+
+void onTimeZone(ParseTarget& t, const SdpLine& l){
+    vector<TimeZoneAdjustment> adjustments = parseTimeZone(t.text(l.value));
+    t.sdp.timeZoneAdjustments.insert(t.sdp.timeZoneAdjustments.end(),
+                                     adjustments.begin(),
+                                     adjustments.end());
+}
 
-    vector<string> lines = split(sdpString, "\r\n");
+void onSessionKey(ParseTarget& t, const SdpLine& l){ t.sdp.encryption = parseEncryption(t.text(l.value)); }
+sp<Attribute> makeAttribute(ParseTarget& t, const SdpLine& l){
+    if(t.options.internPool != NULL)
+        return t.options.internPool->attribute(l.value, t.options.decodeAttributes);
 
-    for(size_t i = 0; i < lines.size(); i++){
-        const string& line = lines[i];
-        if(line.empty())
-            continue;
+    if(!t.options.decodeAttributes)
+        return make_shared<GenericAttribute>(t.text(l.value));
 
-        if(line.size() < 2){
-            fprintf(stderr, "Failed to parse SDP line '%s'. Ignoring.\n", line.c_str());
-            continue;
-        }
+    return parseAttribute(t.text(l.value));
+}
+
+void onSessionAttribute(ParseTarget& t, const SdpLine& l){ t.sdp.attributes.push_back(makeAttribute(t, l)); }
+
+void resetConnectionData(ConnectionData& cd){
+    cd.networkType = NetworkType::IN;
+    cd.addressType = AddressType::IP4;
+    cd.host.clear();
+    cd.multicastIPv4TTL = 0;
+    cd.multicastAddressCount = 0;
+}
 
-        if(line[1] != '='){
-            fprintf(stderr, "SDP syntax incorrect for line '%s'. Ignoring.\n", line.c_str());
-            continue;
+void resetEncryption(Encryption& encryption){
+    encryption.type = EncryptionType::NotSet;
+    encryption.key.clear();
+}
+
+/// Returns stream to a default-constructed state, keeping the capacity of its strings and vectors.
+void resetStream(Stream& stream){
+    MediaDescription& md = stream.mediaDescription;
+    md.mediaType = MediaType::NotSet;
+    md.port = 0;
+    md.portCount = 0;
+    md.protocol = Protocol::NotSet;
+    md.payloadTypes.clear();
+    md.payloadTypeSet.clear();
+    md.codec = Symbol();
+
+    stream.title.clear();
+    stream.attributes.clear();
+    resetConnectionData(stream.connectionData);
+    stream.bandwidth = Bandwidth();
+    resetEncryption(stream.encryption);
+    stream.attributeIndex.clear();
+}
+
+void resetSdp(Sdp& sdp){
+    sdp.version = VersionNumber;
+    sdp.origin.username.clear();
+    sdp.origin.sessionID.clear();
+    sdp.origin.sessionVersion.clear();
+    sdp.origin.networkType = NetworkType::IN;
+    sdp.origin.addressType = AddressType::IP4;
+    sdp.origin.host.clear();
+    sdp.sessionName.clear();
+    sdp.sessionInformation.clear();
+    sdp.uri.clear();
+    sdp.email.clear();
+    sdp.phoneNumber.clear();
+    resetConnectionData(sdp.connectionData);
+    sdp.bandwidth = Bandwidth();
+    sdp.times.clear();
+    sdp.timeZoneAdjustments.clear();
+    resetEncryption(sdp.encryption);
+    sdp.attributes.clear();
+    // Streams are reset one at a time as m= lines reuse them.
+}
+
+void onMedia(ParseTarget& t, const SdpLine& l){
+    if(t.streamCount == t.sdp.streams.size())
+        t.sdp.streams.emplace_back();
+
+    Stream& stream = t.sdp.streams[t.streamCount++];
+    resetStream(stream);
+
+    const vector<uint32_t>& attributeCounts = t.context.attributeCounts;
+    if(t.streamCount < attributeCounts.size())
+        stream.attributes.reserve(attributeCounts[t.streamCount]);
+
+    parseMediaDescInto(l.value, stream, t.context.scratch);
+}
+
+void onMediaTitle(ParseTarget& t, const SdpLine& l){ assignView(t.currStream().title, l.value); }
+void onMediaConnection(ParseTarget& t, const SdpLine& l){ parseConnectionDataInto(l.value, t.currStream().connectionData, t.context.scratch); }
+void onMediaBandwidth(ParseTarget& t, const SdpLine& l){ parseBandwidthInto(l.value, t.currStream().bandwidth, t.context.scratch); }
+void onMediaKey(ParseTarget& t, const SdpLine& l){ t.currStream().encryption = parseEncryption(t.text(l.value)); }
+void onMediaAttribute(ParseTarget& t, const SdpLine& l){ t.currStream().attributes.push_back(makeAttribute(t, l)); }
+
+void ignoreUnknownLine(ParseTarget& t, const SdpLine& l){
+    fprintf(stderr, "Unexpected SDP line type '%c': Ignoring.\n", l.type);
+}
+
+void ignoreMalformedLine(ParseTarget& t, const SdpLine& l){
+    string line = l.raw.str();
+    fprintf(stderr, "SDP syntax incorrect for line '%s'. Ignoring.\n", line.c_str());
+}
+
+void rejectLine(ParseTarget& t, const SdpLine& l){
+    throw invalid_argument("Unexpected SDP line '" + l.raw.str() + "': lines are out of order.");
+}
+
+struct DispatchTables {
+    uint8_t lineClass[256];
+    Transition transitions[ST_Count][LC_Count];
+
+    DispatchTables(){
+        static const LineHandler handlers[ST_Count] = {
+            NULL,
+            onVersion,
+            onOrigin,
+            onSessionName,
+            onSessionInfo,
+            onUri,
+            onEmail,
+            onPhone,
+            onSessionConnection,
+            onSessionBandwidth,
+            onTiming,
+            onRepeat,
+            onTimeZone,
+            onSessionKey,
+            onSessionAttribute,
+            onMedia,
+            onMediaTitle,
+            onMediaConnection,
+            onMediaBandwidth,
+            onMediaKey,
+            onMediaAttribute,
+        };
+
+        memset(lineClass, LC_Unknown, sizeof(lineClass));
+        lineClass[0] = LC_Malformed;
+
+        static const char typeChars[] = "vosiuepcbtrzkam";
+        for(size_t i = 0; typeChars[i] != 0; i++){
+            lineClass[(uint8_t)typeChars[i]] = (uint8_t)(LC_V + i);
+            lineClass[(uint8_t)toupper(typeChars[i])] = (uint8_t)(LC_V + i);
         }
 
-        char code = tolower(line[0]);
-        string restOfLine = line.substr(2);
+        for(int s = 0; s < ST_Count; s++){
+            for(int c = 0; c < LC_Count; c++)
+                transitions[s][c] = { rejectLine, (State)s };
 
-        if(code == 'm'){
-            sdp.streams.push_back(parseMediaDesc(restOfLine));
-            currStream = &*sdp.streams.rbegin();
+            transitions[s][LC_Unknown] = { ignoreUnknownLine, (State)s };
+            transitions[s][LC_Malformed] = { ignoreMalformedLine, (State)s };
         }
-        else if(currStream == NULL){ // session-level parameters
-            switch(code){
-                case 'v': sdp.version = parseVersion(restOfLine); break;
-                case 'o': sdp.origin = parseOrigin(restOfLine); break;
-                case 's': sdp.sessionName = restOfLine; break;
-                case 'i': sdp.sessionInformation = restOfLine; break;
-                case 'u': sdp.uri = restOfLine; break;
-                case 'e': sdp.email = restOfLine; break;
-                case 'p': sdp.phoneNumber = restOfLine; break;
-                case 'c': sdp.connectionData = parseConnectionData(restOfLine); break;
-                case 'b': sdp.bandwidth = parseBandwidth(restOfLine); break;
-                case 't': sdp.times.push_back(parseTiming(restOfLine)); break;
-                case 'z':
-                {
-                    vector<TimeZoneAdjustment> adjustments = parseTimeZone(restOfLine);
-                    for(size_t i = 0; i < adjustments.size(); i++)
-                        sdp.timeZoneAdjustments.push_back(adjustments[i]);
-
-                    break;
-                }
-                case 'r':
-                {
-                    if(sdp.times.empty())
-                        throw invalid_argument("Invalid SDP: r= without t=.");
-
-                    Timing& timing = *sdp.times.end();
-                    RepeatingTime rt = parseRepeatingTime(restOfLine);
-
-                    timing.repeatingTimes.push_back(rt);
-                    break;
-                }
-                case 'a':
-                    sdp.attributes.push_back(parseAttribute(restOfLine));
-                    break;
-
-                default:
-                    fprintf(stderr, "Unexpected session-level code '%c': Ignoring.\n", code);
+
+        // RFC 4566 section 5: the state reached names the line just accepted.
+        struct Edge { State from; const char* types; };
+        static const Edge edges[] = {
+            { ST_Start,             "v" },
+            { ST_Version,           "o" },
+            { ST_Origin,            "s" },
+            { ST_SessionName,       "iuepcbt" },
+            { ST_SessionInfo,       "uepcbt" },
+            { ST_Uri,               "epcbt" },
+            { ST_Email,             "epcbt" },
+            { ST_Phone,             "pcbt" },
+            { ST_SessionConnection, "bt" },
+            { ST_SessionBandwidth,  "bt" },
+            { ST_Timing,            "trzkam" },
+            { ST_Repeat,            "trzkam" },
+            { ST_TimeZone,          "kam" },
+            { ST_SessionKey,        "am" },
+            { ST_SessionAttribute,  "am" },
+            { ST_Media,             "icbkam" },
+            { ST_MediaTitle,        "cbkam" },
+            { ST_MediaConnection,   "cbkam" },
+            { ST_MediaBandwidth,    "bkam" },
+            { ST_MediaKey,          "am" },
+            { ST_MediaAttribute,    "am" },
+        };
+
+        for(const Edge& edge : edges){
+            bool inMedia = edge.from >= ST_Media;
+            for(const char* type = edge.types; *type != 0; type++){
+                State next = stateForLine(*type, inMedia);
+                transitions[edge.from][lineClass[(uint8_t)*type]] = { handlers[next], next };
             }
         }
-        else{
-            switch(code){
-                case 'i': currStream->title = restOfLine;
-                case 'c': currStream->connectionData = parseConnectionData(restOfLine);
-                case 'b': currStream->bandwidth = parseBandwidth(restOfLine);
-                case 'k': currStream->encryption = parseEncryption(restOfLine);
-                case 'a':
-                    currStream->attributes.push_back(parseAttribute(restOfLine));
-                default:
-                    fprintf(stderr, "Unexpected media-level code '%c': Ignoring.\n", code);
-            }
+    }
+
+    static State stateForLine(char type, bool inMedia){
+        switch(type){
+            case 'v': return ST_Version;
+            case 'o': return ST_Origin;
+            case 's': return ST_SessionName;
+            case 'i': return inMedia ? ST_MediaTitle : ST_SessionInfo;
+            case 'u': return ST_Uri;
+            case 'e': return ST_Email;
+            case 'p': return ST_Phone;
+            case 'c': return inMedia ? ST_MediaConnection : ST_SessionConnection;
+            case 'b': return inMedia ? ST_MediaBandwidth : ST_SessionBandwidth;
+            case 't': return ST_Timing;
+            case 'r': return ST_Repeat;
+            case 'z': return ST_TimeZone;
+            case 'k': return inMedia ? ST_MediaKey : ST_SessionKey;
+            case 'a': return inMedia ? ST_MediaAttribute : ST_SessionAttribute;
+            case 'm': return ST_Media;
+            default: throw logic_error("No state for SDP line type.");
+        }
+    }
+};
+
+const DispatchTables& dispatchTables(){
+    static const DispatchTables tables;
+    return tables;
+}
+
+} // namespace
+
+SdpLineOrder::Verdict SdpLineOrder::next(char type) noexcept {
+    const DispatchTables& tables = dispatchTables();
+    const Transition& transition = tables.transitions[mState][tables.lineClass[(uint8_t)type]];
+
+    if(transition.handler == rejectLine)
+        return Reject;
+    else if(transition.handler == ignoreUnknownLine || transition.handler == ignoreMalformedLine)
+        return Ignore;
+
+    mState = transition.next;
+    return Accept;
+}
+
+bool SdpLineOrder::inMedia() const noexcept {
+    return mState >= ST_Media;
+}
+
+bool SdpLineOrder::complete() const noexcept {
+    return mState >= ST_Timing;
+}
+
+Sdp parseSdp(const string& sdpString){
+    return parseSdp(sdpString, ParseOptions());
+}
+
+namespace {
+
+/**
+ * Counts the a= lines before the first m= line and in each media section,
+ * so the attribute and stream vectors can be sized before parsing. Lines
+ * end at '\n', or at a "\n" escape in a JSON string.
+ */
+void prescan(StringView text, bool jsonString, vector<uint32_t>& attributeCounts){
+    attributeCounts.clear();
+    attributeCounts.push_back(0);
+
+    const StringView jsonLineEnd("\\n", 2);
+    size_t pos = 0;
+    while(pos + 1 < text.size()){
+        if(text[pos + 1] == '='){
+            if(text[pos] == 'a')
+                attributeCounts.back()++;
+            else if(text[pos] == 'm')
+                attributeCounts.push_back(0);
         }
+
+        size_t lineEnd = jsonString ? text.find(jsonLineEnd, pos) : text.find('\n', pos);
+        if(lineEnd == StringView::npos)
+            break;
+
+        pos = lineEnd + (jsonString ? jsonLineEnd.size() : 1);
+    }
+}
+
+template<typename Lexer>
+void runParser(Lexer& lexer, ParseTarget& target){
+    const DispatchTables& tables = dispatchTables();
+    State state = ST_Start;
+
+    SdpLine line;
+    while(lexer.next(&line)){
+        const Transition& transition = tables.transitions[state][tables.lineClass[(uint8_t)line.type]];
+        transition.handler(target, line);
+        state = transition.next;
     }
 
+    if(state < ST_Timing)
+        throw invalid_argument("Incomplete SDP: missing required o=, s= or t= line.");
+}
+
+} // namespace
+
+Sdp parseSdp(StringView sdpString, const ParseOptions& options){
+    Sdp sdp;
+    parseSdpInto(sdp, sdpString, threadParseContext(), options);
+
     return sdp;
 }
 
+ParseContext& threadParseContext(){
+    static thread_local ParseContext context;
+    return context;
+}
+
+void parseSdpInto(Sdp& reuse, StringView sdpString, ParseContext& context, const ParseOptions& options){
+    bool jsonString = options.inputEncoding == InputEncoding::JsonString;
+    if(jsonString && sdpString.size() >= 2 && sdpString.front() == '"' && sdpString.back() == '"')
+        sdpString = sdpString.substr(1, sdpString.size() - 2);
+
+    if(!sdpString.startsWith("v="))
+        throw runtime_error("Not an SDP.");
+
+    prescan(sdpString, jsonString, context.attributeCounts);
+    resetSdp(reuse);
+    reuse.attributes.reserve(context.attributeCounts[0]);
+    reuse.streams.reserve(context.attributeCounts.size() - 1);
+
+    ParseTarget target = { reuse, options, context, 0 };
+    if(jsonString){
+        JsonStringLexer lexer(sdpString);
+        runParser(lexer, target);
+    }
+    else{
+        SdpLexer lexer(sdpString);
+        runParser(lexer, target);
+    }
+
+    // Drop streams left over from an earlier, longer SDP.
+    reuse.streams.erase(reuse.streams.begin() + target.streamCount, reuse.streams.end());
+
+    for(Stream& stream : reuse.streams)
+        stream.reindexAttributes();
+}
+
 MediaDirection mediaDirectionForStr(const std::string& s){
     string lc = strToLower(s);
     if(lc == "sendrecv")
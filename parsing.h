@@ -21,12 +21,84 @@
 #define __ZSDP_PARSING_H__
 
 #include <zsdp/sdp.h>
+#include <zsdp/string-view.h>
 #include <string>
 #include <vector>
 
 
 namespace zsdp {
 
+/// Walks the sep-separated fields of a line, the same fields split(line, sep) returns.
+class FieldReader {
+public:
+    FieldReader(StringView line, char sep) noexcept : mRest(line), mSep(sep), mDone(false) {}
+
+    bool next(StringView& field) noexcept {
+        if(mDone)
+            return false;
+
+        size_t end = mRest.find(mSep);
+        if(end == StringView::npos){
+            field = mRest;
+            mDone = true;
+        }
+        else{
+            field = mRest.substr(0, end);
+            mRest = mRest.substr(end + 1);
+        }
+
+        return true;
+    }
+
+private:
+    StringView mRest;
+    char mSep;
+    bool mDone;
+};
+
+/// Stores the first maxFields fields of line in fields and returns how many fields there are in total.
+inline size_t splitFields(StringView line, char sep, StringView* fields, size_t maxFields) noexcept {
+    FieldReader reader(line, sep);
+    size_t count = 0;
+
+    StringView field;
+    while(reader.next(field)){
+        if(count < maxFields)
+            fields[count] = field;
+
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * The line-order rules of parseSdp()'s state machine, for parsers that fill
+ * something other than an Sdp. Pass each line type to next() in turn.
+ */
+class SdpLineOrder {
+public:
+    enum Verdict {
+        Accept,
+        Ignore, /// not an SDP line, or an unknown type; parseSdp() skips these
+        Reject, /// out of order
+    };
+
+    SdpLineOrder() noexcept : mState(0) {}
+
+    /// Advances past an accepted line. A rejected or ignored line leaves the state as it was.
+    Verdict next(char type) noexcept;
+
+    /// True once an m= line has been accepted.
+    bool inMedia() const noexcept;
+
+    /// True once the required v=, o=, s= and t= lines have been accepted.
+    bool complete() const noexcept;
+
+private:
+    uint8_t mState;
+};
+
 Sdp parseSdp(const std::string& sdpString);
 
 uint32_t parseVersion(const std::string& line);
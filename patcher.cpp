@@ -0,0 +1,210 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/patcher.h>
+#include "lexer.h"
+
+
+using namespace std;
+
+namespace zsdp {
+
+namespace {
+
+/// Finds the index'th space-separated token of value.
+bool findToken(StringView value, size_t index, const char** start, const char** end){
+    const char* p = value.begin();
+    const char* valueEnd = value.end();
+
+    for(size_t i = 0; ; i++){
+        while(p < valueEnd && *p == ' ')
+            p++;
+
+        if(p == valueEnd)
+            return false;
+
+        const char* tokenStart = p;
+        p = (const char*)memchr(p, ' ', valueEnd - p);
+        if(p == NULL)
+            p = valueEnd;
+
+        if(i == index){
+            *start = tokenStart;
+            *end = p;
+            return true;
+        }
+    }
+}
+
+/**
+ * Builds the output by copying the input up to each replaced span, so the
+ * unpatched text is appended in as few pieces as possible.
+ */
+class SpliceWriter {
+public:
+    SpliceWriter(StringView in, string& out) : mIn(in), mOut(out), mCopied(in.begin()) {}
+
+    void replace(const char* start, const char* end, StringView replacement){
+        mOut.append(mCopied, start - mCopied);
+        mOut += replacement;
+        mCopied = end;
+    }
+
+    void finish(){
+        mOut.append(mCopied, mIn.end() - mCopied);
+    }
+
+private:
+    StringView mIn;
+    string& mOut;
+    const char* mCopied;
+};
+
+} // namespace
+
+void SdpPatcher::AddressPatch::assign(const string& host, AddressType addressType){
+    set = true;
+    replacement = addressType == AddressType::IP6 ? "IP6 " : "IP4 ";
+    replacement += host;
+}
+
+void SdpPatcher::setOriginAddress(const string& host, AddressType addressType){
+    mOrigin.assign(host, addressType);
+}
+
+void SdpPatcher::setConnectionAddress(const string& host, AddressType addressType){
+    mConnection.assign(host, addressType);
+}
+
+void SdpPatcher::setSessionConnectionAddress(const string& host, AddressType addressType){
+    mSessionConnection.assign(host, addressType);
+}
+
+void SdpPatcher::setMediaConnectionAddress(size_t streamIndex,
+                                           const string& host,
+                                           AddressType addressType)
+{
+    streamPatch(streamIndex).connection.assign(host, addressType);
+}
+
+void SdpPatcher::setMediaPort(size_t streamIndex, uint16_t port){
+    StreamPatch& patch = streamPatch(streamIndex);
+    string portStr = to_string(port);
+
+    patch.hasPort = true;
+    patch.portSize = (uint8_t)portStr.size();
+    memcpy(patch.port, portStr.data(), portStr.size());
+}
+
+void SdpPatcher::clear(){
+    mOrigin = AddressPatch();
+    mConnection = AddressPatch();
+    mSessionConnection = AddressPatch();
+    mStreams.clear();
+}
+
+SdpPatcher::StreamPatch& SdpPatcher::streamPatch(size_t streamIndex){
+    if(streamIndex >= mStreams.size())
+        mStreams.resize(streamIndex + 1);
+
+    return mStreams[streamIndex];
+}
+
+size_t SdpPatcher::apply(StringView sdp, string& out) const{
+    out.clear();
+    if(out.capacity() < sdp.size() + 64)
+        out.reserve(sdp.size() + 64);
+
+    SpliceWriter writer(sdp, out);
+    SdpLexer lexer(sdp);
+    SdpLine line;
+    size_t patchCount = 0;
+    size_t streamIndex = 0;
+    bool inMedia = false;
+
+    // Replaces "<addrtype> <host>" where addrTypeToken is the index of <addrtype>.
+    auto patchAddress = [&](const AddressPatch& patch, size_t addrTypeToken){
+        const char* typeStart;
+        const char* typeEnd;
+        const char* hostStart;
+        const char* hostEnd;
+
+        if(!patch.set
+           || !findToken(line.value, addrTypeToken, &typeStart, &typeEnd)
+           || !findToken(StringView(typeEnd, line.value.end() - typeEnd), 0, &hostStart, &hostEnd))
+            return;
+
+        // Keep a multicast "/<ttl>/<count>" suffix.
+        const char* slash = (const char*)memchr(hostStart, '/', hostEnd - hostStart);
+        if(slash != NULL)
+            hostEnd = slash;
+
+        writer.replace(typeStart, hostEnd, patch.replacement);
+        patchCount++;
+    };
+
+    while(lexer.next(&line)){
+        switch(line.type){
+            case 'o':
+                patchAddress(mOrigin, 4);
+                break;
+
+            case 'm': {
+                streamIndex = inMedia ? streamIndex + 1 : 0;
+                inMedia = true;
+
+                if(streamIndex >= mStreams.size() || !mStreams[streamIndex].hasPort)
+                    break;
+
+                const char* portStart;
+                const char* portEnd;
+                if(!findToken(line.value, 1, &portStart, &portEnd))
+                    break;
+
+                const char* slash = (const char*)memchr(portStart, '/', portEnd - portStart);
+                if(slash != NULL)
+                    portEnd = slash;
+
+                const StreamPatch& patch = mStreams[streamIndex];
+                writer.replace(portStart, portEnd, StringView(patch.port, patch.portSize));
+                patchCount++;
+                break;
+            }
+
+            case 'c':
+                if(!inMedia)
+                    patchAddress(mSessionConnection.set ? mSessionConnection : mConnection, 1);
+                else if(streamIndex < mStreams.size() && mStreams[streamIndex].connection.set)
+                    patchAddress(mStreams[streamIndex].connection, 1);
+                else
+                    patchAddress(mConnection, 1);
+
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    writer.finish();
+
+    return patchCount;
+}
+
+} // namespace zsdp
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/payload-table.h>
+
+
+using namespace std;
+
+namespace zsdp {
+
+namespace {
+
+struct StaticAssignment {
+    uint8_t payloadType;
+    const char* encodingName;
+    uint32_t clockRate;
+    uint32_t channels;
+};
+
+/// RFC 3551 tables 4 and 5.
+const StaticAssignment kStaticAssignments[] = {
+    {  0, "PCMU",   8000, 1 },
+    {  3, "GSM",    8000, 1 },
+    {  4, "G723",   8000, 1 },
+    {  5, "DVI4",   8000, 1 },
+    {  6, "DVI4",  16000, 1 },
+    {  7, "LPC",    8000, 1 },
+    {  8, "PCMA",   8000, 1 },
+    {  9, "G722",   8000, 1 },
+    { 10, "L16",   44100, 2 },
+    { 11, "L16",   44100, 1 },
+    { 12, "QCELP",  8000, 1 },
+    { 13, "CN",     8000, 1 },
+    { 14, "MPA",   90000, 0 },
+    { 15, "G728",   8000, 1 },
+    { 16, "DVI4",  11025, 1 },
+    { 17, "DVI4",  22050, 1 },
+    { 18, "G729",   8000, 1 },
+    { 25, "CelB",  90000, 0 },
+    { 26, "JPEG",  90000, 0 },
+    { 28, "nv",    90000, 0 },
+    { 31, "H261",  90000, 0 },
+    { 32, "MPV",   90000, 0 },
+    { 33, "MP2T",  90000, 0 },
+    { 34, "H263",  90000, 0 },
+};
+
+struct StaticTable {
+    StaticTable(){
+        for(const StaticAssignment& assignment : kStaticAssignments){
+            PayloadInfo& info = entries[assignment.payloadType];
+            info.defined = true;
+            info.isStatic = true;
+            info.encodingName = assignment.encodingName;
+            info.clockRate = assignment.clockRate;
+            info.channels = assignment.channels;
+        }
+    }
+
+    PayloadInfo entries[kMaxPayloadType + 1];
+};
+
+uint8_t parseRtcpFeedbackType(StringView type){
+    size_t space = type.find(' ');
+    StringView name = type.substr(0, space);
+    StringView param = space == StringView::npos ? StringView() : type.substr(space + 1);
+
+    if(name == "nack")
+        return param.empty() ? kRtcpFeedback_Nack : param == "pli" ? kRtcpFeedback_Pli : kRtcpFeedback_Other;
+    else if(name == "ccm" && param == "fir")
+        return kRtcpFeedback_Fir;
+    else if(name == "goog-remb")
+        return kRtcpFeedback_Remb;
+    else if(name == "transport-cc")
+        return kRtcpFeedback_TransportCc;
+
+    return kRtcpFeedback_Other;
+}
+
+/// Parses "<pt> <type>" or "* <type>". Returns false for anything else; allPayloadTypes is set for "*".
+bool parseRtcpFeedback(StringView value, bool* allPayloadTypes, uint8_t* pt, uint8_t* feedback){
+    size_t space = value.find(' ');
+    if(space == StringView::npos || space == 0)
+        return false;
+
+    StringView target = value.substr(0, space);
+    *allPayloadTypes = target == "*";
+
+    if(!*allPayloadTypes){
+        uint32_t n = 0;
+        for(char c : target){
+            if(c < '0' || c > '9' || (n = n * 10 + (c - '0')) > kMaxPayloadType)
+                return false;
+        }
+
+        *pt = (uint8_t)n;
+    }
+
+    *feedback = parseRtcpFeedbackType(value.substr(space + 1));
+    return true;
+}
+
+} // namespace
+
+const PayloadInfo& PayloadTable::staticPayloadType(uint8_t pt){
+    static const StaticTable table;
+    return table.entries[pt & kMaxPayloadType];
+}
+
+PayloadTable::PayloadTable(const Stream& stream){
+    for(uint8_t pt : stream.mediaDescription.payloadTypes){
+        if(pt > kMaxPayloadType || mEntries[pt].defined)
+            continue;
+
+        // Overwritten below if there is an rtpmap.
+        mEntries[pt] = staticPayloadType(pt);
+        mEntries[pt].defined = true;
+        mSize++;
+    }
+
+    for(const AttrRtpMap& rtpMap : stream.findAll<AttrRtpMap>()){
+        if(rtpMap.payloadType > kMaxPayloadType || !mEntries[rtpMap.payloadType].defined)
+            continue;
+
+        PayloadInfo& info = mEntries[rtpMap.payloadType];
+        info.isStatic = false;
+        info.encodingName = rtpMap.encodingName;
+        info.clockRate = rtpMap.clockRate;
+        info.channels = rtpMap.audioChannelCount;
+    }
+
+    for(const AttrFormatParams& fmtp : stream.findAll<AttrFormatParams>()){
+        if(fmtp.payloadType <= kMaxPayloadType && mEntries[fmtp.payloadType].defined)
+            mEntries[fmtp.payloadType].formatParams = fmtp.formatParams;
+    }
+
+    // rtcp-fb has no attribute class of its own.
+    for(const GenericAttribute& attr : stream.findAll<GenericAttribute>()){
+        if(attr.key() != "rtcp-fb")
+            continue;
+
+        StringView value = StringView(attr.line()).substr(attr.key().size() + 1);
+        bool allPayloadTypes = false;
+        uint8_t pt = 0;
+        uint8_t feedback = 0;
+        if(!parseRtcpFeedback(value, &allPayloadTypes, &pt, &feedback))
+            continue;
+
+        if(allPayloadTypes){
+            for(PayloadInfo& info : mEntries){
+                if(info.defined)
+                    info.rtcpFeedback |= feedback;
+            }
+        }
+        else if(mEntries[pt].defined)
+            mEntries[pt].rtcpFeedback |= feedback;
+    }
+}
+
+} // namespace zsdp
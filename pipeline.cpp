@@ -0,0 +1,501 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/pipeline.h>
+#include "lexer.h"
+#include "string-util.h"
+
+
+using namespace std;
+
+namespace zsdp {
+
+struct PipelineRunState {
+    const vector<sp<SdpFilter>>* filters;
+    string* out;
+    const char* inputEnd;
+    const char* sectionStart;
+    const char* sectionEnd;
+};
+
+StringView SdpLineEvent::mediaSection() const{
+    if(streamIndex == kSessionLevel || mRun == NULL)
+        return StringView();
+
+    if(mRun->sectionEnd == NULL){
+        // Find the next m= line, skipping over the current one.
+        SdpLexer lexer(mRun->sectionStart, mRun->inputEnd - mRun->sectionStart);
+        SdpLine line;
+        mRun->sectionEnd = mRun->inputEnd;
+        lexer.next(&line);
+
+        while(lexer.next(&line)){
+            if(line.type == 'm'){
+                mRun->sectionEnd = line.raw.data();
+                break;
+            }
+        }
+    }
+
+    return StringView(mRun->sectionStart, mRun->sectionEnd - mRun->sectionStart);
+}
+
+/// Hands lines emitted by stage (mStage - 1) to stage mStage, or to the output after the last stage.
+class SdpPipeline::Link : public SdpLineSink {
+public:
+    Link(size_t stage, const SdpLineEvent& context) : mStage(stage), mContext(context) {}
+
+    virtual void emit(char type, StringView value) override{
+        SdpLineEvent event = mContext;
+        event.type = type;
+        event.value = value;
+
+        deliver(mStage, event);
+    }
+
+    static void deliver(size_t stage, const SdpLineEvent& event){
+        const vector<sp<SdpFilter>>& filters = *event.mRun->filters;
+
+        if(stage == filters.size()){
+            string& out = *event.mRun->out;
+            if(event.type != 0){
+                out += event.type;
+                out += '=';
+            }
+
+            out += event.value;
+            out.append("\r\n", 2);
+            return;
+        }
+
+        Link next(stage + 1, event);
+        filters[stage]->onLine(event, next);
+    }
+
+    static void endSection(const SdpLineEvent& context){
+        const vector<sp<SdpFilter>>& filters = *context.mRun->filters;
+
+        for(size_t stage = 0; stage < filters.size(); stage++){
+            Link next(stage + 1, context);
+            filters[stage]->endSection(context.streamIndex, next);
+        }
+    }
+
+private:
+    size_t mStage;
+    const SdpLineEvent& mContext;
+};
+
+SdpPipeline& SdpPipeline::add(const sp<SdpFilter>& filter){
+    mFilters.push_back(filter);
+
+    return *this;
+}
+
+void SdpPipeline::run(StringView sdp, string& out) const{
+    out.clear();
+    if(out.capacity() < sdp.size() + 64)
+        out.reserve(sdp.size() + 64);
+
+    for(auto& filter : mFilters)
+        filter->reset();
+
+    PipelineRunState run;
+    run.filters = &mFilters;
+    run.out = &out;
+    run.inputEnd = sdp.end();
+    run.sectionStart = NULL;
+    run.sectionEnd = NULL;
+
+    SdpLineEvent event;
+    event.streamIndex = kSessionLevel;
+    event.mRun = &run;
+
+    SdpLexer lexer(sdp);
+    SdpLine line;
+    while(lexer.next(&line)){
+        if(line.type == 'm'){
+            if(event.streamIndex != kSessionLevel)
+                Link::endSection(event);
+
+            event.streamIndex = event.streamIndex == kSessionLevel ? 0 : event.streamIndex + 1;
+            run.sectionStart = line.raw.data();
+            run.sectionEnd = NULL;
+        }
+
+        event.type = line.type;
+        event.value = line.value;
+        Link::deliver(0, event);
+    }
+
+    if(event.streamIndex != kSessionLevel)
+        Link::endSection(event);
+}
+
+
+namespace {
+
+/// Parses the leading payload type of "96 ..." or a bare "96". Returns -1 if there is none.
+int leadingPayloadType(StringView s){
+    int pt = 0;
+    size_t i = 0;
+
+    for(; i < s.size() && s[i] >= '0' && s[i] <= '9' && i < 3; i++)
+        pt = pt * 10 + (s[i] - '0');
+
+    if(i == 0 || (i < s.size() && s[i] != ' '))
+        return -1;
+
+    return pt;
+}
+
+/// For "a=<key>:<value>" lines, returns true and sets value if the key matches.
+bool attributeValue(StringView line, StringView key, StringView* value){
+    if(line.size() <= key.size() || line[key.size()] != ':' || !line.startsWith(key))
+        return false;
+
+    *value = line.substr(key.size() + 1);
+    return true;
+}
+
+StringView attributeKey(StringView line){
+    size_t colon = line.find(':');
+
+    return colon == StringView::npos ? line : line.substr(0, colon);
+}
+
+/// Calls fnc(pt, encodingName) for each a=rtpmap line in the section.
+template<typename Fnc>
+void forEachRtpMap(StringView section, Fnc fnc){
+    SdpLexer lexer(section);
+    SdpLine line;
+    StringView value;
+
+    while(lexer.next(&line)){
+        if(line.type != 'a' || !attributeValue(line.value, "rtpmap", &value))
+            continue;
+
+        int pt = leadingPayloadType(value);
+        size_t nameStart = value.find(' ');
+        if(pt < 0 || nameStart == StringView::npos)
+            continue;
+
+        StringView encoding = value.substr(nameStart + 1);
+        fnc(pt, encoding.substr(0, encoding.find('/')));
+    }
+}
+
+/// Static RTP/AVP payload types that are commonly sent without an rtpmap line.
+StringView staticEncodingName(int pt){
+    switch(pt){
+        case 0: return "PCMU";
+        case 3: return "GSM";
+        case 4: return "G723";
+        case 8: return "PCMA";
+        case 9: return "G722";
+        case 18: return "G729";
+        case 26: return "JPEG";
+        case 31: return "H261";
+        case 34: return "H263";
+        default: return StringView();
+    }
+}
+
+bool containsIgnoreCase(const vector<string>& names, StringView name){
+    for(auto& n : names){
+        if(name.equalsIgnoreCase(n))
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Splits an m= value into "<media> <port> <proto>" and the format list.
+ * Returns false for lines with fewer than four tokens.
+ */
+bool splitMediaLine(StringView value, StringView* prefix, StringView* formats){
+    size_t pos = 0;
+    for(int i = 0; i < 3; i++){
+        pos = value.find(' ', pos);
+        if(pos == StringView::npos)
+            return false;
+
+        while(pos < value.size() && value[pos] == ' ')
+            pos++;
+    }
+
+    if(pos >= value.size())
+        return false;
+
+    *prefix = value.substr(0, pos);
+    *formats = value.substr(pos);
+    return true;
+}
+
+/// Calls fnc(token) for each space-separated token.
+template<typename Fnc>
+void forEachToken(StringView s, Fnc fnc){
+    size_t pos = 0;
+    while(pos < s.size()){
+        size_t end = s.find(' ', pos);
+        if(end == StringView::npos)
+            end = s.size();
+
+        if(end > pos)
+            fnc(s.substr(pos, end - pos));
+
+        pos = end + 1;
+    }
+}
+
+StringView directionStr(MediaDirection direction){
+    switch(direction){
+        case MediaDirection::SendOnly: return "sendonly";
+        case MediaDirection::RecvOnly: return "recvonly";
+        case MediaDirection::Inactive: return "inactive";
+        default: return "sendrecv";
+    }
+}
+
+bool isDirection(StringView value){
+    return value == "sendrecv" || value == "sendonly" || value == "recvonly" || value == "inactive";
+}
+
+} // namespace
+
+
+DropCodecsFilter::DropCodecsFilter(const vector<string>& encodingNames)
+    : mEncodingNames(encodingNames) {}
+
+void DropCodecsFilter::reset(){
+    mDropped.clear();
+}
+
+void DropCodecsFilter::onLine(const SdpLineEvent& line, SdpLineSink& next){
+    if(line.type == 'm'){
+        reset();
+
+        StringView prefix;
+        StringView formats;
+        if(!splitMediaLine(line.value, &prefix, &formats)){
+            next.emit(line.type, line.value);
+            return;
+        }
+
+        PayloadTypeSet mapped;
+        forEachRtpMap(line.mediaSection(), [&](int pt, StringView name){
+            mapped.insert(pt);
+            if(containsIgnoreCase(mEncodingNames, name))
+                mDropped.insert(pt);
+        });
+
+        size_t kept = 0;
+        forEachToken(formats, [&](StringView fmt){
+            int pt = leadingPayloadType(fmt);
+            if(!mapped.contains(pt) && containsIgnoreCase(mEncodingNames, staticEncodingName(pt)))
+                mDropped.insert(pt);
+
+            if(!mDropped.contains(pt))
+                kept++;
+        });
+
+        if(mDropped.empty()){
+            next.emit(line.type, line.value);
+            return;
+        }
+
+        mScratch.clear();
+        if(kept == 0){
+            // Nothing left to offer: reject the stream by zeroing its port (RFC 3264 section 6).
+            StringView media = prefix.substr(0, prefix.find(' '));
+            StringView afterPort = prefix.substr(prefix.find(' ', media.size() + 1));
+            mScratch += media;
+            mScratch += " 0";
+            mScratch += afterPort;
+            mScratch += formats;
+        }
+        else{
+            mScratch += prefix;
+            forEachToken(formats, [&](StringView fmt){
+                if(mDropped.contains(leadingPayloadType(fmt)))
+                    return;
+
+                if(mScratch.size() > prefix.size())
+                    mScratch += ' ';
+
+                mScratch += fmt;
+            });
+        }
+
+        next.emit(line.type, mScratch);
+        return;
+    }
+
+    StringView value;
+    if(line.type == 'a'
+       && (attributeValue(line.value, "rtpmap", &value)
+           || attributeValue(line.value, "fmtp", &value)
+           || attributeValue(line.value, "rtcp-fb", &value))
+       && mDropped.contains(leadingPayloadType(value)))
+        return;
+
+    next.emit(line.type, line.value);
+}
+
+
+StripAttributesFilter::StripAttributesFilter(const vector<string>& keys)
+    : mKeys(keys) {}
+
+void StripAttributesFilter::onLine(const SdpLineEvent& line, SdpLineSink& next){
+    if(line.type == 'a'){
+        StringView key = attributeKey(line.value);
+        for(auto& k : mKeys){
+            if(key == k)
+                return;
+        }
+    }
+
+    next.emit(line.type, line.value);
+}
+
+
+ReorderPayloadTypesFilter::ReorderPayloadTypesFilter(const vector<string>& preferredEncodingNames)
+    : mPreferred(preferredEncodingNames) {}
+
+void ReorderPayloadTypesFilter::onLine(const SdpLineEvent& line, SdpLineSink& next){
+    StringView prefix;
+    StringView formats;
+    if(line.type != 'm' || !splitMediaLine(line.value, &prefix, &formats)){
+        next.emit(line.type, line.value);
+        return;
+    }
+
+    // rank[pt] is the index of the payload type's encoding in mPreferred.
+    uint8_t rank[kMaxPayloadType + 1];
+    const uint8_t unranked = 255;
+    memset(rank, unranked, sizeof(rank));
+
+    auto rankOf = [&](StringView name){
+        for(size_t i = 0; i < mPreferred.size() && i < unranked; i++){
+            if(name.equalsIgnoreCase(mPreferred[i]))
+                return (uint8_t)i;
+        }
+
+        return unranked;
+    };
+
+    PayloadTypeSet mapped;
+    forEachRtpMap(line.mediaSection(), [&](int pt, StringView name){
+        mapped.insert(pt);
+        rank[pt] = rankOf(name);
+    });
+
+    forEachToken(formats, [&](StringView fmt){
+        int pt = leadingPayloadType(fmt);
+        if(pt >= 0 && !mapped.contains(pt))
+            rank[pt] = rankOf(staticEncodingName(pt));
+    });
+
+    mScratch.clear();
+    mScratch += prefix;
+    size_t prefixSize = mScratch.size();
+
+    auto appendFormat = [&](StringView fmt){
+        if(mScratch.size() > prefixSize)
+            mScratch += ' ';
+
+        mScratch += fmt;
+    };
+
+    for(size_t r = 0; r < mPreferred.size() && r < unranked; r++){
+        forEachToken(formats, [&](StringView fmt){
+            int pt = leadingPayloadType(fmt);
+            if(pt >= 0 && rank[pt] == r)
+                appendFormat(fmt);
+        });
+    }
+
+    forEachToken(formats, [&](StringView fmt){
+        int pt = leadingPayloadType(fmt);
+        if(pt < 0 || rank[pt] == unranked)
+            appendFormat(fmt);
+    });
+
+    next.emit(line.type, mScratch);
+}
+
+
+ForceDirectionFilter::ForceDirectionFilter(MediaDirection direction)
+    : mDirection(direction) {}
+
+void ForceDirectionFilter::reset(){
+    mSectionHasDirection = false;
+}
+
+void ForceDirectionFilter::onLine(const SdpLineEvent& line, SdpLineSink& next){
+    if(line.type == 'm')
+        mSectionHasDirection = false;
+
+    if(line.type == 'a' && isDirection(line.value)){
+        if(mSectionHasDirection && line.streamIndex != kSessionLevel)
+            return;
+
+        if(line.streamIndex != kSessionLevel)
+            mSectionHasDirection = true;
+
+        next.emit('a', directionStr(mDirection));
+        return;
+    }
+
+    next.emit(line.type, line.value);
+}
+
+void ForceDirectionFilter::endSection(size_t streamIndex, SdpLineSink& next){
+    if(!mSectionHasDirection)
+        next.emit('a', directionStr(mDirection));
+}
+
+
+CapBandwidthFilter::CapBandwidthFilter(uint64_t maxKbps)
+    : mMaxKbps(maxKbps) {}
+
+void CapBandwidthFilter::onLine(const SdpLineEvent& line, SdpLineSink& next){
+    if(line.type == 'b' && line.value.size() > 3 && StringView(line.value.data(), 3).equalsIgnoreCase("AS:")){
+        StringView kbpsStr = line.value.substr(3);
+        uint64_t kbps = 0;
+        bool valid = true;
+
+        for(size_t i = 0; i < kbpsStr.size() && valid; i++){
+            valid = kbpsStr[i] >= '0' && kbpsStr[i] <= '9' && kbps < UINT64_MAX / 10;
+            kbps = kbps * 10 + (kbpsStr[i] - '0');
+        }
+
+        if(valid && kbps > mMaxKbps){
+            mScratch.assign(line.value.data(), 3);
+            appendUInt(mScratch, mMaxKbps);
+            next.emit(line.type, mScratch);
+            return;
+        }
+    }
+
+    next.emit(line.type, line.value);
+}
+
+} // namespace zsdp
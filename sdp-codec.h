@@ -0,0 +1,201 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_SDP_CODEC_H__
+#define __ZSDP_SDP_CODEC_H__
+
+#include <zsdp/sdp.h>
+#include "varint.h"
+#include <vector>
+
+
+namespace zsdp {
+
+/*
+ * Record encodings shared by the binary format (binary.cpp) and deltas
+ * (delta.cpp). Changing any of them changes both formats.
+ */
+
+/// Enums are stored as their one-byte ordinal; last is the highest value the format knows.
+template<typename E>
+inline E readEnum(ByteReader& r, E last){
+    uint8_t b = r.u8();
+    if(b > (uint8_t)last)
+        throw std::invalid_argument("Unknown enum value in encoded SDP.");
+
+    return (E)b;
+}
+
+template<typename E>
+inline void appendEnum(std::string& out, E e){
+    out += (char)(uint8_t)e;
+}
+
+inline void appendConnectionData(std::string& out, const ConnectionData& cd){
+    appendEnum(out, cd.networkType);
+    appendEnum(out, cd.addressType);
+    appendLengthPrefixed(out, cd.host);
+    out += (char)cd.multicastIPv4TTL;
+    appendVarint(out, cd.multicastAddressCount);
+}
+
+inline ConnectionData readConnectionData(ByteReader& r){
+    ConnectionData cd;
+    cd.networkType = readEnum(r, NetworkType::IN);
+    cd.addressType = readEnum(r, AddressType::IP6);
+    cd.host = r.lengthPrefixed().str();
+    cd.multicastIPv4TTL = r.u8();
+    cd.multicastAddressCount = (uint32_t)r.varint();
+
+    return cd;
+}
+
+inline void appendBandwidth(std::string& out, const Bandwidth& bandwidth){
+    appendEnum(out, bandwidth.type);
+    appendVarint(out, bandwidth.kbps);
+}
+
+inline Bandwidth readBandwidth(ByteReader& r){
+    Bandwidth bandwidth;
+    bandwidth.type = readEnum(r, BandwidthType::ApplicationSpecific);
+    bandwidth.kbps = r.varint();
+
+    return bandwidth;
+}
+
+inline void appendEncryption(std::string& out, const Encryption& encryption){
+    appendEnum(out, encryption.type);
+    appendLengthPrefixed(out, encryption.key);
+}
+
+inline Encryption readEncryption(ByteReader& r){
+    Encryption encryption;
+    encryption.type = readEnum(r, EncryptionType::PromptForKey);
+    encryption.key = r.lengthPrefixed().str();
+
+    return encryption;
+}
+
+/// t= lines with their r= lines.
+inline void appendTimes(std::string& out, const std::vector<Timing>& times){
+    appendVarint(out, times.size());
+    for(const Timing& timing : times){
+        appendVarint(out, timing.start);
+        appendVarint(out, timing.end);
+        appendVarint(out, timing.repeatingTimes.size());
+        for(const RepeatingTime& rt : timing.repeatingTimes){
+            appendVarint(out, rt.interval);
+            appendVarint(out, rt.duration);
+            appendVarint(out, rt.offsetsFromStartTime.size());
+            for(uint64_t offset : rt.offsetsFromStartTime)
+                appendVarint(out, offset);
+        }
+    }
+}
+
+inline std::vector<Timing> readTimes(ByteReader& r){
+    std::vector<Timing> times;
+
+    uint64_t count = r.varint();
+    for(uint64_t i = 0; i < count; i++){
+        Timing timing;
+        timing.start = r.varint();
+        timing.end = r.varint();
+
+        uint64_t repeatCount = r.varint();
+        for(uint64_t j = 0; j < repeatCount; j++){
+            RepeatingTime rt;
+            rt.interval = r.varint();
+            rt.duration = r.varint();
+
+            uint64_t offsetCount = r.varint();
+            for(uint64_t k = 0; k < offsetCount; k++)
+                rt.offsetsFromStartTime.push_back(r.varint());
+
+            timing.repeatingTimes.push_back(rt);
+        }
+
+        times.push_back(timing);
+    }
+
+    return times;
+}
+
+inline void appendTimeZones(std::string& out, const std::vector<TimeZoneAdjustment>& adjustments){
+    appendVarint(out, adjustments.size());
+    for(const TimeZoneAdjustment& adj : adjustments){
+        appendVarint(out, adj.adjustAtTime);
+        appendSignedVarint(out, adj.adjustment);
+    }
+}
+
+inline std::vector<TimeZoneAdjustment> readTimeZones(ByteReader& r){
+    std::vector<TimeZoneAdjustment> adjustments;
+
+    uint64_t count = r.varint();
+    for(uint64_t i = 0; i < count; i++){
+        TimeZoneAdjustment adj;
+        adj.adjustAtTime = r.varint();
+        adj.adjustment = r.signedVarint();
+        adjustments.push_back(adj);
+    }
+
+    return adjustments;
+}
+
+/// m= line fields.
+inline void appendMediaDescription(std::string& out, const MediaDescription& md){
+    appendEnum(out, md.mediaType);
+    appendVarint(out, md.port);
+    appendVarint(out, md.portCount);
+    appendEnum(out, md.protocol);
+    appendVarint(out, md.payloadTypes.size());
+    out.append((const char*)md.payloadTypes.data(), md.payloadTypes.size());
+    appendLengthPrefixed(out, md.codec.view());
+}
+
+inline MediaDescription readMediaDescription(ByteReader& r){
+    MediaDescription md;
+    md.mediaType = readEnum(r, MediaType::Message);
+    md.port = (uint16_t)r.varint();
+    md.portCount = (uint16_t)r.varint();
+    md.protocol = readEnum(r, Protocol::UnknownUDP);
+
+    StringView payloadTypes = r.lengthPrefixed();
+    md.payloadTypes.assign((const uint8_t*)payloadTypes.begin(), (const uint8_t*)payloadTypes.end());
+    md.reindexPayloadTypes();
+    md.codec = r.lengthPrefixed().str();
+
+    return md;
+}
+
+/// The text after "a=". Points into the attribute for a GenericAttribute, otherwise into scratch.
+inline StringView attributeLine(const Attribute& attr, std::string& scratch){
+    if(auto generic = attr.as<GenericAttribute>())
+        return generic->line();
+
+    scratch.clear();
+    attr.appendSdpLine(scratch);
+
+    return scratch;
+}
+
+} // namespace zsdp
+
+#endif /* __ZSDP_SDP_CODEC_H__ */
@@ -0,0 +1,694 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/sdp-fixed.h>
+#include "lexer.h"
+#include "parsing.h"
+
+
+namespace zsdp {
+
+/*
+ * Nothing in this file may allocate or throw: no std::string, and only the
+ * noexcept parts of the shared lexer and line-order tables.
+ */
+
+const char* fixedStatusToString(FixedStatus status) noexcept {
+    switch(status){
+        case FixedStatus::Ok: return "Ok";
+        case FixedStatus::NotSdp: return "NotSdp";
+        case FixedStatus::Malformed: return "Malformed";
+        case FixedStatus::OutOfOrder: return "OutOfOrder";
+        case FixedStatus::Overflow: return "Overflow";
+        default: return "Unknown";
+    }
+}
+
+namespace {
+
+/// Decimal digits only, at most max.
+bool parseUnsigned(StringView s, uint64_t max, uint64_t& value){
+    if(s.empty())
+        return false;
+
+    value = 0;
+    for(char c : s){
+        if(c < '0' || c > '9')
+            return false;
+
+        uint64_t digit = c - '0';
+        if(value > (max - digit) / 10)
+            return false;
+
+        value = value * 10 + digit;
+    }
+
+    return true;
+}
+
+bool networkTypeFor(StringView s, NetworkType& type){
+    if(!s.equalsIgnoreCase("IN"))
+        return false;
+
+    type = NetworkType::IN;
+    return true;
+}
+
+bool addressTypeFor(StringView s, AddressType& type){
+    if(s.equalsIgnoreCase("IP4"))
+        type = AddressType::IP4;
+    else if(s.equalsIgnoreCase("IP6"))
+        type = AddressType::IP6;
+    else
+        return false;
+
+    return true;
+}
+
+bool bandwidthTypeFor(StringView s, BandwidthType& type){
+    if(s.equalsIgnoreCase("CT"))
+        type = BandwidthType::ConferenceTotal;
+    else if(s.equalsIgnoreCase("AS"))
+        type = BandwidthType::ApplicationSpecific;
+    else
+        return false;
+
+    return true;
+}
+
+bool encryptionTypeFor(StringView s, EncryptionType& type){
+    if(s.equalsIgnoreCase("prompt"))
+        type = EncryptionType::PromptForKey;
+    else if(s.equalsIgnoreCase("clear"))
+        type = EncryptionType::Clear;
+    else if(s.equalsIgnoreCase("base64"))
+        type = EncryptionType::Base64;
+    else if(s.equalsIgnoreCase("uri"))
+        type = EncryptionType::URI;
+    else
+        return false;
+
+    return true;
+}
+
+bool mediaTypeFor(StringView s, MediaType& type){
+    if(s.equalsIgnoreCase("video"))
+        type = MediaType::Video;
+    else if(s.equalsIgnoreCase("audio"))
+        type = MediaType::Audio;
+    else if(s.equalsIgnoreCase("text"))
+        type = MediaType::Text;
+    else if(s.equalsIgnoreCase("application"))
+        type = MediaType::Application;
+    else if(s.equalsIgnoreCase("message"))
+        type = MediaType::Message;
+    else
+        return false;
+
+    return true;
+}
+
+bool protocolFor(StringView s, Protocol& protocol){
+    if(s.equalsIgnoreCase("RTP/AVP"))
+        protocol = Protocol::RTP_AVP;
+    else if(s.equalsIgnoreCase("RTP/SAVP"))
+        protocol = Protocol::RTP_SAVP;
+    else if(s.equalsIgnoreCase("UDP"))
+        protocol = Protocol::UnknownUDP;
+    else
+        return false;
+
+    return true;
+}
+
+class FixedParser {
+public:
+    explicit FixedParser(const FixedStorage& storage) : mStorage(storage), mSession(*storage.session) {}
+
+    FixedStatus line(const SdpLine& line, bool inMedia){
+        char type = line.type >= 'A' && line.type <= 'Z' ? line.type + ('a' - 'A') : line.type;
+        StringView value = line.value;
+
+        if(inMedia && type != 'm'){
+            FixedStream& stream = mStorage.streams[mSession.streamCount - 1];
+            switch(type){
+                case 'i': return text(value, stream.title);
+                case 'c': return connectionData(value, stream.connectionData);
+                case 'b': return bandwidth(value, stream.bandwidth);
+                case 'k': return encryption(value, stream.encryption);
+                case 'a': return attribute(value, mSession.streamCount, stream.attributeCount);
+                default: return FixedStatus::OutOfOrder;
+            }
+        }
+
+        switch(type){
+            case 'v': return version(value);
+            case 'o': return origin(value);
+            case 's': return text(value, mSession.sessionName);
+            case 'i': return text(value, mSession.sessionInformation);
+            case 'u': return text(value, mSession.uri);
+            case 'e': return text(value, mSession.email);
+            case 'p': return text(value, mSession.phoneNumber);
+            case 'c': return connectionData(value, mSession.connectionData);
+            case 'b': return bandwidth(value, mSession.bandwidth);
+            case 't': return timing(value);
+            case 'r': return repeat(value);
+            case 'z': return timeZones(value);
+            case 'k': return encryption(value, mSession.encryption);
+            case 'a': return attribute(value, 0, mSession.attributeCount);
+            case 'm': return media(value);
+            default: return FixedStatus::OutOfOrder;
+        }
+    }
+
+private:
+    FixedStatus text(StringView value, FixedText& out){
+        uint32_t& used = *mStorage.textSize;
+        if(value.size() > mStorage.maxTextBytes - used)
+            return FixedStatus::Overflow;
+
+        memcpy(mStorage.text + used, value.data(), value.size());
+        out.offset = used;
+        out.size = (uint32_t)value.size();
+        used += out.size;
+
+        return FixedStatus::Ok;
+    }
+
+    /// Appends sep and value to out, which must be the last text stored.
+    FixedStatus appendText(StringView value, char sep, FixedText& out){
+        if(out.empty())
+            return text(value, out);
+
+        uint32_t& used = *mStorage.textSize;
+        if(out.offset + out.size != used || value.size() + 1 > mStorage.maxTextBytes - used)
+            return FixedStatus::Overflow;
+
+        mStorage.text[used++] = sep;
+        memcpy(mStorage.text + used, value.data(), value.size());
+        used += (uint32_t)value.size();
+        out.size += 1 + (uint32_t)value.size();
+
+        return FixedStatus::Ok;
+    }
+
+    FixedStatus version(StringView value){
+        uint64_t version;
+        if(!parseUnsigned(value, UINT32_MAX, version))
+            return FixedStatus::Malformed;
+
+        mSession.version = (uint32_t)version;
+        return FixedStatus::Ok;
+    }
+
+    FixedStatus origin(StringView value){
+        StringView tokens[6];
+        FixedOrigin& origin = mSession.origin;
+        if(splitFields(value, ' ', tokens, 6) < 6
+           || !networkTypeFor(tokens[3], origin.networkType)
+           || !addressTypeFor(tokens[4], origin.addressType))
+        {
+            return FixedStatus::Malformed;
+        }
+
+        FixedStatus status = text(tokens[0], origin.username);
+        if(status == FixedStatus::Ok)
+            status = text(tokens[1], origin.sessionID);
+
+        if(status == FixedStatus::Ok)
+            status = text(tokens[2], origin.sessionVersion);
+
+        if(status == FixedStatus::Ok)
+            status = text(tokens[5], origin.host);
+
+        return status;
+    }
+
+    FixedStatus connectionData(StringView value, FixedConnectionData& cd){
+        StringView tokens[3];
+        if(splitFields(value, ' ', tokens, 3) < 3
+           || !networkTypeFor(tokens[0], cd.networkType)
+           || !addressTypeFor(tokens[1], cd.addressType))
+        {
+            return FixedStatus::Malformed;
+        }
+
+        return text(tokens[2], cd.host);
+    }
+
+    FixedStatus bandwidth(StringView value, Bandwidth& bandwidth){
+        StringView tokens[2];
+        if(splitFields(value, ':', tokens, 2) != 2
+           || !bandwidthTypeFor(tokens[0], bandwidth.type)
+           || !parseUnsigned(tokens[1], UINT64_MAX, bandwidth.kbps))
+        {
+            return FixedStatus::Malformed;
+        }
+
+        return FixedStatus::Ok;
+    }
+
+    FixedStatus timing(StringView value){
+        if(mSession.timeCount == kFixedMaxTimes)
+            return FixedStatus::Overflow;
+
+        StringView tokens[2];
+        FixedTiming& timing = mSession.times[mSession.timeCount];
+        timing = FixedTiming();
+        if(splitFields(value, ' ', tokens, 2) != 2
+           || !parseUnsigned(tokens[0], UINT64_MAX, timing.start)
+           || !parseUnsigned(tokens[1], UINT64_MAX, timing.end))
+        {
+            return FixedStatus::Malformed;
+        }
+
+        mSession.timeCount++;
+        return FixedStatus::Ok;
+    }
+
+    /// The line order puts r= lines right after their t= line, so they are stored next to each other.
+    FixedStatus repeat(StringView value){
+        StringView tokens[3];
+        if(splitFields(value, ' ', tokens, 3) < 3)
+            return FixedStatus::Malformed;
+
+        return appendText(value, '\n', mSession.times[mSession.timeCount - 1].repeats);
+    }
+
+    FixedStatus timeZones(StringView value){
+        if(splitFields(value, ' ', NULL, 0) % 2 != 0)
+            return FixedStatus::Malformed;
+
+        return text(value, mSession.timeZones);
+    }
+
+    FixedStatus encryption(StringView value, FixedEncryption& encryption){
+        size_t colon = value.find(':');
+        if(!encryptionTypeFor(value.substr(0, colon), encryption.type))
+            return FixedStatus::Malformed;
+
+        encryption.key = FixedText();
+        if(colon == StringView::npos)
+            return FixedStatus::Ok;
+
+        return text(value.substr(colon + 1), encryption.key);
+    }
+
+    FixedStatus attribute(StringView value, size_t section, uint32_t& count){
+        if(count == mStorage.maxAttributesPerSection)
+            return FixedStatus::Overflow;
+
+        FixedStatus status = text(value, mStorage.attributes[section * mStorage.maxAttributesPerSection + count]);
+        if(status == FixedStatus::Ok)
+            count++;
+
+        return status;
+    }
+
+    FixedStatus media(StringView value){
+        if(mSession.streamCount == mStorage.maxStreams)
+            return FixedStatus::Overflow;
+
+        FixedStream& stream = mStorage.streams[mSession.streamCount];
+        stream = FixedStream();
+
+        StringView tokens[4];
+        if(splitFields(value, ' ', tokens, 4) < 4
+           || !mediaTypeFor(tokens[0], stream.mediaType)
+           || !protocolFor(tokens[2], stream.protocol))
+        {
+            return FixedStatus::Malformed;
+        }
+
+        size_t slash = tokens[1].find('/');
+        uint64_t port;
+        uint64_t portCount = 0;
+        if(!parseUnsigned(tokens[1].substr(0, slash), UINT16_MAX, port)
+           || (slash != StringView::npos && !parseUnsigned(tokens[1].substr(slash + 1), UINT16_MAX, portCount)))
+        {
+            return FixedStatus::Malformed;
+        }
+
+        stream.port = (uint16_t)port;
+        stream.portCount = (uint16_t)portCount;
+
+        if(stream.protocol == Protocol::RTP_AVP || stream.protocol == Protocol::RTP_SAVP){
+            uint8_t* payloadTypes = mStorage.payloadTypes + mSession.streamCount * mStorage.maxPayloadTypes;
+
+            FieldReader reader(value, ' ');
+            StringView field;
+            for(size_t i = 0; reader.next(field); i++){
+                if(i < 3)
+                    continue;
+
+                uint64_t payloadType;
+                if(!parseUnsigned(field, kMaxPayloadType, payloadType))
+                    return FixedStatus::Malformed;
+
+                if(stream.payloadTypeCount == mStorage.maxPayloadTypes)
+                    return FixedStatus::Overflow;
+
+                payloadTypes[stream.payloadTypeCount++] = (uint8_t)payloadType;
+            }
+        }
+        else if(stream.protocol == Protocol::UnknownUDP){
+            FixedStatus status = text(tokens[3], stream.codec);
+            if(status != FixedStatus::Ok)
+                return status;
+        }
+
+        mSession.streamCount++;
+        return FixedStatus::Ok;
+    }
+
+    const FixedStorage& mStorage;
+    FixedSession& mSession;
+};
+
+/// Writes into a caller-owned buffer, counting the bytes that did not fit.
+class FixedWriter {
+public:
+    FixedWriter(const FixedStorage& storage, char* out, size_t capacity)
+        : mStorage(storage), mOut(out), mCapacity(capacity), mSize(0) {}
+
+    size_t size() const { return mSize; }
+    bool overflowed() const { return mSize > mCapacity; }
+
+    bool write(){
+        const FixedSession& session = *mStorage.session;
+
+        beginLine('v');
+        putUInt(session.version);
+        endLine();
+
+        beginLine('o');
+        putOrDash(session.origin.username);
+        put(' ');
+        putOrDash(session.origin.sessionID);
+        put(' ');
+        putOrDash(session.origin.sessionVersion);
+        put(' ');
+        put(networkTypeToken(session.origin.networkType));
+        put(' ');
+        put(addressTypeToken(session.origin.addressType));
+        put(' ');
+        putAddress(session.origin.host, session.origin.addressType);
+        endLine();
+
+        if(session.sessionName.empty())
+            line('s', " ");
+        else
+            line('s', session.sessionName);
+
+        optionalLine('i', session.sessionInformation);
+        optionalLine('u', session.uri);
+        optionalLine('e', session.email);
+        optionalLine('p', session.phoneNumber);
+        connectionData(session.connectionData);
+        bandwidth(session.bandwidth);
+
+        if(session.timeCount == 0)
+            line('t', "0 0");
+
+        for(uint32_t i = 0; i < session.timeCount; i++){
+            const FixedTiming& timing = session.times[i];
+            beginLine('t');
+            putUInt(timing.start);
+            put(' ');
+            putUInt(timing.end);
+            endLine();
+
+            FieldReader repeats(text(timing.repeats), '\n');
+            StringView repeat;
+            while(!timing.repeats.empty() && repeats.next(repeat))
+                line('r', repeat);
+        }
+
+        optionalLine('z', session.timeZones);
+        encryption(session.encryption);
+
+        for(uint32_t i = 0; i < session.attributeCount; i++)
+            line('a', mStorage.attributes[i]);
+
+        for(uint32_t i = 0; i < session.streamCount; i++){
+            if(!stream(i))
+                return false;
+        }
+
+        return true;
+    }
+
+private:
+    bool stream(size_t index){
+        const FixedStream& stream = mStorage.streams[index];
+
+        beginLine('m');
+        put(mediaTypeToken(stream.mediaType));
+        put(' ');
+        putUInt(stream.port);
+        if(stream.portCount > 1){
+            put('/');
+            putUInt(stream.portCount);
+        }
+
+        put(' ');
+        put(protocolToken(stream.protocol));
+
+        if(stream.protocol == Protocol::RTP_AVP || stream.protocol == Protocol::RTP_SAVP){
+            if(stream.payloadTypeCount == 0)
+                return false;
+
+            const uint8_t* payloadTypes = mStorage.payloadTypes + index * mStorage.maxPayloadTypes;
+            for(uint32_t i = 0; i < stream.payloadTypeCount; i++){
+                put(' ');
+                putUInt(payloadTypes[i]);
+            }
+        }
+        else if(stream.protocol == Protocol::UnknownUDP){
+            if(stream.codec.empty())
+                return false;
+
+            put(' ');
+            put(text(stream.codec));
+        }
+        else
+            return false;
+
+        endLine();
+
+        optionalLine('i', stream.title);
+        connectionData(stream.connectionData);
+        bandwidth(stream.bandwidth);
+        encryption(stream.encryption);
+
+        const FixedText* attributes = mStorage.attributes + (index + 1) * mStorage.maxAttributesPerSection;
+        for(uint32_t i = 0; i < stream.attributeCount; i++)
+            line('a', attributes[i]);
+
+        return true;
+    }
+
+    void connectionData(const FixedConnectionData& cd){
+        if(cd.addressType == AddressType::NotSet)
+            return;
+
+        beginLine('c');
+        put(networkTypeToken(cd.networkType));
+        put(' ');
+        put(addressTypeToken(cd.addressType));
+        put(' ');
+        putAddress(cd.host, cd.addressType);
+        endLine();
+    }
+
+    void bandwidth(const Bandwidth& bandwidth){
+        if(bandwidth.type == BandwidthType::NotSet)
+            return;
+
+        beginLine('b');
+        put(bandwidth.type == BandwidthType::ConferenceTotal ? "CT" : "AS");
+        put(':');
+        putUInt(bandwidth.kbps);
+        endLine();
+    }
+
+    void encryption(const FixedEncryption& encryption){
+        if(encryption.type == EncryptionType::NotSet)
+            return;
+
+        beginLine('k');
+        put(encryptionTypeToken(encryption.type));
+        if(encryption.type != EncryptionType::PromptForKey){
+            put(':');
+            put(text(encryption.key));
+        }
+
+        endLine();
+    }
+
+    static StringView networkTypeToken(NetworkType){
+        return "IN";
+    }
+
+    static StringView addressTypeToken(AddressType type){
+        return type == AddressType::IP6 ? "IP6" : "IP4";
+    }
+
+    static StringView encryptionTypeToken(EncryptionType type){
+        switch(type){
+            case EncryptionType::Clear: return "clear";
+            case EncryptionType::Base64: return "base64";
+            case EncryptionType::URI: return "uri";
+            case EncryptionType::PromptForKey: return "prompt";
+            default: return "";
+        }
+    }
+
+    static StringView mediaTypeToken(MediaType type){
+        switch(type){
+            case MediaType::Video: return "video";
+            case MediaType::Audio: return "audio";
+            case MediaType::Application: return "application";
+            case MediaType::Message: return "message";
+            case MediaType::Text: return "text";
+            default: return "";
+        }
+    }
+
+    static StringView protocolToken(Protocol protocol){
+        switch(protocol){
+            case Protocol::RTP_AVP: return "RTP/AVP";
+            case Protocol::RTP_SAVP: return "RTP/SAVP";
+            case Protocol::UnknownUDP: return "udp";
+            default: return "";
+        }
+    }
+
+    StringView text(FixedText t) const {
+        return StringView(mStorage.text + t.offset, t.size);
+    }
+
+    void put(char c){
+        if(mSize < mCapacity)
+            mOut[mSize] = c;
+
+        mSize++;
+    }
+
+    void put(StringView v){
+        if(mSize <= mCapacity && v.size() <= mCapacity - mSize)
+            memcpy(mOut + mSize, v.data(), v.size());
+
+        mSize += v.size();
+    }
+
+    void putUInt(uint64_t n){
+        char digits[20];
+        size_t count = 0;
+        do{
+            digits[count++] = (char)('0' + n % 10);
+            n /= 10;
+        } while(n > 0);
+
+        while(count > 0)
+            put(digits[--count]);
+    }
+
+    void putOrDash(FixedText t){
+        put(t.empty() ? StringView("-", 1) : text(t));
+    }
+
+    void putAddress(FixedText host, AddressType type){
+        if(!host.empty())
+            put(text(host));
+        else
+            put(type == AddressType::IP6 ? "::" : "0.0.0.0");
+    }
+
+    void beginLine(char type){
+        put(type);
+        put('=');
+    }
+
+    void endLine(){
+        put(StringView("\r\n", 2));
+    }
+
+    void line(char type, StringView value){
+        beginLine(type);
+        put(value);
+        endLine();
+    }
+
+    void line(char type, FixedText value){
+        line(type, text(value));
+    }
+
+    void optionalLine(char type, FixedText value){
+        if(!value.empty())
+            line(type, value);
+    }
+
+    const FixedStorage& mStorage;
+    char* mOut;
+    size_t mCapacity;
+    size_t mSize;
+};
+
+} // namespace
+
+FixedStatus parseSdpFixed(StringView sdp, const FixedStorage& storage) noexcept {
+    *storage.session = FixedSession();
+    *storage.textSize = 0;
+
+    if(!sdp.startsWith("v="))
+        return FixedStatus::NotSdp;
+
+    FixedParser parser(storage);
+    SdpLineOrder order;
+    SdpLexer lexer(sdp);
+
+    SdpLine line;
+    while(lexer.next(&line)){
+        SdpLineOrder::Verdict verdict = order.next(line.type);
+        if(verdict == SdpLineOrder::Ignore)
+            continue;
+        else if(verdict == SdpLineOrder::Reject)
+            return FixedStatus::OutOfOrder;
+
+        FixedStatus status = parser.line(line, order.inMedia());
+        if(status != FixedStatus::Ok)
+            return status;
+    }
+
+    return order.complete() ? FixedStatus::Ok : FixedStatus::OutOfOrder;
+}
+
+FixedStatus writeSdpFixed(const FixedStorage& storage, char* out, size_t capacity, size_t* size) noexcept {
+    FixedWriter writer(storage, out, capacity);
+    bool valid = writer.write();
+    *size = writer.size();
+
+    if(!valid)
+        return FixedStatus::Malformed;
+
+    return writer.overflowed() ? FixedStatus::Overflow : FixedStatus::Ok;
+}
+
+} // namespace zsdp
@@ -0,0 +1,576 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/sdp-merge.h>
+#include <zsdp/payload-table.h>
+#include "sdp-writer.h"
+#include "string-util.h"
+#include <algorithm>
+#include <stdexcept>
+
+
+using namespace std;
+
+namespace zsdp {
+
+namespace {
+
+/// One-byte extmap headers carry IDs 1-14; RFC 8285 two-byte headers go up to 255.
+constexpr uint16_t kMaxOneByteExtmapId = 14;
+constexpr uint16_t kMaxExtmapId = 255;
+
+/// The decimal number at s[pos], or -1 if there are no digits there. *end is set past the last digit.
+int32_t parseNumber(StringView s, size_t pos, size_t* end){
+    int32_t n = -1;
+    size_t i = pos;
+    for(; i < s.size() && s[i] >= '0' && s[i] <= '9' && i - pos < 9; i++)
+        n = (n < 0 ? 0 : n * 10) + (s[i] - '0');
+
+    *end = i;
+    return n;
+}
+
+/// FNV-1a.
+uint64_t stringHash(StringView s){
+    uint64_t hash = 14695981039346656037ull;
+    for(char c : s)
+        hash = (hash ^ (uint8_t)c) * 1099511628211ull;
+
+    return hash;
+}
+
+/// FNV-1a over the lower-cased encoding name and the rest of the codec.
+uint64_t codecHash(StringView encodingName, uint32_t clockRate, uint32_t channels, StringView formatParams){
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint8_t c){ hash = (hash ^ c) * 1099511628211ull; };
+
+    for(char c : encodingName)
+        mix((uint8_t)(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c));
+
+    for(int shift = 0; shift < 32; shift += 8){
+        mix((uint8_t)(clockRate >> shift));
+        mix((uint8_t)(channels >> shift));
+    }
+
+    for(char c : formatParams)
+        mix((uint8_t)c);
+
+    return hash;
+}
+
+/// Replaces s[pos, end) with n.
+void replaceNumber(string& s, size_t pos, size_t end, uint32_t n){
+    string digits;
+    appendUInt(digits, n);
+    s.replace(pos, end - pos, digits);
+}
+
+/// attr's line without "a=". GenericAttributes, as mid and extmap are, are read in place; others are written to scratch.
+StringView lineOf(const Attribute& attr, string& scratch){
+    if(const GenericAttribute* generic = attr.as<GenericAttribute>())
+        return generic->line();
+
+    scratch.clear();
+    attr.appendSdpLine(scratch);
+    return scratch;
+}
+
+bool isRtp(Protocol protocol){
+    return protocol == Protocol::RTP_AVP || protocol == Protocol::RTP_SAVP;
+}
+
+bool isBundleGroup(const Attribute& attr){
+    return attr.key() == "group" && StringView(attr.value()).startsWith("BUNDLE");
+}
+
+} // namespace
+
+SdpMerger::SdpMerger(const Sdp& session) : mSession(session), mUsedExtmapIds(kMaxExtmapId + 1, false) {
+    mSession.streams.clear();
+}
+
+size_t SdpMerger::add(const SdpSnapshot& source, size_t streamIndex){
+    if(streamIndex >= source.streamCount())
+        throw out_of_range("Stream " + to_string(streamIndex) + " is out of range.");
+
+    return add(source.sharedStream(streamIndex));
+}
+
+size_t SdpMerger::add(sp<const Stream> section){
+    if(section == NULL)
+        throw invalid_argument("The section cannot be NULL.");
+
+    const Stream& stream = *section;
+    const MediaDescription& md = stream.mediaDescription;
+
+    Section entry;
+    entry.stream = section;
+    entry.listed = md.payloadTypeSet;
+
+    // Attribute values are read through lineOf() rather than value(), which allocates for each.
+    string line;
+    StringView sourceMid;
+    for(const sp<Attribute>& attr : stream.attributes){
+        if(attr->key() == "mid"){
+            sourceMid = lineOf(*attr, line).substr(4);
+            entry.hasMid = true;
+            break;
+        }
+    }
+
+    entry.mid = assignMid(sourceMid, mSections.size());
+    entry.unchanged = entry.hasMid && entry.mid == sourceMid;
+
+    // Rejected sections aren't bundled, so their numbers can't clash.
+    if(md.port != 0 && isRtp(md.protocol)){
+        // Only the listed payload types' slots are ever read.
+        const AttrRtpMap* rtpMaps[kMaxPayloadType + 1];
+        const AttrFormatParams* fmtps[kMaxPayloadType + 1];
+        for(uint8_t pt : md.payloadTypes){
+            rtpMaps[pt & kMaxPayloadType] = NULL;
+            fmtps[pt & kMaxPayloadType] = NULL;
+        }
+
+        for(const AttrRtpMap& rtpMap : stream.findAll<AttrRtpMap>()){
+            if(entry.listed.contains(rtpMap.payloadType) && rtpMaps[rtpMap.payloadType] == NULL)
+                rtpMaps[rtpMap.payloadType] = &rtpMap;
+        }
+
+        for(const AttrFormatParams& fmtp : stream.findAll<AttrFormatParams>()){
+            if(entry.listed.contains(fmtp.payloadType) && fmtps[fmtp.payloadType] == NULL)
+                fmtps[fmtp.payloadType] = &fmtp;
+        }
+
+        // RTX and other formats that refer to another payload type go second, once that one's number is known.
+        PayloadTypeSet done;
+        PayloadTypeSet taken;
+        for(int pass = 0; pass < 2; pass++){
+            for(uint8_t pt : md.payloadTypes){
+                if(pt > kMaxPayloadType || done.contains(pt))
+                    continue;
+
+                const AttrFormatParams* fmtp = fmtps[pt];
+                bool refers = fmtp != NULL && fmtp->params().has("apt");
+                if(refers != (pass == 1))
+                    continue;
+
+                done.insert(pt);
+
+                StringView formatParams;
+                if(fmtp != NULL){
+                    formatParams = fmtp->formatParams;
+
+                    if(refers && !entry.payloadTypes.empty()){
+                        line = fmtp->formatParams;
+                        if(rewriteApt(entry, line, 0))
+                            formatParams = line;
+                    }
+                }
+
+                uint8_t to;
+                if(const AttrRtpMap* rtpMap = rtpMaps[pt])
+                    to = assignPayloadType(pt, false, taken, rtpMap->encodingName, rtpMap->clockRate, rtpMap->audioChannelCount, formatParams);
+                else{
+                    const PayloadInfo& info = PayloadTable::staticPayloadType(pt);
+                    to = assignPayloadType(pt, true, taken, info.encodingName, info.clockRate, info.channels, formatParams);
+                }
+
+                taken.insert(to);
+
+                if(to != pt)
+                    entry.payloadTypes.push_back({pt, to});
+            }
+        }
+    }
+
+    if(md.port != 0){
+        for(const sp<Attribute>& attr : stream.attributes){
+            if(attr->key() != "extmap")
+                continue;
+
+            // extmap:<id>[/<direction>] <uri> [<attributes>]
+            StringView value = lineOf(*attr, line).substr(7);
+            size_t idEnd;
+            int32_t id = parseNumber(value, 0, &idEnd);
+            size_t uriStart = value.find(' ', idEnd);
+            if(id <= 0 || id > kMaxExtmapId || uriStart == StringView::npos)
+                continue;
+
+            StringView uri = value.substr(uriStart + 1);
+            uri = uri.substr(0, uri.find(' '));
+
+            uint16_t to = assignExtmapId((uint16_t)id, uri);
+            if(to != id)
+                entry.extmapIds.push_back({(uint16_t)id, to});
+        }
+    }
+
+    entry.unchanged = entry.unchanged && entry.payloadTypes.empty() && entry.extmapIds.empty();
+
+    mSections.push_back(std::move(entry));
+    return mSections.size() - 1;
+}
+
+uint8_t SdpMerger::assignPayloadType(uint8_t pt,
+                                     bool fixed,
+                                     const PayloadTypeSet& taken,
+                                     const Symbol& encodingName,
+                                     uint32_t clockRate,
+                                     uint32_t channels,
+                                     StringView formatParams){
+    uint64_t hash = codecHash(encodingName.view(), clockRate, channels, formatParams);
+
+    // A section that lists one codec twice keeps both numbers apart.
+    for(const Codec& existing : mCodecs){
+        if(existing.hash == hash
+           && existing.clockRate == clockRate
+           && existing.channels == channels
+           && existing.encodingName.equalsIgnoreCase(encodingName)
+           && StringView(existing.formatParams) == formatParams
+           && !taken.contains(existing.payloadType)
+           && (!fixed || existing.payloadType == pt))
+            return existing.payloadType;
+    }
+
+    uint8_t to = pt;
+    if(mUsedPayloadTypes.contains(pt)){
+        if(fixed)
+            throw runtime_error("Payload type " + to_string(pt) + " has no rtpmap and is already used by another codec.");
+
+        // The dynamic range first, then the unassigned part of the static range (RFC 3551, RFC 5761).
+        PayloadTypeSet free;
+        for(uint8_t candidate = 96; candidate <= kMaxPayloadType; candidate++)
+            free.insert(candidate);
+
+        free -= mUsedPayloadTypes;
+        if(free.empty()){
+            for(uint8_t candidate = 35; candidate <= 63; candidate++)
+                free.insert(candidate);
+
+            free -= mUsedPayloadTypes;
+        }
+
+        if(free.empty())
+            throw runtime_error("No payload types are left for " + encodingName.str() + ".");
+
+        to = free.first();
+    }
+
+    mUsedPayloadTypes.insert(to);
+    mCodecs.push_back({hash, encodingName, clockRate, channels, formatParams.str(), to});
+
+    return to;
+}
+
+uint16_t SdpMerger::assignExtmapId(uint16_t id, StringView uri){
+    for(const Extension& extension : mExtensions){
+        if(extension.uri == uri)
+            return extension.id;
+    }
+
+    uint16_t to = id;
+    if(mUsedExtmapIds[id] || id == kMaxOneByteExtmapId + 1){
+        to = 0;
+        for(uint16_t candidate = 1; candidate <= kMaxExtmapId && to == 0; candidate++){
+            if(candidate != kMaxOneByteExtmapId + 1 && !mUsedExtmapIds[candidate])
+                to = candidate;
+        }
+
+        if(to == 0)
+            throw runtime_error("No extmap IDs are left for " + uri.str() + ".");
+    }
+
+    mUsedExtmapIds[to] = true;
+    mExtensions.push_back({uri.str(), to});
+
+    return to;
+}
+
+bool SdpMerger::midTaken(StringView mid, uint64_t hash) const{
+    auto it = lower_bound(mMidIndex.begin(), mMidIndex.end(), make_pair(hash, (size_t)0));
+    for(; it != mMidIndex.end() && it->first == hash; ++it){
+        if(StringView(mSections[it->second].mid) == mid)
+            return true;
+    }
+
+    return false;
+}
+
+string SdpMerger::assignMid(StringView preferred, size_t section){
+    string mid;
+    uint64_t hash = stringHash(preferred);
+
+    if(!preferred.empty() && !midTaken(preferred, hash))
+        mid = preferred.str();
+    else{
+        do{
+            mid = to_string(mNextMid++);
+            hash = stringHash(mid);
+        } while(midTaken(mid, hash));
+    }
+
+    auto entry = make_pair(hash, section);
+    mMidIndex.insert(upper_bound(mMidIndex.begin(), mMidIndex.end(), entry), entry);
+
+    return mid;
+}
+
+uint8_t SdpMerger::mappedPayloadType(const Section& section, uint8_t pt){
+    for(const Remap<uint8_t>& remap : section.payloadTypes){
+        if(remap.from == pt)
+            return remap.to;
+    }
+
+    return pt;
+}
+
+uint16_t SdpMerger::mappedExtmapId(const Section& section, uint16_t id){
+    for(const Remap<uint16_t>& remap : section.extmapIds){
+        if(remap.from == id)
+            return remap.to;
+    }
+
+    return id;
+}
+
+bool SdpMerger::rewriteApt(const Section& section, string& params, size_t pos){
+    bool changed = false;
+
+    while(pos < params.size()){
+        size_t end = params.find(';', pos);
+        if(end == string::npos)
+            end = params.size();
+
+        size_t key = pos;
+        while(key < end && params[key] == ' ')
+            key++;
+
+        size_t digits = key + 4;
+        size_t digitsEnd;
+        int32_t pt;
+        if(StringView(params).substr(key, 4).equalsIgnoreCase("apt=")
+           && (pt = parseNumber(params, digits, &digitsEnd)) >= 0
+           && pt <= kMaxPayloadType){
+            uint8_t to = mappedPayloadType(section, (uint8_t)pt);
+            if(to != pt){
+                size_t before = params.size();
+                replaceNumber(params, digits, digitsEnd, to);
+                end = end + params.size() - before;
+                changed = true;
+            }
+        }
+
+        pos = end + 1;
+    }
+
+    return changed;
+}
+
+uint8_t SdpMerger::payloadType(size_t i, uint8_t pt) const{
+    const Section& section = mSections.at(i);
+    return section.listed.contains(pt) ? mappedPayloadType(section, pt) : kPayloadType_NotSet;
+}
+
+uint16_t SdpMerger::extmapId(size_t i, uint16_t id) const{
+    const Section& section = mSections.at(i);
+    for(const sp<Attribute>& attr : section.stream->attributes){
+        if(attr->key() != "extmap")
+            continue;
+
+        size_t idEnd;
+        if(parseNumber(attr->value(), 0, &idEnd) == id)
+            return mappedExtmapId(section, id);
+    }
+
+    return 0;
+}
+
+bool SdpMerger::rewrite(const Section& section, const Attribute& attr, string& line) const{
+    size_t start = line.size();
+    attr.appendSdpLine(line);
+
+    StringView key = attr.key();
+    size_t valueStart = start + key.size() + 1;
+    size_t numberEnd;
+
+    if(key == "rtpmap" || key == "fmtp" || key == "rtcp-fb"){
+        if(section.payloadTypes.empty())
+            return false;
+
+        int32_t pt = parseNumber(line, valueStart, &numberEnd);
+        if(pt < 0 || pt > kMaxPayloadType || (numberEnd < line.size() && line[numberEnd] != ' '))
+            return false;   // "*", or not ours to fix.
+
+        bool changed = key == "fmtp" && rewriteApt(section, line, numberEnd);
+
+        uint8_t to = mappedPayloadType(section, (uint8_t)pt);
+        if(to != pt){
+            replaceNumber(line, valueStart, numberEnd, to);
+            changed = true;
+        }
+
+        return changed;
+    }
+
+    if(key == "extmap"){
+        if(section.extmapIds.empty())
+            return false;
+
+        int32_t id = parseNumber(line, valueStart, &numberEnd);
+        if(id <= 0 || id > kMaxExtmapId)
+            return false;
+
+        uint16_t to = mappedExtmapId(section, (uint16_t)id);
+        if(to == id)
+            return false;
+
+        replaceNumber(line, valueStart, numberEnd, to);
+        return true;
+    }
+
+    if(key == "mid" && StringView(line).substr(valueStart) != section.mid){
+        line.resize(valueStart);
+        line += section.mid;
+        return true;
+    }
+
+    return false;
+}
+
+AttributeList SdpMerger::sessionAttributes() const{
+    AttributeList attributes;
+
+    string group = "group:BUNDLE";
+    bool bundled = false;
+    for(const Section& section : mSections){
+        if(section.stream->mediaDescription.port != 0){
+            group += ' ';
+            group += section.mid;
+            bundled = true;
+        }
+    }
+
+    if(bundled)
+        attributes.push_back(make_shared<GenericAttribute>(group));
+
+    bool allowMixed = false;
+    for(const sp<Attribute>& attr : mSession.attributes){
+        if(isBundleGroup(*attr))
+            continue;
+
+        allowMixed = allowMixed || attr->key() == "extmap-allow-mixed";
+        attributes.push_back(attr);
+    }
+
+    // IDs above 14 need two-byte headers, which the answerer must be told may be mixed with one-byte ones (RFC 8285).
+    if(!allowMixed){
+        for(const Extension& extension : mExtensions){
+            if(extension.id > kMaxOneByteExtmapId){
+                attributes.push_back(make_shared<GenericAttribute>("extmap-allow-mixed"));
+                break;
+            }
+        }
+    }
+
+    return attributes;
+}
+
+void SdpMerger::writeSection(string& out, const Section& section) const{
+    SdpWriter writer(out);
+    const Stream& stream = *section.stream;
+
+    if(section.unchanged){
+        writer.write(stream);
+        return;
+    }
+
+    if(section.payloadTypes.empty())
+        writer.writeMediaLines(stream, stream.mediaDescription);
+    else{
+        MediaDescription md = stream.mediaDescription;
+        for(uint8_t& pt : md.payloadTypes)
+            pt = mappedPayloadType(section, pt);
+
+        writer.writeMediaLines(stream, md);
+    }
+
+    if(!section.hasMid)
+        writer.line('a', "mid:" + section.mid);
+
+    string line;
+    for(const sp<Attribute>& attr : stream.attributes){
+        line.clear();
+        rewrite(section, *attr, line);
+        writer.line('a', line);
+    }
+}
+
+void SdpMerger::write(string& out) const{
+    SdpWriter writer(out);
+    writer.writeSessionLines(mSession);
+
+    for(const sp<Attribute>& attr : sessionAttributes())
+        writer.write(*attr);
+
+    for(const Section& section : mSections)
+        writeSection(out, section);
+}
+
+string SdpMerger::toString() const{
+    string out;
+    write(out);
+
+    return out;
+}
+
+Sdp SdpMerger::toSdp() const{
+    Sdp sdp = mSession;
+    sdp.attributes = sessionAttributes();
+    sdp.streams.reserve(mSections.size());
+
+    for(const Section& section : mSections){
+        Stream stream = *section.stream;
+
+        if(!section.unchanged){
+            for(uint8_t& pt : stream.mediaDescription.payloadTypes)
+                pt = mappedPayloadType(section, pt);
+
+            stream.mediaDescription.reindexPayloadTypes();
+
+            AttributeList attributes;
+            if(!section.hasMid)
+                attributes.push_back(parseAttribute("mid:" + section.mid));
+
+            string line;
+            for(const sp<Attribute>& attr : stream.attributes){
+                line.clear();
+                attributes.push_back(rewrite(section, *attr, line) ? parseAttribute(line) : attr);
+            }
+
+            stream.attributes = std::move(attributes);
+            stream.reindexAttributes();
+        }
+
+        sdp.streams.push_back(std::move(stream));
+    }
+
+    return sdp;
+}
+
+} // namespace zsdp
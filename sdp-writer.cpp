@@ -0,0 +1,299 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sdp-writer.h"
+#include "string-util.h"
+#include <stdexcept>
+
+
+using namespace std;
+
+namespace zsdp {
+
+
+static const char CRLF[] = "\r\n";
+
+static StringView dashIfEmpty(const string& s){
+    if(s.empty())
+        return "-";
+    else
+        return s;
+}
+
+static StringView nullAddrIfEmpty(const string& s, AddressType t){
+    if(s.empty()){
+        if(t == AddressType::IP4)
+            return "0.0.0.0";
+        else if(t == AddressType::IP6)
+            return "::";
+        else
+            throw invalid_argument("Unknown Address Type " + to_string((uint32_t)t));
+    }
+
+    return s;
+}
+
+static StringView bandwidthTypeToStr(BandwidthType type){
+    switch(type){
+        case BandwidthType::ConferenceTotal: return "CT";
+        case BandwidthType::ApplicationSpecific: return "AS";
+        default: return "";
+    }
+}
+
+static StringView encTypeToStr(EncryptionType type){
+    switch(type){
+        case EncryptionType::Base64: return "base64";
+        case EncryptionType::Clear: return "clear";
+        case EncryptionType::PromptForKey: return "prompt";
+        case EncryptionType::URI: return "uri";
+        default: return "";
+    }
+}
+
+void SdpWriter::beginLine(char type){
+    mOut += type;
+    mOut += '=';
+}
+
+void SdpWriter::endLine(){
+    mOut.append(CRLF, 2);
+}
+
+void SdpWriter::line(char type, StringView value){
+    beginLine(type);
+    mOut += value;
+    endLine();
+}
+
+void SdpWriter::write(const Sdp& sdp){
+    writeSessionLines(sdp);
+
+    for(auto& attr : sdp.attributes)
+        write(*attr);
+
+    for(auto& stream : sdp.streams)
+        write(stream);
+}
+
+void SdpWriter::writeSessionLines(const Sdp& sdp){
+    beginLine('v');
+    appendUInt(mOut, sdp.version);
+    endLine();
+
+    beginLine('o');
+    value(sdp.origin);
+    endLine();
+
+    if(sdp.sessionName.empty())
+        line('s', " ");
+    else
+        line('s', sdp.sessionName);
+
+    if(!sdp.sessionInformation.empty())
+        line('i', sdp.sessionInformation);
+
+    if(!sdp.uri.empty())
+        line('u', sdp.uri);
+
+    if(!sdp.email.empty())
+        line('e', sdp.email);
+
+    if(!sdp.phoneNumber.empty())
+        line('p', sdp.phoneNumber);
+
+    if(sdp.connectionData.addressType != AddressType::NotSet){
+        beginLine('c');
+        value(sdp.connectionData);
+        endLine();
+    }
+
+    if(sdp.bandwidth.type != BandwidthType::NotSet){
+        beginLine('b');
+        value(sdp.bandwidth);
+        endLine();
+    }
+
+    if(sdp.times.empty())
+        line('t', "0 0");
+    else{
+        for(auto& timing : sdp.times){
+            beginLine('t');
+            value(timing);
+            endLine();
+
+            for(auto& repeatingTime : timing.repeatingTimes){
+                beginLine('r');
+                value(repeatingTime);
+                endLine();
+            }
+        }
+    }
+
+    if(!sdp.timeZoneAdjustments.empty()){
+        beginLine('z');
+
+        for(size_t i = 0; i < sdp.timeZoneAdjustments.size(); i++){
+            if(i > 0)
+                mOut += ' ';
+
+            appendUInt(mOut, sdp.timeZoneAdjustments[i].adjustAtTime);
+            mOut += ' ';
+            appendInt(mOut, sdp.timeZoneAdjustments[i].adjustment);
+        }
+
+        endLine();
+    }
+
+    if(sdp.encryption.type != EncryptionType::NotSet){
+        beginLine('k');
+        value(sdp.encryption);
+        endLine();
+    }
+}
+
+void SdpWriter::write(const Stream& stream){
+    writeMediaLines(stream, stream.mediaDescription);
+
+    for(auto& attr : stream.attributes)
+        write(*attr);
+}
+
+void SdpWriter::writeMediaLines(const Stream& stream, const MediaDescription& mediaDescription){
+    beginLine('m');
+    value(mediaDescription);
+    endLine();
+
+    if(!stream.title.empty())
+        line('i', stream.title);
+
+    if(stream.connectionData.addressType != AddressType::NotSet){
+        beginLine('c');
+        value(stream.connectionData);
+        endLine();
+    }
+
+    if(stream.bandwidth.type != BandwidthType::NotSet){
+        beginLine('b');
+        value(stream.bandwidth);
+        endLine();
+    }
+
+    if(stream.encryption.type != EncryptionType::NotSet){
+        beginLine('k');
+        value(stream.encryption);
+        endLine();
+    }
+}
+
+void SdpWriter::write(const Attribute& attr){
+    beginLine('a');
+    attr.appendSdpLine(mOut);
+    endLine();
+}
+
+void SdpWriter::value(const Origin& origin){
+    mOut += dashIfEmpty(origin.username);
+    mOut += ' ';
+    mOut += dashIfEmpty(origin.sessionID);
+    mOut += ' ';
+    mOut += dashIfEmpty(origin.sessionVersion);
+    mOut += ' ';
+    mOut += networkTypeToString(origin.networkType);
+    mOut += ' ';
+    mOut += addressTypeToString(origin.addressType);
+    mOut += ' ';
+    mOut += nullAddrIfEmpty(origin.host, origin.addressType);
+}
+
+void SdpWriter::value(const ConnectionData& connectionData){
+    mOut += networkTypeToString(connectionData.networkType);
+    mOut += ' ';
+    mOut += addressTypeToString(connectionData.addressType);
+    mOut += ' ';
+    mOut += nullAddrIfEmpty(connectionData.host, connectionData.addressType);
+}
+
+void SdpWriter::value(const MediaDescription& mediaDescription){
+    mOut += mediaTypeToString(mediaDescription.mediaType);
+    mOut += ' ';
+    appendUInt(mOut, mediaDescription.port);
+
+    if(mediaDescription.portCount > 1){
+        mOut += '/';
+        appendUInt(mOut, mediaDescription.portCount);
+    }
+
+    mOut += ' ';
+    mOut += protocolToString(mediaDescription.protocol);
+
+    Protocol protocol = mediaDescription.protocol;
+    if(protocol == Protocol::RTP_AVP || protocol == Protocol::RTP_SAVP){
+        if(mediaDescription.payloadTypes.empty())
+            throw invalid_argument("At least one payload type must be specified when using RTP/AVP or RTP/SAVP.");
+
+        for(auto pt : mediaDescription.payloadTypes){
+            mOut += ' ';
+            appendUInt(mOut, pt);
+        }
+    }
+    else if(protocol == Protocol::UnknownUDP){
+        if(mediaDescription.codec.empty())
+            throw invalid_argument("The codec must be specified when using raw UDP.");
+
+        mOut += ' ';
+        mOut += mediaDescription.codec;
+    }
+    else
+        throw invalid_argument("Unknown protocol.");
+}
+
+void SdpWriter::value(const Timing& timing){
+    appendUInt(mOut, timing.start);
+    mOut += ' ';
+    appendUInt(mOut, timing.end);
+}
+
+void SdpWriter::value(const RepeatingTime& repeatingTime){
+    appendUInt(mOut, repeatingTime.interval);
+    mOut += ' ';
+    appendUInt(mOut, repeatingTime.duration);
+
+    for(auto offset : repeatingTime.offsetsFromStartTime){
+        mOut += ' ';
+        appendUInt(mOut, offset);
+    }
+}
+
+void SdpWriter::value(const Bandwidth& bandwidth){
+    mOut += bandwidthTypeToStr(bandwidth.type);
+    mOut += ':';
+    appendUInt(mOut, bandwidth.kbps);
+}
+
+void SdpWriter::value(const Encryption& encryption){
+    mOut += encTypeToStr(encryption.type);
+
+    if(encryption.type != EncryptionType::PromptForKey){
+        mOut += ':';
+        mOut += encryption.key;
+    }
+}
+
+} // namespace zsdp
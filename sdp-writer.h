@@ -0,0 +1,73 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_SDP_WRITER_H__
+#define __ZSDP_SDP_WRITER_H__
+
+#include <zsdp/sdp.h>
+#include <zsdp/string-view.h>
+#include <string>
+
+
+namespace zsdp {
+
+/**
+ * Serializes the object model by appending to a caller-owned string. This is
+ * what sdpToString() and the toString() methods are built on.
+ */
+class SdpWriter {
+public:
+    explicit SdpWriter(std::string& out) : mOut(out) {}
+
+    void write(const Sdp& sdp);
+    void write(const Stream& stream);
+
+    /// The session-level lines of sdp, up to but not including its attributes.
+    void writeSessionLines(const Sdp& sdp);
+
+    /// The m=, i=, c=, b= and k= lines of stream, with mediaDescription in place of its own.
+    void writeMediaLines(const Stream& stream, const MediaDescription& mediaDescription);
+
+    /// Writes "a=<line>\r\n".
+    void write(const Attribute& attr);
+
+    /// Writes "<type>=<value>\r\n".
+    void line(char type, StringView value);
+
+    // Field values only, without the "x=" prefix or line ending.
+    void value(const Origin& origin);
+    void value(const ConnectionData& connectionData);
+    void value(const MediaDescription& mediaDescription);
+    void value(const Timing& timing);
+    void value(const RepeatingTime& repeatingTime);
+    void value(const Bandwidth& bandwidth);
+    void value(const Encryption& encryption);
+
+    std::string& out() { return mOut; }
+
+private:
+    void beginLine(char type);
+    void endLine();
+
+    std::string& mOut;
+};
+
+} // namespace zsdp
+
+#endif /* __ZSDP_SDP_WRITER_H__ */
@@ -19,8 +19,8 @@
 
 #include <zsdp/sdp.h>
 #include "string-util.h"
-#include "net-util.h"
-#include <sstream>
+#include "sdp-writer.h"
+#include <stdexcept>
 
 
 using namespace std;
@@ -28,222 +28,122 @@ using namespace std;
 namespace zsdp{
 
 
-static const string CRLF = "\r\n";
-
-
-
-
 string sdpToString(const Sdp* sdp) {
-    ostringstream out;
-    out << "v=" << sdp->version << CRLF;
-
-    out << "o=" << sdp->origin.toString() << CRLF;
-
-    if(sdp->sessionName.empty())
-        out << "s= " << CRLF;
-    else
-        out << "s=" << sdp->sessionName << CRLF;
-
-    if(!sdp->sessionInformation.empty())
-        out << "i=" << sdp->sessionInformation << CRLF;
-
-    if(!sdp->uri.empty())
-        out << "u=" << sdp->uri << CRLF;
-
-    if(!sdp->email.empty())
-        out << "e=" << sdp->email << CRLF;
-
-    if(!sdp->phoneNumber.empty())
-        out << "p=" << sdp->phoneNumber << CRLF;
-
-    if(sdp->connectionData.addressType != AddressType::NotSet)
-        out << "c=" << sdp->connectionData.toString() << CRLF;
-
-    if(sdp->bandwidth.type != BandwidthType::NotSet)
-        out << "b=" << sdp->bandwidth.toString() << CRLF;
-
-    if(!sdp->timeZoneAdjustments.empty()){
-        out << "z=";
-
-        for(size_t i = 0; i < sdp->timeZoneAdjustments.size(); i++){
-            if(i > 0)
-                out << " ";
-
-            out << to_string(sdp->timeZoneAdjustments[i].adjustAtTime)
-                << " "
-                << to_string(sdp->timeZoneAdjustments[i].adjustment);
-        }
-
-        out << CRLF;
-    }
-
-    if(sdp->encryption.type != EncryptionType::NotSet)
-        out << "k=" + sdp->encryption.toString() << CRLF;
+    string out;
+    sdpToString(sdp, out);
 
-    for(size_t i = 0; i < sdp->attributes.size(); i++)
-        out << "a=" + sdp->attributes[i]->sdpLine() << CRLF;
-
-    if(sdp->times.empty())
-        out << "t=0 0" << CRLF;
-    else{
-        for(size_t i = 0; i < sdp->times.size(); i++){
-            out << "t=" << sdp->times[i].toString() << CRLF;
-
-            const vector<RepeatingTime>& repeatingTimes = sdp->times[i].repeatingTimes;
-            for(size_t j = 0; j < repeatingTimes.size(); j++)
-                out << "r=" << repeatingTimes[j].toString() << CRLF;
-        }
-    }
-
-    for(size_t i = 0; i < sdp->streams.size(); i++)
-        out << sdp->streams[i].sdpLines();
-
-    return out.str();
+    return out;
 }
 
-static string dashIfEmpty(string s){
-    if(s.empty())
-        return "-";
-    else
-        return s;
+void sdpToString(const Sdp* sdp, string& out) {
+    SdpWriter(out).write(*sdp);
 }
 
-static string nullAddrIfEmpty(string s, AddressType t){
-    if(s.empty()){
-        if(t == AddressType::IP4)
-            return "0.0.0.0";
-        else if(t == AddressType::IP6)
-            return "::";
-        else
-            throw invalid_argument("Unknown Address Type " + to_string((uint32_t)t));
-    }
-
-    return s;
+#define TO_STRING_VIA_WRITER(TYPE)      \
+string TYPE::toString() const {         \
+    string out;                         \
+    SdpWriter(out).value(*this);        \
+                                        \
+    return out;                         \
 }
 
-string Origin::toString() const{
+TO_STRING_VIA_WRITER(Origin)
+TO_STRING_VIA_WRITER(ConnectionData)
+TO_STRING_VIA_WRITER(MediaDescription)
+TO_STRING_VIA_WRITER(Timing)
+TO_STRING_VIA_WRITER(RepeatingTime)
+TO_STRING_VIA_WRITER(Bandwidth)
+TO_STRING_VIA_WRITER(Encryption)
 
-    ostringstream out;
-    out << dashIfEmpty(username)
-        << " " << dashIfEmpty(sessionID)
-        << " " << dashIfEmpty(sessionVersion)
-        << " " << networkTypeToString(networkType)
-        << " " << addressTypeToString(addressType)
-        << " " << nullAddrIfEmpty(host, addressType);
+string TimeZoneAdjustment::toString() const {
+    string out;
+    appendUInt(out, adjustAtTime);
+    out += ' ';
+    appendInt(out, adjustment);
 
-    return out.str();
+    return out;
 }
-string ConnectionData::toString() const {
-    ostringstream out;
 
-    out << networkTypeToString(networkType)
-        << " " << addressTypeToString(addressType)
-        << " " << nullAddrIfEmpty(host, addressType);
-
-    return out.str();
-}
+string Stream::sdpLines() const {
+    string out;
+    SdpWriter(out).write(*this);
 
-static string bandwidthTypeToStr(BandwidthType type){
-    switch(type){
-        case BandwidthType::ConferenceTotal: return "CT";
-        case BandwidthType::ApplicationSpecific: return "AS";
-        default: return "";
-    }
+    return out;
 }
 
-string Bandwidth::toString() const {
-    return bandwidthTypeToStr(type) + ":" + to_string(kbps);
-}
+constexpr uint16_t AttributeIndex::kNone;
 
-static string encTypeToStr(EncryptionType type){
-    switch(type){
-        case EncryptionType::Base64: return "base64";
-        case EncryptionType::Clear: return "clear";
-        case EncryptionType::PromptForKey: return "prompt";
-        case EncryptionType::URI: return "uri";
-        default: return "";
-    }
+AttributeIndex::AttributeIndex(){
+    clear();
 }
 
-string Encryption::toString() const {
-    if(type == EncryptionType::PromptForKey)
-        return encTypeToStr(type);
+void AttributeIndex::clear(){
+    for(uint16_t& position : mFirst)
+        position = kNone;
 
-    return encTypeToStr(type) + ":" + key;
+    mNext.clear();
+    mSize = 0;
 }
 
-string Stream::sdpLines() const {
-    ostringstream out;
+void AttributeIndex::build(const AttributeList& attributes){
+    clear();
 
-    out << "m=" << mediaDescription.toString() << CRLF;
-
-    if(!title.empty())
-        out << "i=" << title << CRLF;
-
-    if(connectionData.addressType != AddressType::NotSet)
-        out << "c=" << connectionData.toString() << CRLF;
+    // Too long to index with 16-bit positions; lookups scan instead.
+    if(attributes.size() >= kNone){
+        mSize = (size_t)-1;
+        return;
+    }
 
-    if(bandwidth.type != BandwidthType::NotSet)
-        out << "b=" << bandwidth.toString() << CRLF;
+    uint16_t last[(size_t)AttrId::Count];
+    mNext.resize(attributes.size(), kNone);
 
-    if(encryption.type != EncryptionType::NotSet)
-        out << "k=" << encryption.toString() << CRLF;
+    for(uint16_t i = 0; i < attributes.size(); i++){
+        size_t id = (size_t)attributes[i]->id();
+        if(mFirst[id] == kNone)
+            mFirst[id] = i;
+        else
+            mNext[last[id]] = i;
 
-    for(auto& attr : attributes)
-        out << "a=" << attr->sdpLine() << CRLF;
+        last[id] = i;
+    }
 
-    return out.str();
+    mSize = attributes.size();
 }
 
-string Timing::toString() const {
-    ostringstream out;
-    out << start << " " << end;
+static size_t scanAttributes(const AttributeList& attributes, AttrId id, size_t from){
+    for(size_t i = from; i < attributes.size(); i++){
+        if(attributes[i]->id() == id)
+            return i;
+    }
 
-    return out.str();
+    return attributes.size();
 }
 
-string RepeatingTime::toString() const {
-    ostringstream out;
-    out << interval << " " << duration;
+size_t Stream::firstAttribute(AttrId id) const {
+    if(attributeIndex.covers(attributes)){
+        uint16_t position = attributeIndex.first(id);
+        if(position == AttributeIndex::kNone)
+            return attributes.size();
 
-    for(size_t i = 0; i < offsetsFromStartTime.size(); i++)
-        out << " " << offsetsFromStartTime[i];
+        if(attributes[position]->id() == id)
+            return position;
+    }
 
-    return out.str();
+    return scanAttributes(attributes, id, 0);
 }
 
-string MediaDescription::toString() const {
-    ostringstream out;
-
-    out << mediaTypeToString(mediaType)
-        << " "
-        << port;
-
-    if(portCount > 1)
-        out << "/" << portCount;
+size_t Stream::nextAttribute(size_t position) const {
+    AttrId id = attributes[position]->id();
+    if(attributeIndex.covers(attributes)){
+        uint16_t next = attributeIndex.next(position);
+        if(next == AttributeIndex::kNone)
+            return attributes.size();
 
-    out << " "
-        << protocolToString(protocol);
-
-
-    if(protocol == Protocol::RTP_AVP || protocol == Protocol::RTP_SAVP){
-        if(payloadTypes.empty())
-            throw invalid_argument("At least one payload type must be specified when using RTP/AVP or RTP/SAVP.");
-
-        for(auto pt : payloadTypes){
-            out << " " << pt;
-        }
+        if(attributes[next]->id() == id)
+            return next;
     }
-    else if(protocol == Protocol::UnknownUDP){
-        if(codec.empty())
-            throw invalid_argument("The codec must be specified when using raw UDP.");
 
-        out << " " << codec;
-    }
-    else
-        throw invalid_argument("Unknown protocol.");
-
-    return out.str();
+    return scanAttributes(attributes, id, position + 1);
 }
 
 
@@ -275,6 +175,26 @@ std::string addressTypeToString(AddressType t){
     }
 }
 
+std::string encryptionTypeToString(EncryptionType t){
+    switch(t){
+        case EncryptionType::Clear: return "clear";
+        case EncryptionType::Base64: return "base64";
+        case EncryptionType::URI: return "uri";
+        case EncryptionType::PromptForKey: return "prompt";
+        default:
+            throw invalid_argument("Unknown encryption type " + to_string((uint32_t)t));
+    }
+}
+
+std::string bandwidthTypeToString(BandwidthType t){
+    switch(t){
+        case BandwidthType::ConferenceTotal: return "CT";
+        case BandwidthType::ApplicationSpecific: return "AS";
+        default:
+            throw invalid_argument("Unknown bandwidth type " + to_string((uint32_t)t));
+    }
+}
+
 std::string protocolToString(Protocol p){
     switch(p){
         case Protocol::RTP_AVP: return "RTP/AVP";
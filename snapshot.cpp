@@ -0,0 +1,171 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/snapshot.h>
+#include <stdexcept>
+#include <thread>
+
+
+using namespace std;
+
+namespace zsdp {
+
+namespace {
+
+/// The session-level fields of sdp, without its attributes or streams.
+Sdp sessionOnly(Sdp sdp){
+    sdp.attributes.clear();
+    sdp.streams.clear();
+
+    return sdp;
+}
+
+const sp<const AttributeList>& emptyAttributes(){
+    static const sp<const AttributeList> empty = make_shared<AttributeList>();
+    return empty;
+}
+
+} // namespace
+
+SdpSnapshot::SdpSnapshot() : SdpSnapshot(Sdp()) {}
+
+SdpSnapshot::SdpSnapshot(const Sdp& sdp){
+    auto streams = make_shared<StreamList>();
+    streams->reserve(sdp.streams.size());
+    for(const Stream& stream : sdp.streams)
+        streams->push_back(make_shared<Stream>(stream));
+
+    auto data = make_shared<Data>();
+    data->session = make_shared<Sdp>(sessionOnly(sdp));
+    data->attributes = sdp.attributes.empty() ? emptyAttributes() : make_shared<AttributeList>(sdp.attributes);
+    data->streams = std::move(streams);
+    mData = std::move(data);
+}
+
+Sdp SdpSnapshot::toSdp() const{
+    Sdp sdp = session();
+    sdp.attributes = attributes();
+
+    sdp.streams.reserve(streamCount());
+    for(const sp<const Stream>& stream : *mData->streams)
+        sdp.streams.push_back(*stream);
+
+    return sdp;
+}
+
+SdpSnapshot SdpSnapshot::replaceSession(Sdp session) const{
+    auto data = make_shared<Data>(*mData);
+    data->session = make_shared<Sdp>(sessionOnly(std::move(session)));
+
+    return SdpSnapshot(std::move(data));
+}
+
+SdpSnapshot SdpSnapshot::replaceAttributes(AttributeList attributes) const{
+    auto data = make_shared<Data>(*mData);
+    data->attributes = make_shared<AttributeList>(std::move(attributes));
+
+    return SdpSnapshot(std::move(data));
+}
+
+SdpSnapshot SdpSnapshot::replaceStream(size_t i, Stream stream) const{
+    if(i >= streamCount())
+        throw out_of_range("Stream index " + to_string(i) + " is out-of-range.");
+
+    stream.reindexAttributes();
+    stream.mediaDescription.reindexPayloadTypes();
+    StreamList streams = *mData->streams;
+    streams[i] = make_shared<Stream>(std::move(stream));
+
+    return withStreams(std::move(streams));
+}
+
+SdpSnapshot SdpSnapshot::addStream(Stream stream) const{
+    stream.reindexAttributes();
+    stream.mediaDescription.reindexPayloadTypes();
+    StreamList streams = *mData->streams;
+    streams.push_back(make_shared<Stream>(std::move(stream)));
+
+    return withStreams(std::move(streams));
+}
+
+SdpSnapshot SdpSnapshot::removeStream(size_t i) const{
+    if(i >= streamCount())
+        throw out_of_range("Stream index " + to_string(i) + " is out-of-range.");
+
+    StreamList streams = *mData->streams;
+    streams.erase(streams.begin() + i);
+
+    return withStreams(std::move(streams));
+}
+
+SdpSnapshot SdpSnapshot::withStreams(StreamList streams) const{
+    auto data = make_shared<Data>(*mData);
+    data->streams = make_shared<StreamList>(std::move(streams));
+
+    return SdpSnapshot(std::move(data));
+}
+
+AtomicSdpSnapshot::AtomicSdpSnapshot() : AtomicSdpSnapshot(SdpSnapshot()) {}
+
+AtomicSdpSnapshot::AtomicSdpSnapshot(SdpSnapshot initial)
+    : mCurrent(new SdpSnapshot(std::move(initial))), mEpoch(0)
+{
+    mLoads[0] = 0;
+    mLoads[1] = 0;
+}
+
+AtomicSdpSnapshot::~AtomicSdpSnapshot(){
+    delete mCurrent.load();
+}
+
+SdpSnapshot AtomicSdpSnapshot::load() const{
+    while(true){
+        uint32_t epoch = mEpoch.load();
+        mLoads[epoch].fetch_add(1);
+
+        // If a store flipped the epoch in between, it may not wait for us. Retry in the new epoch.
+        if(mEpoch.load() != epoch){
+            mLoads[epoch].fetch_sub(1);
+            continue;
+        }
+
+        SdpSnapshot snapshot = *mCurrent.load();
+        mLoads[epoch].fetch_sub(1);
+
+        return snapshot;
+    }
+}
+
+void AtomicSdpSnapshot::store(SdpSnapshot snapshot){
+    const SdpSnapshot* fresh = new SdpSnapshot(std::move(snapshot));
+
+    lock_guard<mutex> lock(mStoreMutex);
+    const SdpSnapshot* old = mCurrent.exchange(fresh);
+
+    uint32_t oldEpoch = mEpoch.load();
+    mEpoch.store(oldEpoch ^ 1);
+
+    // Loads counted in the old epoch may still be copying old; new loads can only see fresh.
+    while(mLoads[oldEpoch].load() != 0)
+        this_thread::yield();
+
+    delete old;
+}
+
+} // namespace zsdp
@@ -103,6 +103,27 @@ int64_t stoi64(const std::string& s) {
     return stoll(s);
 }
 
+void appendUInt(string& out, uint64_t n){
+    char digits[20];
+    size_t count = 0;
+
+    do {
+        digits[sizeof(digits) - 1 - count++] = (char)('0' + n % 10);
+        n /= 10;
+    } while(n != 0);
+
+    out.append(digits + sizeof(digits) - count, count);
+}
+
+void appendInt(string& out, int64_t n){
+    if(n < 0){
+        out += '-';
+        appendUInt(out, (uint64_t)0 - (uint64_t)n);
+    }
+    else
+        appendUInt(out, (uint64_t)n);
+}
+
 string printHex(const string& title,
                 const void* buf,
                 size_t size)
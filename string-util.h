@@ -37,6 +37,10 @@ int32_t stoi32(const std::string& s);
 uint64_t stou64(const std::string& s);
 int64_t stoi64(const std::string& s);
 
+/// Appends the decimal representation of n without going through to_string().
+void appendUInt(std::string& out, uint64_t n);
+void appendInt(std::string& out, int64_t n);
+
 std::string printHex(const std::string& title,
                      const void* buf,
                      size_t size);
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <zsdp/symbol.h>
+#include <strings.h>
+#include <utility>
+
+
+using namespace std;
+
+namespace zsdp {
+
+namespace {
+
+/*
+ * Open addressing with linear probing. Slots only go from NULL to an entry,
+ * never back, so lookups need no lock and an insert is one compare-and-swap.
+ * The table is never resized; kMaxInterned keeps it at most half full.
+ */
+constexpr size_t kTableSize = 1 << 14;
+constexpr size_t kMaxInterned = kTableSize / 2;
+
+atomic<const void*> gTable[kTableSize];
+atomic<size_t> gInternedCount(0);
+
+size_t hashOf(StringView s){
+    uint64_t h = 14695981039346656037ULL;
+    for(char c : s){
+        h ^= (uint8_t)c;
+        h *= 1099511628211ULL;
+    }
+
+    return (size_t)h;
+}
+
+} // namespace
+
+const Symbol::Entry* Symbol::entryFor(StringView s){
+    static const Entry* const empty = new Entry(StringView(), true);
+    if(s.empty())
+        return empty;
+
+    if(s.size() > kMaxInternedSize)
+        return new Entry(s, false);
+
+    size_t h = hashOf(s);
+    for(size_t i = 0; i < kTableSize; i++){
+        atomic<const void*>& slot = gTable[(h + i) & (kTableSize - 1)];
+        const Entry* entry = (const Entry*)slot.load(memory_order_acquire);
+
+        if(entry == NULL){
+            if(gInternedCount.load(memory_order_relaxed) >= kMaxInterned)
+                break;
+
+            Entry* fresh = new Entry(s, true);
+            const void* expected = NULL;
+            if(slot.compare_exchange_strong(expected, fresh, memory_order_acq_rel, memory_order_acquire)){
+                gInternedCount.fetch_add(1, memory_order_relaxed);
+                return fresh;
+            }
+
+            // Another thread filled the slot first; it may hold the same text.
+            delete fresh;
+            entry = (const Entry*)expected;
+        }
+
+        if(StringView(entry->text) == s)
+            return entry;
+    }
+
+    return new Entry(s, false);
+}
+
+Symbol::Symbol() : mEntry(entryFor(StringView())) {}
+Symbol::Symbol(const char* s) : mEntry(entryFor(StringView(s))) {}
+Symbol::Symbol(const string& s) : mEntry(entryFor(StringView(s))) {}
+Symbol::Symbol(StringView s) : mEntry(entryFor(s)) {}
+
+Symbol::Symbol(const Symbol& other) : mEntry(other.mEntry) {
+    retain();
+}
+
+Symbol::Symbol(Symbol&& other) noexcept : mEntry(other.mEntry) {
+    other.mEntry = entryFor(StringView());
+}
+
+Symbol::~Symbol(){
+    release();
+}
+
+Symbol& Symbol::operator=(const Symbol& other){
+    other.retain();
+    release();
+    mEntry = other.mEntry;
+
+    return *this;
+}
+
+Symbol& Symbol::operator=(Symbol&& other) noexcept{
+    std::swap(mEntry, other.mEntry);
+
+    return *this;
+}
+
+void Symbol::retain() const{
+    if(!mEntry->interned)
+        mEntry->refs.fetch_add(1, memory_order_relaxed);
+}
+
+void Symbol::release() const{
+    if(!mEntry->interned && mEntry->refs.fetch_sub(1, memory_order_acq_rel) == 1)
+        delete mEntry;
+}
+
+bool Symbol::equalsIgnoreCase(const Symbol& other) const{
+    if(mEntry == other.mEntry)
+        return true;
+
+    return size() == other.size() && strncasecmp(c_str(), other.c_str(), size()) == 0;
+}
+
+size_t Symbol::internedCount(){
+    return gInternedCount.load(memory_order_relaxed);
+}
+
+} // namespace zsdp
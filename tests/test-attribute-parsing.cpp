@@ -409,3 +409,34 @@ TEST_CASE("Test Attribute Detection", "[Attribute Detection]"){
 }
 
 
+
+TEST_CASE("Parse Generic Attribute", "[Generic Attribute]"){
+    sp<Attribute> attr = parseAttribute("ice-ufrag:F7gI");
+    REQUIRE( attr.get() != NULL );
+    GenericAttribute* generic = dynamic_cast<GenericAttribute*>(attr.get());
+    REQUIRE( generic != NULL );
+    REQUIRE( attr->key() == "ice-ufrag" );
+    REQUIRE( attr->value() == "F7gI" );
+    REQUIRE( attr->sdpLine() == "ice-ufrag:F7gI" );
+    REQUIRE( generic->decode().get() == NULL );
+
+    attr = parseAttribute("rtcp-mux");
+    REQUIRE( attr->key() == "rtcp-mux" );
+    REQUIRE( attr->value() == "" );
+    REQUIRE( attr->sdpLine() == "rtcp-mux" );
+
+    string out = "a=";
+    attr->appendSdpLine(out);
+    REQUIRE( out == "a=rtcp-mux" );
+
+    GenericAttribute rtpmap("rtpmap:96 VP8/90000");
+    sp<Attribute> decoded = rtpmap.decode();
+    AttrRtpMap* rtpMap = dynamic_cast<AttrRtpMap*>(decoded.get());
+    REQUIRE( rtpMap != NULL );
+    REQUIRE( rtpMap->payloadType == 96 );
+    REQUIRE( rtpMap->encodingName == "VP8" );
+
+    // A registered parser that rejects its value still yields the original line.
+    attr = parseAttribute("ptime:abc");
+    REQUIRE( attr->sdpLine() == "ptime:abc" );
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/binary.h>
+
+using namespace zsdp;
+using namespace std;
+static const char* const kOffer =
+    "v=0\r\n"
+    "o=alice 2890844526 2890842807 IN IP4 10.47.16.5\r\n"
+    "s=SDP Seminar\r\n"
+    "i=A Seminar on the session description protocol\r\n"
+    "u=http://www.example.com/seminars/sdp.pdf\r\n"
+    "e=j.doe@example.com (Jane Doe)\r\n"
+    "c=IN IP4 224.2.17.12/127\r\n"
+    "b=AS:512\r\n"
+    "t=2873397496 2873404696\r\n"
+    "r=604800 3600 0 90000\r\n"
+    "z=2882844526 -3600 2898848070 0\r\n"
+    "k=clear:secret\r\n"
+    "a=recvonly\r\n"
+    "a=x-custom:1 2 3\r\n"
+    "m=audio 49170 RTP/AVP 111 0\r\n"
+    "i=Audio\r\n"
+    "c=IN IP4 10.0.0.1\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=ptime:20\r\n"
+    "a=ice-ufrag:abcd\r\n"
+    "a=rtcp-mux\r\n"
+    "m=video 51372/2 RTP/AVP 96\r\n"
+    "c=IN IP6 ::1\r\n"
+    "b=AS:2000\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=sendonly\r\n";
+
+TEST_CASE("Binary Round Trip", "[Binary]"){
+    Sdp sdp = parseSdp(kOffer);
+    string encoded;
+    encodeBinarySdp(sdp, encoded);
+    REQUIRE( encoded.size() < strlen(kOffer) );
+
+    BinarySdpView view(encoded);
+    REQUIRE( view.formatVersion() == kBinarySdpFormatVersion );
+
+    Sdp decoded = view.toSdp();
+    REQUIRE( sdpToString(&decoded) == sdpToString(&sdp) );
+
+    string reencoded;
+    encodeBinarySdp(decoded, reencoded);
+    REQUIRE( reencoded == encoded );
+
+    ParseOptions options;
+    options.decodeAttributes = false;
+    Sdp generic = parseSdp(kOffer, options);
+    string genericEncoded;
+    encodeBinarySdp(generic, genericEncoded);
+    REQUIRE( genericEncoded == encoded );
+}
+
+TEST_CASE("Binary View", "[Binary]"){
+    Sdp sdp = parseSdp(kOffer);
+
+    // An unaligned start, as when the encoding is one record in a larger mapping.
+    string buffer = "xyz";
+    encodeBinarySdp(sdp, buffer);
+    BinarySdpView view(StringView(buffer.data() + 3, buffer.size() - 3));
+
+    REQUIRE( view.originUsername() == "alice" );
+    REQUIRE( view.originHost() == "10.47.16.5" );
+    REQUIRE( view.sessionName() == "SDP Seminar" );
+    REQUIRE( view.connectionData().host == sdp.connectionData.host );
+    REQUIRE( view.bandwidth().kbps == 512 );
+    REQUIRE( view.encryption().type == EncryptionType::Clear );
+    REQUIRE( view.times().size() == 1 );
+    REQUIRE( view.times()[0].repeatingTimes[0].offsetsFromStartTime.size() == 2 );
+    REQUIRE( view.timeZoneAdjustments()[0].adjustment == -3600 );
+
+    REQUIRE( view.attributes().size() == 2 );
+    REQUIRE( view.attributes()[0].key() == "recvonly" );
+    REQUIRE( !view.attributes()[0].hasValue() );
+    REQUIRE( view.attributes()[1].key() == "x-custom" );
+    REQUIRE( view.attributes()[1].value() == "1 2 3" );
+
+    REQUIRE( view.streamCount() == 2 );
+    BinaryStreamView video = view.stream(1);
+    REQUIRE( video.mediaType() == MediaType::Video );
+    REQUIRE( video.port() == 51372 );
+    REQUIRE( video.portCount() == sdp.streams[1].mediaDescription.portCount );
+    REQUIRE( video.payloadTypeCount() == 1 );
+    REQUIRE( video.payloadType(0) == 96 );
+    REQUIRE( video.connectionData().addressType == AddressType::IP6 );
+    REQUIRE( video.attributes().size() == 2 );
+    REQUIRE( video.attributes()[0].key() == "rtpmap" );
+    REQUIRE( video.attributes()[0].value() == "96 VP8/90000" );
+
+    sp<Attribute> rtpMap = video.attributes()[0].decode();
+    REQUIRE( dynamic_cast<AttrRtpMap*>(rtpMap.get()) != NULL );
+
+    REQUIRE_THROWS_AS( view.stream(2), out_of_range );
+    REQUIRE_THROWS_AS( video.attributes()[2], out_of_range );
+}
+
+TEST_CASE("Binary Malformed Input", "[Binary]"){
+    Sdp sdp = parseSdp(kOffer);
+    string encoded;
+    encodeBinarySdp(sdp, encoded);
+
+    REQUIRE_THROWS_AS( BinarySdpView(""), invalid_argument );
+    REQUIRE_THROWS_AS( BinarySdpView(kOffer), invalid_argument );
+
+    string badVersion = encoded;
+    badVersion[4] = 99;
+    REQUIRE_THROWS_AS( BinarySdpView(badVersion), invalid_argument );
+
+    // Every truncation must be caught, either by the view or when a stream is read.
+    for(size_t size = 0; size < encoded.size(); size++){
+        REQUIRE_THROWS_AS( BinarySdpView(StringView(encoded.data(), size)).toSdp(), invalid_argument );
+    }
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/capability-negotiation.h>
+
+using namespace zsdp;
+using namespace std;
+
+static const char* const kOffer =
+    "v=0\r\n"
+    "o=- 25678 753849 IN IP4 192.0.2.1\r\n"
+    "s=-\r\n"
+    "c=IN IP4 192.0.2.1\r\n"
+    "t=0 0\r\n"
+    "a=tcap:1 RTP/SAVPF RTP/SAVP\r\n"
+    "m=audio 53456 RTP/AVP 0 18\r\n"
+    "a=acap:1 crypto:1 AES_CM_128_HMAC_SHA1_80 inline:WVNfX19zZW1jdGwgKCkgewkyMjA7fQp9CnVubGVz|2^20|1:4\r\n"
+    "a=acap:2 crypto:2 AES_CM_128_HMAC_SHA1_32 inline:NzB4d1BINUAvLEw6UzF3WSJ+PSdFcGdUJShpX1Zj|2^20|1:4\r\n"
+    "a=acap:3 ptime:30\r\n"
+    "a=acap:4 x-unsupported:1\r\n"
+    "a=pcfg:2 a=2|1 t=2\r\n"
+    "a=pcfg:1 a=1,[3] t=1|2\r\n"
+    "a=pcfg:3 a=4 t=2\r\n"
+    "a=pcfg:4 t=2 +x-ext=1\r\n";
+
+namespace {
+
+/// Rejects the x-unsupported attribute, and ptime.
+class TestCheck : public CapabilityCheck {
+public:
+    mutable int attributeQueries = 0;
+    bool acceptPTime = false;
+
+    virtual bool acceptsAttribute(const Attribute& attribute) const override{
+        attributeQueries++;
+        if(attribute.key() == "ptime")
+            return acceptPTime;
+
+        return attribute.key() != "x-unsupported";
+    }
+};
+
+} // namespace
+
+TEST_CASE("Parse Capability Negotiation Attributes", "[CapabilityNegotiation]"){
+    registerCapabilityNegotiationAttributes();
+
+    sp<Attribute> acap = parseAttribute("acap:3 ptime:30");
+    REQUIRE( acap->id() == AttrId::Capability );
+    const AttrCapability& capability = *acap->as<AttrCapability>();
+    REQUIRE( capability.number == 3 );
+    REQUIRE( capability.attribute->as<AttrPTime>() != NULL );
+    REQUIRE( capability.attribute->as<AttrPTime>()->packetDuration == 30 );
+    REQUIRE( acap->sdpLine() == "acap:3 ptime:30" );
+
+    sp<Attribute> tcap = parseAttribute("tcap:5 RTP/SAVPF  RTP/SAVP");
+    REQUIRE( tcap->as<AttrTransportCapability>() != NULL );
+    REQUIRE( tcap->as<AttrTransportCapability>()->firstNumber == 5 );
+    REQUIRE( tcap->as<AttrTransportCapability>()->protocols.size() == 2 );
+    REQUIRE( tcap->value() == "5 RTP/SAVPF RTP/SAVP" );
+
+    sp<Attribute> pcfg = parseAttribute("pcfg:7 a=-m:1,2,[3,4]|5 t=1|2 x-foo=1");
+    const AttrPotentialConfig* config = pcfg->as<AttrPotentialConfig>();
+    REQUIRE( config != NULL );
+    REQUIRE( config->configNumber == 7 );
+    REQUIRE( config->deleteAttributes == kDeleteAttributes_Media );
+    REQUIRE( config->attributeLists.size() == 2 );
+    REQUIRE( config->attributeLists[0].mandatory.size() == 2 );
+    REQUIRE( config->attributeLists[0].optional.size() == 2 );
+    REQUIRE( config->attributeLists[1].mandatory[0] == 5 );
+    REQUIRE( config->transports.size() == 2 );
+    REQUIRE( config->extensions.size() == 1 );
+    REQUIRE_FALSE( config->hasMandatoryExtension() );
+    REQUIRE( pcfg->value() == "7 a=-m:1,2,[3,4]|5 t=1|2 x-foo=1" );
+
+    sp<Attribute> acfg = parseAttribute("acfg:1 t=1 a=1,[3]");
+    const AttrActualConfig* actual = acfg->as<AttrActualConfig>();
+    REQUIRE( actual != NULL );
+    REQUIRE( actual->transport == 1 );
+    REQUIRE( actual->attributes.size() == 2 );
+    REQUIRE( acfg->value() == "1 a=1,3 t=1" );
+
+    // Malformed lines stay generic.
+    REQUIRE( parseAttribute("pcfg:0 a=1")->id() == AttrId::Generic );
+    REQUIRE( parseAttribute("pcfg:1 a=1,[2")->id() == AttrId::Generic );
+    REQUIRE( parseAttribute("acap:1")->id() == AttrId::Generic );
+    REQUIRE( parseAttribute("acfg:1 t=1|2")->id() == AttrId::Generic );
+}
+
+TEST_CASE("Enumerate Configurations In Preference Order", "[CapabilityNegotiation]"){
+    Sdp offer = parseSdp(kOffer);
+    TestCheck check;
+
+    ConfigurationEnumerator configurations(offer, 0, check);
+    PotentialConfiguration config;
+
+    // pcfg 1 first: RTP/SAVPF isn't a protocol we can represent, so t=2 (RTP/SAVP). ptime (optional) is rejected.
+    REQUIRE( configurations.next(config) );
+    REQUIRE( config.configNumber == 1 );
+    REQUIRE( config.transportNumber == 2 );
+    REQUIRE( config.protocol == Protocol::RTP_SAVP );
+    REQUIRE( config.attributes.size() == 1 );
+    REQUIRE( config.attributes[0]->number == 1 );
+    REQUIRE( config.actualConfig()->sdpLine() == "acfg:1 a=1 t=2" );
+
+    // Then pcfg 2's two alternatives in their listed order.
+    REQUIRE( configurations.next(config) );
+    REQUIRE( config.configNumber == 2 );
+    REQUIRE( config.attributes[0]->number == 2 );
+    REQUIRE( configurations.next(config) );
+    REQUIRE( config.configNumber == 2 );
+    REQUIRE( config.attributes[0]->number == 1 );
+
+    // pcfg 3 needs the rejected acap 4, and pcfg 4 a mandatory extension.
+    REQUIRE_FALSE( configurations.next(config) );
+    REQUIRE_FALSE( configurations.next(config) );
+
+    // Each capability is checked once, however many configurations refer to it.
+    REQUIRE( check.attributeQueries == 4 );
+
+    configurations.reset();
+    REQUIRE( configurations.next(config) );
+    REQUIRE( config.configNumber == 1 );
+
+    // With ptime accepted, the optional capability is included.
+    TestCheck withPTime;
+    withPTime.acceptPTime = true;
+    ConfigurationEnumerator optional(offer, 0, withPTime);
+    REQUIRE( optional.next(config) );
+    REQUIRE( config.attributes.size() == 2 );
+    REQUIRE( config.attributes[1]->number == 3 );
+    REQUIRE( config.actualConfig()->value() == "1 a=1,3 t=2" );
+}
+
+TEST_CASE("Apply A Configuration", "[CapabilityNegotiation]"){
+    Sdp offer = parseSdp("v=0\r\n"
+                         "o=- 1 1 IN IP4 192.0.2.1\r\n"
+                         "s=-\r\n"
+                         "t=0 0\r\n"
+                         "m=audio 53456 RTP/AVP 0\r\n"
+                         "a=ptime:20\r\n"
+                         "a=tcap:1 RTP/SAVP\r\n"
+                         "a=acap:1 crypto:1 AES_CM_128_HMAC_SHA1_80 inline:WVNfX19zZW1jdGwgKCkgewkyMjA7fQp9CnVubGVz\r\n"
+                         "a=pcfg:1 a=-m:1 t=1\r\n"
+                         "a=pcfg:2 a=1 t=1\r\n");
+
+    ConfigurationEnumerator configurations(offer, 0);
+    PotentialConfiguration config;
+    REQUIRE( configurations.next(config) );
+    REQUIRE( config.deleteAttributes == kDeleteAttributes_Media );
+
+    Stream deleted = applyConfiguration(offer.streams[0], config);
+    REQUIRE( deleted.mediaDescription.protocol == Protocol::RTP_SAVP );
+    REQUIRE( deleted.attributes.size() == 1 );
+    REQUIRE( deleted.attributes[0]->key() == "crypto" );
+
+    REQUIRE( configurations.next(config) );
+    Stream kept = applyConfiguration(offer.streams[0], config);
+    REQUIRE( kept.attributes.size() == 2 );
+    REQUIRE( kept.find<AttrPTime>() != NULL );
+    REQUIRE( kept.attributes[1]->key() == "crypto" );
+
+    REQUIRE_FALSE( configurations.next(config) );
+    REQUIRE_THROWS( ConfigurationEnumerator(offer, 1) );
+}
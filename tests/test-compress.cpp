@@ -0,0 +1,122 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/compress.h>
+
+using namespace zsdp;
+using namespace std;
+
+static const char* const kOffer =
+    "v=0\r\n"
+    "o=- 4611731400430051336 2 IN IP4 127.0.0.1\r\n"
+    "s=-\r\n"
+    "t=0 0\r\n"
+    "a=group:BUNDLE 0 1\r\n"
+    "a=msid-semantic: WMS stream\r\n"
+    "m=audio 9 UDP/TLS/RTP/SAVPF 111 0 8\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=rtcp:9 IN IP4 0.0.0.0\r\n"
+    "a=ice-ufrag:F7gI\r\n"
+    "a=ice-pwd:x9cml/YzichV2+XlhiMu8g\r\n"
+    "a=ice-options:trickle\r\n"
+    "a=fingerprint:sha-256 D2:FA:0E:C3:22:59:5E:14:95:69:92:3D:13:B4:84:24:2C:C2:A2:C0:3E:FD:34:8E:5E:EA:6F:AF:52:CE:E6:0F\r\n"
+    "a=setup:actpass\r\n"
+    "a=mid:0\r\n"
+    "a=sendrecv\r\n"
+    "a=rtcp-mux\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=rtcp-fb:111 transport-cc\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "a=rtpmap:8 PCMA/8000\r\n"
+    "a=ssrc:1001 cname:abcd\r\n"
+    "m=video 9 UDP/TLS/RTP/SAVPF 96 97\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=rtcp:9 IN IP4 0.0.0.0\r\n"
+    "a=mid:1\r\n"
+    "a=sendrecv\r\n"
+    "a=rtcp-mux\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=rtcp-fb:96 nack\r\n"
+    "a=rtcp-fb:96 nack pli\r\n"
+    "a=rtpmap:97 rtx/90000\r\n"
+    "a=fmtp:97 apt=96\r\n";
+
+static string roundTrip(const string& input, size_t* compressedSize = NULL){
+    string compressed;
+    compressSdp(input, compressed);
+    if(compressedSize != NULL)
+        *compressedSize = compressed.size();
+
+    string out;
+    decompressSdp(compressed, out);
+
+    return out;
+}
+
+TEST_CASE("Compress SDP", "[Compress]"){
+    size_t compressedSize = 0;
+    REQUIRE( roundTrip(kOffer, &compressedSize) == kOffer );
+    REQUIRE( compressedSize * 2 < strlen(kOffer) );
+
+    REQUIRE( roundTrip("") == "" );
+    REQUIRE( roundTrip("v") == "v" );
+    REQUIRE( roundTrip("v=0\r\n") == "v=0\r\n" );
+    REQUIRE( roundTrip(string(1000, 'a')) == string(1000, 'a') );
+
+    string binary;
+    for(int i = 0; i < 5000; i++)
+        binary += (char)((i * 7919) ^ (i >> 3));
+
+    REQUIRE( roundTrip(binary) == binary );
+
+    string repeated;
+    for(int i = 0; i < 50; i++)
+        repeated += kOffer;
+
+    REQUIRE( roundTrip(repeated) == repeated );
+}
+
+TEST_CASE("Decompress Appends", "[Compress]"){
+    string compressed;
+    compressSdp(kOffer, compressed);
+
+    string out = "prefix";
+    decompressSdp(compressed, out);
+    REQUIRE( out == string("prefix") + kOffer );
+}
+
+TEST_CASE("Decompress Corrupt Input", "[Compress]"){
+    string compressed;
+    compressSdp(kOffer, compressed);
+
+    string out;
+    REQUIRE_THROWS_AS( decompressSdp("", out), invalid_argument );
+    REQUIRE_THROWS_AS( decompressSdp(kOffer, out), invalid_argument );
+
+    for(size_t size = 1; size < compressed.size(); size++){
+        out.clear();
+        REQUIRE_THROWS_AS( decompressSdp(StringView(compressed.data(), size), out), invalid_argument );
+    }
+
+    string trailing = compressed + "x";
+    REQUIRE_THROWS_AS( decompressSdp(trailing, out), invalid_argument );
+}
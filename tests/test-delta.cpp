@@ -0,0 +1,121 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/delta.h>
+
+using namespace zsdp;
+using namespace std;
+
+static const char* const kOffer =
+    "v=0\r\n"
+    "o=- 123 1 IN IP4 10.0.0.1\r\n"
+    "s=-\r\n"
+    "c=IN IP4 10.0.0.1\r\n"
+    "t=0 0\r\n"
+    "a=group:BUNDLE 0 1\r\n"
+    "m=audio 5000 RTP/AVP 111 0\r\n"
+    "c=IN IP4 10.0.0.1\r\n"
+    "a=mid:0\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "a=sendrecv\r\n"
+    "m=video 5002 RTP/AVP 96\r\n"
+    "c=IN IP4 10.0.0.1\r\n"
+    "a=mid:1\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=sendrecv\r\n";
+
+static void requireRoundTrip(const Sdp& base, const Sdp& next, size_t maxDeltaSize){
+    string delta = encodeDelta(base, next);
+    INFO( "delta size " << delta.size() );
+    REQUIRE( delta.size() <= maxDeltaSize );
+
+    Sdp applied = applyDelta(base, delta);
+    REQUIRE( sdpToString(&applied) == sdpToString(&next) );
+}
+
+TEST_CASE("Delta Unchanged", "[Delta]"){
+    Sdp base = parseSdp(kOffer);
+    requireRoundTrip(base, base, 8);
+
+    Sdp same = parseSdp(kOffer);
+    requireRoundTrip(base, same, 8);
+}
+
+TEST_CASE("Delta Changes", "[Delta]"){
+    Sdp base = parseSdp(kOffer);
+
+    Sdp portChange = base;
+    portChange.origin.sessionVersion = "2";
+    portChange.streams[1].mediaDescription.port = 6002;
+    requireRoundTrip(base, portChange, 40);
+
+    Sdp directionChange = parseSdp(kOffer);
+    directionChange.streams[0].attributes.back() = parseAttribute("recvonly");
+    requireRoundTrip(base, directionChange, 24);
+
+    // Unchanged attributes are shared with base, not reparsed.
+    Sdp applied = applyDelta(base, encodeDelta(base, directionChange));
+    REQUIRE( applied.streams[0].attributes[1].get() == base.streams[0].attributes[1].get() );
+    REQUIRE( applied.streams[1].attributes[0].get() == base.streams[1].attributes[0].get() );
+
+    Sdp removedCodec = parseSdp(kOffer);
+    removedCodec.streams[0].mediaDescription.payloadTypes.pop_back();
+    removedCodec.streams[0].attributes.erase(removedCodec.streams[0].attributes.begin() + 3);
+    requireRoundTrip(base, removedCodec, 24);
+
+    Sdp addedStream = parseSdp(kOffer);
+    addedStream.streams.push_back(addedStream.streams[1]);
+    addedStream.streams.back().mediaDescription.port = 7000;
+    requireRoundTrip(base, addedStream, 200);
+
+    Sdp removedStream = parseSdp(kOffer);
+    removedStream.streams.pop_back();
+    requireRoundTrip(base, removedStream, 8);
+
+    Sdp session = parseSdp(kOffer);
+    session.sessionName = "renamed";
+    session.timeZoneAdjustments.push_back(TimeZoneAdjustment());
+    session.timeZoneAdjustments.back().adjustment = -3600;
+    session.attributes.insert(session.attributes.begin(), parseAttribute("ice-lite"));
+    requireRoundTrip(base, session, 40);
+
+    Sdp reordered = parseSdp(kOffer);
+    swap(reordered.streams[0].attributes[1], reordered.streams[0].attributes[3]);
+    requireRoundTrip(base, reordered, 24);
+}
+
+TEST_CASE("Delta Malformed Input", "[Delta]"){
+    Sdp base = parseSdp(kOffer);
+    Sdp next = parseSdp(kOffer);
+    next.streams[0].mediaDescription.port = 1;
+    next.streams.push_back(next.streams[0]);
+    string delta = encodeDelta(base, next);
+
+    REQUIRE_THROWS_AS( applyDelta(base, ""), invalid_argument );
+    for(size_t size = 1; size < delta.size(); size++)
+        REQUIRE_THROWS_AS( applyDelta(base, StringView(delta.data(), size)), invalid_argument );
+
+    // Applied to a base without the referenced streams or attributes.
+    Sdp smaller = parseSdp("v=0\r\no=- 1 1 IN IP4 1.2.3.4\r\ns=-\r\nt=0 0\r\n");
+    REQUIRE_THROWS_AS( applyDelta(smaller, delta), invalid_argument );
+}
@@ -0,0 +1,274 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/format-params.h>
+#include <zsdp/sdp.h>
+#include <thread>
+#include <vector>
+
+using namespace zsdp;
+using namespace std;
+
+TEST_CASE("Split Format Parameters", "[FormatParamMap]"){
+    string text = "profile-level-id=42e01f; packetization-mode=1;level-asymmetry-allowed=1;;x-flag";
+    FormatParamMap params(text);
+
+    REQUIRE( params.size() == 4 );
+
+    // Sorted by key.
+    vector<string> keys;
+    for(const FormatParam& p : params)
+        keys.push_back(p.key.str());
+    REQUIRE( keys == vector<string>({ "level-asymmetry-allowed", "packetization-mode", "profile-level-id", "x-flag" }) );
+
+    REQUIRE( params.get("profile-level-id") == "42e01f" );
+    REQUIRE( params.get("Packetization-Mode") == "1" );
+    REQUIRE( params.has("x-flag") );
+    REQUIRE( params.get("x-flag").empty() );
+    REQUIRE_FALSE( params.has("sprop-parameter-sets") );
+    REQUIRE( params.get("missing", "default") == "default" );
+
+    int64_t i = 0;
+    uint64_t hex = 0;
+    bool flag = false;
+    REQUIRE( params.getInt("packetization-mode", &i) );
+    REQUIRE( i == 1 );
+    REQUIRE( params.getHex("profile-level-id", &hex) );
+    REQUIRE( hex == 0x42e01f );
+    REQUIRE( params.getBool("level-asymmetry-allowed", &flag) );
+    REQUIRE( flag );
+
+    REQUIRE_FALSE( params.getInt("profile-level-id", &i) );
+    REQUIRE_FALSE( params.getBool("x-flag", &flag) );
+    REQUIRE( params.intOr("missing", -5) == -5 );
+
+    // A bare value, as telephone-event's.
+    FormatParamMap events("0-15");
+    REQUIRE( events.size() == 1 );
+    REQUIRE( events.has("0-15") );
+
+    REQUIRE( FormatParamMap("").empty() );
+    REQUIRE( FormatParamMap("a=1;a=2").get("a") == "1" );
+}
+
+TEST_CASE("Codec Format Parameters", "[FormatParamMap]"){
+    H264Params h264;
+    REQUIRE( parseH264Params(FormatParamMap("profile-level-id=640C28;packetization-mode=1"), &h264) );
+    REQUIRE( h264.profileIdc == 0x64 );
+    REQUIRE( h264.profileIop == 0x0c );
+    REQUIRE( h264.levelIdc == 0x28 );
+    REQUIRE( h264.packetizationMode == 1 );
+    REQUIRE_FALSE( h264.levelAsymmetryAllowed );
+
+    H264Params defaults;
+    REQUIRE( parseH264Params(FormatParamMap(""), &defaults) );
+    REQUIRE( defaults.profileIdc == 0x42 );
+    REQUIRE( defaults.levelIdc == 0x0a );
+    REQUIRE_FALSE( defaults.sameCodec(h264) );
+
+    H264Params otherLevel;
+    REQUIRE( parseH264Params(FormatParamMap("profile-level-id=640c1f;packetization-mode=1"), &otherLevel) );
+    REQUIRE( otherLevel.sameCodec(h264) );
+    REQUIRE_FALSE( parseH264Params(FormatParamMap("profile-level-id=42e0"), &h264) );
+
+    OpusParams opus = parseOpusParams(FormatParamMap("minptime=10;useinbandfec=1;stereo=1;maxplaybackrate=16000"));
+    REQUIRE( opus.minPTime == 10 );
+    REQUIRE( opus.useInbandFec );
+    REQUIRE( opus.stereo );
+    REQUIRE_FALSE( opus.useDtx );
+    REQUIRE( opus.maxPlaybackRate == 16000 );
+    REQUIRE( opus.spropMaxCaptureRate == 48000 );
+
+    REQUIRE( parseVp9ProfileId(FormatParamMap("profile-id=2")) == 2 );
+    REQUIRE( parseVp9ProfileId(FormatParamMap("")) == 0 );
+    REQUIRE( parseVp9ProfileId(FormatParamMap("profile-id=x")) == -1 );
+}
+
+TEST_CASE("Format Parameters Are Parsed Once", "[FormatParamMap]"){
+    Sdp sdp = parseSdp("v=0\r\n"
+                       "o=- 1 1 IN IP4 10.0.0.1\r\n"
+                       "s=-\r\n"
+                       "t=0 0\r\n"
+                       "m=video 5000 RTP/AVP 97\r\n"
+                       "a=rtpmap:97 H264/90000\r\n"
+                       "a=fmtp:97 profile-level-id=42e01f;packetization-mode=1\r\n");
+
+    AttrFormatParams& fmtp = const_cast<AttrFormatParams&>(*sdp.streams[0].find<AttrFormatParams>());
+
+    const FormatParamMap& first = fmtp.params();
+    REQUIRE( &fmtp.params() == &first );
+    REQUIRE( first.get("packetization-mode") == "1" );
+
+    // Changing formatParams is noticed, and the earlier map stays readable.
+    fmtp.formatParams = "profile-level-id=42e01f;packetization-mode=0";
+    const FormatParamMap& second = fmtp.params();
+    REQUIRE( &second != &first );
+    REQUIRE( second.get("packetization-mode") == "0" );
+    REQUIRE( first.get("packetization-mode") == "1" );
+
+    // Copies start without a cache.
+    AttrFormatParams copy(fmtp);
+    REQUIRE( copy.params().get("packetization-mode") == "0" );
+    REQUIRE( &copy.params() != &second );
+
+    // Concurrent first calls agree on one map.
+    AttrFormatParams shared;
+    shared.formatParams = "minptime=10;useinbandfec=1";
+    vector<const FormatParamMap*> seen(4);
+    vector<thread> threads;
+    for(size_t t = 0; t < seen.size(); t++)
+        threads.emplace_back([&, t](){ seen[t] = &shared.params(); });
+
+    for(thread& t : threads)
+        t.join();
+
+    for(const FormatParamMap* map : seen)
+        REQUIRE( map == &shared.params() );
+}
+
+static string encodeBase64(const vector<uint8_t>& bytes){
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    string out;
+    for(size_t i = 0; i < bytes.size(); i += 3){
+        uint32_t group = (uint32_t)bytes[i] << 16;
+        if(i + 1 < bytes.size())
+            group |= (uint32_t)bytes[i + 1] << 8;
+        if(i + 2 < bytes.size())
+            group |= bytes[i + 2];
+
+        out += alphabet[group >> 18];
+        out += alphabet[(group >> 12) & 63];
+        out += i + 1 < bytes.size() ? alphabet[(group >> 6) & 63] : '=';
+        out += i + 2 < bytes.size() ? alphabet[group & 63] : '=';
+    }
+
+    return out;
+}
+
+TEST_CASE("Decode Base64 And Hex", "[BinaryParam]"){
+    vector<uint8_t> out;
+    REQUIRE( decodeBase64("Zm9vYmFy", out) );
+    REQUIRE( string(out.begin(), out.end()) == "foobar" );
+
+    // Padding is optional, and out is appended to.
+    REQUIRE( decodeBase64("Zm9vYg==", out) );
+    REQUIRE( decodeBase64("Zm8", out) );
+    REQUIRE( string(out.begin(), out.end()) == "foobarfoobfo" );
+
+    out.clear();
+    REQUIRE_FALSE( decodeBase64("Zm9vY", out) );
+    REQUIRE_FALSE( decodeBase64("Zm9v YmFy", out) );
+    REQUIRE_FALSE( decodeBase64("Zm=vYmFy", out) );
+    REQUIRE( out.empty() );
+
+    // Long enough for the block decoders, with every byte value and every tail length.
+    for(size_t size = 0; size < 80; size++){
+        vector<uint8_t> bytes;
+        for(size_t i = 0; i < size; i++)
+            bytes.push_back((uint8_t)(i * 53 + size));
+
+        string hex;
+        for(uint8_t b : bytes){
+            hex += "0123456789abcdef"[b >> 4];
+            hex += "0123456789ABCDEF"[b & 15];
+        }
+
+        vector<uint8_t> fromBase64;
+        vector<uint8_t> fromHex;
+        REQUIRE( decodeBase64(encodeBase64(bytes), fromBase64) );
+        REQUIRE( decodeHex(hex, fromHex) );
+        REQUIRE( fromBase64 == bytes );
+        REQUIRE( fromHex == bytes );
+    }
+
+    // A bad character inside a block is still caught.
+    string longBase64 = encodeBase64(vector<uint8_t>(48, 0x5a));
+    longBase64[20] = '-';
+    REQUIRE_FALSE( decodeBase64(longBase64, out) );
+    REQUIRE_FALSE( decodeHex("00112233445566778899aabbccddeefg", out) );
+    REQUIRE_FALSE( decodeHex("abc", out) );
+    REQUIRE( out.empty() );
+}
+
+TEST_CASE("Binary Parameters Are Decoded Once", "[BinaryParam]"){
+    Sdp sdp = parseSdp("v=0\r\n"
+                       "o=- 1 1 IN IP4 10.0.0.1\r\n"
+                       "s=-\r\n"
+                       "t=0 0\r\n"
+                       "m=video 5000 RTP/AVP 97\r\n"
+                       "a=rtpmap:97 H264/90000\r\n"
+                       "a=fmtp:97 profile-level-id=42e01f;sprop-parameter-sets=Z0LgH9oFB+Q=,aM4G4g==\r\n"
+                       "m=audio 5002 RTP/AVP 96\r\n"
+                       "a=rtpmap:96 mpeg4-generic/48000/2\r\n"
+                       "a=fmtp:96 mode=AAC-hbr;config=1190;sizelength=13\r\n");
+
+    const AttrFormatParams& h264 = *sdp.streams[0].find<AttrFormatParams>();
+    sp<const BinaryParam> sets = h264.spropParameterSets();
+    REQUIRE( sets.get() != NULL );
+    REQUIRE( sets->unitCount() == 2 );
+    REQUIRE( sets->unit(0).size == 8 );
+    REQUIRE( sets->unit(0).data[0] == 0x67 ); // SPS
+    REQUIRE( sets->unit(1).size == 4 );
+    REQUIRE( sets->unit(1).data[0] == 0x68 ); // PPS
+    REQUIRE( sets->bytes().size() == 12 );
+
+    // Cached: the same buffer each time, for any spelling of the key.
+    REQUIRE( h264.spropParameterSets() == sets );
+    REQUIRE( h264.binaryParam("SPROP-parameter-sets", BinaryEncoding::Base64) == sets );
+    REQUIRE( h264.binaryParam("sprop-vps", BinaryEncoding::Base64).get() == NULL );
+    REQUIRE( h264.config().get() == NULL );
+
+    sp<const BinaryParam> config = sdp.streams[1].find<AttrFormatParams>()->config();
+    REQUIRE( config.get() != NULL );
+    REQUIRE( config->unitCount() == 1 );
+    REQUIRE( config->bytes() == vector<uint8_t>({ 0x11, 0x90 }) );
+
+    // Malformed values give NULL, and a changed value is decoded again.
+    AttrFormatParams fmtp;
+    fmtp.formatParams = "sprop-parameter-sets=Z0LgH9oFB+Q=,";
+    REQUIRE( fmtp.spropParameterSets().get() == NULL );
+    fmtp.formatParams = "sprop-parameter-sets=aM4G4g==";
+    REQUIRE( fmtp.spropParameterSets().get() != NULL );
+    REQUIRE( fmtp.spropParameterSets()->bytes() == vector<uint8_t>({ 0x68, 0xce, 0x06, 0xe2 }) );
+
+    // The buffer outlives the attribute.
+    sp<const BinaryParam> kept;
+    {
+        AttrFormatParams temporary(fmtp);
+        kept = temporary.spropParameterSets();
+    }
+    REQUIRE( kept->unit(0).data[1] == 0xce );
+
+    // Concurrent first calls decode once.
+    AttrFormatParams shared;
+    shared.formatParams = "config=40002410adca00";
+    vector<sp<const BinaryParam>> seen(4);
+    vector<thread> threads;
+    for(size_t t = 0; t < seen.size(); t++)
+        threads.emplace_back([&, t](){ seen[t] = shared.config(); });
+
+    for(thread& t : threads)
+        t.join();
+
+    for(const sp<const BinaryParam>& param : seen)
+        REQUIRE( param == shared.config() );
+}
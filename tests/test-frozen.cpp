@@ -0,0 +1,132 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/frozen.h>
+
+using namespace zsdp;
+using namespace std;
+
+static const char* const kOffer =
+    "v=0\r\n"
+    "o=alice 123 1 IN IP4 10.0.0.1\r\n"
+    "s=Call\r\n"
+    "i=Information\r\n"
+    "c=IN IP4 10.0.0.1\r\n"
+    "b=AS:512\r\n"
+    "t=3034423619 3042462419\r\n"
+    "r=604800 3600 0 90000\r\n"
+    "z=2882844526 -3600 2898848070 0\r\n"
+    "a=group:BUNDLE 0 1\r\n"
+    "m=audio 5000 RTP/AVP 111 0\r\n"
+    "c=IN IP4 10.0.0.1\r\n"
+    "a=mid:0\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "a=sendrecv\r\n"
+    "m=video 5002 RTP/AVP 96\r\n"
+    "i=Camera\r\n"
+    "c=IN IP4 10.0.0.1\r\n"
+    "b=AS:2000\r\n"
+    "a=mid:1\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=sendrecv\r\n";
+
+TEST_CASE("Frozen Round Trip", "[Frozen]"){
+    Sdp sdp = parseSdp(kOffer);
+    FrozenSdp frozen(sdp);
+
+    Sdp thawed = frozen.toSdp();
+    REQUIRE( sdpToString(&thawed) == sdpToString(&sdp) );
+}
+
+TEST_CASE("Frozen Accessors", "[Frozen]"){
+    Sdp sdp = parseSdp(kOffer);
+    FrozenSdp frozen(sdp);
+
+    REQUIRE( frozen.version() == 0 );
+    REQUIRE( frozen.originUsername() == "alice" );
+    REQUIRE( frozen.originSessionID() == "123" );
+    REQUIRE( frozen.originHost() == "10.0.0.1" );
+    REQUIRE( frozen.sessionName() == "Call" );
+    REQUIRE( frozen.sessionInformation() == "Information" );
+    REQUIRE( frozen.uri().empty() );
+    REQUIRE( frozen.connectionData().host == "10.0.0.1" );
+    REQUIRE( frozen.bandwidth().type == BandwidthType::ApplicationSpecific );
+    REQUIRE( frozen.bandwidth().kbps == 512 );
+
+    REQUIRE( frozen.attributeCount() == 1 );
+    REQUIRE( frozen.attribute(0).key == "group" );
+    REQUIRE( frozen.attribute(0).value == "BUNDLE 0 1" );
+    REQUIRE_THROWS_AS( frozen.attribute(1), out_of_range );
+
+    REQUIRE( frozen.times().size() == 1 );
+    REQUIRE( frozen.times()[0].repeatingTimes.size() == 1 );
+    REQUIRE( frozen.times()[0].repeatingTimes[0].offsetsFromStartTime.size() == 2 );
+    REQUIRE( frozen.timeZoneAdjustments().size() == 2 );
+    REQUIRE( frozen.timeZoneAdjustments()[0].adjustment == -3600 );
+
+    REQUIRE( frozen.streamCount() == 2 );
+    FrozenStream audio = frozen.stream(0);
+    REQUIRE( audio.mediaType() == MediaType::Audio );
+    REQUIRE( audio.port() == 5000 );
+    REQUIRE( audio.protocol() == Protocol::RTP_AVP );
+    REQUIRE( audio.payloadTypeCount() == 2 );
+    REQUIRE( audio.payloadType(0) == 111 );
+    REQUIRE( audio.payloadType(1) == 0 );
+    REQUIRE( audio.attributeCount() == 5 );
+    REQUIRE( audio.attribute(4).key == "sendrecv" );
+    REQUIRE_FALSE( audio.attribute(4).hasValue );
+
+    sp<Attribute> rtpmap = audio.attribute(1).decode();
+    REQUIRE( rtpmap->key() == "rtpmap" );
+    REQUIRE( rtpmap->value() == "111 opus/48000/2" );
+
+    FrozenStream video = frozen.stream(1);
+    REQUIRE( video.title() == "Camera" );
+    REQUIRE( video.bandwidth().kbps == 2000 );
+    REQUIRE( video.attribute(1).value == "96 VP8/90000" );
+    REQUIRE_THROWS_AS( frozen.stream(2), out_of_range );
+}
+
+TEST_CASE("Frozen Shares Repeated Strings", "[Frozen]"){
+    Sdp sdp = parseSdp(kOffer);
+    FrozenSdp frozen(sdp);
+
+    // "10.0.0.1" appears in o= and three c= lines; "sendrecv" twice.
+    REQUIRE( frozen.originHost().data() == frozen.connectionData().host.data() );
+    REQUIRE( frozen.stream(0).connectionData().host.data() == frozen.stream(1).connectionData().host.data() );
+    REQUIRE( frozen.stream(0).attribute(4).key.data() == frozen.stream(1).attribute(2).key.data() );
+
+    REQUIRE( frozen.memoryUsage() < strlen(kOffer) + 1024 );
+}
+
+TEST_CASE("Frozen Move", "[Frozen]"){
+    FrozenSdp frozen(parseSdp(kOffer));
+    FrozenSdp moved(std::move(frozen));
+    REQUIRE( moved.streamCount() == 2 );
+
+    FrozenSdp other(parseSdp("v=0\r\no=- 1 1 IN IP4 0.0.0.0\r\ns=-\r\nt=0 0\r\n"));
+    REQUIRE( other.streamCount() == 0 );
+    other = std::move(moved);
+    REQUIRE( other.streamCount() == 2 );
+    REQUIRE( other.stream(1).attribute(0).value == "1" );
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/intern.h>
+
+using namespace zsdp;
+using namespace std;
+
+static const char* const kOffer =
+    "v=0\r\n"
+    "o=- 123 1 IN IP4 10.0.0.1\r\n"
+    "s=-\r\n"
+    "c=IN IP4 10.0.0.1\r\n"
+    "t=0 0\r\n"
+    "m=audio 5000 RTP/AVP 111 0\r\n"
+    "c=IN IP4 10.0.0.1\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "a=sendrecv\r\n"
+    "m=audio 5002 RTP/AVP 111 0\r\n"
+    "c=IN IP4 10.0.0.1\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "a=sendrecv\r\n";
+
+TEST_CASE("Intern Attributes While Parsing", "[Intern]"){
+    InternPool pool;
+    ParseOptions options;
+    options.internPool = &pool;
+
+    Sdp first = parseSdp(kOffer, options);
+    Sdp second = parseSdp(kOffer, options);
+
+    Sdp plain = parseSdp(kOffer);
+    REQUIRE( sdpToString(&first) == sdpToString(&plain) );
+    REQUIRE( first.streams[0].attributes[0] == first.streams[1].attributes[0] );
+    REQUIRE( first.streams[0].attributes[1] == second.streams[0].attributes[1] );
+    REQUIRE( dynamic_cast<AttrRtpMap*>(first.streams[0].attributes[0].get()) != NULL );
+
+    InternStats stats = pool.stats();
+    REQUIRE( stats.attributeLookups == 16 );
+    REQUIRE( stats.distinctAttributes == 4 );
+    REQUIRE( pool.attributeCount() == 4 );
+    REQUIRE( stats.attributeDedupRatio() == Approx(4.0) );
+
+    // Undecoded attributes are pooled separately.
+    options.decodeAttributes = false;
+    Sdp generic = parseSdp(kOffer, options);
+    REQUIRE( generic.streams[0].attributes[0] != first.streams[0].attributes[0] );
+    REQUIRE( dynamic_cast<GenericAttribute*>(generic.streams[0].attributes[0].get()) != NULL );
+    REQUIRE( pool.attributeCount() == 8 );
+}
+
+TEST_CASE("Intern Streams", "[Intern]"){
+    InternPool pool;
+    Sdp sdp = parseSdp(kOffer);
+
+    Stream other = sdp.streams[0];
+    sp<const Stream> a = pool.intern(sdp.streams[0]);
+    sp<const Stream> b = pool.intern(other);
+    REQUIRE( a == b );
+    REQUIRE( a->sdpLines() == sdp.streams[0].sdpLines() );
+
+    // A different port is a different m-section, but its attributes are shared.
+    sp<const Stream> c = pool.intern(sdp.streams[1]);
+    REQUIRE( c != a );
+    REQUIRE( c->attributes[0] == a->attributes[0] );
+
+    REQUIRE( pool.stats().streamLookups == 3 );
+    REQUIRE( pool.stats().distinctStreams == 2 );
+    REQUIRE( pool.streamCount() == 2 );
+}
+
+TEST_CASE("Intern Prune", "[Intern]"){
+    InternPool pool;
+    ParseOptions options;
+    options.internPool = &pool;
+
+    sp<Attribute> kept = pool.attribute("sendrecv");
+    {
+        Sdp sdp = parseSdp(kOffer, options);
+        pool.intern(sdp.streams[0]);
+        REQUIRE( pool.prune() == 1 );
+        REQUIRE( pool.attributeCount() == 4 );
+    }
+
+    REQUIRE( pool.prune() == 3 );
+    REQUIRE( pool.attributeCount() == 1 );
+    REQUIRE( pool.attribute("sendrecv") == kept );
+
+    pool.clear();
+    REQUIRE( pool.attributeCount() == 0 );
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/json.h>
+#include "../json-util.h"
+
+using namespace zsdp;
+using namespace std;
+
+static const char* const kOffer =
+    "v=0\r\n"
+    "o=alice 2890844526 2890842807 IN IP4 10.47.16.5\r\n"
+    "s=Session \"quoted\" \\ name\r\n"
+    "i=A Seminar on the session description protocol\r\n"
+    "c=IN IP4 224.2.17.12/127\r\n"
+    "b=AS:512\r\n"
+    "t=2873397496 2873404696\r\n"
+    "r=604800 3600 0 90000\r\n"
+    "z=2882844526 -3600 2898848070 0\r\n"
+    "a=recvonly\r\n"
+    "a=tool:zsdp\r\n"
+    "m=audio 49170 RTP/AVP 111 0\r\n"
+    "i=Audio\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=ptime:20\r\n"
+    "a=ice-ufrag:abcd\r\n"
+    "m=video 51372 RTP/AVP 96\r\n"
+    "c=IN IP4 10.0.0.2\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=sendonly\r\n";
+
+static string escaped(const string& s){
+    string out;
+    appendJsonString(out, s);
+
+    return out;
+}
+
+TEST_CASE("JSON String Escaping", "[JSON]"){
+    REQUIRE( escaped("") == "\"\"" );
+    REQUIRE( escaped("abc") == "\"abc\"" );
+    REQUIRE( escaped("a\"b\\c") == "\"a\\\"b\\\\c\"" );
+    REQUIRE( escaped("\r\n\t") == "\"\\r\\n\\t\"" );
+    REQUIRE( escaped(string("\x01", 1)) == "\"\\u0001\"" );
+
+    // Long enough to go through the 16-byte blocks, with escapes in and after the first block.
+    string longStr = "0123456789abcdef0123456789\"abcdef\n0123";
+    REQUIRE( escaped(longStr) == "\"0123456789abcdef0123456789\\\"abcdef\\n0123\"" );
+
+    string roundTrip;
+    string input = "x\x1f\"\\/\xc3\xa9" + longStr;
+    string json = escaped(input);
+    appendJsonUnescaped(roundTrip, StringView(json.data() + 1, json.size() - 2));
+    REQUIRE( roundTrip == input );
+}
+
+TEST_CASE("JSON String Unescaping", "[JSON]"){
+    string out;
+    appendJsonUnescaped(out, "a\\/b\\u00e9\\ud83d\\ude00");
+    REQUIRE( out == "a/b\xc3\xa9\xf0\x9f\x98\x80" );
+
+    out.clear();
+    REQUIRE_THROWS_AS( appendJsonUnescaped(out, "\\x"), invalid_argument );
+    REQUIRE_THROWS_AS( appendJsonUnescaped(out, "\\u12"), invalid_argument );
+    REQUIRE_THROWS_AS( appendJsonUnescaped(out, "\\ud83d"), invalid_argument );
+}
+
+TEST_CASE("SDP to JSON", "[JSON]"){
+    Sdp sdp = parseSdp(kOffer);
+    string json;
+    sdpToJson(sdp, json);
+
+    REQUIRE( json.find("\"sessionName\":\"Session \\\"quoted\\\" \\\\ name\"") != string::npos );
+    REQUIRE( json.find("{\"key\":\"rtpmap\",\"payloadType\":111,\"encodingName\":\"opus\",\"clockRate\":48000,\"channels\":2}") != string::npos );
+    REQUIRE( json.find("{\"key\":\"ptime\",\"value\":20}") != string::npos );
+    REQUIRE( json.find("{\"key\":\"ice-ufrag\",\"value\":\"abcd\"}") != string::npos );
+    REQUIRE( json.find("{\"key\":\"recvonly\"}") != string::npos );
+    REQUIRE( json.find("\"adjustment\":-3600") != string::npos );
+    REQUIRE( json.find("\"payloadTypes\":[111,0]") != string::npos );
+}
+
+TEST_CASE("JSON Round Trip", "[JSON]"){
+    Sdp sdp = parseSdp(kOffer);
+    string json;
+    sdpToJson(sdp, json);
+
+    Sdp fromJson = sdpFromJson(json);
+    REQUIRE( sdpToString(&fromJson) == sdpToString(&sdp) );
+
+    string jsonAgain;
+    sdpToJson(fromJson, jsonAgain);
+    REQUIRE( jsonAgain == json );
+}
+
+TEST_CASE("JSON Reader", "[JSON]"){
+    Sdp sdp = sdpFromJson(
+        " {\"version\": 0, \"unknown\": {\"nested\": [1, true, null, \"x\\\"}\"]},\n"
+        "  \"origin\": {\"username\": \"-\", \"sessionID\": \"1\", \"sessionVersion\": \"2\","
+        "              \"networkType\": \"IN\", \"addressType\": \"IP6\", \"host\": \"::1\"},\n"
+        "  \"sessionName\": \"caf\\u00e9\",\n"
+        "  \"times\": [{\"start\": 0, \"end\": 0}],\n"
+        "  \"streams\": [{\"mediaDescription\": {\"mediaType\": \"audio\", \"port\": 9,"
+        "                 \"protocol\": \"RTP/AVP\", \"payloadTypes\": [0]},"
+        "                 \"attributes\": [{\"key\": \"maxptime\", \"value\": 60}]}]} ");
+
+    REQUIRE( sdp.origin.addressType == AddressType::IP6 );
+    REQUIRE( sdp.origin.host == "::1" );
+    REQUIRE( sdp.sessionName == "caf\xc3\xa9" );
+    REQUIRE( sdp.streams.size() == 1 );
+    REQUIRE( sdp.streams[0].mediaDescription.port == 9 );
+    REQUIRE( sdp.streams[0].attributes.size() == 1 );
+    REQUIRE( sdp.streams[0].attributes[0]->key() == "maxptime" );
+    REQUIRE( sdp.streams[0].attributes[0]->value() == "60" );
+
+    REQUIRE_THROWS_AS( sdpFromJson("{\"version\": 0"), invalid_argument );
+    REQUIRE_THROWS_AS( sdpFromJson("{\"version\": -1}"), invalid_argument );
+    REQUIRE_THROWS_AS( sdpFromJson("{\"sessionName\": \"abc}"), invalid_argument );
+    REQUIRE_THROWS_AS( sdpFromJson("{} x"), invalid_argument );
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/negotiation-cache.h>
+
+using namespace zsdp;
+using namespace std;
+
+static LocalCapabilities localCapabilities(){
+    LocalCapabilities local;
+
+    LocalCodec opus;
+    opus.mediaType = MediaType::Audio;
+    opus.encodingName = "opus";
+    opus.clockRate = 48000;
+    opus.channels = 2;
+    local.codecs.push_back(opus);
+
+    LocalCodec vp8;
+    vp8.mediaType = MediaType::Video;
+    vp8.encodingName = "VP8";
+    vp8.clockRate = 90000;
+    local.codecs.push_back(vp8);
+
+    local.connectionData.host = "192.0.2.10";
+    local.firstPort = 40000;
+    return local;
+}
+
+static string offer(const string& sessionID, const string& host, uint16_t port, const string& time, const string& audioCodec = "opus/48000/2"){
+    return "v=0\r\n"
+           "o=- " + sessionID + " 1 IN IP4 " + host + "\r\n"
+           "s=-\r\n"
+           "c=IN IP4 " + host + "\r\n"
+           "t=" + time + "\r\n"
+           "m=audio " + to_string(port) + " RTP/AVP 111\r\n"
+           "a=rtpmap:111 " + audioCodec + "\r\n"
+           "a=ptime:20\r\n"
+           "m=video " + to_string(port + 2) + " RTP/AVP 96\r\n"
+           "a=rtpmap:96 VP8/90000\r\n"
+           "a=recvonly\r\n";
+}
+
+TEST_CASE("Fingerprint Ignores Addresses And Ports", "[NegotiationCache]"){
+    Sdp a = parseSdp(offer("1", "10.0.0.1", 5000, "0 0"));
+    Sdp b = parseSdp(offer("2", "10.9.9.9", 7000, "3034423619 3042462419"));
+    REQUIRE( negotiationFingerprint(a) == negotiationFingerprint(b) );
+
+    // Attributes negotiation doesn't look at don't count either.
+    b.streams[0].attributes.pop_back();
+    REQUIRE( negotiationFingerprint(a) == negotiationFingerprint(b) );
+
+    Sdp otherCodec = parseSdp(offer("1", "10.0.0.1", 5000, "0 0", "opus/48000/1"));
+    REQUIRE( negotiationFingerprint(a) != negotiationFingerprint(otherCodec) );
+
+    Sdp rejected = a;
+    rejected.streams[1].mediaDescription.port = 0;
+    REQUIRE( negotiationFingerprint(a) != negotiationFingerprint(rejected) );
+
+    Sdp sessionDirection = a;
+    sessionDirection.attributes.push_back(parseAttribute("sendonly"));
+    REQUIRE( negotiationFingerprint(a) != negotiationFingerprint(sessionDirection) );
+}
+
+TEST_CASE("Cached Answers Match Negotiated Answers", "[NegotiationCache]"){
+    Negotiator negotiator(localCapabilities());
+    NegotiationCache cache;
+
+    Sdp first = parseSdp(offer("1", "10.0.0.1", 5000, "0 0"));
+    Sdp second = parseSdp(offer("2", "10.9.9.9", 7000, "3034423619 3042462419"));
+
+    Sdp firstAnswer = cache.answer(negotiator, first);
+    Sdp secondAnswer = cache.answer(negotiator, second);
+    Sdp firstExpected = negotiator.answer(first);
+    Sdp expected = negotiator.answer(second);
+
+    REQUIRE( sdpToString(&firstAnswer) == sdpToString(&firstExpected) );
+    REQUIRE( sdpToString(&secondAnswer) == sdpToString(&expected) );
+    REQUIRE( secondAnswer.times[0].start == 3034423619ULL );
+
+    NegotiationCacheStats stats = cache.stats();
+    REQUIRE( stats.misses == 1 );
+    REQUIRE( stats.hits == 1 );
+    REQUIRE( stats.entries == 1 );
+    REQUIRE( stats.hitRatio() == 0.5 );
+
+    // Per-call addresses and ports on top of the cached skeleton.
+    AnswerTransport transport;
+    transport.origin.sessionID = "77";
+    transport.connectionData.host = "198.51.100.5";
+    transport.firstPort = 50000;
+
+    Sdp withTransport = cache.answer(negotiator, second, transport);
+    Sdp expectedWithTransport = negotiator.answer(second, transport);
+    REQUIRE( sdpToString(&withTransport) == sdpToString(&expectedWithTransport) );
+    REQUIRE( withTransport.streams[1].mediaDescription.port == 50002 );
+    REQUIRE( withTransport.streams[1].connectionData.host == "198.51.100.5" );
+    REQUIRE( cache.stats().hits == 2 );
+}
+
+TEST_CASE("Cache Entries Are Per Negotiator", "[NegotiationCache]"){
+    LocalCapabilities audioOnly = localCapabilities();
+    audioOnly.codecs.pop_back();
+
+    Negotiator full(localCapabilities());
+    Negotiator limited(audioOnly);
+    REQUIRE( full.profileId() != limited.profileId() );
+
+    NegotiationCache cache(2);
+    Sdp sdp = parseSdp(offer("1", "10.0.0.1", 5000, "0 0"));
+
+    REQUIRE( cache.answer(full, sdp).streams[1].mediaDescription.port != 0 );
+    REQUIRE( cache.answer(limited, sdp).streams[1].mediaDescription.port == 0 );
+    REQUIRE( cache.size() == 2 );
+
+    // Full: emptied, then refilled.
+    Sdp other = parseSdp(offer("1", "10.0.0.1", 5000, "0 0", "opus/48000/1"));
+    cache.answer(full, other);
+    REQUIRE( cache.size() == 1 );
+
+    cache.clear();
+    REQUIRE( cache.size() == 0 );
+}
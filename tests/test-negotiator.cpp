@@ -0,0 +1,209 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/negotiator.h>
+
+using namespace zsdp;
+using namespace std;
+
+static LocalCodec codec(MediaType mediaType, const char* name, uint32_t clockRate, uint32_t channels = 1, const char* fmtp = ""){
+    LocalCodec c;
+    c.mediaType = mediaType;
+    c.encodingName = name;
+    c.clockRate = clockRate;
+    c.channels = channels;
+    c.formatParams = fmtp;
+    return c;
+}
+
+static LocalCapabilities localCapabilities(){
+    LocalCapabilities local;
+    local.codecs.push_back(codec(MediaType::Audio, "opus", 48000, 2, "minptime=10;useinbandfec=1"));
+    local.codecs.push_back(codec(MediaType::Audio, "PCMU", 8000));
+    local.codecs.push_back(codec(MediaType::Audio, "telephone-event", 8000, 1, "0-15"));
+    local.codecs.push_back(codec(MediaType::Video, "H264", 90000, 1, "profile-level-id=42e01f;packetization-mode=1"));
+    local.origin.sessionID = "999";
+    local.origin.sessionVersion = "1";
+    local.origin.host = "192.0.2.10";
+    local.connectionData.host = "192.0.2.10";
+    local.firstPort = 40000;
+    return local;
+}
+
+static const char* const kOffer =
+    "v=0\r\n"
+    "o=- 123 1 IN IP4 10.0.0.1\r\n"
+    "s=-\r\n"
+    "c=IN IP4 10.0.0.1\r\n"
+    "t=0 0\r\n"
+    "m=audio 5000 RTP/AVP 111 0 8 101\r\n"
+    "a=rtpmap:111 OPUS/48000/2\r\n"
+    "a=rtpmap:101 telephone-event/8000\r\n"
+    "a=sendonly\r\n"
+    "m=video 5002 RTP/AVP 96 97\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=rtpmap:97 H264/90000\r\n"
+    "a=fmtp:97 profile-level-id=42e034;packetization-mode=1\r\n"
+    "m=video 5004 RTP/AVP 98\r\n"
+    "a=rtpmap:98 VP9/90000\r\n"
+    "m=application 5006 udp wb\r\n";
+
+TEST_CASE("Answer An Offer", "[Negotiator]"){
+    Negotiator negotiator(localCapabilities());
+    Sdp offer = parseSdp(kOffer);
+    Sdp answer = negotiator.answer(offer);
+
+    REQUIRE( sdpToString(&answer) ==
+             "v=0\r\n"
+             "o=- 999 1 IN IP4 192.0.2.10\r\n"
+             "s=-\r\n"
+             "c=IN IP4 192.0.2.10\r\n"
+             "t=0 0\r\n"
+             "m=audio 40000 RTP/AVP 111 0 101\r\n"
+             "c=IN IP4 192.0.2.10\r\n"
+             "a=rtpmap:111 opus/48000/2\r\n"
+             "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+             "a=rtpmap:0 PCMU/8000\r\n"
+             "a=rtpmap:101 telephone-event/8000\r\n"
+             "a=fmtp:101 0-15\r\n"
+             "a=recvonly\r\n"
+             "m=video 40002 RTP/AVP 97\r\n"
+             "c=IN IP4 192.0.2.10\r\n"
+             "a=rtpmap:97 H264/90000\r\n"
+             "a=fmtp:97 profile-level-id=42e01f;packetization-mode=1\r\n"
+             "a=sendrecv\r\n"
+             "m=video 0 RTP/AVP 98\r\n"
+             "c=IN IP4 192.0.2.10\r\n"
+             "m=application 0 udp wb\r\n"
+             "c=IN IP4 192.0.2.10\r\n" );
+
+    REQUIRE( answer.streams[0].find<AttrRtpMap>()->payloadType == 111 );
+    REQUIRE( answer.streams[0].mediaDescription.payloadTypeSet.contains(101) );
+    REQUIRE( answer.streams[1].find<AttrMediaDirection>()->direction == MediaDirection::SendRecv );
+}
+
+TEST_CASE("Match Offered Payload Types", "[Negotiator]"){
+    Negotiator negotiator(localCapabilities());
+    Sdp offer = parseSdp(kOffer);
+
+    const LocalCodec* opus = negotiator.match(offer.streams[0], 111);
+    REQUIRE( opus != NULL );
+    REQUIRE( opus->encodingName == "opus" );
+
+    // Static, without an rtpmap.
+    REQUIRE( negotiator.match(offer.streams[0], 0)->encodingName == "PCMU" );
+    REQUIRE( negotiator.match(offer.streams[0], 8) == NULL );
+
+    // Not offered in this m-section.
+    REQUIRE( negotiator.match(offer.streams[1], 111) == NULL );
+    REQUIRE( negotiator.match(offer.streams[1], 97)->mediaType == MediaType::Video );
+}
+
+TEST_CASE("Match H264 By Profile And Packetization Mode", "[Negotiator]"){
+    LocalCapabilities local = localCapabilities();
+    local.codecs.push_back(codec(MediaType::Video, "H264", 90000, 1, "profile-level-id=640c1f;packetization-mode=0"));
+    Negotiator negotiator(local);
+
+    Sdp offer = parseSdp("v=0\r\n"
+                         "o=- 1 1 IN IP4 10.0.0.1\r\n"
+                         "s=-\r\n"
+                         "t=0 0\r\n"
+                         "m=video 5000 RTP/AVP 100 101 102 103 104\r\n"
+                         "a=rtpmap:100 H264/90000\r\n"
+                         "a=fmtp:100 profile-level-id=42e01f;packetization-mode=0\r\n"
+                         "a=rtpmap:101 H264/90000\r\n"
+                         "a=fmtp:101 profile-level-id=42E00B; packetization-mode=1\r\n"
+                         "a=rtpmap:102 H264/90000\r\n"
+                         "a=fmtp:102 profile-level-id=640c28\r\n"
+                         "a=rtpmap:103 H264/90000\r\n"
+                         "a=rtpmap:104 H264/90000\r\n"
+                         "a=fmtp:104 profile-level-id=4d001f;packetization-mode=1\r\n");
+
+    const Stream& video = offer.streams[0];
+
+    // Same profile, other packetization mode.
+    REQUIRE( negotiator.match(video, 100) == NULL );
+
+    // A different level is fine.
+    REQUIRE( negotiator.match(video, 101) == &negotiator.local().codecs[3] );
+    REQUIRE( negotiator.match(video, 102) == &negotiator.local().codecs[4] );
+
+    // No fmtp means Baseline (42000a), packetization mode 0.
+    REQUIRE( negotiator.match(video, 103) == NULL );
+    REQUIRE( negotiator.match(video, 104) == NULL );
+
+    LocalCapabilities invalid = localCapabilities();
+    invalid.codecs.push_back(codec(MediaType::Video, "H264", 90000, 1, "profile-level-id=xyz"));
+    REQUIRE_THROWS_AS( Negotiator(invalid), invalid_argument );
+}
+
+TEST_CASE("Answer Direction", "[Negotiator]"){
+    LocalCapabilities local = localCapabilities();
+    local.direction = MediaDirection::SendOnly;
+    Negotiator sendOnly(local);
+
+    auto directionFor = [](const Negotiator& negotiator, const string& sessionAttr, const string& streamAttr){
+        Sdp offer = parseSdp("v=0\r\n"
+                             "o=- 1 1 IN IP4 10.0.0.1\r\n"
+                             "s=-\r\n"
+                             "t=0 0\r\n"
+                             + sessionAttr +
+                             "m=audio 5000 RTP/AVP 0\r\n"
+                             + streamAttr);
+
+        return negotiator.answer(offer).streams[0].find<AttrMediaDirection>()->direction;
+    };
+
+    Negotiator sendRecv(localCapabilities());
+    REQUIRE( directionFor(sendRecv, "", "") == MediaDirection::SendRecv );
+    REQUIRE( directionFor(sendRecv, "", "a=recvonly\r\n") == MediaDirection::SendOnly );
+    REQUIRE( directionFor(sendRecv, "", "a=inactive\r\n") == MediaDirection::Inactive );
+    REQUIRE( directionFor(sendRecv, "a=sendonly\r\n", "") == MediaDirection::RecvOnly );
+    REQUIRE( directionFor(sendRecv, "a=sendonly\r\n", "a=sendrecv\r\n") == MediaDirection::SendRecv );
+
+    REQUIRE( directionFor(sendOnly, "", "") == MediaDirection::SendOnly );
+    REQUIRE( directionFor(sendOnly, "", "a=sendonly\r\n") == MediaDirection::Inactive );
+}
+
+TEST_CASE("Reject What Cannot Be Answered", "[Negotiator]"){
+    Negotiator negotiator(localCapabilities());
+    Sdp offer = parseSdp("v=0\r\n"
+                         "o=- 1 1 IN IP4 10.0.0.1\r\n"
+                         "s=-\r\n"
+                         "t=0 0\r\n"
+                         "m=audio 0 RTP/AVP 0\r\n"
+                         "m=audio 5000 RTP/AVP 96\r\n"
+                         "a=rtpmap:96 opus/48000\r\n");
+
+    Sdp answer = negotiator.answer(offer);
+    REQUIRE( answer.streams.size() == 2 );
+
+    // Already rejected in the offer.
+    REQUIRE( answer.streams[0].mediaDescription.port == 0 );
+
+    // opus with one channel is not the local opus/48000/2.
+    REQUIRE( answer.streams[1].mediaDescription.port == 0 );
+    REQUIRE( answer.streams[1].attributes.empty() );
+
+    LocalCapabilities noMediaType;
+    noMediaType.codecs.push_back(LocalCodec());
+    REQUIRE_THROWS_AS( Negotiator(noMediaType), invalid_argument );
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/patcher.h>
+
+using namespace zsdp;
+using namespace std;
+
+static const char* const kOffer =
+    "v=0\r\n"
+    "o=alice 2890844526 2890844526 IN IP4 192.168.1.10\r\n"
+    "s=-\r\n"
+    "c=IN IP4 192.168.1.10\r\n"
+    "t=0 0\r\n"
+    "m=audio 49170 RTP/AVP 0 8\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "m=video 51372/2 RTP/AVP 96\r\n"
+    "c=IN IP4 192.168.1.11\r\n"
+    "a=rtpmap:96 VP8/90000\r\n";
+
+TEST_CASE("Patch Nothing", "[Patcher]"){
+    SdpPatcher patcher;
+    string out = "stale";
+
+    REQUIRE( patcher.apply(kOffer, out) == 0 );
+    REQUIRE( out == kOffer );
+}
+
+TEST_CASE("Patch Addresses and Ports", "[Patcher]"){
+    SdpPatcher patcher;
+    patcher.setOriginAddress("203.0.113.5");
+    patcher.setConnectionAddress("203.0.113.5");
+    patcher.setMediaConnectionAddress(1, "2001:db8::1", AddressType::IP6);
+    patcher.setMediaPort(0, 20000);
+    patcher.setMediaPort(1, 7);
+
+    string out;
+    REQUIRE( patcher.apply(kOffer, out) == 5 );
+    REQUIRE( out ==
+        "v=0\r\n"
+        "o=alice 2890844526 2890844526 IN IP4 203.0.113.5\r\n"
+        "s=-\r\n"
+        "c=IN IP4 203.0.113.5\r\n"
+        "t=0 0\r\n"
+        "m=audio 20000 RTP/AVP 0 8\r\n"
+        "a=rtpmap:0 PCMU/8000\r\n"
+        "m=video 7/2 RTP/AVP 96\r\n"
+        "c=IN IP6 2001:db8::1\r\n"
+        "a=rtpmap:96 VP8/90000\r\n" );
+
+    patcher.clear();
+    patcher.setSessionConnectionAddress("10.0.0.1");
+    patcher.setMediaPort(5, 1000);
+    REQUIRE( patcher.apply(kOffer, out) == 1 );
+    REQUIRE( out.find("c=IN IP4 10.0.0.1\r\n") != string::npos );
+    REQUIRE( out.find("c=IN IP4 192.168.1.11\r\n") != string::npos );
+}
+
+TEST_CASE("Patch Keeps Multicast Suffix and Line Endings", "[Patcher]"){
+    SdpPatcher patcher;
+    patcher.setConnectionAddress("233.252.0.2");
+
+    string out;
+    REQUIRE( patcher.apply("v=0\nc=IN IP4 233.252.0.1/127/3\nt=0 0\n", out) == 1 );
+    REQUIRE( out == "v=0\nc=IN IP4 233.252.0.2/127/3\nt=0 0\n" );
+
+    // Malformed lines are left alone.
+    REQUIRE( patcher.apply("v=0\r\nc=IN\r\n", out) == 0 );
+    REQUIRE( out == "v=0\r\nc=IN\r\n" );
+}
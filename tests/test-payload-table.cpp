@@ -0,0 +1,114 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/payload-table.h>
+
+using namespace zsdp;
+using namespace std;
+
+static const char* const kOffer =
+    "v=0\r\n"
+    "o=- 123 1 IN IP4 10.0.0.1\r\n"
+    "s=-\r\n"
+    "c=IN IP4 10.0.0.1\r\n"
+    "t=0 0\r\n"
+    "m=audio 5000 RTP/AVP 111 0 9 101\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=rtcp-fb:111 transport-cc\r\n"
+    "a=rtpmap:9 G722/8000\r\n"
+    "a=rtpmap:101 telephone-event/8000\r\n"
+    "a=fmtp:101 0-15\r\n"
+    "a=rtpmap:102 ignored/8000\r\n"
+    "m=video 5002 RTP/AVP 96 97 34\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=rtpmap:97 H264/90000\r\n"
+    "a=fmtp:97 profile-level-id=42e01f;packetization-mode=1\r\n"
+    "a=rtcp-fb:* nack\r\n"
+    "a=rtcp-fb:96 nack pli\r\n"
+    "a=rtcp-fb:96 ccm fir\r\n"
+    "a=rtcp-fb:97 goog-remb\r\n"
+    "a=rtcp-fb:97 trr-int 100\r\n";
+
+TEST_CASE("Payload Table From Audio Stream", "[PayloadTable]"){
+    Sdp sdp = parseSdp(kOffer);
+    PayloadTable table(sdp.streams[0]);
+
+    REQUIRE( table.size() == 4 );
+
+    const PayloadInfo& opus = table[111];
+    REQUIRE( opus.defined );
+    REQUIRE_FALSE( opus.isStatic );
+    REQUIRE( opus.encodingName == "opus" );
+    REQUIRE( opus.clockRate == 48000 );
+    REQUIRE( opus.channels == 2 );
+    REQUIRE( opus.formatParams == "minptime=10;useinbandfec=1" );
+    REQUIRE( opus.rtcpFeedback == kRtcpFeedback_TransportCc );
+
+    // No rtpmap: the static assignment.
+    const PayloadInfo* pcmu = table.find(0);
+    REQUIRE( pcmu != NULL );
+    REQUIRE( pcmu->isStatic );
+    REQUIRE( pcmu->encodingName == "PCMU" );
+    REQUIRE( pcmu->clockRate == 8000 );
+    REQUIRE( pcmu->channels == 1 );
+
+    // An rtpmap overrides the static assignment.
+    REQUIRE_FALSE( table[9].isStatic );
+    REQUIRE( table[9].channels == 1 );
+
+    REQUIRE( table[101].encodingName == "telephone-event" );
+    REQUIRE( table[101].formatParams == "0-15" );
+
+    // Not on the m= line.
+    REQUIRE( table.find(102) == NULL );
+    REQUIRE( table.find(8) == NULL );
+    REQUIRE( table.find(200) == NULL );
+    REQUIRE( &table[111 | 0x80] == &opus );
+}
+
+TEST_CASE("Payload Table Collects RTCP Feedback", "[PayloadTable]"){
+    Sdp sdp = parseSdp(kOffer);
+    PayloadTable table(sdp.streams[1]);
+
+    REQUIRE( table.size() == 3 );
+    REQUIRE( table[96].rtcpFeedback == (kRtcpFeedback_Nack | kRtcpFeedback_Pli | kRtcpFeedback_Fir) );
+    REQUIRE( table[97].rtcpFeedback == (kRtcpFeedback_Nack | kRtcpFeedback_Remb | kRtcpFeedback_Other) );
+    REQUIRE( table[97].formatParams == "profile-level-id=42e01f;packetization-mode=1" );
+    
+    REQUIRE( table[34].isStatic );
+    REQUIRE( table[34].encodingName == "H263" );
+    REQUIRE( table[34].clockRate == 90000 );
+    REQUIRE( table[34].channels == 0 );
+    REQUIRE( table[34].rtcpFeedback == kRtcpFeedback_Nack );
+}
+
+TEST_CASE("Static Payload Types", "[PayloadTable]"){
+    REQUIRE( PayloadTable::staticPayloadType(8).encodingName == "PCMA" );
+    REQUIRE( PayloadTable::staticPayloadType(10).channels == 2 );
+    REQUIRE( PayloadTable::staticPayloadType(10).clockRate == 44100 );
+    REQUIRE_FALSE( PayloadTable::staticPayloadType(2).defined );
+    REQUIRE_FALSE( PayloadTable::staticPayloadType(96).defined );
+
+    PayloadTable empty;
+    REQUIRE( empty.size() == 0 );
+    REQUIRE( empty.find(0) == NULL );
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/payload-type-set.h>
+#include <zsdp/sdp.h>
+#include <vector>
+
+using namespace zsdp;
+using namespace std;
+
+static vector<uint8_t> members(const PayloadTypeSet& set){
+    vector<uint8_t> pts;
+    set.forEach([&](uint8_t pt){ pts.push_back(pt); });
+    return pts;
+}
+
+TEST_CASE("Payload Type Set Membership", "[PayloadTypeSet]"){
+    PayloadTypeSet set;
+    REQUIRE( set.empty() );
+    REQUIRE( set.size() == 0 );
+    REQUIRE( set.first() == kPayloadType_NotSet );
+
+    set.insert(0);
+    set.insert(63);
+    set.insert(64);
+    set.insert(127);
+    set.insert(127);
+    set.insert(128);
+    set.insert(-1);
+
+    REQUIRE( set.size() == 4 );
+    REQUIRE( set.contains(0) );
+    REQUIRE( set.contains(63) );
+    REQUIRE( set.contains(64) );
+    REQUIRE( set.contains(127) );
+    REQUIRE_FALSE( set.contains(1) );
+    REQUIRE_FALSE( set.contains(128) );
+    REQUIRE_FALSE( set.contains(-1) );
+    REQUIRE( members(set) == vector<uint8_t>({ 0, 63, 64, 127 }) );
+
+    set.erase(0);
+    REQUIRE( set.first() == 63 );
+    set.erase(63);
+    REQUIRE( set.first() == 64 );
+
+    set.clear();
+    REQUIRE( set.empty() );
+}
+
+TEST_CASE("Payload Type Set Operations", "[PayloadTypeSet]"){
+    PayloadTypeSet offered = { 111, 0, 8, 101, 9 };
+    PayloadTypeSet supported = PayloadTypeSet::of(vector<int>({ 0, 9, 111, 96 }));
+
+    REQUIRE( members(offered & supported) == vector<uint8_t>({ 0, 9, 111 }) );
+    REQUIRE( members(offered | supported) == vector<uint8_t>({ 0, 8, 9, 96, 101, 111 }) );
+    REQUIRE( members(offered - supported) == vector<uint8_t>({ 8, 101 }) );
+
+    REQUIRE( offered.intersects(supported) );
+    REQUIRE_FALSE( PayloadTypeSet({ 8 }).intersects(supported) );
+    REQUIRE( (offered & supported).isSubsetOf(offered) );
+    REQUIRE_FALSE( offered.isSubsetOf(supported) );
+
+    PayloadTypeSet copy = offered;
+    REQUIRE( copy == offered );
+    copy &= supported;
+    REQUIRE( copy != offered );
+    REQUIRE( copy.word(0) == ((1ULL << 0) | (1ULL << 9)) );
+    REQUIRE( copy.word(1) == (1ULL << (111 - 64)) );
+}
+
+TEST_CASE("Decoders Fill In The Payload Type Set", "[PayloadTypeSet]"){
+    Sdp sdp = parseSdp(
+        "v=0\r\n"
+        "o=- 123 1 IN IP4 10.0.0.1\r\n"
+        "s=-\r\n"
+        "c=IN IP4 10.0.0.1\r\n"
+        "t=0 0\r\n"
+        "m=audio 5000 RTP/AVP 111 0 101\r\n"
+        "a=rtpmap:111 opus/48000/2\r\n"
+        "a=rtpmap:101 telephone-event/8000\r\n"
+        "m=application 5004 udp wb\r\n");
+
+    MediaDescription& audio = sdp.streams[0].mediaDescription;
+    REQUIRE( members(audio.payloadTypeSet) == vector<uint8_t>({ 0, 101, 111 }) );
+    REQUIRE( sdp.streams[1].mediaDescription.payloadTypeSet.empty() );
+
+    // m= and rtpmap consistency as a set difference: 0 is static, so it needs no rtpmap.
+    PayloadTypeSet mapped;
+    for(const AttrRtpMap& rtpMap : sdp.streams[0].findAll<AttrRtpMap>())
+        mapped.insert(rtpMap.payloadType);
+    REQUIRE( members(audio.payloadTypeSet - mapped) == vector<uint8_t>({ 0 }) );
+
+    audio.addPayloadType(8);
+    REQUIRE( audio.payloadTypeSet.contains(8) );
+    REQUIRE( audio.payloadTypes.size() == 4 );
+
+    audio.payloadTypes.erase(audio.payloadTypes.begin());
+    audio.reindexPayloadTypes();
+    REQUIRE( members(audio.payloadTypeSet) == vector<uint8_t>({ 0, 8, 101 }) );
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/pipeline.h>
+
+using namespace zsdp;
+using namespace std;
+
+static const char* const kOffer =
+    "v=0\r\n"
+    "o=- 1 1 IN IP4 10.0.0.1\r\n"
+    "s=-\r\n"
+    "t=0 0\r\n"
+    "a=sendrecv\r\n"
+    "m=audio 5000 RTP/AVP 111 0 8 101\r\n"
+    "b=AS:128\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=fmtp:111 minptime=10\r\n"
+    "a=rtpmap:8 PCMA/8000\r\n"
+    "a=rtpmap:101 telephone-event/8000\r\n"
+    "a=ice-ufrag:abcd\r\n"
+    "m=video 5002 RTP/AVP 96 97\r\n"
+    "b=AS:2000\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=rtcp-fb:96 nack\r\n"
+    "a=rtpmap:97 H264/90000\r\n"
+    "a=recvonly\r\n";
+
+static string runPipeline(const SdpPipeline& pipeline, const string& in){
+    string out;
+    pipeline.run(in, out);
+
+    return out;
+}
+
+TEST_CASE("Empty Pipeline", "[Pipeline]"){
+    SdpPipeline pipeline;
+    REQUIRE( runPipeline(pipeline, kOffer) == kOffer );
+
+    // Line endings are normalized to CRLF.
+    REQUIRE( runPipeline(pipeline, "v=0\nbad line\n") == "v=0\r\nbad line\r\n" );
+}
+
+TEST_CASE("Drop Codecs", "[Pipeline]"){
+    SdpPipeline pipeline;
+    pipeline.add(make_shared<DropCodecsFilter>(vector<string>{ "opus", "pcmu", "VP8" }));
+
+    string out = runPipeline(pipeline, kOffer);
+    REQUIRE( out.find("m=audio 5000 RTP/AVP 8 101\r\n") != string::npos );
+    REQUIRE( out.find("m=video 5002 RTP/AVP 97\r\n") != string::npos );
+    REQUIRE( out.find("opus") == string::npos );
+    REQUIRE( out.find("a=fmtp:111") == string::npos );
+    REQUIRE( out.find("a=rtcp-fb:96") == string::npos );
+    REQUIRE( out.find("a=rtpmap:8 PCMA/8000\r\n") != string::npos );
+
+    // Dropping every format rejects the stream.
+    SdpPipeline dropAll;
+    dropAll.add(make_shared<DropCodecsFilter>(vector<string>{ "VP8", "H264" }));
+    out = runPipeline(dropAll, kOffer);
+    REQUIRE( out.find("m=video 0 RTP/AVP 96 97\r\n") != string::npos );
+}
+
+TEST_CASE("Strip Attributes", "[Pipeline]"){
+    SdpPipeline pipeline;
+    pipeline.add(make_shared<StripAttributesFilter>(vector<string>{ "ice-ufrag", "rtcp-fb" }));
+
+    string out = runPipeline(pipeline, kOffer);
+    REQUIRE( out.find("ice-ufrag") == string::npos );
+    REQUIRE( out.find("rtcp-fb") == string::npos );
+    REQUIRE( out.size() == strlen(kOffer) - strlen("a=ice-ufrag:abcd\r\na=rtcp-fb:96 nack\r\n") );
+}
+
+TEST_CASE("Reorder Payload Types", "[Pipeline]"){
+    SdpPipeline pipeline;
+    pipeline.add(make_shared<ReorderPayloadTypesFilter>(vector<string>{ "PCMU", "PCMA", "H264" }));
+
+    string out = runPipeline(pipeline, kOffer);
+    REQUIRE( out.find("m=audio 5000 RTP/AVP 0 8 111 101\r\n") != string::npos );
+    REQUIRE( out.find("m=video 5002 RTP/AVP 97 96\r\n") != string::npos );
+}
+
+TEST_CASE("Force Direction", "[Pipeline]"){
+    SdpPipeline pipeline;
+    pipeline.add(make_shared<ForceDirectionFilter>(MediaDirection::SendOnly));
+
+    string out = runPipeline(pipeline, kOffer);
+    REQUIRE( out.find("sendrecv") == string::npos );
+    REQUIRE( out.find("recvonly") == string::npos );
+    REQUIRE( out.find("t=0 0\r\na=sendonly\r\nm=audio") != string::npos );
+    REQUIRE( out.find("a=ice-ufrag:abcd\r\na=sendonly\r\nm=video") != string::npos );
+    REQUIRE( out.find("a=rtpmap:97 H264/90000\r\na=sendonly\r\n") != string::npos );
+    REQUIRE( out.find("a=sendonly\r\na=sendonly") == string::npos );
+}
+
+TEST_CASE("Cap Bandwidth", "[Pipeline]"){
+    SdpPipeline pipeline;
+    pipeline.add(make_shared<CapBandwidthFilter>(500));
+
+    string out = runPipeline(pipeline, kOffer);
+    REQUIRE( out.find("b=AS:128\r\n") != string::npos );
+    REQUIRE( out.find("b=AS:500\r\n") != string::npos );
+    REQUIRE( out.find("b=AS:2000") == string::npos );
+}
+
+TEST_CASE("Chained Filters", "[Pipeline]"){
+    SdpPipeline pipeline;
+    pipeline.add(make_shared<DropCodecsFilter>(vector<string>{ "VP8" }))
+            .add(make_shared<StripAttributesFilter>(vector<string>{ "ice-ufrag" }))
+            .add(make_shared<ReorderPayloadTypesFilter>(vector<string>{ "PCMA" }))
+            .add(make_shared<ForceDirectionFilter>(MediaDirection::Inactive))
+            .add(make_shared<CapBandwidthFilter>(64));
+
+    string expected =
+        "v=0\r\n"
+        "o=- 1 1 IN IP4 10.0.0.1\r\n"
+        "s=-\r\n"
+        "t=0 0\r\n"
+        "a=inactive\r\n"
+        "m=audio 5000 RTP/AVP 8 111 0 101\r\n"
+        "b=AS:64\r\n"
+        "a=rtpmap:111 opus/48000/2\r\n"
+        "a=fmtp:111 minptime=10\r\n"
+        "a=rtpmap:8 PCMA/8000\r\n"
+        "a=rtpmap:101 telephone-event/8000\r\n"
+        "a=inactive\r\n"
+        "m=video 5002 RTP/AVP 97\r\n"
+        "b=AS:64\r\n"
+        "a=rtpmap:97 H264/90000\r\n"
+        "a=inactive\r\n";
+
+    REQUIRE( runPipeline(pipeline, kOffer) == expected );
+
+    // Filters are reset between runs.
+    REQUIRE( runPipeline(pipeline, kOffer) == expected );
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/sdp-fixed.h>
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+using namespace zsdp;
+using namespace std;
+
+static atomic<size_t> gAllocationCount(0);
+
+void* operator new(size_t size){
+    gAllocationCount++;
+    void* p = malloc(size == 0 ? 1 : size);
+    if(p == NULL)
+        throw bad_alloc();
+
+    return p;
+}
+
+void operator delete(void* p) noexcept{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept{
+    free(p);
+}
+
+static const char* const kOffer =
+    "v=0\r\n"
+    "o=- 4611731400430051336 2 IN IP4 127.0.0.1\r\n"
+    "s=-\r\n"
+    "c=IN IP4 203.0.113.1\r\n"
+    "t=0 0\r\n"
+    "a=group:BUNDLE 0 1\r\n"
+    "m=audio 10000 RTP/AVP 111 0 8 101\r\n"
+    "c=IN IP4 203.0.113.1\r\n"
+    "b=AS:64\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=rtpmap:101 telephone-event/8000\r\n"
+    "a=sendrecv\r\n"
+    "m=video 10002 RTP/SAVP 96 97\r\n"
+    "i=camera\r\n"
+    "k=prompt\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=rtpmap:97 H264/90000\r\n"
+    "a=fmtp:97 profile-level-id=42e01f;packetization-mode=1\r\n"
+    "a=recvonly\r\n";
+
+typedef SdpFixed<4, 8, 8, 1024> RealtimeSdp;
+
+TEST_CASE("Parse And Serialize Without Allocating", "[SdpFixed]"){
+    RealtimeSdp sdp;
+    char out[2048];
+    size_t size = 0;
+
+    size_t before = gAllocationCount;
+    FixedStatus parsed = sdp.parse(kOffer);
+    FixedStatus written = sdp.serialize(out, sizeof(out), &size);
+    size_t allocations = gAllocationCount - before;
+
+    REQUIRE( parsed == FixedStatus::Ok );
+    REQUIRE( written == FixedStatus::Ok );
+    REQUIRE( allocations == 0 );
+
+    REQUIRE( sdp.streamCount() == 2 );
+    REQUIRE( sdp.attributeCount() == 1 );
+    REQUIRE( sdp.attribute(0) == "group:BUNDLE 0 1" );
+    REQUIRE( sdp.text(sdp.session().origin.sessionID) == "4611731400430051336" );
+
+    const FixedStream& audio = sdp.stream(0);
+    REQUIRE( audio.mediaType == MediaType::Audio );
+    REQUIRE( audio.port == 10000 );
+    REQUIRE( audio.payloadTypeCount == 4 );
+    REQUIRE( sdp.payloadType(0, 3) == 101 );
+    REQUIRE( audio.bandwidth.kbps == 64 );
+    REQUIRE( audio.attributeCount == 4 );
+    REQUIRE( sdp.streamAttribute(0, 1) == "fmtp:111 minptime=10;useinbandfec=1" );
+
+    const FixedStream& video = sdp.stream(1);
+    REQUIRE( video.protocol == Protocol::RTP_SAVP );
+    REQUIRE( sdp.text(video.title) == "camera" );
+    REQUIRE( video.encryption.type == EncryptionType::PromptForKey );
+    REQUIRE( sdp.streamAttribute(1, 3) == "recvonly" );
+
+    // Same text as the heap-based object model.
+    Sdp reference = parseSdp(kOffer);
+    REQUIRE( string(out, size) == sdpToString(&reference) );
+}
+
+TEST_CASE("SdpFixed Reports Overflow", "[SdpFixed]"){
+    SdpFixed<1, 8, 8, 1024> oneStream;
+    REQUIRE( oneStream.parse(kOffer) == FixedStatus::Overflow );
+
+    SdpFixed<4, 3, 8, 1024> fewAttributes;
+    REQUIRE( fewAttributes.parse(kOffer) == FixedStatus::Overflow );
+
+    SdpFixed<4, 8, 2, 1024> fewPayloadTypes;
+    REQUIRE( fewPayloadTypes.parse(kOffer) == FixedStatus::Overflow );
+
+    SdpFixed<4, 8, 8, 64> littleText;
+    REQUIRE( littleText.parse(kOffer) == FixedStatus::Overflow );
+
+    // The output buffer is checked too, and the needed size reported.
+    RealtimeSdp sdp;
+    REQUIRE( sdp.parse(kOffer) == FixedStatus::Ok );
+
+    char out[32];
+    size_t size = 0;
+    REQUIRE( sdp.serialize(out, sizeof(out), &size) == FixedStatus::Overflow );
+    Sdp reference = parseSdp(kOffer);
+    REQUIRE( size == sdpToString(&reference).size() );
+}
+
+TEST_CASE("SdpFixed Rejects What parseSdp Rejects", "[SdpFixed]"){
+    RealtimeSdp sdp;
+    REQUIRE( sdp.parse("o=- 1 1 IN IP4 127.0.0.1\r\n") == FixedStatus::NotSdp );
+    REQUIRE( sdp.parse("v=0\r\ns=-\r\no=- 1 1 IN IP4 127.0.0.1\r\nt=0 0\r\n") == FixedStatus::OutOfOrder );
+    REQUIRE( sdp.parse("v=0\r\no=- 1 1 IN IP4 127.0.0.1\r\ns=-\r\n") == FixedStatus::OutOfOrder );
+    REQUIRE( sdp.parse("v=0\r\no=- 1 1 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\nm=audio 5000 RTP/AVP 200\r\n") == FixedStatus::Malformed );
+    REQUIRE( sdp.parse("v=0\r\no=- 1 1 XX IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\n") == FixedStatus::Malformed );
+
+    // Unknown line types are skipped, as parseSdp() skips them.
+    REQUIRE( sdp.parse("v=0\r\no=- 1 1 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\nx=ignored\r\n") == FixedStatus::Ok );
+}
+
+TEST_CASE("SdpFixed Keeps Repeat Times As Written", "[SdpFixed]"){
+    RealtimeSdp sdp;
+    REQUIRE( sdp.parse("v=0\r\n"
+                       "o=- 1 1 IN IP6 ::1\r\n"
+                       "s=Session\r\n"
+                       "t=3034423619 3042462419\r\n"
+                       "r=7d 1h 0 25h\r\n"
+                       "r=604800 3600 0\r\n"
+                       "z=2882844526 -1h 2898848070 0\r\n"
+                       "m=application 5004/2 udp wb\r\n") == FixedStatus::Ok );
+
+    REQUIRE( sdp.session().timeCount == 1 );
+    REQUIRE( sdp.text(sdp.session().times[0].repeats) == "7d 1h 0 25h\n604800 3600 0" );
+    REQUIRE( sdp.stream(0).portCount == 2 );
+    REQUIRE( sdp.text(sdp.stream(0).codec) == "wb" );
+
+    char out[512];
+    size_t size = 0;
+    REQUIRE( sdp.serialize(out, sizeof(out), &size) == FixedStatus::Ok );
+    REQUIRE( string(out, size) ==
+             "v=0\r\n"
+             "o=- 1 1 IN IP6 ::1\r\n"
+             "s=Session\r\n"
+             "c=IN IP4 0.0.0.0\r\n"
+             "t=3034423619 3042462419\r\n"
+             "r=7d 1h 0 25h\r\n"
+             "r=604800 3600 0\r\n"
+             "z=2882844526 -1h 2898848070 0\r\n"
+             "m=application 5004/2 udp wb\r\n"
+             "c=IN IP4 0.0.0.0\r\n" );
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/sdp-merge.h>
+
+using namespace zsdp;
+using namespace std;
+
+static const char* const kSession =
+    "v=0\r\n"
+    "o=- 4000 1 IN IP4 10.0.0.9\r\n"
+    "s=-\r\n"
+    "c=IN IP4 10.0.0.9\r\n"
+    "t=0 0\r\n"
+    "a=group:BUNDLE old\r\n"
+    "a=msid-semantic: WMS\r\n";
+
+static const char* const kPublisherA =
+    "v=0\r\n"
+    "o=- 1 1 IN IP4 10.0.0.1\r\n"
+    "s=-\r\n"
+    "t=0 0\r\n"
+    "m=audio 5000 RTP/AVP 111 0\r\n"
+    "a=mid:0\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=extmap:1 urn:ietf:params:rtp-hdrext:ssrc-audio-level\r\n"
+    "m=video 5002 RTP/AVP 96 97\r\n"
+    "a=mid:1\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=rtpmap:97 rtx/90000\r\n"
+    "a=fmtp:97 apt=96\r\n"
+    "a=rtcp-fb:96 nack\r\n"
+    "a=extmap:2 urn:ietf:params:rtp-hdrext:toffset\r\n";
+
+static const char* const kPublisherB =
+    "v=0\r\n"
+    "o=- 2 1 IN IP4 10.0.0.2\r\n"
+    "s=-\r\n"
+    "t=0 0\r\n"
+    "m=audio 6000 RTP/AVP 111\r\n"
+    "a=mid:0\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+    "a=extmap:1 urn:ietf:params:rtp-hdrext:ssrc-audio-level\r\n"
+    "m=video 6002 RTP/AVP 96 97\r\n"
+    "c=IN IP4 10.0.0.2\r\n"
+    "a=rtpmap:96 H264/90000\r\n"
+    "a=fmtp:96 profile-level-id=42e01f;packetization-mode=1\r\n"
+    "a=rtpmap:97 rtx/90000\r\n"
+    "a=fmtp:97 apt=96\r\n"
+    "a=rtcp-fb:96 nack\r\n"
+    "a=rtcp-fb:* ccm fir\r\n"
+    "a=extmap:1 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+    "m=application 0 UDP webrtc-datachannel\r\n";
+
+TEST_CASE("Merge Sections Into One Bundle", "[SdpMerge]"){
+    SdpSnapshot a(parseSdp(kPublisherA));
+    SdpSnapshot b(parseSdp(kPublisherB));
+
+    SdpMerger merger(parseSdp(kSession));
+    for(size_t i = 0; i < a.streamCount(); i++)
+        merger.add(a, i);
+
+    for(size_t i = 0; i < b.streamCount(); i++)
+        merger.add(b, i);
+
+    REQUIRE( merger.size() == 5 );
+
+    // Sections are held, not copied.
+    REQUIRE( merger.section(0).get() == a.sharedStream(0).get() );
+
+    // The first publisher's sections need no change.
+    REQUIRE( merger.unchanged(0) );
+    REQUIRE( merger.unchanged(1) );
+    REQUIRE( merger.mid(0) == "0" );
+
+    // B's audio has the same codec and extension, so only its mid changes.
+    REQUIRE_FALSE( merger.unchanged(2) );
+    REQUIRE( merger.mid(2) == "2" );
+    REQUIRE( merger.payloadType(2, 111) == 111 );
+
+    // B's H264 and its RTX clash with A's VP8 and RTX, and take the next free numbers.
+    REQUIRE( merger.mid(3) == "3" );
+    REQUIRE( merger.payloadType(3, 96) == 98 );
+    REQUIRE( merger.payloadType(3, 97) == 99 );
+    REQUIRE( merger.payloadType(3, 100) == kPayloadType_NotSet );
+    REQUIRE( merger.extmapId(3, 1) == 3 );
+    REQUIRE( merger.extmapId(3, 2) == 0 );
+
+    string merged = merger.toString();
+
+    REQUIRE( merged.find("a=group:BUNDLE 0 1 2 3\r\n") != string::npos );
+    REQUIRE( merged.find("BUNDLE old") == string::npos );
+    REQUIRE( merged.find("a=msid-semantic: WMS\r\n") != string::npos );
+
+    REQUIRE( merged.find("m=video 6002 RTP/AVP 98 99\r\n"
+                         "c=IN IP4 10.0.0.2\r\n"
+                         "a=mid:3\r\n"
+                         "a=rtpmap:98 H264/90000\r\n"
+                         "a=fmtp:98 profile-level-id=42e01f;packetization-mode=1\r\n"
+                         "a=rtpmap:99 rtx/90000\r\n"
+                         "a=fmtp:99 apt=98\r\n"
+                         "a=rtcp-fb:98 nack\r\n"
+                         "a=rtcp-fb:* ccm fir\r\n"
+                         "a=extmap:3 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n") != string::npos );
+
+    // The rejected section still gets a mid, but stays out of the group.
+    REQUIRE( merged.find("m=application 0 udp webrtc-datachannel\r\n") < merged.find("a=mid:4\r\n") );
+
+    // Unchanged sections are written exactly as SdpWriter writes them.
+    Sdp sdpA = a.toSdp();
+    string textA = sdpToString(&sdpA);
+    REQUIRE( merged.find(textA.substr(textA.find("m=audio"))) != string::npos );
+
+    // The object model agrees with the text.
+    Sdp sdp = merger.toSdp();
+    REQUIRE( sdpToString(&sdp) == merged );
+    REQUIRE( sdp.streams[3].mediaDescription.payloadTypeSet.contains(98) );
+    REQUIRE( sdp.streams[3].find<AttrRtpMap>()->payloadType == 98 );
+
+    // Parsing it back gives the same SDP.
+    Sdp reparsed = parseSdp(merged);
+    REQUIRE( sdpToString(&reparsed) == merged );
+}
+
+TEST_CASE("Identical Codecs Share A Payload Type", "[SdpMerge]"){
+    Sdp source = parseSdp("v=0\r\n"
+                          "o=- 1 1 IN IP4 10.0.0.1\r\n"
+                          "s=-\r\n"
+                          "t=0 0\r\n"
+                          "m=video 5000 RTP/AVP 100 101\r\n"
+                          "a=rtpmap:100 VP8/90000\r\n"
+                          "a=rtpmap:101 vp8/90000\r\n"
+                          "m=video 5002 RTP/AVP 102\r\n"
+                          "a=rtpmap:102 VP8/90000\r\n"
+                          "m=audio 5004 RTP/AVP 0\r\n"
+                          "m=audio 5006 RTP/AVP 0\r\n"
+                          "a=rtpmap:0 opus/48000/2\r\n");
+
+    SdpMerger merger(Sdp{});
+    merger.add(make_shared<Stream>(source.streams[0]));
+    merger.add(make_shared<Stream>(source.streams[1]));
+    merger.add(make_shared<Stream>(source.streams[3]));
+
+    // One section listing the same codec twice keeps two numbers.
+    REQUIRE( merger.payloadType(0, 100) == 100 );
+    REQUIRE( merger.payloadType(0, 101) == 101 );
+
+    // Another section with that codec reuses the first number.
+    REQUIRE( merger.payloadType(1, 102) == 100 );
+
+    // Sections without a=mid get one.
+    REQUIRE( merger.mid(0) == "0" );
+    REQUIRE_FALSE( merger.unchanged(0) );
+
+    // A static payload type has no rtpmap to rename, so a clash on it can't be resolved.
+    REQUIRE( merger.payloadType(2, 0) == 0 );
+    REQUIRE_THROWS_AS( merger.add(make_shared<Stream>(source.streams[2])), runtime_error );
+    REQUIRE_THROWS_AS( merger.add(sp<const Stream>()), invalid_argument );
+}
+
+TEST_CASE("Extmap IDs Past The One-Byte Range", "[SdpMerge]"){
+    string session = "v=0\r\n"
+                     "o=- 1 1 IN IP4 10.0.0.1\r\n"
+                     "s=-\r\n"
+                     "t=0 0\r\n";
+
+    SdpMerger merger(parseSdp(session));
+    for(int i = 0; i < 15; i++){
+        Sdp publisher = parseSdp(session
+                                 + "m=audio 5000 RTP/AVP 0\r\n"
+                                 + "a=extmap:1 urn:example:ext" + to_string(i) + "\r\n");
+
+        merger.add(make_shared<Stream>(publisher.streams[0]));
+    }
+
+    REQUIRE( merger.extmapId(13, 1) == 14 );
+    REQUIRE( merger.extmapId(14, 1) == 16 );
+    REQUIRE( merger.toString().find("a=extmap-allow-mixed\r\n") != string::npos );
+}
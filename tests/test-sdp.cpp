@@ -137,9 +137,278 @@ TEST_CASE("SDP", "[SDP]"){
         "p=+1 (555) 555-5555\r\n"
         "c=IN IP4 1.2.3.4\r\n"
         "b=CT:1024\r\n"
+        "t=1000 2000\r\n"
         "z=1000 -3600 2000 3600\r\n"
-        "k=clear:12345\r\n"
-        "t=1000 2000\r\n";
+        "k=clear:12345\r\n";
     REQUIRE( actual == expected );
 }
 
+TEST_CASE("Parse SDP", "[Parse SDP]"){
+    string sdpStr =
+        "v=0\r\n"
+        "o=- 123 1 IN IP4 10.0.0.1\r\n"
+        "s=session\r\n"
+        "c=IN IP4 10.0.0.1\r\n"
+        "t=0 0\r\n"
+        "r=7d 1h 0 25h\r\n"
+        "a=tool:zsdp\r\n"
+        "m=audio 5000 RTP/AVP 0 8\r\n"
+        "i=audio title\r\n"
+        "c=IN IP4 10.0.0.2\r\n"
+        "b=AS:64\r\n"
+        "a=rtpmap:0 PCMU/8000\r\n"
+        "a=sendrecv\r\n"
+        "m=video 5002 RTP/AVP 96\r\n"
+        "a=rtpmap:96 VP8/90000\r\n";
+
+    Sdp sdp = parseSdp(sdpStr);
+    REQUIRE( sdp.origin.sessionID == "123" );
+    REQUIRE( sdp.sessionName == "session" );
+    REQUIRE( sdp.times.size() == 1 );
+    REQUIRE( sdp.times[0].repeatingTimes.size() == 1 );
+    REQUIRE( sdp.times[0].repeatingTimes[0].interval == 7 * 24 * 3600 );
+    REQUIRE( sdp.times[0].repeatingTimes[0].offsetsFromStartTime.size() == 2 );
+    REQUIRE( sdp.times[0].repeatingTimes[0].offsetsFromStartTime[1] == 25 * 3600 );
+    REQUIRE( sdp.attributes.size() == 1 );
+
+    REQUIRE( sdp.streams.size() == 2 );
+    REQUIRE( sdp.streams[0].title == "audio title" );
+    REQUIRE( sdp.streams[0].connectionData.host == "10.0.0.2" );
+    REQUIRE( sdp.streams[0].bandwidth.type == BandwidthType::ApplicationSpecific );
+    REQUIRE( sdp.streams[0].bandwidth.kbps == 64 );
+    REQUIRE( sdp.streams[0].attributes.size() == 2 );
+    REQUIRE( sdp.streams[1].mediaDescription.payloadTypes.size() == 1 );
+    REQUIRE( sdp.streams[1].attributes.size() == 1 );
+
+    string expected =
+        "v=0\r\n"
+        "o=- 123 1 IN IP4 10.0.0.1\r\n"
+        "s=session\r\n"
+        "c=IN IP4 10.0.0.1\r\n"
+        "t=0 0\r\n"
+        "r=604800 3600 0 90000\r\n"
+        "a=tool:zsdp\r\n"
+        "m=audio 5000 RTP/AVP 0 8\r\n"
+        "i=audio title\r\n"
+        "c=IN IP4 10.0.0.2\r\n"
+        "b=AS:64\r\n"
+        "a=rtpmap:0 PCMU/8000\r\n"
+        "a=sendrecv\r\n"
+        "m=video 5002 RTP/AVP 96\r\n"
+        "c=IN IP4 0.0.0.0\r\n"
+        "a=rtpmap:96 VP8/90000\r\n";
+    REQUIRE( sdpToString(&sdp) == expected );
+    Sdp reparsed = parseSdp(sdpToString(&sdp));
+    REQUIRE( sdpToString(&reparsed) == expected );
+
+    // Bare LF line endings are accepted.
+    sdp = parseSdp("v=0\no=- 1 1 IN IP4 1.2.3.4\ns=-\nt=0 0\nm=audio 9 RTP/AVP 0\n");
+    REQUIRE( sdp.streams.size() == 1 );
+}
+
+TEST_CASE("Parse SDP Line Order", "[Parse SDP]"){
+    REQUIRE_THROWS( parseSdp("") );
+    REQUIRE_THROWS( parseSdp("o=- 1 1 IN IP4 1.2.3.4\r\nv=0\r\n") );
+
+    // Missing s= and t=
+    REQUIRE_THROWS( parseSdp("v=0\r\no=- 1 1 IN IP4 1.2.3.4\r\n") );
+    REQUIRE_THROWS( parseSdp("v=0\r\no=- 1 1 IN IP4 1.2.3.4\r\ns=-\r\n") );
+
+    // r= without t=
+    REQUIRE_THROWS( parseSdp("v=0\r\no=- 1 1 IN IP4 1.2.3.4\r\ns=-\r\nr=7d 1h 0\r\nt=0 0\r\n") );
+
+    // Session-level lines after the first m=
+    REQUIRE_THROWS( parseSdp("v=0\r\no=- 1 1 IN IP4 1.2.3.4\r\ns=-\r\nt=0 0\r\n"
+                             "m=audio 9 RTP/AVP 0\r\nt=0 0\r\n") );
+
+    // Attributes must follow c= and b= within a media section.
+    REQUIRE_THROWS( parseSdp("v=0\r\no=- 1 1 IN IP4 1.2.3.4\r\ns=-\r\nt=0 0\r\n"
+                             "m=audio 9 RTP/AVP 0\r\na=sendrecv\r\nc=IN IP4 1.2.3.4\r\n") );
+
+    // Unknown line types are ignored.
+    Sdp sdp = parseSdp("v=0\r\no=- 1 1 IN IP4 1.2.3.4\r\ns=-\r\nt=0 0\r\n"
+                       "m=audio 9 RTP/AVP 0\r\nx=unknown\r\na=sendrecv\r\n");
+    REQUIRE( sdp.streams.size() == 1 );
+    REQUIRE( sdp.streams[0].attributes.size() == 1 );
+
+    // A single media-level i= line is applied once and nothing else.
+    sdp = parseSdp("v=0\r\no=- 1 1 IN IP4 1.2.3.4\r\ns=-\r\nt=0 0\r\n"
+                   "m=audio 9 RTP/AVP 0\r\ni=title\r\n");
+    REQUIRE( sdp.streams[0].title == "title" );
+    REQUIRE( sdp.streams[0].attributes.empty() );
+    REQUIRE( sdp.streams[0].connectionData.host.empty() );
+}
+
+TEST_CASE("SDP Attribute Pass-Through", "[Parse SDP]"){
+    string sdpStr =
+        "v=0\r\n"
+        "o=- 123 1 IN IP4 10.0.0.1\r\n"
+        "s=-\r\n"
+        "c=IN IP4 10.0.0.1\r\n"
+        "t=0 0\r\n"
+        "a=group:BUNDLE 0\r\n"
+        "a=msid-semantic: WMS *\r\n"
+        "m=audio 5000 RTP/AVP 111\r\n"
+        "c=IN IP4 10.0.0.1\r\n"
+        "a=ice-ufrag:F7gI\r\n"
+        "a=rtpmap:111 opus/48000/2\r\n"
+        "a=rtcp-mux\r\n"
+        "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+        "a=x-unknown:1 2 3\r\n";
+
+    Sdp sdp = parseSdp(sdpStr);
+    REQUIRE( sdp.attributes.size() == 2 );
+    REQUIRE( sdp.streams[0].attributes.size() == 5 );
+    REQUIRE( dynamic_cast<AttrRtpMap*>(sdp.streams[0].attributes[1].get()) != NULL );
+    REQUIRE( sdpToString(&sdp) == sdpStr );
+
+    ParseOptions options;
+    options.decodeAttributes = false;
+    sdp = parseSdp(sdpStr, options);
+    for(auto& attr : sdp.streams[0].attributes)
+        REQUIRE( dynamic_cast<GenericAttribute*>(attr.get()) != NULL );
+
+    REQUIRE( sdpToString(&sdp) == sdpStr );
+
+    string out = "prefix";
+    sdpToString(&sdp, out);
+    REQUIRE( out == "prefix" + sdpStr );
+}
+
+TEST_CASE("Parse JSON-Escaped SDP", "[Parse SDP]"){
+    string sdpStr =
+        "v=0\r\n"
+        "o=- 123 1 IN IP4 10.0.0.1\r\n"
+        "s=\"quoted\" \\ caf\xc3\xa9\r\n"
+        "c=IN IP4 10.0.0.1\r\n"
+        "t=0 0\r\n"
+        "m=audio 5000 RTP/AVP 111\r\n"
+        "c=IN IP4 10.0.0.1\r\n"
+        "a=rtpmap:111 opus/48000/2\r\n"
+        "a=x-path:C:\\new\r\n";
+
+    string escaped =
+        "\"v=0\\r\\n"
+        "o=- 123 1 IN IP4 10.0.0.1\\r\\n"
+        "s=\\\"quoted\\\" \\\\ caf\\u00e9\\r\\n"
+        "c=IN IP4 10.0.0.1\\r\\n"
+        "t=0 0\\n"
+        "m=audio 5000 RTP/AVP 111\\r\\n"
+        "c=IN IP4 10.0.0.1\\r\\n"
+        "a=rtpmap:111 opus\\/48000\\/2\\r\\n"
+        "a=x-path:C:\\\\new\\r\\n\"";
+
+    ParseOptions options;
+    options.inputEncoding = InputEncoding::JsonString;
+    Sdp sdp = parseSdp(escaped, options);
+    REQUIRE( sdp.sessionName == "\"quoted\" \\ caf\xc3\xa9" );
+    REQUIRE( sdp.streams.size() == 1 );
+    REQUIRE( sdp.streams[0].attributes.size() == 2 );
+    REQUIRE( sdp.streams[0].attributes[1]->value() == "C:\\new" );
+    REQUIRE( sdpToString(&sdp) == sdpStr );
+
+    // Without the surrounding quotes.
+    sdp = parseSdp(StringView(escaped.data() + 1, escaped.size() - 2), options);
+    REQUIRE( sdpToString(&sdp) == sdpStr );
+
+    REQUIRE_THROWS_AS( parseSdp("v=0\\r\\no=- 1 1 IN IP4 1.2.3.4\\r\\ns=\\q\\r\\nt=0 0", options), invalid_argument );
+}
+
+TEST_CASE("Parse SDP Into Reused Sdp", "[Parse SDP]"){
+    const string large =
+        "v=0\r\n"
+        "o=- 123 1 IN IP4 10.0.0.1\r\n"
+        "s=Large\r\n"
+        "i=Information\r\n"
+        "c=IN IP4 10.0.0.1\r\n"
+        "b=AS:512\r\n"
+        "t=0 0\r\n"
+        "a=tool:test\r\n"
+        "m=audio 5000 RTP/AVP 111 0\r\n"
+        "i=Audio\r\n"
+        "c=IN IP4 10.0.0.2\r\n"
+        "a=rtpmap:111 opus/48000/2\r\n"
+        "a=sendrecv\r\n"
+        "m=video 5002 RTP/AVP 96\r\n"
+        "c=IN IP4 10.0.0.3\r\n"
+        "k=clear:secret\r\n"
+        "a=rtpmap:96 VP8/90000\r\n";
+
+    const string small =
+        "v=0\r\n"
+        "o=- 456 2 IN IP4 10.0.0.9\r\n"
+        "s=Small\r\n"
+        "c=IN IP4 10.0.0.9\r\n"
+        "t=0 0\r\n"
+        "m=audio 6000 RTP/AVP 0\r\n"
+        "c=IN IP4 10.0.0.9\r\n";
+
+    ParseContext context;
+    Sdp reuse;
+
+    parseSdpInto(reuse, large, context);
+    REQUIRE( sdpToString(&reuse) == large );
+    REQUIRE( context.attributeCounts == vector<uint32_t>({ 1, 2, 1 }) );
+
+    const uint8_t* payloadTypes = reuse.streams[0].mediaDescription.payloadTypes.data();
+
+    // Nothing from the larger SDP survives, but the first stream's storage is reused.
+    parseSdpInto(reuse, small, context);
+    REQUIRE( sdpToString(&reuse) == small );
+    REQUIRE( reuse.streams.size() == 1 );
+    REQUIRE( reuse.streams[0].attributes.empty() );
+    REQUIRE( reuse.streams[0].title.empty() );
+    REQUIRE( reuse.streams[0].mediaDescription.payloadTypes.data() == payloadTypes );
+
+    parseSdpInto(reuse, large, threadParseContext());
+    Sdp fresh = parseSdp(large);
+    REQUIRE( sdpToString(&reuse) == sdpToString(&fresh) );
+
+    REQUIRE_THROWS_AS( parseSdpInto(reuse, "x=0\r\n", context), runtime_error );
+}
+
+TEST_CASE("Find Attributes By Class", "[Parse SDP]"){
+    Sdp sdp = parseSdp(
+        "v=0\r\n"
+        "o=- 123 1 IN IP4 10.0.0.1\r\n"
+        "s=-\r\n"
+        "c=IN IP4 10.0.0.1\r\n"
+        "t=0 0\r\n"
+        "m=audio 5000 RTP/AVP 111 0 101\r\n"
+        "a=rtpmap:111 opus/48000/2\r\n"
+        "a=x-custom:1\r\n"
+        "a=fmtp:111 minptime=10\r\n"
+        "a=rtpmap:101 telephone-event/8000\r\n"
+        "a=sendrecv\r\n");
+
+    Stream& stream = sdp.streams[0];
+
+    const AttrRtpMap* rtpMap = stream.find<AttrRtpMap>();
+    REQUIRE( rtpMap != NULL );
+    REQUIRE( rtpMap->payloadType == 111 );
+    REQUIRE( stream.find<AttrFormatParams>()->formatParams == "minptime=10" );
+    REQUIRE( stream.find<AttrMediaDirection>()->direction == MediaDirection::SendRecv );
+    REQUIRE( stream.find<AttrPTime>() == NULL );
+
+    vector<uint8_t> payloadTypes;
+    for(const AttrRtpMap& attr : stream.findAll<AttrRtpMap>())
+        payloadTypes.push_back(attr.payloadType);
+    REQUIRE( payloadTypes == vector<uint8_t>({ 111, 101 }) );
+    REQUIRE( stream.findAll<AttrPTime>().empty() );
+
+    const Attribute& custom = *stream.attributes[1];
+    REQUIRE( custom.id() == AttrId::Generic );
+    REQUIRE( custom.key() == "x-custom" );
+    REQUIRE( custom.as<AttrRtpMap>() == NULL );
+    REQUIRE( stream.attributes[0]->as<AttrRtpMap>() == rtpMap );
+
+    // Attributes added without reindexing are still found.
+    auto ptime = make_shared<AttrPTime>();
+    ptime->packetDuration = 20;
+    stream.attributes.push_back(ptime);
+    REQUIRE( stream.find<AttrPTime>() == ptime.get() );
+
+    stream.reindexAttributes();
+    REQUIRE( stream.find<AttrPTime>() == ptime.get() );
+    REQUIRE( stream.find<AttrRtpMap>() == rtpMap );
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/sdp.h>
+#include <zsdp/small-vector.h>
+
+using namespace zsdp;
+using namespace std;
+
+TEST_CASE("SmallVector Spills To Heap", "[SmallVector]"){
+    SmallVector<string, 2> v;
+    REQUIRE( v.isInline() );
+    REQUIRE( v.capacity() == 2 );
+
+    v.push_back("a");
+    v.push_back("b");
+    REQUIRE( v.isInline() );
+
+    v.push_back("c");
+    REQUIRE( !v.isInline() );
+    REQUIRE( v.size() == 3 );
+    REQUIRE( v[0] == "a" );
+    REQUIRE( v[2] == "c" );
+
+    // Pushing a reference to an element that moves during the spill.
+    SmallVector<string, 1> self;
+    self.push_back("x");
+    self.push_back(self[0]);
+    REQUIRE( self.size() == 2 );
+    REQUIRE( self[1] == "x" );
+
+    v.clear();
+    REQUIRE( v.empty() );
+    REQUIRE( v.capacity() >= 3 );
+}
+
+TEST_CASE("SmallVector Copy And Move", "[SmallVector]"){
+    SmallVector<string, 2> small { "a" };
+    SmallVector<string, 2> big { "a", "b", "c" };
+
+    SmallVector<string, 2> smallCopy(small);
+    SmallVector<string, 2> bigCopy(big);
+    REQUIRE( smallCopy == small );
+    REQUIRE( bigCopy == big );
+
+    SmallVector<string, 2> smallMoved(std::move(smallCopy));
+    REQUIRE( smallMoved.isInline() );
+    REQUIRE( smallMoved == small );
+    REQUIRE( smallCopy.empty() );
+
+    const string* heapData = bigCopy.data();
+    SmallVector<string, 2> bigMoved(std::move(bigCopy));
+    REQUIRE( bigMoved.data() == heapData );
+    REQUIRE( bigMoved == big );
+    REQUIRE( bigCopy.empty() );
+    REQUIRE( bigCopy.isInline() );
+
+    bigMoved = small;
+    REQUIRE( bigMoved == small );
+
+    smallMoved.swap(bigCopy);
+    REQUIRE( smallMoved.empty() );
+    REQUIRE( bigCopy == small );
+}
+
+TEST_CASE("SmallVector Insert And Erase", "[SmallVector]"){
+    SmallVector<int, 4> v { 1, 2, 5 };
+    int middle[] = { 3, 4 };
+
+    v.insert(v.begin() + 2, middle, middle + 2);
+    REQUIRE( v == (SmallVector<int, 4> { 1, 2, 3, 4, 5 }) );
+
+    v.insert(v.begin(), 0);
+    REQUIRE( v.front() == 0 );
+
+    v.erase(v.begin() + 1, v.begin() + 3);
+    REQUIRE( v == (SmallVector<int, 4> { 0, 3, 4, 5 }) );
+
+    v.erase(remove_if(v.begin(), v.end(), [](int i){ return i % 2 == 1; }), v.end());
+    REQUIRE( v == (SmallVector<int, 4> { 0, 4 }) );
+
+    v.resize(3, 7);
+    REQUIRE( v.back() == 7 );
+    REQUIRE_THROWS_AS( v.at(3), out_of_range );
+}
+
+TEST_CASE("Typical Sdp Fits Inline", "[SmallVector]"){
+    Sdp sdp = parseSdp(
+        "v=0\r\n"
+        "o=- 123 1 IN IP4 10.0.0.1\r\n"
+        "s=-\r\n"
+        "t=0 0\r\n"
+        "a=group:BUNDLE 0 1\r\n"
+        "m=audio 5000 RTP/AVP 111 0 8 101\r\n"
+        "a=rtpmap:111 opus/48000/2\r\n"
+        "a=rtpmap:0 PCMU/8000\r\n"
+        "a=sendrecv\r\n"
+        "m=video 5002 RTP/AVP 96 97\r\n"
+        "a=rtpmap:96 VP8/90000\r\n"
+        "a=rtpmap:97 H264/90000\r\n"
+        "a=sendrecv\r\n");
+
+    REQUIRE( sdp.streams.size() == 2 );
+    REQUIRE( sdp.streams.isInline() );
+    REQUIRE( sdp.attributes.isInline() );
+    for(const Stream& stream : sdp.streams){
+        REQUIRE( stream.mediaDescription.payloadTypes.isInline() );
+        REQUIRE( stream.attributes.isInline() );
+    }
+
+    REQUIRE( sdp.streams[0].mediaDescription.payloadTypes == (PayloadTypeList { 111, 0, 8, 101 }) );
+}
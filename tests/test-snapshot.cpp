@@ -0,0 +1,132 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/snapshot.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace zsdp;
+using namespace std;
+
+static const char* const kOffer =
+    "v=0\r\n"
+    "o=- 123 1 IN IP4 10.0.0.1\r\n"
+    "s=-\r\n"
+    "c=IN IP4 10.0.0.1\r\n"
+    "t=0 0\r\n"
+    "a=group:BUNDLE 0 1\r\n"
+    "m=audio 5000 RTP/AVP 111 0\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=sendrecv\r\n"
+    "m=video 5002 RTP/AVP 96\r\n"
+    "a=rtpmap:96 VP8/90000\r\n"
+    "a=sendrecv\r\n";
+
+TEST_CASE("Snapshot Round Trip", "[SdpSnapshot]"){
+    Sdp sdp = parseSdp(kOffer);
+    SdpSnapshot snapshot(sdp);
+
+    REQUIRE( snapshot.streamCount() == 2 );
+    REQUIRE( snapshot.attributes().size() == 1 );
+    REQUIRE( snapshot.session().streams.empty() );
+    REQUIRE( snapshot.session().origin.sessionID == "123" );
+
+    Sdp copy = snapshot.toSdp();
+    REQUIRE( sdpToString(&copy) == sdpToString(&sdp) );
+
+    SdpSnapshot empty;
+    REQUIRE( empty.streamCount() == 0 );
+    REQUIRE( empty.attributes().empty() );
+}
+
+TEST_CASE("Snapshot Updates Share Untouched Parts", "[SdpSnapshot]"){
+    SdpSnapshot v1(parseSdp(kOffer));
+
+    SdpSnapshot v2 = v1.updateStream(1, [](Stream& stream){
+        stream.mediaDescription.port = 6002;
+    });
+
+    REQUIRE( v1.stream(1).mediaDescription.port == 5002 );
+    REQUIRE( v2.stream(1).mediaDescription.port == 6002 );
+    REQUIRE( v2.sharedStream(0) == v1.sharedStream(0) );
+    REQUIRE( v2.sharedStream(1) != v1.sharedStream(1) );
+    REQUIRE( &v2.session() == &v1.session() );
+    REQUIRE( &v2.attributes() == &v1.attributes() );
+
+    SdpSnapshot v3 = v2.updateSession([](Sdp& session){
+        session.origin.sessionVersion = "2";
+        session.streams.emplace_back(); // ignored
+    });
+
+    REQUIRE( v3.session().origin.sessionVersion == "2" );
+    REQUIRE( v3.session().streams.empty() );
+    REQUIRE( v3.streamCount() == 2 );
+    REQUIRE( v3.sharedStream(1) == v2.sharedStream(1) );
+    REQUIRE( v2.session().origin.sessionVersion == "1" );
+
+    SdpSnapshot v4 = v3.removeStream(0).addStream(v1.stream(0));
+    REQUIRE( v4.stream(0).mediaDescription.mediaType == MediaType::Video );
+    REQUIRE( v4.stream(1).mediaDescription.mediaType == MediaType::Audio );
+    REQUIRE( v4.sharedStream(0) == v3.sharedStream(1) );
+    REQUIRE_THROWS_AS( v4.replaceStream(2, Stream()), out_of_range );
+
+    SdpSnapshot copy = v4;
+    REQUIRE( copy.sameAs(v4) );
+    REQUIRE_FALSE( copy.sameAs(v3) );
+}
+
+TEST_CASE("Publish Snapshots To Concurrent Readers", "[SdpSnapshot]"){
+    SdpSnapshot initial(parseSdp(kOffer));
+    AtomicSdpSnapshot current(initial);
+
+    atomic<bool> done(false);
+    atomic<size_t> badReads(0);
+    vector<thread> readers;
+
+    for(size_t t = 0; t < 4; t++){
+        readers.emplace_back([&](){
+            while(!done.load()){
+                SdpSnapshot snapshot = current.load();
+
+                // Every published version keeps both streams' ports in step.
+                uint16_t audio = snapshot.stream(0).mediaDescription.port;
+                uint16_t video = snapshot.stream(1).mediaDescription.port;
+                if(video != audio + 2)
+                    badReads++;
+            }
+        });
+    }
+
+    SdpSnapshot latest = initial;
+    for(uint16_t port = 5004; port < 7000; port += 2){
+        latest = latest.updateStream(0, [port](Stream& s){ s.mediaDescription.port = port; })
+                       .updateStream(1, [port](Stream& s){ s.mediaDescription.port = port + 2; });
+        current.store(latest);
+    }
+
+    done = true;
+    for(thread& t : readers)
+        t.join();
+
+    REQUIRE( badReads == 0 );
+    REQUIRE( current.load().sameAs(latest) );
+}
@@ -101,3 +101,21 @@ TEST_CASE("String splitting", "[String splitting]"){
     REQUIRE( tokens[0] == "96" );
     REQUIRE( tokens[1] == "param1 param2 param3;param4/param5" );
 }
+
+TEST_CASE("Append Integers", "[Append Integers]"){
+    string s;
+    appendUInt(s, 0);
+    REQUIRE( s == "0" );
+
+    s = "x";
+    appendUInt(s, 18446744073709551615ULL);
+    REQUIRE( s == "x18446744073709551615" );
+
+    s.clear();
+    appendInt(s, -3600);
+    REQUIRE( s == "-3600" );
+
+    s.clear();
+    appendInt(s, INT64_MIN);
+    REQUIRE( s == "-9223372036854775808" );
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include <zsdp/sdp.h>
+#include <zsdp/symbol.h>
+#include <thread>
+#include <vector>
+
+using namespace zsdp;
+using namespace std;
+
+TEST_CASE("Symbol Interning", "[Symbol]"){
+    Symbol a("opus");
+    Symbol b(string("opus"));
+    Symbol c(StringView("xopusx").substr(1, 4));
+
+    REQUIRE( a.isInterned() );
+    REQUIRE( a.c_str() == b.c_str() );
+    REQUIRE( a.c_str() == c.c_str() );
+    REQUIRE( a == b );
+    REQUIRE( a == "opus" );
+    REQUIRE( a == string("opus") );
+    REQUIRE( a != "OPUS" );
+    REQUIRE( a.equalsIgnoreCase("OPUS") );
+    REQUIRE_FALSE( a.equalsIgnoreCase("opu") );
+
+    Symbol empty;
+    REQUIRE( empty.empty() );
+    REQUIRE( empty == Symbol("") );
+
+    Symbol copy = a;
+    Symbol moved = std::move(copy);
+    REQUIRE( moved == a );
+    REQUIRE( copy.empty() );
+}
+
+TEST_CASE("Symbol Too Long To Intern", "[Symbol]"){
+    string text(Symbol::kMaxInternedSize + 1, 'x');
+    Symbol a(text);
+    Symbol b(text);
+
+    REQUIRE_FALSE( a.isInterned() );
+    REQUIRE( a.c_str() != b.c_str() );
+    REQUIRE( a == b );
+    REQUIRE( a != Symbol("x") );
+
+    Symbol copy = a;
+    a = Symbol("short");
+    REQUIRE( copy == text );
+    REQUIRE( a == "short" );
+}
+
+TEST_CASE("Symbol Concurrent Interning", "[Symbol]"){
+    const size_t threadCount = 8;
+    vector<vector<const char*>> seen(threadCount);
+    vector<thread> threads;
+
+    for(size_t t = 0; t < threadCount; t++){
+        threads.emplace_back([&seen, t](){
+            for(int i = 0; i < 200; i++)
+                seen[t].push_back(Symbol("codec-" + to_string(i)).c_str());
+        });
+    }
+
+    for(thread& t : threads)
+        t.join();
+
+    for(size_t t = 1; t < threadCount; t++)
+        REQUIRE( seen[t] == seen[0] );
+}
+
+TEST_CASE("Symbol Fields Are Shared", "[Symbol]"){
+    Sdp first = parseSdp("v=0\r\no=- 1 1 IN IP4 0.0.0.0\r\ns=-\r\nt=0 0\r\n"
+                         "m=audio 5000 RTP/AVP 111\r\na=rtpmap:111 opus/48000/2\r\na=lang:en\r\n");
+    Sdp second = parseSdp("v=0\r\no=- 2 1 IN IP4 0.0.0.0\r\ns=-\r\nt=0 0\r\n"
+                          "m=audio 6000 RTP/AVP 111\r\na=rtpmap:111 opus/48000/2\r\na=lang:en\r\n");
+
+    auto firstRtpMap = dynamic_pointer_cast<AttrRtpMap>(first.streams[0].attributes[0]);
+    auto secondRtpMap = dynamic_pointer_cast<AttrRtpMap>(second.streams[0].attributes[0]);
+    REQUIRE( firstRtpMap->encodingName == "opus" );
+    REQUIRE( firstRtpMap->encodingName.c_str() == secondRtpMap->encodingName.c_str() );
+
+    auto firstLang = dynamic_pointer_cast<AttrMediaLanguage>(first.streams[0].attributes[1]);
+    auto secondLang = dynamic_pointer_cast<AttrMediaLanguage>(second.streams[0].attributes[1]);
+    REQUIRE( firstLang->language.c_str() == secondLang->language.c_str() );
+    REQUIRE( firstLang->sdpLine() == "lang:en" );
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2019 Richard Kern <kernrj@gmail.com>
+ *
+ * This file is part of zsdp.
+ *
+ * Zsdp is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Zsdp is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with zsdp.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ZSDP_VARINT_H__
+#define __ZSDP_VARINT_H__
+
+#include <zsdp/string-view.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdexcept>
+#include <string>
+
+
+namespace zsdp {
+
+/// Appends v as a little-endian base-128 varint (1 byte below 128, at most 10).
+inline void appendVarint(std::string& out, uint64_t v){
+    char buf[10];
+    size_t n = 0;
+    while(v >= 0x80){
+        buf[n++] = (char)(v | 0x80);
+        v >>= 7;
+    }
+
+    buf[n++] = (char)v;
+    out.append(buf, n);
+}
+
+/// Zig-zag maps small negative numbers to small varints.
+inline void appendSignedVarint(std::string& out, int64_t v){
+    appendVarint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+/// Appends a varint length followed by the bytes.
+inline void appendLengthPrefixed(std::string& out, StringView s){
+    appendVarint(out, s.size());
+    out += s;
+}
+
+inline void appendU32(std::string& out, uint32_t v){
+    char buf[4] = { (char)v, (char)(v >> 8), (char)(v >> 16), (char)(v >> 24) };
+    out.append(buf, 4);
+}
+
+inline void storeU32(std::string& out, size_t pos, uint32_t v){
+    out[pos] = (char)v;
+    out[pos + 1] = (char)(v >> 8);
+    out[pos + 2] = (char)(v >> 16);
+    out[pos + 3] = (char)(v >> 24);
+}
+
+inline uint32_t loadU32(const char* p){
+    const uint8_t* b = (const uint8_t*)p;
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+/**
+ * Bounds-checked cursor over an encoded buffer. Nothing is copied: strings
+ * come back as views into the buffer. Throws invalid_argument when a read
+ * would run past the end.
+ */
+class ByteReader {
+public:
+    ByteReader(StringView data, size_t pos = 0) : mData(data), mPos(pos) {
+        if(pos > data.size())
+            fail();
+    }
+
+    size_t position() const { return mPos; }
+    bool atEnd() const { return mPos == mData.size(); }
+
+    void seek(size_t pos){
+        if(pos > mData.size())
+            fail();
+
+        mPos = pos;
+    }
+
+    uint8_t u8(){
+        if(mPos >= mData.size())
+            fail();
+
+        return (uint8_t)mData[mPos++];
+    }
+
+    uint32_t u32(){
+        return loadU32(bytes(4).data());
+    }
+
+    uint64_t varint(){
+        uint64_t v = 0;
+        for(unsigned shift = 0; shift < 64; shift += 7){
+            uint8_t b = u8();
+            v |= (uint64_t)(b & 0x7f) << shift;
+            if((b & 0x80) == 0)
+                return v;
+        }
+
+        throw std::invalid_argument("Malformed varint in encoded SDP.");
+    }
+
+    int64_t signedVarint(){
+        uint64_t v = varint();
+        return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+    }
+
+    StringView bytes(size_t n){
+        if(n > mData.size() - mPos)
+            fail();
+
+        StringView s = mData.substr(mPos, n);
+        mPos += n;
+
+        return s;
+    }
+
+    StringView lengthPrefixed(){
+        return bytes(varint());
+    }
+
+private:
+    [[noreturn]] static void fail(){
+        throw std::invalid_argument("Truncated encoded SDP.");
+    }
+
+    StringView mData;
+    size_t mPos;
+};
+
+} // namespace zsdp
+
+#endif /* __ZSDP_VARINT_H__ */